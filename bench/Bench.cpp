@@ -0,0 +1,265 @@
+#include "Bench.hpp"
+#include "../src/core/HotkeyManager.hpp"
+#include "../src/core/LuaEnvironment.hpp"
+#include "../src/core/Simulation.hpp"
+#include "../src/core/Stats.hpp"
+#include "../src/platform/InputSink.hpp"
+#include "../src/utils/Log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <map>
+#include <thread>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace Bench {
+    namespace {
+        std::vector<std::string> loaded;                     // Scripts of the current workload
+        std::mutex exportedMutex;
+        std::map<std::string, ScriptFunction> exported;      // BENCH.export() of the current workload
+    }
+
+    void Watch::Observe(const InputEvent* events, size_t count) {
+        auto now = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < count; ++i) {
+                const InputEvent& event = events[i];
+                uint16_t key;
+                if (event.type == InputEvent::Type::Key && !event.up && event.code < Mouse) {
+                    key = event.code;
+                } else if (event.type == InputEvent::Type::MouseMove) {
+                    key = Mouse;
+                } else {
+                    continue;
+                }
+                ++presses[key];
+                last[key] = now;
+                if (key == traced) trace.push_back(now);
+            }
+            total += count;
+        }
+        changed.notify_all();
+    }
+
+    uint64_t Watch::Presses(uint16_t key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return presses[key];
+    }
+
+    uint64_t Watch::Total() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return total;
+    }
+
+    std::optional<Clock::time_point> Watch::WaitFor(uint16_t key, uint64_t seen, Clock::duration timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!changed.wait_for(lock, timeout, [&] { return presses[key] > seen; })) return std::nullopt;
+        return last[key];
+    }
+
+    bool Watch::WaitTotal(uint64_t count, Clock::duration timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, timeout, [&] { return total >= count; });
+    }
+
+    void Watch::Trace(uint16_t key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        traced = key;
+        trace.clear();
+    }
+
+    std::vector<Clock::time_point> Watch::TakeTrace() {
+        std::lock_guard<std::mutex> lock(mutex);
+        traced = -1;
+        return std::move(trace);
+    }
+
+    Result& Result::Add(const std::string& key, double value, int decimals) {
+        char text[64];
+        std::snprintf(text, sizeof(text), "%.*f", decimals, std::isfinite(value) ? value : 0.0);
+        return Field(key, text);
+    }
+
+    Result& Result::Add(const std::string& key, const std::string& value) {
+        std::string quoted = "\"";
+        for (char c : value) {
+            if (c == '"' || c == '\\') quoted += '\\';
+            quoted += (unsigned char)c < 0x20 ? ' ' : c;
+        }
+        return Field(key, quoted + "\"");
+    }
+
+    Result& Result::Latency(const std::string& key, std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double sample : samples) sum += sample;
+        auto at = [&](double p) { return samples.empty() ? 0.0 : samples[(size_t)(p * (double)(samples.size() - 1))]; };
+        Add(key + "_count", (uint64_t)samples.size());
+        Add(key + "_mean_us", samples.empty() ? 0.0 : sum / (double)samples.size());
+        Add(key + "_p50_us", at(0.5));
+        Add(key + "_p90_us", at(0.9));
+        Add(key + "_p99_us", at(0.99));
+        return Add(key + "_max_us", samples.empty() ? 0.0 : samples.back());
+    }
+
+    Result& Result::Latency(const std::string& key, const Histogram& histogram) {
+        Add(key + "_count", histogram.Count());
+        Add(key + "_mean_us", histogram.Mean());
+        Add(key + "_p50_us", histogram.Percentile(0.5));
+        Add(key + "_p99_us", histogram.Percentile(0.99));
+        return Add(key + "_max_us", histogram.Max());
+    }
+
+    void Result::Emit() {
+        std::string line = json + "}";
+        if (options.out.empty()) {
+            Log::Out() << line;
+            return;
+        }
+        std::ofstream file(options.out, std::ios::app);
+        file << line << "\n";
+    }
+
+    bool Result::Fail(const std::string& error) {
+        Add("error", error);
+        Emit();
+        Log::Err() << "[Error] " << name << ": " << error;
+        return false;
+    }
+
+    int64_t ResidentKb() {
+#ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        int64_t size = 0, resident = 0;
+        if (statm >> size >> resident) return resident * (int64_t)sysconf(_SC_PAGESIZE) / 1024;
+#endif
+        return 0;
+    }
+
+    bool LoadScripts(const std::vector<std::string>& names) {
+        uint64_t done = Stats::reload.latency.Count() + names.size();
+        uint64_t errors = Stats::reload.errors.load();
+        for (const auto& name : names) ScriptHost::Load(name);
+        // A load ends with its bindings swapped in, so chords work from here on
+        auto deadline = Clock::now() + 30s;
+        while (Stats::reload.latency.Count() < done) {
+            if (Clock::now() > deadline) return false;
+            std::this_thread::sleep_for(100us);
+        }
+        return Stats::reload.errors.load() == errors;
+    }
+
+    namespace {
+        // Unloads the current workload and empties the scripts directory
+        // The directory is fixed once the workers run, so workloads take
+        // turns in it rather than becoming it
+        void ClearScripts() {
+            for (const auto& old : loaded) ScriptHost::Unload(old);
+            loaded.clear();
+            {
+                std::lock_guard<std::mutex> lock(exportedMutex);
+                exported.clear();
+            }
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(options.scripts, ec)) std::filesystem::remove_all(entry.path(), ec);
+        }
+
+        bool LoadAll() {
+            loaded = ScriptHost::Scan();
+            return !loaded.empty() && LoadScripts(loaded);
+        }
+    }
+
+    bool LoadWorkload(const std::string& name) {
+        ClearScripts();
+        std::error_code ec;
+        std::filesystem::copy(options.workloads + "/" + name, options.scripts, std::filesystem::copy_options::recursive, ec);
+        return !ec && LoadAll();
+    }
+
+    bool LoadFiles(const std::map<std::string, std::string>& files) {
+        ClearScripts();
+        for (const auto& [path, text] : files) {
+            auto file = std::filesystem::path(options.scripts) / path;
+            std::error_code ec;
+            std::filesystem::create_directories(file.parent_path(), ec);
+            std::ofstream out(file, std::ios::binary);
+            out << text;
+            if (!out) return false;
+        }
+        return LoadAll();
+    }
+
+    std::optional<double> RoundTrip(uint16_t key, uint16_t answer) {
+        uint64_t seen = watch.Presses(answer);
+        auto start = Clock::now();
+        if (!Simulation::events->InjectHotkey(Ctrl, key)) return std::nullopt;
+        auto at = watch.WaitFor(answer, seen);
+        if (!at) return std::nullopt;
+        return Micros(*at - start);
+    }
+
+    bool Latencies(uint16_t key, uint16_t answer, size_t count, std::vector<double>& samples) {
+        for (int i = 0; i < 100; ++i) {
+            if (!RoundTrip(key, answer)) return false;
+        }
+        samples.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto us = RoundTrip(key, answer);
+            if (!us) return false;
+            samples.push_back(*us);
+        }
+        return true;
+    }
+
+    void OnLoop(std::function<void()> task) {
+        std::promise<void> done;
+        HotkeyManager::Post([&] {
+            task();
+            done.set_value();
+        });
+        done.get_future().wait();
+    }
+
+    bool OnWorker(const ScriptFunction& fn, std::function<void()> task) {
+        auto done = std::make_shared<std::promise<void>>();
+        auto future = done->get_future();
+        ScriptHost::Run(fn, [task = std::move(task), done] {
+            task();
+            done->set_value();
+        });
+        if (future.wait_for(60s) != std::future_status::ready) return false;
+        try {
+            future.get();
+            return true;
+        } catch (const std::future_error&) {
+            return false;                                    // Dropped with its retired script
+        }
+    }
+
+    ScriptFunction Exported(const std::string& name) {
+        std::lock_guard<std::mutex> lock(exportedMutex);
+        auto it = exported.find(name);
+        return it != exported.end() ? it->second : nullptr;
+    }
+
+    void Environment(sol::state& lua) {
+        SetupLuaEnvironment(lua);
+        auto bench = lua.create_table();
+        bench["chars"] = (lua_Integer)options.textChars;
+        bench["bytes"] = (lua_Integer)options.spawnBytes;
+        bench["timers"] = (lua_Integer)options.timers;
+        bench.set_function("export", [](const std::string& name, sol::function fn) {
+            auto shared = ScriptHost::Share(std::move(fn));
+            std::lock_guard<std::mutex> lock(exportedMutex);
+            exported[name] = std::move(shared);
+        });
+        lua["BENCH"] = bench;
+    }
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include "../src/core/ScriptHost.hpp"
+#include "../src/utils/Histogram.hpp"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct InputEvent;
+
+// Shared pieces of moonkey-bench
+// Every benchmark is a function returning false on failure; moonkey-bench.cpp
+// lists them. They all run with the engine started on Simulation's
+// backends. End-to-end benchmarks play the user and time what comes back;
+// engine benchmarks call one subsystem directly, on the thread that owns it,
+// and drive the schedulers through a VirtualClock rather than the wall clock.
+namespace Bench {
+    using Clock = std::chrono::steady_clock;
+    using namespace std::chrono_literals;
+
+    constexpr int Ctrl = 0x0002;                  // MOD.CTRL
+    constexpr uint16_t Mouse = 0x100;             // Watch key standing for cursor moves
+
+    // KEY.F<n>
+    constexpr uint16_t F(int n) { return (uint16_t)(0x70 + n - 1); }
+
+    struct Options {
+        std::string workloads = "bench/workloads";
+        std::string scripts;                      // Scripts directory the workloads are copied into
+        std::string out;                          // Results file; stdout if empty
+        bool quick = false;                       // Smaller counts, for a smoke test
+        std::vector<std::string> only;            // Benchmarks to run; all if empty
+        size_t textChars = 100000;                // BENCH.chars of the text workload
+        int64_t spawnBytes = int64_t(1) << 30;    // BENCH.bytes of the spawn workload
+        size_t timers = 10000;                    // BENCH.timers of the timer_heap workload
+    };
+    inline Options options;
+
+    inline double Micros(Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); }
+
+    // Counts and timestamps what the scripts send
+    class Watch {
+    public:
+        // RecordingInputSink observer; runs on whichever thread sent the batch
+        void Observe(const InputEvent* events, size_t count);
+
+        // Presses of key so far (Mouse: cursor moves)
+        uint64_t Presses(uint16_t key);
+
+        // Events of any kind so far
+        uint64_t Total();
+
+        // Waits until key has been pressed more than seen times
+        // Returns when the last press arrived, or nullopt on timeout
+        std::optional<Clock::time_point> WaitFor(uint16_t key, uint64_t seen, Clock::duration timeout = 10s);
+
+        // Waits until count events have been sent in total
+        bool WaitTotal(uint64_t count, Clock::duration timeout = 60s);
+
+        // Starts recording the time of every press of key
+        void Trace(uint16_t key);
+
+        // Stops recording and returns the times recorded
+        std::vector<Clock::time_point> TakeTrace();
+
+    private:
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::array<uint64_t, Mouse + 1> presses{};
+        std::array<Clock::time_point, Mouse + 1> last{};
+        uint64_t total = 0;
+        int traced = -1;
+        std::vector<Clock::time_point> trace;
+    };
+    inline Watch watch;
+
+    // One benchmark's results, written as a JSON line
+    class Result {
+    public:
+        explicit Result(const std::string& name) : name(name), json("{\"bench\":\"" + name + "\"") {}
+
+        Result& Add(const std::string& key, double value, int decimals = 1);
+        Result& Add(const std::string& key, uint64_t value) { return Field(key, std::to_string(value)); }
+        Result& Add(const std::string& key, int64_t value) { return Field(key, std::to_string(value)); }
+        Result& Add(const std::string& key, bool value) { return Field(key, value ? "true" : "false"); }
+        Result& Add(const std::string& key, const std::string& value);
+
+        // Count, mean and percentiles of samples in microseconds
+        Result& Latency(const std::string& key, std::vector<double> samples);
+
+        // Count and percentiles of an engine histogram in microseconds
+        Result& Latency(const std::string& key, const Histogram& histogram);
+
+        void Emit();
+
+        // Emits the result with an error and returns false
+        bool Fail(const std::string& error);
+
+    private:
+        Result& Field(const std::string& key, const std::string& value) {
+            json += ",\"" + key + "\":" + value;
+            return *this;
+        }
+
+        std::string name;
+        std::string json;
+    };
+
+    // Resident set size of this process in KiB; 0 where unknown
+    int64_t ResidentKb();
+
+    // Loads or reloads scripts and waits until they are live
+    // Returns false if one failed to load or took too long
+    bool LoadScripts(const std::vector<std::string>& names);
+
+    // Copies a workload directory into the scripts directory and loads it
+    // Scripts of the previous workload are unloaded and their files removed
+    bool LoadWorkload(const std::string& name);
+
+    // Replaces the scripts directory with generated files and loads them
+    // files: Contents by path relative to the scripts directory
+    bool LoadFiles(const std::map<std::string, std::string>& files);
+
+    // Presses Ctrl+key and waits for the script to send answer
+    // Returns the latency in microseconds, or nullopt if no answer came
+    std::optional<double> RoundTrip(uint16_t key, uint16_t answer);
+
+    // Round trips one at a time, after a warm-up
+    bool Latencies(uint16_t key, uint16_t answer, size_t count, std::vector<double>& samples);
+
+    // Runs task on the MessageLoop thread and waits for it
+    // While it runs the loop neither dispatches nor fires timers on its own
+    void OnLoop(std::function<void()> task);
+
+    // Runs task on the worker of fn's script and waits for it
+    // Returns false if the script went away first
+    bool OnWorker(const ScriptFunction& fn, std::function<void()> task);
+
+    // Function a workload handed over with BENCH.export(name, fn)
+    // Returns nullptr if the loaded workload has not exported one
+    ScriptFunction Exported(const std::string& name);
+
+    // Registers the BENCH table in a new script state
+    void Environment(sol::state& lua);
+
+    // End-to-end benchmarks (EndToEnd.cpp)
+    bool HotkeyLatency();
+    bool CrossScriptLatency();
+    bool TimerJitter();
+    bool TextThroughput();
+    bool MousePathTiming();
+    bool GcPauses();
+    bool SpawnThroughput();
+    bool ReloadTime();
+    bool StoreOps();
+
+    // Dispatch benchmarks (Dispatch.cpp)
+    bool LoopWakeup();
+    bool HotkeyDispatch();
+    bool WindowFilter();
+    bool InputRing();
+    bool HotstringMatch();
+    bool EventPublish();
+
+    // Scheduler benchmarks, mostly on a virtual clock (Scheduling.cpp)
+    bool TimerHeap();
+    bool CoroutineWaits();
+    bool MacroSteps();
+    bool WaitJitter();
+
+    // Input recording benchmarks (Recording.cpp)
+    bool InputLogThroughput();
+
+    // Screen benchmarks (Screen.cpp)
+    bool ImageSearchTime();
+
+    // Window benchmarks (Windows.cpp)
+    bool WindowLookup();
+
+    // Script loading and isolation benchmarks (Scripts.cpp)
+    bool StartupTime();
+    bool ScriptIsolation();
+}
@@ -0,0 +1,464 @@
+#include "Bench.hpp"
+#include "../src/api/WindowManager.hpp"
+#include "../src/core/ChordTable.hpp"
+#include "../src/core/InputHooks.hpp"
+#include "../src/core/Simulation.hpp"
+#include "../src/core/Stats.hpp"
+#include "../src/platform/MemoryEventSource.hpp"
+#include "../src/utils/EventDispatcher.hpp"
+#include "../src/utils/HotstringAutomaton.hpp"
+#include "../src/utils/WindowMatcher.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace Bench {
+    namespace {
+        // Presses Ctrl+F13 at random gaps of 1-15 ms, one at a time, and
+        // leaves the time from each press to its callback starting in
+        // Stats::dispatch
+        // poll: Event source sleep-poll interval, or zero to block on it
+        bool Wakeups(Clock::duration poll, size_t count) {
+            Simulation::events->pollInterval = poll.count();
+            // The loop may be blocked from before; the first press wakes it
+            if (!RoundTrip(F(13), F(14))) return false;
+            Stats::dispatch.Reset();
+            std::mt19937 random(1);
+            std::uniform_int_distribution<int> gap(1000, 15000);
+            for (size_t i = 0; i < count; ++i) {
+                std::this_thread::sleep_for(std::chrono::microseconds(gap(random)));
+                if (!RoundTrip(F(13), F(14))) return false;
+            }
+            return Stats::dispatch.latency.Count() == count;
+        }
+
+        // Payload of the publish benchmark
+        struct Stamp {
+            Clock::time_point at;
+            uint32_t producer = 0;
+            uint32_t seq = 0;
+        };
+
+        const Event<Stamp> Published("bench.published");
+
+        // Checks per-producer order and times one event in every sampling
+        // from publish to delivery
+        struct Receiver {
+            std::vector<uint32_t> next;
+            std::vector<double> samples;
+            uint64_t sampling;
+            bool ordered = true;
+            uint64_t received = 0;
+
+            Receiver(size_t producers, uint64_t sampling) : next(producers, 0), sampling(sampling) {}
+
+            void operator()(const Stamp& stamp) {
+                ordered = ordered && stamp.seq == next[stamp.producer];
+                next[stamp.producer] = stamp.seq + 1;
+                if (received++ % sampling == 0) samples.push_back(Micros(Clock::now() - stamp.at));
+            }
+        };
+
+        // Starts the producers together; each publishes count stamps, one
+        // per gap (sleeping in between), or as fast as it can with a zero gap
+        template <typename Publish>
+        std::vector<std::thread> Produce(size_t producers, uint32_t count, Clock::duration gap, std::atomic<bool>& go, Publish publish) {
+            std::vector<std::thread> threads;
+            for (uint32_t producer = 0; producer < producers; ++producer) {
+                threads.emplace_back([=, &go] {
+                    while (!go.load(std::memory_order_acquire)) {}
+                    auto due = Clock::now();
+                    for (uint32_t seq = 0; seq < count; ++seq) {
+                        if (gap > Clock::duration::zero()) std::this_thread::sleep_until(due);
+                        due += gap;
+                        publish(Stamp{ Clock::now(), producer, seq });
+                    }
+                });
+            }
+            return threads;
+        }
+
+        // Runs one round of the publish benchmark through an EventDispatcher
+        // Returns: Seconds from start until the owner had drained everything
+        double DispatcherRound(Receiver& receiver, uint32_t count, Clock::duration gap) {
+            EventDispatcher dispatcher;
+            dispatcher.subscribe(Published, [&](const Stamp& stamp) { receiver(stamp); });
+            uint64_t total = receiver.next.size() * (uint64_t)count;
+            std::atomic<bool> go = false;
+            auto threads = Produce(receiver.next.size(), count, gap, go, [&](Stamp stamp) { dispatcher.publish(Published, stamp); });
+            auto start = Clock::now();
+            go.store(true, std::memory_order_release);
+            while (receiver.received < total) {
+                dispatcher.wait();
+                dispatcher.drain();
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            for (auto& thread : threads) thread.join();
+            return seconds;
+        }
+
+        // The same round through a mutex-guarded vector the owner swaps out
+        double MutexRound(Receiver& receiver, uint32_t count, Clock::duration gap) {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::vector<Stamp> queue, batch;
+            uint64_t total = receiver.next.size() * (uint64_t)count;
+            std::atomic<bool> go = false;
+            auto threads = Produce(receiver.next.size(), count, gap, go, [&](Stamp stamp) {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(stamp);
+                if (queue.size() == 1) ready.notify_one();
+            });
+            auto start = Clock::now();
+            go.store(true, std::memory_order_release);
+            while (receiver.received < total) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&] { return !queue.empty(); });
+                    batch.swap(queue);
+                }
+                for (const Stamp& stamp : batch) receiver(stamp);
+                batch.clear();
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            for (auto& thread : threads) thread.join();
+            return seconds;
+        }
+
+        // ChordTable handler; id tells which binding won
+        struct Binding {
+            WindowMatcher context;
+            int id = 0;
+        };
+    }
+
+    // Hotkey presses through the real MessageLoop, timed from the event
+    // source to the callback starting on its worker, so SendInput is left
+    // out: once with the loop blocking on the event source, once with the
+    // source sleeping 10 ms between polls as the loop did before
+    bool LoopWakeup() {
+        Result result("loop_wakeup");
+        if (!LoadWorkload("hotkey")) return result.Fail("workload did not load");
+        size_t count = options.quick ? 100 : 1000;
+        bool polled = Wakeups(10ms, count);
+        result.Latency("sleep_poll", Stats::dispatch.latency);
+        bool blocked = polled && Wakeups(0ms, count);
+        if (!polled || !blocked) return result.Fail("no answer to Ctrl+F13");
+        result.Latency("event_wait", Stats::dispatch.latency).Emit();
+        return true;
+    }
+
+    // Chord resolution with 5,000 bindings on 1,250 chords: three
+    // window-scoped bindings (exact process, title substring, class
+    // wildcard) and a global fallback per chord, one active window snapshot
+    // per press. The same presses through a std::map keyed by chord show
+    // what a tree lookup alone costs.
+    bool HotkeyDispatch() {
+        Result result("hotkey_dispatch");
+        ChordTable<Binding> table;
+        std::map<int, Binding> tree;
+        std::vector<int> keys;
+        int id = 0;
+        for (int mods = 1; mods < 16 && keys.size() < 1250; ++mods) {
+            for (int vk = 0x30; vk < 0x30 + 90 && keys.size() < 1250; ++vk) {
+                Binding process, title, windowClass;
+                process.context.Add(MatchField::Process, "editor" + std::to_string(vk) + ".exe", MatchMode::Exact);
+                title.context.Add(MatchField::Title, "Project " + std::to_string(mods));
+                windowClass.context.Add(MatchField::Class, "Chrome_*" + std::to_string(vk), MatchMode::Wildcard);
+                for (Binding* binding : { &process, &title, &windowClass }) {
+                    binding->id = ++id;
+                    table.Add(mods, vk, *binding);
+                }
+                Binding fallback;
+                fallback.id = ++id;
+                table.Add(mods, vk, fallback);
+                tree[ChordTable<Binding>::Key(mods, vk)] = fallback;
+                keys.push_back(ChordTable<Binding>::Key(mods, vk));
+            }
+        }
+
+        size_t presses = options.quick ? 1000000 : 10000000;
+        std::mt19937 random(1);
+        std::vector<int> sequence(4096);
+        for (int& key : sequence) key = keys[random() % keys.size()];
+        WindowInfo window{ 1, "Project 3 - notes.txt", "Chrome_WidgetWin_1", "editor48.exe", 1 };
+
+        uint64_t checksum = 0;
+        auto start = Clock::now();
+        for (size_t i = 0; i < presses; ++i) {
+            const Binding* binding = table.Resolve(sequence[i & 4095], [&]() -> const WindowInfo& { return window; });
+            checksum += binding ? binding->id : 0;
+        }
+        double tableNs = Micros(Clock::now() - start) * 1000.0 / (double)presses;
+
+        uint64_t treeChecksum = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < presses; ++i) {
+            auto it = tree.find(sequence[i & 4095]);
+            treeChecksum += it != tree.end() ? it->second.id : 0;
+        }
+        double treeNs = Micros(Clock::now() - start) * 1000.0 / (double)presses;
+
+        result.Add("bindings", (uint64_t)table.HandlerCount())
+            .Add("chords", (uint64_t)keys.size())
+            .Add("dispatch_ns", tableNs, 2)
+            .Add("tree_lookup_ns", treeNs, 2)
+            .Add("checksum", checksum + treeChecksum);
+        if (checksum == 0 || treeChecksum == 0) return result.Fail("no binding resolved");
+        result.Emit();
+        return true;
+    }
+
+    // Window filters as the MessageLoop evaluates them: a press reads the
+    // active window snapshot once and tries the chord's window-scoped
+    // bindings in order. Every chord has eight bindings of one match mode,
+    // spread over title, class and process, and only the last can match,
+    // so each press runs eight filters. The foreground window switches
+    // every 64 presses through the simulated provider, which refreshes the
+    // cached snapshot; querying the provider on every press instead shows
+    // what the cache saves
+    bool WindowFilter() {
+        Result result("window_filter");
+        const WindowInfo windows[] = {
+            { 0x5001, "Project 3 - notes.txt - Editor", "Chrome_WidgetWin_1", "editor.exe", 5001 },
+            { 0x5002, "Inbox - Mail", "Qt5QWindowIcon", "mail.exe", 5002 },
+        };
+        struct Mode {
+            const char* name;
+            MatchMode mode;
+            std::string (*pattern)(MatchField field, int i);  // Filters that never match
+            MatchField field;                                  // Filter matching windows[0]
+            const char* match;
+        };
+        const Mode modes[] = {
+            { "substring", MatchMode::Substring, [](MatchField field, int i) {
+                  return (field == MatchField::Process ? "tool" : "Report ") + std::to_string(i); },
+              MatchField::Title, "notes.txt" },
+            { "exact", MatchMode::Exact, [](MatchField field, int i) {
+                  return field == MatchField::Process ? "tool" + std::to_string(i) + ".exe" : "Report " + std::to_string(i); },
+              MatchField::Process, "editor.exe" },
+            { "wildcard", MatchMode::Wildcard, [](MatchField field, int i) {
+                  return field == MatchField::Process ? "tool" + std::to_string(i) + "?.exe" : "*Report " + std::to_string(i) + "*"; },
+              MatchField::Title, "Project * - notes.*" },
+            { "regex", MatchMode::Regex, [](MatchField field, int i) {
+                  return field == MatchField::Process ? "^tool" + std::to_string(i) + "\\.exe$" : "Report [0-9]+ " + std::to_string(i); },
+              MatchField::Title, "Project [0-9]+ - notes" },
+        };
+        const MatchField fields[] = { MatchField::Title, MatchField::Class, MatchField::Process };
+        constexpr int scoped = 8;
+        size_t presses = options.quick ? 200000 : 2000000;
+
+        for (const Mode& mode : modes) {
+            ChordTable<Binding> table;
+            std::vector<int> keys;
+            int id = 0;
+            for (int vk = 0x30; vk < 0x30 + 64; ++vk) {
+                for (int i = 0; i < scoped; ++i) {
+                    Binding binding;
+                    if (i + 1 < scoped) {
+                        binding.context.Add(fields[i % 3], mode.pattern(fields[i % 3], vk * scoped + i), mode.mode);
+                    } else {
+                        binding.context.Add(mode.field, mode.match, mode.mode);
+                    }
+                    binding.id = ++id;
+                    table.Add(Ctrl, vk, binding);
+                }
+                keys.push_back(ChordTable<Binding>::Key(Ctrl, vk));
+            }
+
+            // Every other run of 64 presses lands on windows[0], where the last binding matches
+            auto run = [&](auto&& active) {
+                uint64_t matched = 0;
+                auto start = Clock::now();
+                for (size_t i = 0; i < presses; ++i) {
+                    if ((i & 63) == 0) Simulation::windows->SetForeground(windows[(i >> 6) & 1]);
+                    std::shared_ptr<const WindowInfo> window;
+                    WindowInfo queried;
+                    const Binding* binding = table.Resolve(keys[i % keys.size()], [&]() -> const WindowInfo& { return active(window, queried); });
+                    matched += binding != nullptr;
+                }
+                double ns = Micros(Clock::now() - start) * 1000.0 / (double)presses;
+                return std::make_pair(ns, matched);
+            };
+            auto [cachedNs, cachedMatched] = run([](std::shared_ptr<const WindowInfo>& window, WindowInfo&) -> const WindowInfo& {
+                window = WindowManager::ActiveWindow();
+                return *window;
+            });
+            auto [queriedNs, queriedMatched] = run([](std::shared_ptr<const WindowInfo>&, WindowInfo& queried) -> const WindowInfo& {
+                queried = WindowManager::provider->Foreground();
+                return queried;
+            });
+            size_t expected = presses / 128 * 64 + std::min<size_t>(presses % 128, 64);
+            if (cachedMatched != expected || queriedMatched != expected) {
+                Simulation::windows->SetForeground({ 1, "moonkey-bench", "MoonKeyBench", "moonkey-bench", 1 });
+                return result.Fail(std::string(mode.name) + " filters matched the wrong windows");
+            }
+            result.Add(std::string(mode.name) + "_press_ns", cachedNs, 1)
+                .Add(std::string(mode.name) + "_filter_ns", cachedNs / scoped, 1)
+                .Add(std::string(mode.name) + "_queried_press_ns", queriedNs, 1);
+        }
+
+        Simulation::windows->SetForeground({ 1, "moonkey-bench", "MoonKeyBench", "moonkey-bench", 1 });
+        result.Add("filters_per_press", (uint64_t)scoped).Emit();
+        return true;
+    }
+
+    // The capture ring alone (one producer, one consumer draining batches of
+    // 256), then the real path: key transitions from the synthetic capture
+    // through InputHooks' ring and the MessageLoop, bursts of them to time
+    // the drain, and an on_key_down handler's answer to time one press
+    bool InputRing() {
+        Result result("input_ring");
+        uint64_t count = options.quick ? 2000000 : 20000000;
+        auto ring = std::make_unique<InputHooks::Ring>();
+        uint64_t received = 0;
+        auto start = Clock::now();
+        std::thread consumer([&] {
+            RawInput batch[256];
+            while (received < count) received += ring->PopBatch(batch, 256);
+        });
+        RawInput input;
+        bool wasEmpty;
+        for (uint64_t i = 0; i < count; ++i) {
+            input.vk = (uint16_t)(i & 0xFF);
+            while (!ring->TryPush(input, wasEmpty)) {}
+        }
+        consumer.join();
+        double ringSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (!LoadWorkload("keys")) return result.Fail("workload did not load");
+        std::vector<int> letters;
+        for (int vk = 'A'; vk <= 'Z'; ++vk) letters.push_back(vk);
+        size_t bursts = options.quick ? 100 : 1000;
+        uint64_t dropped = InputHooks::dropped.load();
+        uint64_t events = 0;
+        start = Clock::now();
+        for (size_t burst = 0; burst < bursts; ++burst) {
+            uint64_t target = InputHooks::dispatched.load() + Simulation::capture->Generate(1000, letters);
+            events += 2000;
+            auto deadline = Clock::now() + 10s;
+            while (InputHooks::dispatched.load() + (InputHooks::dropped.load() - dropped) < target) {
+                if (Clock::now() > deadline) return result.Fail("events were not drained");
+            }
+        }
+        double engineSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+        dropped = InputHooks::dropped.load() - dropped;
+
+        std::vector<double> samples;
+        for (size_t i = 0; i < (options.quick ? 1000 : 10000); ++i) {
+            uint64_t seen = watch.Presses(F(14));
+            start = Clock::now();
+            Simulation::capture->Emit(F(13), true);
+            Simulation::capture->Emit(F(13), false);
+            auto at = watch.WaitFor(F(14), seen);
+            if (!at) return result.Fail("on_key_down did not answer");
+            samples.push_back(Micros(*at - start));
+        }
+
+        result.Add("ring_events_per_s", (double)count / ringSeconds, 0)
+            .Add("engine_events_per_s", (double)events / engineSeconds, 0)
+            .Add("dropped", dropped)
+            .Latency("handler", std::move(samples))
+            .Emit();
+        return true;
+    }
+
+    // Hotstring matching of a 10M-keystroke stream against 5,000
+    // abbreviations of 3-8 letters, one in 50 keystrokes completing one of
+    // them. The automaton costs the same per key whatever the pattern count;
+    // the naive scan (every pattern against the typed tail, as Hotstrings did
+    // before the automaton) runs on a 1% slice of the stream.
+    bool HotstringMatch() {
+        Result result("hotstring_match");
+        std::mt19937 random(1);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::vector<std::u16string> patterns(5000);
+        HotstringAutomaton automaton;
+        auto start = Clock::now();
+        for (auto& pattern : patterns) {
+            size_t length = 3 + random() % 6;
+            for (size_t i = 0; i < length; ++i) pattern += (char16_t)letter(random);
+            automaton.Add(pattern);
+        }
+        automaton.Build();
+        double buildMs = Micros(Clock::now() - start) / 1000.0;
+
+        size_t keys = options.quick ? 1000000 : 10000000;
+        std::u16string stream;
+        stream.reserve(keys + 8);
+        while (stream.size() < keys) {
+            if (random() % 50 == 0) {
+                stream += patterns[random() % patterns.size()];
+            } else {
+                stream += random() % 6 ? (char16_t)letter(random) : u' ';
+            }
+        }
+        stream.resize(keys);
+
+        uint64_t matches = 0;
+        uint32_t state = HotstringAutomaton::root;
+        start = Clock::now();
+        for (char16_t c : stream) {
+            state = automaton.Step(state, c);
+            matches += automaton.OutputsEnd(state) - automaton.OutputsBegin(state);
+        }
+        double automatonNs = Micros(Clock::now() - start) * 1000.0 / (double)keys;
+
+        size_t slice = keys / 100;
+        uint64_t naiveMatches = 0;
+        start = Clock::now();
+        for (size_t i = 1; i <= slice; ++i) {
+            for (const auto& pattern : patterns) {
+                if (pattern.size() <= i && stream.compare(i - pattern.size(), pattern.size(), pattern) == 0) ++naiveMatches;
+            }
+        }
+        double naiveNs = Micros(Clock::now() - start) * 1000.0 / (double)slice;
+
+        result.Add("patterns", (uint64_t)automaton.PatternCount())
+            .Add("states", (uint64_t)automaton.StateCount())
+            .Add("build_ms", buildMs, 2)
+            .Add("keys", (uint64_t)keys)
+            .Add("matches", matches)
+            .Add("automaton_ns_per_key", automatonNs, 2)
+            .Add("naive_ns_per_key", naiveNs, 2);
+        if (matches < keys / 100) return result.Fail("typed abbreviations were not matched");
+        result.Emit();
+        return true;
+    }
+
+    // Four producers publishing into an EventDispatcher while its owner
+    // waits and drains, against the same traffic through a mutex-guarded
+    // vector the owner swaps out. A flood measures throughput; a paced round
+    // (each producer publishing every 50 us) times publish to delivery of
+    // every event, which a flood would only turn into queue depth. Every
+    // event is checked for per-producer order.
+    bool EventPublish() {
+        Result result("event_publish");
+        const size_t producers = 4;
+        const uint32_t flood = options.quick ? 250000 : 2500000;
+        const uint32_t paced = options.quick ? 2000 : 20000;
+
+        Receiver mpscFlood(producers, 1ull << 62), mutexFlood(producers, 1ull << 62);
+        Receiver mpscPaced(producers, 1), mutexPaced(producers, 1);
+        double mpscSeconds = DispatcherRound(mpscFlood, flood, {});
+        double mutexSeconds = MutexRound(mutexFlood, flood, {});
+        DispatcherRound(mpscPaced, paced, 50us);
+        MutexRound(mutexPaced, paced, 50us);
+
+        uint64_t total = producers * (uint64_t)flood;
+        result.Add("producers", (uint64_t)producers)
+            .Add("events", total)
+            .Add("mpsc_events_per_s", (double)total / mpscSeconds, 0)
+            .Add("mutex_events_per_s", (double)total / mutexSeconds, 0)
+            .Latency("mpsc", std::move(mpscPaced.samples))
+            .Latency("mutex", std::move(mutexPaced.samples));
+        for (const Receiver* receiver : { &mpscFlood, &mutexFlood, &mpscPaced, &mutexPaced }) {
+            if (!receiver->ordered) return result.Fail("events of one producer arrived out of order");
+        }
+        result.Emit();
+        return true;
+    }
+}
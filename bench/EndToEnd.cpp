@@ -0,0 +1,242 @@
+#include "Bench.hpp"
+#include "../src/core/PrecisionClock.hpp"
+#include "../src/core/Simulation.hpp"
+#include "../src/core/Stats.hpp"
+#include "../src/core/Store.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+
+namespace Bench {
+    // Chord press to the key its callback sends: MessageLoop dispatch,
+    // worker queue, Lua call and SendInput
+    bool HotkeyLatency() {
+        Result result("hotkey_latency");
+        if (!LoadWorkload("hotkey")) return result.Fail("workload did not load");
+        std::vector<double> samples;
+        Stats::hotkey.Reset();
+        Stats::dispatch.Reset();
+        if (!Latencies(F(13), F(14), options.quick ? 2000 : 20000, samples)) return result.Fail("no answer to Ctrl+F13");
+        result.Latency("latency", std::move(samples)).Latency("dispatch", Stats::dispatch.latency)
+            .Latency("callback", Stats::hotkey.latency).Emit();
+        return true;
+    }
+
+    // Chord press in one script to the key an on() handler in another sends
+    bool CrossScriptLatency() {
+        Result result("cross_script_latency");
+        if (!LoadWorkload("events")) return result.Fail("workload did not load");
+        std::vector<double> samples;
+        if (!Latencies(F(15), F(16), options.quick ? 1000 : 10000, samples)) return result.Fail("no answer to Ctrl+F15");
+        result.Latency("latency", std::move(samples)).Emit();
+        return true;
+    }
+
+    // How far the ticks of a 5 ms interval timer stray from its period,
+    // measured where its key presses leave the engine; then the same timers
+    // on a virtual clock stepped from deadline to deadline, where any
+    // lateness is the scheduler's own drift and the wall time is its cost
+    bool TimerJitter() {
+        Result result("timer_jitter");
+        if (!LoadWorkload("timers")) return result.Fail("workload did not load");
+        std::this_thread::sleep_for(100ms);
+        PrecisionClock::lateness.Reset();
+        watch.Trace(F(17));
+        std::this_thread::sleep_for(options.quick ? 1s : 5s);
+        auto ticks = watch.TakeTrace();
+        if (ticks.size() < 2) return result.Fail("timer did not fire");
+
+        std::vector<double> deviation;
+        deviation.reserve(ticks.size() - 1);
+        for (size_t i = 1; i < ticks.size(); ++i) deviation.push_back(std::abs(Micros(ticks[i] - ticks[i - 1]) - 5000.0));
+        result.Add("ticks", (uint64_t)ticks.size())
+            .Latency("deviation", std::move(deviation))
+            .Latency("lateness", PrecisionClock::lateness);
+
+        std::vector<double> cost;
+        OnLoop([&] {
+            VirtualClock clock;
+            auto end = clock.Now() + 10s;
+            PrecisionClock::lateness.Reset();
+            while (clock.Now() < end) {
+                auto start = Clock::now();
+                if (!clock.NextTimer()) break;
+                cost.push_back(Micros(Clock::now() - start));
+            }
+        });
+        result.Latency("virtual_update", std::move(cost)).Latency("virtual_lateness", PrecisionClock::lateness).Emit();
+        return true;
+    }
+
+    // write() of a long string, from the chord press to its last event
+    bool TextThroughput() {
+        Result result("text_throughput");
+        if (!LoadWorkload("text")) return result.Fail("workload did not load");
+        uint64_t events = 2 * (uint64_t)options.textChars;   // Press and release per character
+        size_t runs = options.quick ? 3 : 10;
+        std::vector<double> rates;
+        size_t batches = 0;
+        Stats::send.Reset();
+        for (size_t run = 0; run < runs; ++run) {
+            Simulation::sink->Reset();
+            uint64_t target = watch.Total() + events;
+            auto start = Clock::now();
+            if (!Simulation::events->InjectHotkey(Ctrl, F(18))) return result.Fail("Ctrl+F18 is not bound");
+            if (!watch.WaitTotal(target)) return result.Fail("text did not arrive");
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            rates.push_back((double)options.textChars / seconds);
+            batches = Simulation::sink->Batches();
+        }
+        std::sort(rates.begin(), rates.end());
+        result.Add("chars", (uint64_t)options.textChars)
+            .Add("runs", (uint64_t)runs)
+            .Add("chars_per_s_median", rates[rates.size() / 2], 0)
+            .Add("chars_per_s_min", rates.front(), 0)
+            .Add("batches_per_write", (uint64_t)batches)
+            .Latency("send", Stats::send.latency)
+            .Emit();
+        return true;
+    }
+
+    // A 200 ms mouse_path at 1000 positions per second: overrun past its
+    // duration and the spacing of its steps
+    bool MousePathTiming() {
+        Result result("mouse_path");
+        if (!LoadWorkload("mouse")) return result.Fail("workload did not load");
+        size_t runs = options.quick ? 5 : 20;
+        std::vector<double> overrun, gaps;
+        uint64_t moves = 0;
+        for (size_t run = 0; run < runs; ++run) {
+            uint64_t seen = watch.Presses(F(20));
+            watch.Trace(Mouse);
+            auto start = Clock::now();
+            if (!Simulation::events->InjectHotkey(Ctrl, F(19))) return result.Fail("Ctrl+F19 is not bound");
+            auto end = watch.WaitFor(F(20), seen);
+            auto steps = watch.TakeTrace();
+            if (!end) return result.Fail("path did not finish");
+            overrun.push_back(Micros(*end - start) - 200000.0);
+            for (size_t i = 1; i < steps.size(); ++i) gaps.push_back(Micros(steps[i] - steps[i - 1]));
+            moves = steps.size();
+        }
+        result.Add("moves_per_path", moves).Latency("overrun", std::move(overrun)).Latency("step_gap", std::move(gaps)).Emit();
+        return true;
+    }
+
+    // Idle-gap collection slices while a timer churns out garbage, and what
+    // they do to a hotkey on the same script
+    bool GcPauses() {
+        Result result("gc_pauses");
+        if (!LoadWorkload("gc")) return result.Fail("workload did not load");
+        std::this_thread::sleep_for(200ms);
+        Stats::gc.Reset();
+        std::vector<double> samples;
+        auto end = Clock::now() + (options.quick ? 1s : 3s);
+        while (Clock::now() < end) {
+            auto us = RoundTrip(F(13), F(14));
+            if (!us) return result.Fail("no answer to Ctrl+F13");
+            samples.push_back(*us);
+            std::this_thread::sleep_for(1ms);
+        }
+        result.Latency("slice", Stats::gc.latency).Latency("hotkey", std::move(samples)).Emit();
+        return true;
+    }
+
+    // A command streaming BENCH.bytes through on_stdout, and the latency of
+    // a hotkey of the same script meanwhile
+    bool SpawnThroughput() {
+        Result result("spawn_throughput");
+        if (!LoadWorkload("spawn")) return result.Fail("workload did not load");
+        uint64_t complete = watch.Presses(F(22));
+        uint64_t incomplete = watch.Presses(F(23));
+        std::vector<double> samples;
+        auto start = Clock::now();
+        if (!Simulation::events->InjectHotkey(Ctrl, F(21))) return result.Fail("Ctrl+F21 is not bound");
+        while (watch.Presses(F(22)) == complete && watch.Presses(F(23)) == incomplete) {
+            if (Clock::now() - start > 10min) return result.Fail("command did not finish");
+            auto us = RoundTrip(F(13), F(14));
+            if (!us) return result.Fail("no answer to Ctrl+F13");
+            samples.push_back(*us);
+            std::this_thread::sleep_for(1ms);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        bool delivered = watch.Presses(F(22)) > complete;
+        result.Add("bytes", options.spawnBytes)
+            .Add("complete", delivered)
+            .Add("mb_per_s", (double)options.spawnBytes / 1e6 / seconds)
+            .Latency("hotkey", std::move(samples));
+        if (!delivered) return result.Fail("output was lost");
+        result.Emit();
+        return true;
+    }
+
+    // Reloads of a configuration with a module, hundreds of bindings,
+    // timers and hotstrings, the time each swap held up dispatch, and the
+    // memory they leave behind
+    bool ReloadTime() {
+        Result result("reload");
+        if (!LoadWorkload("reload")) return result.Fail("workload did not load");
+        for (int i = 0; i < 5; ++i) {
+            if (!LoadScripts({ "main.lua" })) return result.Fail("reload failed");
+        }
+        size_t runs = options.quick ? 30 : 200;
+        int64_t before = ResidentKb();
+        Stats::reload.Reset();
+        Stats::swap.Reset();
+        std::vector<double> samples;
+        for (size_t run = 0; run < runs; ++run) {
+            auto start = Clock::now();
+            if (!LoadScripts({ "main.lua" })) return result.Fail("reload failed");
+            samples.push_back(Micros(Clock::now() - start));
+        }
+        int64_t after = ResidentKb();
+        result.Add("runs", (uint64_t)runs)
+            .Latency("wall", std::move(samples))
+            .Latency("engine", Stats::reload.latency)
+            .Latency("dispatch_paused", Stats::swap.latency)
+            .Add("rss_kb", after)
+            .Add("rss_growth_kb", after - before)
+            .Emit();
+        return true;
+    }
+
+    // Store writes, reads and increments from C++, and reopening the log
+    bool StoreOps() {
+        Result result("store");
+        auto file = (std::filesystem::temp_directory_path() / "moonkey-bench.store").string();
+        std::filesystem::remove(file);
+        if (!Store::Open(file)) return result.Fail("cannot open " + file);
+
+        size_t count = options.quick ? 100000 : 1000000;
+        std::vector<std::string> keys(count);
+        for (size_t i = 0; i < count; ++i) keys[i] = Store::Key("bench", "key" + std::to_string(i));
+        auto perOp = [&](auto&& op) {
+            auto start = Clock::now();
+            for (size_t i = 0; i < count; ++i) op(i);
+            return Micros(Clock::now() - start) * 1000.0 / (double)count;
+        };
+        size_t missing = 0;
+        double set = perOp([&](size_t i) { Store::Set(keys[i], Store::Value{ (lua_Integer)i }); });
+        double get = perOp([&](size_t i) { missing += !Store::Get(keys[i]); });
+        double incr = perOp([&](size_t i) { Store::Incr(keys[i], Store::Value{ (lua_Integer)1 }); });
+        Store::Close();
+
+        auto start = Clock::now();
+        bool reopened = Store::Open(file);
+        double recovery = Micros(Clock::now() - start) / 1000.0;
+        size_t recovered = Store::Count();
+        Store::Close();
+        uint64_t bytes = std::filesystem::file_size(file);
+        std::filesystem::remove(file);
+
+        result.Add("keys", (uint64_t)count)
+            .Add("set_ns", set)
+            .Add("get_ns", get)
+            .Add("incr_ns", incr)
+            .Add("recovery_ms", recovery)
+            .Add("file_bytes", bytes);
+        if (!reopened || recovered != count || missing) return result.Fail("values were lost");
+        result.Emit();
+        return true;
+    }
+}
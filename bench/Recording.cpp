@@ -0,0 +1,81 @@
+#include "Bench.hpp"
+#include "../src/utils/InputLog.hpp"
+#include <cstring>
+#include <random>
+
+namespace Bench {
+    // Encoding, decoding and compacting a recording of 10M events held in
+    // memory (a million distinct events, repeated with later times): events
+    // per second each way and the bytes an event takes before and after
+    // Compact
+    bool InputLogThroughput() {
+        Result result("input_log");
+        const size_t distinct = options.quick ? 100000 : 1000000;
+        const size_t repeats = 10;
+        std::mt19937 random(1);
+        std::vector<InputLogRecord> pattern(distinct);
+        uint64_t time = 0;
+        int32_t x = 960, y = 540;
+        for (auto& record : pattern) {
+            time += random() % 2000;
+            record.time = time;
+            if (random() % 10 < 7) {
+                x += (int32_t)(random() % 9) - 4;
+                y += (int32_t)(random() % 9) - 4;
+                record.kind = InputLogRecord::Move;
+            } else {
+                record.kind = random() % 2 ? InputLogRecord::KeyDown : InputLogRecord::KeyUp;
+                record.vk = (uint8_t)('A' + random() % 26);
+            }
+            record.x = x;
+            record.y = y;
+        }
+        uint64_t span = time + 1000;
+
+        InputLogWriter writer;
+        auto start = Clock::now();
+        for (size_t repeat = 0; repeat < repeats; ++repeat) {
+            for (InputLogRecord record : pattern) {
+                record.time += repeat * span;
+                writer.Append(record);
+            }
+        }
+        double encodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+        uint64_t events = writer.Count();
+
+        InputLog::Header header{ { 'M', 'K', 'I', 'R' }, InputLog::version, 0, 0, events };
+        std::vector<uint8_t> image(sizeof(header));
+        std::memcpy(image.data(), &header, sizeof(header));
+        image.insert(image.end(), writer.Bytes().begin(), writer.Bytes().end());
+
+        InputLogReader reader;
+        std::string error;
+        if (!reader.Open(image.data(), image.size(), error)) return result.Fail(error);
+        InputLogRecord record;
+        uint64_t decoded = 0, checksum = 0;
+        start = Clock::now();
+        while (reader.Next(record)) {
+            checksum += record.time + (uint32_t)record.x + record.vk;
+            ++decoded;
+        }
+        double decodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        reader.Open(image.data(), image.size(), error);
+        InputLogWriter compacted;
+        start = Clock::now();
+        uint64_t kept = InputLog::Compact(reader, compacted, 8000);
+        double compactSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        result.Add("events", events)
+            .Add("encode_events_per_s", (double)events / encodeSeconds, 0)
+            .Add("decode_events_per_s", (double)decoded / decodeSeconds, 0)
+            .Add("compact_events_per_s", (double)events / compactSeconds, 0)
+            .Add("bytes_per_event", (double)writer.Size() / (double)events, 2)
+            .Add("compacted_events", kept)
+            .Add("compacted_bytes_per_event", (double)compacted.Size() / (double)events, 2)
+            .Add("checksum", checksum);
+        if (decoded != events) return result.Fail("decoded " + std::to_string(decoded) + " of " + std::to_string(events) + " events");
+        result.Emit();
+        return true;
+    }
+}
@@ -0,0 +1,178 @@
+#include "Bench.hpp"
+#include "../src/core/CoroutineScheduler.hpp"
+#include "../src/core/PrecisionClock.hpp"
+#include "../src/core/Simulation.hpp"
+#include "../src/core/VirtualClock.hpp"
+
+namespace Bench {
+    namespace {
+        // Runs an exported fn(steps) as a coroutine on its worker, the
+        // virtual clock jumping from one wait to the next, and checks that
+        // every step tapped F15
+        // Returns: Nanoseconds per step, or nullopt if the steps did not run
+        std::optional<double> PerStep(const char* name, size_t steps) {
+            auto fn = Exported(name);
+            if (!fn) return std::nullopt;
+            Simulation::sink->Reset();
+            uint64_t seen = watch.Presses(F(15));
+            double micros = 0;
+            bool ran = OnWorker(fn, [&] {
+                VirtualClock clock;
+                clock.Attach();
+                auto start = Clock::now();
+                CoroutineScheduler::Spawn(*fn, (lua_Integer)steps);
+                while (CoroutineScheduler::Pending() > 0 && clock.NextCoroutine()) {}
+                micros = Micros(Clock::now() - start);
+            });
+            if (!ran || watch.Presses(F(15)) != seen + steps) return std::nullopt;
+            return micros * 1000.0 / (double)steps;
+        }
+    }
+
+    // BENCH.timers interval timers on a virtual clock: the cost of one
+    // MessageLoop tick at 1 ms steps, how late timers fire relative to the
+    // tick (never more than one step if deadlines keep the original
+    // schedule), and the lateness when the clock jumps from deadline to
+    // deadline, which must be zero
+    bool TimerHeap() {
+        Result result("timer_heap");
+        if (!LoadWorkload("timer_heap")) return result.Fail("workload did not load");
+
+        std::vector<double> ticks, jumps;
+        uint64_t fired = 0, tickLate99 = 0, tickLateMax = 0;
+        OnLoop([&] {
+            VirtualClock clock;
+            auto end = clock.Now() + (options.quick ? 2s : 10s);
+            PrecisionClock::lateness.Reset();
+            while (clock.Now() < end) {
+                auto start = Clock::now();
+                clock.AdvanceTimers(1ms);
+                ticks.push_back(Micros(Clock::now() - start));
+            }
+            fired = PrecisionClock::lateness.Count();
+            tickLate99 = PrecisionClock::lateness.Percentile(0.99);
+            tickLateMax = PrecisionClock::lateness.Max();
+
+            end = clock.Now() + (options.quick ? 2s : 10s);
+            PrecisionClock::lateness.Reset();
+            while (clock.Now() < end) {
+                auto start = Clock::now();
+                if (!clock.NextTimer()) break;
+                jumps.push_back(Micros(Clock::now() - start));
+            }
+        });
+        result.Add("timers", (uint64_t)options.timers)
+            .Add("fired_per_tick", ticks.empty() ? 0.0 : (double)fired / (double)ticks.size())
+            .Latency("tick", std::move(ticks))
+            .Add("tick_lateness_p99_us", tickLate99)
+            .Add("tick_lateness_max_us", tickLateMax)
+            .Latency("deadline_update", std::move(jumps))
+            .Latency("deadline_lateness", PrecisionClock::lateness);
+        if (tickLateMax >= 1000 || PrecisionClock::lateness.Max() > 0) return result.Fail("timers drifted");
+        result.Emit();
+        return true;
+    }
+
+    // 1,000 macros waiting at once on one worker, on a virtual clock moving
+    // in 100 us steps: the cost of starting a macro and of one scheduler
+    // step, and how late the waits resume, which must stay under one step
+    bool CoroutineWaits() {
+        Result result("coroutine_waits");
+        if (!LoadWorkload("macros")) return result.Fail("workload did not load");
+        auto macro = Exported("macro");
+        if (!macro) return result.Fail("workload exported no macro");
+
+        constexpr size_t count = 1000;
+        constexpr auto step = 100us;
+        double spawn = 0;
+        size_t left = 0;
+        std::vector<double> steps;
+        bool ran = OnWorker(macro, [&] {
+            VirtualClock clock;
+            clock.Attach();
+            PrecisionClock::lateness.Reset();
+            auto start = Clock::now();
+            for (size_t i = 0; i < count; ++i) CoroutineScheduler::Spawn(*macro, (lua_Integer)(1 + (i * 37) % 500));
+            spawn = Micros(Clock::now() - start) / (double)count;
+            while (CoroutineScheduler::Pending() > 0 && steps.size() < 10000) {
+                start = Clock::now();
+                clock.AdvanceCoroutines(step);
+                steps.push_back(Micros(Clock::now() - start));
+            }
+            left = CoroutineScheduler::Pending();
+            CoroutineScheduler::CancelAll();
+        });
+        if (!ran) return result.Fail("worker did not run the macros");
+
+        result.Add("macros", (uint64_t)count)
+            .Add("spawn_us", spawn, 2)
+            .Latency("step", std::move(steps))
+            .Latency("lateness", PrecisionClock::lateness);
+        if (left > 0 || PrecisionClock::lateness.Count() != count) return result.Fail("macros did not resume");
+        if (PrecisionClock::lateness.Max() >= (uint64_t)Micros(step)) return result.Fail("macros resumed late");
+        result.Emit();
+        return true;
+    }
+
+    // Per-step cost of the macro executor against the same steps written as
+    // a Lua loop: a key tap per step, back to back and with a 1 ms wait
+    // after each (on a virtual clock, so only the scheduling is paid for)
+    bool MacroSteps() {
+        Result result("macro_steps");
+        if (!LoadWorkload("macro_steps")) return result.Fail("workload did not load");
+        size_t steps = options.quick ? 100000 : 1000000;
+        size_t waits = options.quick ? 10000 : 100000;
+        auto compiled = PerStep("compiled", steps);
+        auto lua = PerStep("lua", steps);
+        auto compiledWaits = PerStep("compiled_waits", waits);
+        auto luaWaits = PerStep("lua_waits", waits);
+        if (!compiled || !lua || !compiledWaits || !luaWaits) return result.Fail("steps did not run");
+        result.Add("steps", (uint64_t)steps)
+            .Add("compiled_ns_per_step", *compiled, 1)
+            .Add("lua_ns_per_step", *lua, 1)
+            .Add("waits", (uint64_t)waits)
+            .Add("compiled_wait_ns_per_step", *compiledWaits, 1)
+            .Add("lua_wait_ns_per_step", *luaWaits, 1)
+            .Emit();
+        return true;
+    }
+
+    // Lateness of PrecisionClock waits on a fixed schedule at 1 ms, 5 ms and
+    // 16.6 ms periods (a 60 Hz frame) in each spin mode, on a bench thread
+    // with the real clock: what a macro step, a timer or a frame-paced loop
+    // can count on, and what the spinning tail buys over OS sleeps alone
+    bool WaitJitter() {
+        Result result("wait_jitter");
+        struct Period {
+            const char* name;
+            Clock::duration length;
+        };
+        const Period periods[] = {
+            { "1ms", 1ms },
+            { "5ms", 5ms },
+            { "16_6ms", std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(16667)) },
+        };
+        const std::pair<const char*, SpinMode> modes[] = {
+            { "sleep", SpinMode::Sleep }, { "yield", SpinMode::Yield }, { "spin", SpinMode::Spin },
+        };
+        auto run = options.quick ? 500ms : 3s;
+        SpinMode previous = PrecisionClock::mode.load();
+        for (const auto& [modeName, mode] : modes) {
+            PrecisionClock::mode = mode;
+            for (const Period& period : periods) {
+                std::vector<double> late;
+                auto deadline = Clock::now();
+                auto end = deadline + run;
+                while (deadline < end) {
+                    deadline += period.length;
+                    PrecisionClock::SleepUntil(deadline);
+                    late.push_back(Micros(Clock::now() - deadline));
+                }
+                result.Latency(std::string(modeName) + "_" + period.name, std::move(late));
+            }
+        }
+        PrecisionClock::mode = previous;
+        result.Add("spin_threshold_us", Micros(PrecisionClock::Threshold()), 0).Emit();
+        return true;
+    }
+}
@@ -0,0 +1,128 @@
+#include "Bench.hpp"
+#include "../src/core/Screen.hpp"
+#include "../src/core/Simulation.hpp"
+#include "../src/utils/ImageSearch.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace Bench {
+    namespace {
+        // Desktop-like frame: flat panels in a few colors with noise on top
+        Bitmap Desktop(int width, int height, std::mt19937& random) {
+            const uint32_t panels[] = { 0xFFF3F3F3, 0xFF1E1E1E, 0xFF2B579A, 0xFFFFFFFF };
+            Bitmap screen;
+            screen.Resize(width, height);
+            for (int y = 0; y < height; ++y) {
+                uint32_t* row = screen.Row(y);
+                for (int x = 0; x < width; ++x) {
+                    uint32_t pixel = panels[((x / 320) + (y / 180)) % 4];
+                    if (random() % 8 == 0) pixel ^= random() & 0x003F3F3F;
+                    row[x] = pixel;
+                }
+            }
+            return screen;
+        }
+
+        // Writes image as a top-down 32-bit BMP
+        bool SaveBmp(const std::string& path, const Bitmap& image) {
+            uint32_t pixelBytes = (uint32_t)image.pixels.size() * 4;
+            uint8_t header[54] = { 'B', 'M' };
+            auto put = [&](size_t at, uint32_t value, size_t bytes) {
+                for (size_t i = 0; i < bytes; ++i) header[at + i] = (uint8_t)(value >> (8 * i));
+            };
+            put(2, 54 + pixelBytes, 4);
+            put(10, 54, 4);
+            put(14, 40, 4);
+            put(18, (uint32_t)image.width, 4);
+            put(22, (uint32_t)-image.height, 4);
+            put(26, 1, 2);
+            put(28, 32, 2);
+            put(34, pixelBytes, 4);
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            return file.write(reinterpret_cast<const char*>(header), sizeof(header)) &&
+                   file.write(reinterpret_cast<const char*>(image.pixels.data()), pixelBytes);
+        }
+
+        double Median(std::vector<double> samples) {
+            std::sort(samples.begin(), samples.end());
+            return samples[samples.size() / 2];
+        }
+    }
+
+    // Finding a 48x48 template near the bottom-right corner of a 1080p and a
+    // 4K frame, with its anchor color sprinkled over the frame as decoys:
+    // the search kernel alone for every instruction set this CPU has, then
+    // image_find's path through Screen (capture from MemoryFrameSource,
+    // cached template, search) with the frame cache dropped before each call
+    bool ImageSearchTime() {
+        Result result("image_search");
+        struct Size {
+            const char* name;
+            int width;
+            int height;
+        };
+        const Size sizes[] = { { "1080p", 1920, 1080 }, { "4k", 3840, 2160 } };
+        const std::pair<const char*, ImageSearch::Isa> isas[] = {
+            { "scalar", ImageSearch::Isa::Scalar }, { "sse2", ImageSearch::Isa::Sse2 }, { "avx2", ImageSearch::Isa::Avx2 },
+        };
+        size_t runs = options.quick ? 5 : 30;
+        auto path = (std::filesystem::temp_directory_path() / "moonkey-bench-needle.bmp").string();
+        ImageSearch::Isa best = ImageSearch::isa;
+        std::mt19937 random(1);
+
+        for (const Size& size : sizes) {
+            Bitmap screen = Desktop(size.width, size.height, random);
+            Bitmap needle;
+            needle.Resize(48, 48);
+            for (uint32_t& pixel : needle.pixels) pixel = 0xFF000000 | (random() & 0x00FFFFFF);
+            int placeX = size.width - 200, placeY = size.height - 120;
+            for (int y = 0; y < needle.height; ++y) std::copy_n(needle.Row(y), needle.width, screen.Row(placeY + y) + placeX);
+            for (int decoy = 0; decoy < 1000; ++decoy) {
+                int x = (int)(random() % (uint32_t)placeX), y = (int)(random() % (uint32_t)placeY);
+                screen.Row(y)[x] = needle.pixels[0];
+            }
+            ImageTemplate prepared = ImageSearch::Prepare(needle);
+
+            for (const auto& [isaName, isa] : isas) {
+                if (isa > best) continue;
+                ImageSearch::isa = isa;
+                std::vector<double> times;
+                for (size_t run = 0; run < runs; ++run) {
+                    int x = -1, y = -1;
+                    auto start = Clock::now();
+                    bool found = ImageSearch::Find(screen, prepared, 8, x, y);
+                    times.push_back(Micros(Clock::now() - start) / 1000.0);
+                    if (!found || x != placeX || y != placeY) {
+                        ImageSearch::isa = best;
+                        return result.Fail(std::string(isaName) + " search missed the template");
+                    }
+                }
+                result.Add(std::string(size.name) + "_" + isaName + "_ms", Median(std::move(times)), 3);
+            }
+            ImageSearch::isa = best;
+
+            if (!SaveBmp(path, needle)) return result.Fail("cannot write " + path);
+            Simulation::screen->SetScreen(std::move(screen));
+            std::vector<double> times;
+            for (size_t run = 0; run < runs; ++run) {
+                Screen::Invalidate();
+                std::string error;
+                auto start = Clock::now();
+                auto found = Screen::ImageFind(path, std::nullopt, 8, error);
+                times.push_back(Micros(Clock::now() - start) / 1000.0);
+                if (!found || found->first != placeX || found->second != placeY) {
+                    return result.Fail(error.empty() ? "image_find missed the template" : error);
+                }
+            }
+            result.Add(std::string(size.name) + "_image_find_ms", Median(std::move(times)), 3);
+        }
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        Simulation::screen->SetScreen({});
+        Screen::Invalidate();
+        result.Emit();
+        return true;
+    }
+}
@@ -0,0 +1,97 @@
+#include "Bench.hpp"
+#include "../src/core/BytecodeCache.hpp"
+#include <algorithm>
+#include <filesystem>
+
+namespace Bench {
+    namespace {
+        // Module of about a thousand lines of small functions
+        std::string Module(int index) {
+            std::string text = "-- generated module " + std::to_string(index) + "\nlocal M = {}\n";
+            for (int f = 1; f <= 199; ++f) {
+                std::string n = std::to_string(f);
+                text += "function M.f" + n + "(a, b)\n";
+                text += "    local t = { a, b, \"m" + std::to_string(index) + "f" + n + "\" }\n";
+                text += "    if a > b then return t[1] + " + n + " end\n";
+                text += "    return #t\nend\n";
+            }
+            return text + "return M\n";
+        }
+
+        double Median(std::vector<double> samples) {
+            std::sort(samples.begin(), samples.end());
+            return samples.empty() ? 0.0 : samples[samples.size() / 2];
+        }
+    }
+
+    // Loading a 50,000-line script tree (main.lua requiring 50 modules):
+    // compiled from source with the cache off, cold with an empty cache
+    // that the load then fills, and warm from the filled cache
+    bool StartupTime() {
+        Result result("startup");
+        std::map<std::string, std::string> files;
+        std::string main = "-- generated: requires every module\nlocal total = 0\n";
+        for (int i = 1; i <= 50; ++i) {
+            files["lib/m" + std::to_string(i) + ".lua"] = Module(i);
+            main += "total = total + require(\"lib.m" + std::to_string(i) + "\").f1(2, 1)\n";
+        }
+        files["main.lua"] = main;
+        size_t lines = 0;
+        for (const auto& [path, text] : files) lines += (size_t)std::count(text.begin(), text.end(), '\n');
+
+        std::string directory = BytecodeCache::directory;
+        auto cache = std::filesystem::temp_directory_path() / "moonkey-bench-cache";
+        std::error_code ec;
+        std::filesystem::remove_all(cache, ec);
+        BytecodeCache::directory = cache.string();
+
+        // The first load only warms the file system
+        BytecodeCache::enabled = false;
+        if (!LoadFiles(files)) return result.Fail("script tree did not load");
+
+        size_t runs = options.quick ? 3 : 10;
+        auto time = [&](bool enabled, bool wipe, std::vector<double>& samples) {
+            BytecodeCache::enabled = enabled;
+            for (size_t run = 0; run < runs; ++run) {
+                if (wipe) std::filesystem::remove_all(cache, ec);
+                auto start = Clock::now();
+                if (!LoadScripts({ "main.lua" })) return false;
+                samples.push_back(Micros(Clock::now() - start) / 1000.0);
+            }
+            return true;
+        };
+        std::vector<double> source, cold, warm;
+        bool loaded = time(false, false, source) && time(true, true, cold) && time(true, false, warm);
+
+        BytecodeCache::enabled = true;
+        BytecodeCache::directory = directory;
+        std::filesystem::remove_all(cache, ec);
+        if (!loaded) return result.Fail("reload failed");
+
+        result.Add("lines", (uint64_t)lines)
+            .Add("files", (uint64_t)files.size())
+            .Add("runs", (uint64_t)runs)
+            .Add("source_ms", Median(source))
+            .Add("cold_ms", Median(cold))
+            .Add("warm_ms", Median(warm))
+            .Emit();
+        return true;
+    }
+
+    // Hotkey latency of a light script on its own, then while a neighbouring
+    // script keeps its worker busy with a timer that burns CPU: scripts on
+    // different workers must not wait for each other
+    bool ScriptIsolation() {
+        Result result("script_isolation");
+        if (!LoadWorkload("isolation")) return result.Fail("workload did not load");
+        size_t count = options.quick ? 200 : 2000;
+        std::vector<double> quiet, busy;
+        if (!Latencies(F(13), F(14), count, quiet)) return result.Fail("light script did not answer");
+        if (!RoundTrip(F(16), F(17))) return result.Fail("heavy script did not start burning");
+        bool answered = Latencies(F(13), F(14), count, busy);
+        if (!RoundTrip(F(16), F(17))) return result.Fail("heavy script did not stop burning");
+        if (!answered) return result.Fail("light script did not answer next to the busy one");
+        result.Latency("quiet", std::move(quiet)).Latency("busy_neighbour", std::move(busy)).Emit();
+        return true;
+    }
+}
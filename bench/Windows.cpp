@@ -0,0 +1,91 @@
+#include "Bench.hpp"
+#include "../src/api/WindowManager.hpp"
+#include "../src/core/Simulation.hpp"
+#include <random>
+
+namespace Bench {
+    namespace {
+        volatile size_t found = 0;    // Lookup results, so the lookups are not optimized away
+
+        // Nanoseconds per call of lookup, over count calls
+        template <typename Lookup>
+        double PerCall(size_t count, Lookup lookup) {
+            size_t total = 0;
+            auto start = Clock::now();
+            for (size_t i = 0; i < count; ++i) total += lookup();
+            double ns = Micros(Clock::now() - start) * 1000.0 / (double)count;
+            found = found + total;
+            return ns;
+        }
+    }
+
+    // 2,000 windows on the simulated desktop, opened through
+    // MemoryWindowProvider so the live WindowIndex follows their events:
+    // the cost of applying an event, of focus() and windows() style lookups
+    // from the index, and of the same lookups over a fresh enumeration, which
+    // is what every lookup paid before the index existed
+    bool WindowLookup() {
+        Result result("window_lookup");
+        const size_t count = 2000;
+        const char* classes[] = { "Chrome_WidgetWin_1", "Notepad", "CASCADIA_HOSTING_WINDOW_CLASS", "SunAwtFrame" };
+        const char* processes[] = { "chrome.exe", "notepad.exe", "WindowsTerminal.exe", "idea64.exe" };
+        size_t before = WindowManager::index.Size();
+
+        std::vector<WindowInfo> windows(count);
+        for (size_t i = 0; i < count; ++i) {
+            windows[i].handle = 0x10000 + i;
+            windows[i].title = "Document " + std::to_string(i) + " - " + processes[i % 4];
+            windows[i].className = classes[i % 4];
+            windows[i].processName = i == 0 ? "target.exe" : processes[i % 4];
+            windows[i].pid = (uint32_t)(1000 + i);
+        }
+        auto start = Clock::now();
+        for (const WindowInfo& window : windows) Simulation::windows->Create(window);
+        double createNs = Micros(Clock::now() - start) * 1000.0 / (double)count;
+        if (WindowManager::index.Size() != before + count) return result.Fail("the index missed window events");
+
+        // The target was opened first, so it sits at the bottom of the z-order
+        WindowMatcher exact, substring, wildcard, miss;
+        exact.Add(MatchField::Process, "target.exe", MatchMode::Exact);
+        substring.Add(MatchField::Title, "Document 1999");
+        wildcard.Add(MatchField::Class, "CASCADIA_*", MatchMode::Wildcard);
+        miss.Add(MatchField::Title, "no such window");
+
+        size_t lookups = options.quick ? 2000 : 20000;
+        auto indexFind = [&](const WindowMatcher& matcher) {
+            return PerCall(lookups, [&] { return (size_t)WindowManager::index.Find(matcher).has_value(); });
+        };
+        auto scanFind = [&](const WindowMatcher& matcher) {
+            return PerCall(lookups / 10, [&] {
+                for (const auto& window : Simulation::windows->Enumerate()) {
+                    if (matcher.Matches(window)) return (size_t)1;
+                }
+                return (size_t)0;
+            });
+        };
+        if (!WindowManager::index.Find(exact) || WindowManager::index.Query(wildcard).size() != count / 4) {
+            return result.Fail("the index lost windows");
+        }
+
+        result.Add("windows", (uint64_t)WindowManager::index.Size())
+            .Add("create_event_ns", createNs, 0)
+            .Add("find_exact_ns", indexFind(exact), 0)
+            .Add("find_substring_ns", indexFind(substring), 0)
+            .Add("find_miss_ns", indexFind(miss), 0)
+            .Add("query_wildcard_ns", PerCall(lookups / 10, [&] { return WindowManager::index.Query(wildcard).size(); }), 0)
+            .Add("scan_exact_ns", scanFind(exact), 0)
+            .Add("scan_miss_ns", scanFind(miss), 0);
+
+        // Focus changes move windows to the front of the z-order
+        std::mt19937 random(1);
+        start = Clock::now();
+        for (size_t i = 0; i < lookups; ++i) Simulation::windows->SetForeground(windows[random() % count]);
+        result.Add("foreground_event_ns", Micros(Clock::now() - start) * 1000.0 / (double)lookups, 0);
+
+        for (const WindowInfo& window : windows) Simulation::windows->Destroy(window.handle);
+        Simulation::windows->SetForeground({ 1, "moonkey-bench", "MoonKeyBench", "moonkey-bench", 1 });
+        if (WindowManager::index.Size() != before) return result.Fail("the index kept closed windows");
+        result.Emit();
+        return true;
+    }
+}
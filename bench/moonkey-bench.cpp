@@ -0,0 +1,123 @@
+// moonkey-bench: benchmarks on the headless simulation backends
+// Usage:
+//   moonkey-bench [-w workloads] [-o results.jsonl] [--quick] [benchmark...]
+// End-to-end benchmarks load the scripts of one directory under
+// bench/workloads through ScriptHost, the way MoonKey loads its scripts
+// directory, then play the user on Simulation's backends: they press chords
+// and timestamp the keys the scripts send back. Engine benchmarks time one
+// subsystem on the thread that owns it, with timers and coroutine waits on a
+// VirtualClock. Every benchmark prints one JSON line (the lines starting
+// with '{'); with -o the lines are appended to a file instead, to track
+// results across builds.
+// Wall-clock timings come from the real engine threads, so run it on an
+// otherwise idle machine and compare percentiles rather than single runs.
+#include "Bench.hpp"
+#include "../src/api/InputManager.hpp"
+#include "../src/core/HotkeyManager.hpp"
+#include "../src/core/ScriptHost.hpp"
+#include "../src/core/Simulation.hpp"
+#include "../src/utils/Log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace {
+    using namespace Bench;
+
+    struct Benchmark {
+        const char* name;
+        bool (*run)();
+    };
+
+    const Benchmark benchmarks[] = {
+        { "hotkey_latency", HotkeyLatency },
+        { "cross_script_latency", CrossScriptLatency },
+        { "timer_jitter", TimerJitter },
+        { "text_throughput", TextThroughput },
+        { "mouse_path", MousePathTiming },
+        { "gc_pauses", GcPauses },
+        { "spawn_throughput", SpawnThroughput },
+        { "reload", ReloadTime },
+        { "store", StoreOps },
+        { "loop_wakeup", LoopWakeup },
+        { "hotkey_dispatch", HotkeyDispatch },
+        { "window_filter", WindowFilter },
+        { "input_ring", InputRing },
+        { "hotstring_match", HotstringMatch },
+        { "event_publish", EventPublish },
+        { "timer_heap", TimerHeap },
+        { "coroutine_waits", CoroutineWaits },
+        { "macro_steps", MacroSteps },
+        { "wait_jitter", WaitJitter },
+        { "input_log", InputLogThroughput },
+        { "image_search", ImageSearchTime },
+        { "window_lookup", WindowLookup },
+        { "startup", StartupTime },
+        { "script_isolation", ScriptIsolation },
+    };
+
+    int Usage() {
+        std::fprintf(stderr, "usage: moonkey-bench [-w workloads] [-o results.jsonl] [--quick] [benchmark...]\nbenchmarks:");
+        for (const auto& benchmark : benchmarks) std::fprintf(stderr, " %s", benchmark.name);
+        std::fprintf(stderr, "\n");
+        return 2;
+    }
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-w" && i + 1 < argc) {
+            options.workloads = argv[++i];
+        } else if (arg == "-o" && i + 1 < argc) {
+            options.out = argv[++i];
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else if (!arg.empty() && arg[0] != '-' &&
+                   std::any_of(std::begin(benchmarks), std::end(benchmarks), [&](const Benchmark& b) { return arg == b.name; })) {
+            options.only.push_back(arg);
+        } else {
+            return Usage();
+        }
+    }
+    if (options.quick) {
+        options.textChars = 20000;
+        options.spawnBytes = 64 << 20;
+        options.timers = 2000;
+    }
+
+    // Workloads are copied into a scratch scripts directory one at a time
+    auto scripts = std::filesystem::temp_directory_path() / "moonkey-bench-scripts";
+    std::error_code ec;
+    std::filesystem::remove_all(scripts, ec);
+    if (!std::filesystem::create_directories(scripts, ec)) {
+        std::fprintf(stderr, "moonkey-bench: cannot create %s\n", scripts.string().c_str());
+        return 1;
+    }
+    options.scripts = scripts.string();
+
+    // The engine runs unchanged on top of the simulated desktop
+    Simulation::Install();
+    Simulation::windows->SetForeground({ 1, "moonkey-bench", "MoonKeyBench", "moonkey-bench", 1 });
+    Simulation::sink->Observe([](const InputEvent* events, size_t count) { watch.Observe(events, count); });
+    std::thread(HotkeyManager::MessageLoop).detach();
+
+    ScriptHost::root = options.scripts;
+    ScriptHost::environment = Environment;
+    ScriptHost::Start();
+
+    int failed = 0;
+    for (const auto& benchmark : benchmarks) {
+        if (!options.only.empty() && std::find(options.only.begin(), options.only.end(), benchmark.name) == options.only.end()) continue;
+        if (!benchmark.run()) ++failed;
+    }
+
+    Log::Flush();
+    std::fflush(stdout);
+    // The MessageLoop and the workers never return; leave without running
+    // the static destructors they still depend on
+    std::quick_exit(failed ? 1 : 0);
+}
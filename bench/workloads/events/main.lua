@@ -0,0 +1,6 @@
+-- cross_script_latency: Ctrl+F15 emits an event that relay.lua answers
+local n = 0
+bind(MOD.CTRL, KEY.F15, function()
+    n = n + 1
+    emit("bench.ping", n, { source = "main" })
+end)
@@ -0,0 +1,4 @@
+-- Runs in a state of its own, usually on another worker
+on("bench.ping", function(n, info)
+    send(KEY.F16)
+end)
@@ -0,0 +1,10 @@
+-- gc_pauses: a timer churns through short-lived tables while Ctrl+F13
+-- keeps answering with F14
+local keep, slot = {}, 0
+set_interval(1, function()
+    local garbage = {}
+    for i = 1, 2000 do garbage[i] = { i, tostring(i) } end
+    slot = slot % 64 + 1
+    keep[slot] = garbage
+end)
+bind(MOD.CTRL, KEY.F13, function() send(KEY.F14) end)
@@ -0,0 +1,11 @@
+-- hotkey_latency: Ctrl+F13 answers with F14
+-- A few hundred other bindings, some window-scoped, keep the chord table
+-- and window resolution as busy as in a large configuration
+for vk = KEY.A, KEY.Z do
+    for _, mods in ipairs({ MOD.ALT, MOD.SHIFT, MOD.ALT + MOD.SHIFT, MOD.WIN }) do
+        bind(mods, vk, function() end)
+        bind(mods, vk, function() end, { process = "editor.exe" })
+    end
+end
+bind(MOD.CTRL, KEY.F13, function() send(KEY.F15) end, { title = "never matches", match = "exact" })
+bind(MOD.CTRL, KEY.F13, function() send(KEY.F14) end)
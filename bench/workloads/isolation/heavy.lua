@@ -0,0 +1,16 @@
+-- script_isolation: Ctrl+F16 starts or stops burning CPU on this script's
+-- worker, then answers with F17
+local burner
+
+bind(MOD.CTRL, KEY.F16, function()
+    if burner then
+        clear_timer(burner)
+        burner = nil
+    else
+        burner = set_interval(1, function()
+            local x = 0
+            for i = 1, 2000000 do x = x + i end
+        end)
+    end
+    send(KEY.F17)
+end)
@@ -0,0 +1,2 @@
+-- script_isolation: Ctrl+F13 answers with F14 while heavy.lua may be busy
+bind(MOD.CTRL, KEY.F13, function() send(KEY.F14) end)
@@ -0,0 +1,2 @@
+-- input_ring: F13 going down answers with F14; letters have no handler
+on_key_down(KEY.F13, function() send(KEY.F14) end)
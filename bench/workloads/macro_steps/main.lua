@@ -0,0 +1,20 @@
+-- macro_steps: the same key taps as a compiled macro and as a Lua loop,
+-- back to back and with a 1 ms wait after each
+BENCH.export("compiled", function(n)
+    macro.compile{ { "loop", n, { { "tap", KEY.F15 } } } }:run()
+end)
+
+BENCH.export("lua", function(n)
+    for i = 1, n do send(KEY.F15) end
+end)
+
+BENCH.export("compiled_waits", function(n)
+    macro.compile{ { "loop", n, { { "tap", KEY.F15 }, { "wait", 1 } } } }:run()
+end)
+
+BENCH.export("lua_waits", function(n)
+    for i = 1, n do
+        send(KEY.F15)
+        sleep(1)
+    end
+end)
@@ -0,0 +1,4 @@
+-- coroutine_waits: a macro that waits, started a thousand times over by the benchmark
+BENCH.export("macro", function(ms)
+    sleep(ms)
+end)
@@ -0,0 +1,6 @@
+-- mouse_path: Ctrl+F19 plays a 200 ms path at 1000 positions per second,
+-- then presses F20
+bind(MOD.CTRL, KEY.F19, function()
+    mouse_path{ from = {0, 0}, to = {1920, 1080}, curve = "bezier", duration = 200, rate = 1000 }
+    send(KEY.F20)
+end)
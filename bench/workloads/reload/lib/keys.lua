@@ -0,0 +1,10 @@
+-- Module loaded through require, as split configurations do
+local M = { bindings = {} }
+local windows = { nil, "Notepad", { process = "code.exe" }, { class = "Chrome_WidgetWin_1" } }
+
+for vk = KEY.A, KEY.Z do
+    for i, mods in ipairs({ MOD.CTRL + MOD.ALT, MOD.CTRL + MOD.SHIFT, MOD.WIN + MOD.ALT }) do
+        table.insert(M.bindings, { mods = mods, vk = vk, answer = KEY.F1 + i, window = windows[vk % 4 + 1] })
+    end
+end
+return M
@@ -0,0 +1,13 @@
+-- reload: a configuration of typical size, reloaded over and over
+local keys = require("lib.keys")
+
+for i, binding in ipairs(keys.bindings) do
+    bind(binding.mods, binding.vk, function() send(binding.answer) end, binding.window)
+end
+for i = 1, 20 do
+    set_interval(3600 * 1000 + i, function() end)
+end
+for _, word in ipairs({ "btw", "omw", "afaik", "imo", "brb", "ty", "np", "lgtm" }) do
+    hotstring(word, word:upper())
+end
+on("bench.reload", function() end)
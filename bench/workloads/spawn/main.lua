@@ -0,0 +1,18 @@
+-- spawn_throughput: Ctrl+F21 streams BENCH.bytes of 100-byte lines through
+-- on_stdout; on exit F22 reports a complete delivery, F23 a short one.
+-- Ctrl+F13 answers with F14 all the while.
+local bytes = (BENCH and BENCH.bytes) or (1 << 30)
+local line = string.rep("x", 99)
+
+bind(MOD.CTRL, KEY.F21, function()
+    local received = 0
+    spawn("yes " .. line .. " | head -c " .. bytes, {
+        on_stdout = function(lines)
+            for i = 1, #lines do received = received + #lines[i] + 1 end
+        end,
+        on_exit = function(code)
+            send(received == bytes and KEY.F22 or KEY.F23)
+        end,
+    })
+end)
+bind(MOD.CTRL, KEY.F13, function() send(KEY.F14) end)
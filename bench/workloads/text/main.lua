@@ -0,0 +1,7 @@
+-- text_throughput: Ctrl+F18 types BENCH.chars lowercase characters
+-- Only letters and spaces, so every character is exactly one key press
+local chars = (BENCH and BENCH.chars) or 100000
+local sentence = "the quick brown fox jumps over the lazy dog "
+local text = string.rep(sentence, chars // #sentence + 1):sub(1, chars)
+
+bind(MOD.CTRL, KEY.F18, function() write(text) end)
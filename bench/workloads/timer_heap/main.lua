@@ -0,0 +1,9 @@
+-- timer_heap: BENCH.timers intervals from 5 ms to 1 s, one in ten window-scoped
+for i = 1, BENCH.timers do
+    local ms = 5 + (i % 200) * 5
+    if i % 10 == 0 then
+        set_interval(ms, function() end, { process = "editor.exe" })
+    else
+        set_interval(ms, function() end)
+    end
+end
@@ -0,0 +1,5 @@
+-- timer_jitter: F17 every 5 ms, next to timers that only add load
+set_interval(5, function() send(KEY.F17) end)
+set_interval(1, function() end)
+set_interval(7, function() end)
+set_interval(50, function() local t = {} for i = 1, 100 do t[i] = i end end)
@@ -1,85 +1,73 @@
 #include "InputManager.hpp"
 
 void InputManager::SimulateKeyPress(int vk) {
-    INPUT inputs[2] = {};
-    inputs[0].type = INPUT_KEYBOARD;
-    inputs[0].ki.wVk = (WORD)vk;
-    inputs[1].type = INPUT_KEYBOARD;
-    inputs[1].ki.wVk = (WORD)vk;
-    inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
-    SendInput(2, inputs, sizeof(INPUT));
+    const InputEvent inputs[2] = {
+        InputEvent::Key((uint16_t)vk, false),
+        InputEvent::Key((uint16_t)vk, true),
+    };
+    sink->Send(inputs, 2);
 }
 
-void InputManager::WriteText(const std::string& text) {
-    for (char c : text) {
-        SHORT vk = VkKeyScan(c);
-        BYTE vkCode = LOBYTE(vk);
-        BYTE shiftState = HIBYTE(vk);
-
-        if (shiftState & 1) {
-            INPUT shiftDown = {};
-            shiftDown.type = INPUT_KEYBOARD;
-            shiftDown.ki.wVk = VK_SHIFT;
-            SendInput(1, &shiftDown, sizeof(INPUT));
-        }
+void InputManager::EraseChars(int count) {
+    if (count <= 0) return;
+    std::vector<InputEvent> inputs;
+    inputs.reserve((size_t)count * 2);
+    for (int i = 0; i < count; ++i) {
+        inputs.push_back(InputEvent::Key(Vk::Back, false));
+        inputs.push_back(InputEvent::Key(Vk::Back, true));
+    }
+    sink->Send(inputs.data(), inputs.size());
+}
 
-        INPUT keyDown = {};
-        keyDown.type = INPUT_KEYBOARD;
-        keyDown.ki.wVk = vkCode;
-        SendInput(1, &keyDown, sizeof(INPUT));
+void InputManager::WriteText(const std::string& text, const WriteOptions& options) {
+    TextInjector::Write(text, options, *sink);
+}
 
-        INPUT keyUp = {};
-        keyUp.type = INPUT_KEYBOARD;
-        keyUp.ki.wVk = vkCode;
-        keyUp.ki.dwFlags = KEYEVENTF_KEYUP;
-        SendInput(1, &keyUp, sizeof(INPUT));
+WriteOptions InputManager::ParseWriteOptions(const sol::object& options) {
+    WriteOptions result;
+    if (!options.is<sol::table>()) return result;
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    sol::table t = options.as<sol::table>();
+    result.pacing = TextInjector::ParsePacing(t.get_or<std::string>("pace", "none"));
+    result.delay = std::chrono::milliseconds(t.get_or("delay", 15));
+    result.batchSize = (size_t)t.get_or("batch", 4096);
 
-        if (shiftState & 1) {
-            INPUT shiftUp = {};
-            shiftUp.type = INPUT_KEYBOARD;
-            shiftUp.ki.wVk = VK_SHIFT;
-            shiftUp.ki.dwFlags = KEYEVENTF_KEYUP;
-            SendInput(1, &shiftUp, sizeof(INPUT));
-        }
+    sol::object paste = t["paste"];
+    if (paste.is<bool>()) {
+        result.pasteThreshold = paste.as<bool>() ? 1 : 0;
+    } else if (paste.is<int>()) {
+        result.pasteThreshold = (size_t)paste.as<int>();
     }
+    return result;
 }
 
 void InputManager::SetMousePos(int x, int y) {
-    double screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    double screenHeight = GetSystemMetrics(SM_CYSCREEN);
-    INPUT input = { 0 };
-    input.type = INPUT_MOUSE;
-    input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE;
-    input.mi.dx = (long)(x * (65535.0 / screenWidth));
-    input.mi.dy = (long)(y * (65535.0 / screenHeight));
-    SendInput(1, &input, sizeof(INPUT));
+    InputEvent input = InputEvent::Move(x, y);
+    sink->Send(&input, 1);
 }
 
 void InputManager::MouseClick(int button) {
-    INPUT inputs[2] = { 0 };
-    inputs[0].type = INPUT_MOUSE;
-    inputs[1].type = INPUT_MOUSE;
-    if (button == 0) {
-        inputs[0].mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-        inputs[1].mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    } else if (button == 1) {
-        inputs[0].mi.dwFlags = MOUSEEVENTF_RIGHTDOWN;
-        inputs[1].mi.dwFlags = MOUSEEVENTF_RIGHTUP;
-    } else {
-        inputs[0].mi.dwFlags = MOUSEEVENTF_MIDDLEDOWN;
-        inputs[1].mi.dwFlags = MOUSEEVENTF_MIDDLEUP;
-    }
-    SendInput(2, inputs, sizeof(INPUT));
+    const InputEvent inputs[2] = {
+        InputEvent::Button(button, false),
+        InputEvent::Button(button, true),
+    };
+    sink->Send(inputs, 2);
 }
 
 sol::table InputManager::GetMousePos(sol::this_state ts) {
-    POINT p;
-    GetCursorPos(&p);
+    int x, y;
+    sink->GetCursorPos(x, y);
     sol::state_view lua(ts);
-    sol::table pos_table = lua.create_table();
-    pos_table["x"] = p.x;
-    pos_table["y"] = p.y;
+    sol::table pos_table = lua.create_table(0, 2);
+    pos_table["x"] = x;
+    pos_table["y"] = y;
     return pos_table;
-}
\ No newline at end of file
+}
+
+int InputManager::LuaMouseXY(lua_State* L) {
+    int x, y;
+    sink->GetCursorPos(x, y);
+    lua_pushinteger(L, x);
+    lua_pushinteger(L, y);
+    return 2;
+}
@@ -1,28 +1,43 @@
 #pragma once
 #include <sol/sol.hpp>
-#include <windows.h>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
+#include "../platform/InputSink.hpp"
+#include "../core/TextInjector.hpp"
+#include "../core/ProbedInputSink.hpp"
 
 // Input simulation for keyboard and mouse
-// Provides cross-platform input simulation using Windows SendInput API
+// Provides input simulation through an InputSink (SendInput on Windows)
 // Supports keyboard events, text typing, and mouse operations
 struct InputManager {
+    static inline std::unique_ptr<InputSink> sink =
+        std::make_unique<ProbedInputSink>(CreateDefaultInputSink(), Stats::send); // OS input backend, timed per batch
+
     // Simulate a single key press and release
     // vk: Virtual key code (use KEY constants)
     // Simulates pressing and immediately releasing a key
     // Equivalent to a quick tap on the keyboard
     static void SimulateKeyPress(int vk);
 
+    // Delete characters before the caret
+    // count: Number of Backspace presses, sent as a single batch
+    static void EraseChars(int count);
+
     // Type text as if from keyboard
-    // text: String to type
-    // Simulates typing complete strings with proper shift key handling
-    // for uppercase and special characters. Includes small delays between
-    // keystrokes for reliability with some applications.
-    // Handles shift states for characters like @, !, %, etc.
-    // Includes 15ms delay between keystrokes
-    static void WriteText(const std::string& text);
+    // text: UTF-8 string to type
+    // options: Pacing and clipboard settings for this call
+    // Builds the whole event sequence first and sends it in batches.
+    // Characters on the current layout are typed as keys with proper shift
+    // handling; anything else (emoji, other scripts) is sent as Unicode input.
+    // By default no delay is inserted; use Fixed or Adaptive pacing for
+    // applications that drop fast input
+    static void WriteText(const std::string& text, const WriteOptions& options = {});
+
+    // Parse write() options from Lua
+    // options: nil or { pace = "none" | "fixed" | "adaptive", delay = ms, batch = n, paste = true | minChars }
+    static WriteOptions ParseWriteOptions(const sol::object& options);
 
     // Move mouse cursor to absolute screen coordinates
     // x: X coordinate (0 = left edge, screen width = right edge)
@@ -44,4 +59,9 @@ struct InputManager {
     // Returns the current cursor position in screen coordinates
     // Position is relative to the primary monitor
     static sol::table GetMousePos(sol::this_state ts);
-};
\ No newline at end of file
+
+    // Lua binding: mouse_xy()
+    // Returns the cursor position as two values (x, y) without creating a
+    // table, for loops that poll it often
+    static int LuaMouseXY(lua_State* L);
+};
@@ -1,25 +1,201 @@
 #include "TimerManager.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../core/CoroutineScheduler.hpp"
+#include "../core/BindingSet.hpp"
+#include "../core/ScriptModules.hpp"
+#include "../core/PrecisionClock.hpp"
+#include <algorithm>
 
-void TimerManager::Add(int ms, sol::function callback, std::string targetWindow) {
-    long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
-    timers.push_back({ callback, (long long)ms, now, targetWindow });
+int TimerManager::Add(int ms, ScriptFunction callback, WindowMatcher context, MissedTickPolicy policy, std::string owner) {
+    auto interval = std::chrono::milliseconds((std::max)(ms, 1));
+    return Enqueue({ Request::Type::Add, nextHandle++,
+                     { callback, interval, Clock::now() + interval, std::move(context), true, policy, std::move(owner),
+                       Stats::ForBinding(Stats::timer, *callback) } });
+}
+
+int TimerManager::AddTimeout(int ms, ScriptFunction callback, WindowMatcher context, std::string owner) {
+    auto delay = std::chrono::milliseconds((std::max)(ms, 0));
+    return Enqueue({ Request::Type::Add, nextHandle++,
+                     { callback, delay, Clock::now() + delay, std::move(context), false, MissedTickPolicy::Skip, std::move(owner),
+                       Stats::ForBinding(Stats::timer, *callback) } });
+}
+
+void TimerManager::Cancel(int handle, std::string script) {
+    TimerData data;
+    data.owner = std::move(script);
+    Enqueue({ Request::Type::Cancel, handle, std::move(data) });
+}
+
+void TimerManager::CancelOwner(std::string owner) {
+    TimerData data;
+    data.owner = std::move(owner);
+    Enqueue({ Request::Type::CancelOwner, 0, std::move(data) });
 }
 
 void TimerManager::Update() {
-    long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
+    Update(Clock::now());
+}
+
+void TimerManager::Update(Clock::time_point now) {
+    ApplyRequests();
+
+    std::shared_ptr<const WindowInfo> active;  // Snapshot read at most once per update
+
+    while (!heap.empty() && heap.front().deadline <= now) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        Entry entry = heap.back();
+        heap.pop_back();
+
+        // Callbacks may have cancelled timers that are still in this batch
+        if (hasRequests) ApplyRequests();
+
+        auto it = timers.find(entry.handle);
+        if (it == timers.end() || it->second.deadline != entry.deadline) continue;
 
-    for (auto& timer : timers) {
-        if (now - timer.lastTick >= timer.interval) {
-            if (timer.targetWindow.empty() || WindowManager::GetActiveWindowTitle() == timer.targetWindow) {
-                timer.callback();
+        TimerData& timer = it->second;
+        bool run = timer.context.IsGlobal();
+        if (!run) {
+            if (!active) active = WindowManager::ActiveWindow();
+            run = timer.context.Matches(*active);
+        }
+
+        // Reschedule before running so the callback can cancel its own timer
+        ScriptFunction callback = timer.callback;
+        std::shared_ptr<Probe> probe = timer.probe;
+        std::shared_ptr<std::atomic<bool>> queued = timer.queued;
+        // A Skip timer whose last firing has not run yet does not pile up
+        // behind a busy script
+        if (run && timer.repeat && timer.policy == MissedTickPolicy::Skip) run = !queued->exchange(true);
+        if (timer.repeat) {
+            Clock::time_point next = timer.deadline + timer.interval;
+            if (next <= now && timer.policy == MissedTickPolicy::Skip) {
+                auto missed = (now - timer.deadline) / timer.interval;
+                next = timer.deadline + timer.interval * (missed + 1);
             }
-            timer.lastTick = now;
+            Schedule(entry.handle, next);
+        } else {
+            timers.erase(it);
+        }
+
+        if (run) {
+            // Only firings count towards lateness; dropped ticks never ran late
+            PrecisionClock::Record(entry.deadline, now);
+            ScriptHost::Run(callback, [callback, probe = std::move(probe), queued = std::move(queued)]() mutable {
+                queued->store(false);
+                CoroutineScheduler::SpawnProbed(std::move(probe), *callback);
+            });
+        }
+    }
+
+    // Drop stale entries once they dominate the heap
+    if (heap.size() > 64 && heap.size() > timers.size() * 2) {
+        heap.clear();
+        for (const auto& [handle, timer] : timers) {
+            heap.push_back({ timer.deadline, handle });
         }
+        std::make_heap(heap.begin(), heap.end(), std::greater<>());
+    }
+}
+
+std::optional<TimerManager::Clock::time_point> TimerManager::NextDeadline() {
+    ApplyRequests();
+    while (!heap.empty()) {
+        const Entry& top = heap.front();
+        auto it = timers.find(top.handle);
+        if (it != timers.end() && it->second.deadline == top.deadline) return top.deadline;
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        heap.pop_back();
     }
+    return std::nullopt;
 }
 
 void TimerManager::Clear() {
-    timers.clear();
-}
\ No newline at end of file
+    Enqueue({ Request::Type::Clear, 0, {} });
+}
+
+void TimerManager::Replace(const std::string& script, std::vector<std::pair<int, TimerData>> staged) {
+    auto owned = [&](const TimerData& timer) { return ScriptModules::BelongsTo(timer.owner, script); };
+    {
+        // Requests of other scripts stay queued
+        std::lock_guard<std::mutex> lock(requestMutex);
+        std::erase_if(requests, [&](const Request& req) { return req.type == Request::Type::Add && owned(req.data); });
+    }
+    // Heap entries of removed timers go stale and are skipped
+    std::erase_if(timers, [&](const auto& item) { return owned(item.second); });
+
+    auto now = Clock::now();
+    for (auto& [handle, timer] : staged) {
+        timer.deadline = now + timer.interval;
+        timers[handle] = std::move(timer);
+        heap.push_back({ timers[handle].deadline, handle });
+    }
+    std::make_heap(heap.begin(), heap.end(), std::greater<>());
+}
+
+MissedTickPolicy TimerManager::ParsePolicy(const std::string& name) {
+    if (name == "catchup" || name == "catch_up") return MissedTickPolicy::CatchUp;
+    return MissedTickPolicy::Skip;
+}
+
+int TimerManager::Enqueue(Request request) {
+    int handle = request.handle;
+    if (auto* staged = BindingSet::staging) {
+        if (request.type == Request::Type::Add) {
+            staged->timers.emplace_back(handle, std::move(request.data));
+            return handle;
+        }
+        if (request.type == Request::Type::Cancel) {
+            std::erase_if(staged->timers, [&](const auto& item) { return item.first == handle; });
+            return handle;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        requests.push_back(std::move(request));
+        hasRequests = true;
+    }
+    HotkeyManager::Wake();
+    return handle;
+}
+
+void TimerManager::ApplyRequests() {
+    if (!hasRequests) return;
+
+    std::vector<Request> pending;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        pending.swap(requests);
+        hasRequests = false;
+    }
+
+    for (auto& req : pending) {
+        switch (req.type) {
+        case Request::Type::Add:
+            Schedule(req.handle, req.data.deadline);
+            timers[req.handle] = std::move(req.data);
+            break;
+        case Request::Type::Cancel: {
+            // Handles are global; a script only cancels its own timers
+            auto it = timers.find(req.handle);
+            if (it != timers.end() && (req.data.owner.empty() || ScriptModules::BelongsTo(it->second.owner, req.data.owner))) {
+                timers.erase(it);
+            }
+            break;
+        }
+        case Request::Type::CancelOwner:
+            std::erase_if(timers, [&](const auto& item) { return item.second.owner == req.data.owner; });
+            break;
+        case Request::Type::Clear:
+            timers.clear();
+            heap.clear();
+            break;
+        }
+    }
+}
+
+void TimerManager::Schedule(int handle, Clock::time_point deadline) {
+    auto it = timers.find(handle);
+    if (it != timers.end()) it->second.deadline = deadline;
+    heap.push_back({ deadline, handle });
+    std::push_heap(heap.begin(), heap.end(), std::greater<>());
+}
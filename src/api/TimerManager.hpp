@@ -1,41 +1,135 @@
 #pragma once
 #include <sol/sol.hpp>
-#include <windows.h>
 #include <string>
 #include <chrono>
+#include <optional>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
 #include "WindowManager.hpp"
+#include "../core/Stats.hpp"
+#include "../core/ScriptHost.hpp"
+
+// What to do when a repeating timer falls behind by one or more periods
+enum class MissedTickPolicy {
+    Skip,       // Drop missed periods and fire once, keeping the original phase
+    CatchUp     // Fire once for every missed period
+};
 
 // Timer management for scheduled callbacks
-// Provides functionality to set up repeating timers that execute Lua callbacks
+// Provides functionality to set up repeating and one-shot timers that execute Lua callbacks
 // Timers can be global or tied to specific window titles for context-sensitive execution
 struct TimerData {
-    sol::function callback;
-    long long interval;
-    long long lastTick;
-    std::string targetWindow;
+    using Clock = std::chrono::steady_clock;
+
+    ScriptFunction callback;
+    Clock::duration interval;         // Period between firings
+    Clock::time_point deadline;       // Next scheduled firing, derived from the original schedule
+    WindowMatcher context;            // Window filter (global if empty)
+    bool repeat = true;               // false for set_timeout
+    MissedTickPolicy policy = MissedTickPolicy::Skip;
+    std::string owner;                // Script module that created the timer
+    std::shared_ptr<Probe> probe;     // Call count and run time of the callback
+    std::shared_ptr<std::atomic<bool>> queued = std::make_shared<std::atomic<bool>>(false); // A firing waits on the script's worker
 };
 
 class TimerManager {
 public:
-    // Store active timers
-    static inline std::vector<TimerData> timers;
+    using Clock = TimerData::Clock;
+
+    // Active timers by handle
+    // Only touched on the MessageLoop thread
+    static inline std::unordered_map<int, TimerData> timers;
 
-    // Add a new timer
+    // Add a new repeating timer
     // ms: Interval in milliseconds between callback executions
     // callback: Lua function to call when timer ticks
-    // targetWindow: Optional window title for context-sensitive timers
-    // If targetWindow is specified, the callback will only execute when that window is active
+    // context: Optional window filter for context-sensitive timers
+    // policy: How to handle periods missed while the loop was busy
+    // owner: Script module that creates the timer (see ScriptModules::Owner)
+    // Returns: Handle that can be passed to Cancel()
+    // If context is specified, the callback will only execute when a matching window is active
     // If empty, the timer will execute regardless of active window
-    static void Add(int ms, sol::function callback, std::string targetWindow = "");
+    // Deadlines are computed from the time of the call, so the timer does not drift
+    // A firing is posted to the script's worker; with the Skip policy, a tick
+    // that comes while the previous firing is still queued there is dropped
+    // Safe to call from any thread; wakes the MessageLoop so the new deadline is taken into account
+    static int Add(int ms, ScriptFunction callback, WindowMatcher context = {},
+                   MissedTickPolicy policy = MissedTickPolicy::Skip, std::string owner = "");
 
-    // Update timers and execute callbacks as needed
+    // Add a one-shot timer
+    // ms: Delay in milliseconds before the callback executes
+    // Returns: Handle that can be passed to Cancel()
+    // A window-scoped timeout is dropped if the window is not active when it fires
+    static int AddTimeout(int ms, ScriptFunction callback, WindowMatcher context = {}, std::string owner = "");
+
+    // Cancel a timer by handle
+    // script: Top-level script the timer must belong to (one of its modules
+    //         counts too), or empty to cancel any timer
+    // Unknown or already finished handles, and timers of other scripts, are ignored
+    static void Cancel(int handle, std::string script = "");
+
+    // Cancel every timer created by a script module
+    // Queued behind earlier Add() calls, so timers added afterwards survive
+    static void CancelOwner(std::string owner);
+
+    // Execute callbacks for every timer that is due
     // This should be called regularly (e.g., in the main loop) to check timers
-    // It checks if the interval has passed for each timer and executes the callback if so
+    // Only timers whose deadline has passed are visited
     // For context-sensitive timers, it also checks if the target window is active before executing
     static void Update();
 
+    // Same as Update() against an explicit clock reading
+    // Lets a virtual clock drive the scheduler
+    static void Update(Clock::time_point now);
+
+    // Get the time at which the next timer becomes due
+    // Returns nullopt when no timers are registered
+    // Used by the MessageLoop to sleep until the next timer instead of polling
+    static std::optional<Clock::time_point> NextDeadline();
+
     // Clear all timers
     // Removes all active timers from the system
     // Use with caution as this will stop all scheduled callbacks
     static void Clear();
-};
\ No newline at end of file
+
+    // Replace the timers of one script with a staged set
+    // script: Top-level script that was reloaded or unloaded
+    // staged: Timers by handle, collected while its new state loaded
+    // Must be called on the MessageLoop thread. Timers of other scripts are
+    // kept, pending additions from the previous state are dropped, and staged
+    // deadlines are rebased so each timer first fires one interval after the swap
+    static void Replace(const std::string& script, std::vector<std::pair<int, TimerData>> staged);
+
+    // Parses a missed-tick policy name from Lua ("skip" or "catchup")
+    // Unknown names fall back to Skip
+    static MissedTickPolicy ParsePolicy(const std::string& name);
+
+private:
+    // Heap entry; stale entries (cancelled or rescheduled timers) are skipped when popped
+    struct Entry {
+        Clock::time_point deadline;
+        int handle;
+        bool operator>(const Entry& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : handle > other.handle;
+        }
+    };
+
+    // Pending change requested from Lua
+    struct Request {
+        enum class Type { Add, Cancel, CancelOwner, Clear } type;
+        int handle;
+        TimerData data;
+    };
+
+    static inline std::vector<Entry> heap;                 // Min-heap keyed by deadline
+    static inline std::vector<Request> requests;           // Queue for thread-safe changes
+    static inline std::mutex requestMutex;                 // Mutex for request queue
+    static inline std::atomic<bool> hasRequests = false;   // Fast check for pending requests
+    static inline std::atomic<int> nextHandle = 1;         // Next timer handle
+
+    static int Enqueue(Request request);
+    static void ApplyRequests();
+    static void Schedule(int handle, Clock::time_point deadline);
+};
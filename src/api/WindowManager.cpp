@@ -1,35 +1,105 @@
 #include "WindowManager.hpp"
+#include "../utils/Log.hpp"
+
+void WindowManager::Attach() {
+    // Notifications are delivered on this thread, so none can slip in between
+    provider->Attach(&WindowManager::OnEvent);
+    index.Reset(provider->Enumerate());
+    attached = true;
+    Update(provider->Foreground());
+}
+
+std::shared_ptr<const WindowInfo> WindowManager::ActiveWindow() {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    return active;
+}
 
 std::string WindowManager::GetActiveWindowTitle() {
-    char title[256];
-    HWND hwnd = GetForegroundWindow();
-    GetWindowTextA(hwnd, title, sizeof(title));
-    return std::string(title);
-}
-
-void WindowManager::SetFocusToWindow(std::string windowTitle) {
-    // First try: Find window by title
-    HWND hwnd = FindWindow(NULL, windowTitle.c_str());
-
-    if (hwnd == NULL) {
-        std::cerr << "[Error] Window not found by title: " << windowTitle << std::endl;
-        
-        // Second try: Find window by class name
-        hwnd = FindWindow(windowTitle.c_str(), NULL);
-        if (hwnd == NULL) {
-            std::cerr << "[Error] Window not found by class name: " << windowTitle << std::endl;
-            return;
-        }
+    return ActiveWindow()->title;
+}
+
+WindowMatcher WindowManager::ParseFilter(const sol::object& filter) {
+    WindowMatcher matcher;
+    if (filter.is<std::string>()) {
+        std::string title = filter.as<std::string>();
+        if (!title.empty()) matcher.Add(MatchField::Title, title);
+    } else if (filter.is<sol::table>()) {
+        sol::table t = filter.as<sol::table>();
+        MatchMode mode = WindowMatcher::ParseMode(t.get_or<std::string>("match", "substring"));
+        if (auto title = t.get<sol::optional<std::string>>("title")) matcher.Add(MatchField::Title, *title, mode);
+        if (auto cls = t.get<sol::optional<std::string>>("class")) matcher.Add(MatchField::Class, *cls, mode);
+        if (auto process = t.get<sol::optional<std::string>>("process")) matcher.Add(MatchField::Process, *process, mode);
     }
+    return matcher;
+}
 
-    if (SetForegroundWindow(hwnd)) {
-        std::cout << "[System] Successfully focused window: " << windowTitle << std::endl;
-        
-        // Restore window if minimized
-        ShowWindow(hwnd, SW_RESTORE);
-    } else {
-        DWORD error = GetLastError();
-        std::cerr << "[Error] Failed to set focus to window: " << windowTitle 
-                  << " (Error: " << error << ")" << std::endl;
+void WindowManager::OnEvent(const WindowEvent& event) {
+    index.Apply(event);
+    if (event.type == WindowEvent::Type::Foreground) {
+        Update(event.window);
+    } else if (event.type == WindowEvent::Type::Renamed) {
+        auto current = ActiveWindow();
+        if (current->handle != event.window.handle) return;
+        WindowInfo renamed = *current;
+        renamed.title = event.window.title;
+        Update(renamed);
     }
-}
\ No newline at end of file
+}
+
+void WindowManager::Update(const WindowInfo& window) {
+    auto snapshot = std::make_shared<const WindowInfo>(window);
+    std::lock_guard<std::mutex> lock(activeMutex);
+    active = std::move(snapshot);
+}
+
+std::vector<WindowInfo> WindowManager::Windows(const WindowMatcher& matcher) {
+    if (attached) return index.Query(matcher);
+    std::vector<WindowInfo> found;
+    for (auto& window : provider->Enumerate()) {
+        if (matcher.Matches(window)) found.push_back(std::move(window));
+    }
+    return found;
+}
+
+bool WindowManager::Focus(const WindowMatcher& matcher) {
+    std::optional<WindowInfo> found;
+    if (attached) {
+        found = index.Find(matcher);
+    } else if (auto all = Windows(matcher); !all.empty()) {
+        found = std::move(all.front());
+    }
+    if (!found) {
+        Log::Err() << "[Error] Window not found: " << matcher.Describe();
+        return false;
+    }
+    if (!provider->Activate(found->handle)) {
+        Log::Err() << "[Error] Failed to set focus to window: " << found->title;
+        return false;
+    }
+    Log::Out() << "[System] Successfully focused window: " << found->title;
+    return true;
+}
+
+bool WindowManager::SetFocusToWindow(const std::string& windowTitle) {
+    WindowMatcher byTitle, byClass;
+    byTitle.Add(MatchField::Title, windowTitle);
+    byClass.Add(MatchField::Class, windowTitle, MatchMode::Exact);
+    return Focus(Windows(byTitle).empty() ? byClass : byTitle);
+}
+
+sol::table WindowManager::LuaWindows(sol::object filter, sol::this_state ts) {
+    sol::state_view lua(ts);
+    auto found = Windows(ParseFilter(filter));
+    sol::table list = lua.create_table((int)found.size(), 0);
+    for (size_t i = 0; i < found.size(); ++i) {
+        const auto& window = found[i];
+        list[i + 1] = lua.create_table_with("handle", (lua_Integer)window.handle, "title", window.title,
+                                            "class", window.className, "process", window.processName, "pid", window.pid);
+    }
+    return list;
+}
+
+bool WindowManager::LuaFocus(sol::object target) {
+    if (target.is<std::string>()) return SetFocusToWindow(target.as<std::string>());
+    return Focus(ParseFilter(target));
+}
@@ -1,30 +1,78 @@
 #pragma once
-#include <windows.h>
+#include <sol/sol.hpp>
 #include <string>
-#include <iostream>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include "../platform/WindowProvider.hpp"
+#include "../utils/WindowMatcher.hpp"
+#include "../utils/WindowIndex.hpp"
 
 // Window management and focus control
 // Provides functionality to find, activate, and manage application windows
-// using Windows API functions
+// through the platform WindowProvider. Window lookups are answered from a
+// WindowIndex kept current by window notifications, not by searching the OS
 struct WindowManager {
+    static inline std::unique_ptr<WindowProvider> provider = CreateDefaultWindowProvider(); // OS window backend
+    static inline WindowIndex index;                            // Visible top-level windows, topmost first
+
+    // Start tracking windows
+    // Must be called on the MessageLoop thread; seeds the cached context and
+    // the window index and subscribes to the window notifications that keep
+    // them current
+    static void Attach();
+
+    // Get a snapshot of the currently active window
+    // Returns: Cached title, class and process of the foreground window
+    // Served from the cache maintained by foreground-change notifications,
+    // so it costs no system calls. Read it once per event and reuse it.
+    static std::shared_ptr<const WindowInfo> ActiveWindow();
+
     // Get title of currently active window
     // Returns: Window title as string
     // Retrieves the title of the foreground window (window with user focus)
     // Returns empty string if no window is active or title cannot be retrieved
-    // Uses GetForegroundWindow() and GetWindowTextA()
+    // Served from the cached context, see ActiveWindow()
     // Maximum title length is 255 characters
     static std::string GetActiveWindowTitle();
 
+    // Compile a Lua window filter into a matcher
+    // filter: nil (global), a string (title substring) or a table
+    //         { title = ..., class = ..., process = ..., match = "substring" | "exact" | "wildcard" | "regex" }
+    // Returns: Matcher evaluated against ActiveWindow() snapshots
+    static WindowMatcher ParseFilter(const sol::object& filter);
+
+    // Find windows
+    // matcher: Window filter; a global matcher lists every window
+    // Returns: Matching windows, topmost first
+    // Served from the index once Attach() has run; before that (while the
+    // MessageLoop thread starts up) the provider is enumerated directly
+    static std::vector<WindowInfo> Windows(const WindowMatcher& matcher);
+
+    // Bring the topmost matching window to the foreground
+    // Restores the window if it is minimized
+    // Returns: true if a window matched and was activated
+    // WARNING: Windows refuses foreground changes unless the calling process
+    // received the last input event, so this may fail outside hotkey callbacks
+    static bool Focus(const WindowMatcher& matcher);
+
     // Bring window to foreground and give it focus
-    // windowTitle: Window title or class name to find
-    // Searches for a window with the specified title or class name and
-    // attempts to bring it to the foreground. Tries two search methods:
-    // 1. By window title (caption)
-    // 2. By window class name
-    // Uses FindWindow() with NULL class name, then with NULL window name
-    // Shows window with SW_RESTORE if minimized
-    // May fail due to Windows security restrictions on foreground changes
-    // WARNING: Some applications block foreground window changes for security
-    // WARNING: UWP/Store apps may not be accessible with this method
-    static void SetFocusToWindow(std::string windowTitle);
-};
\ No newline at end of file
+    // windowTitle: Part of the window title, or an exact window class name
+    // Tries the title first and falls back to the class name
+    static bool SetFocusToWindow(const std::string& windowTitle);
+
+    // Lua binding: windows([filter]) -> { {handle, title, class, process, pid}, ... }
+    static sol::table LuaWindows(sol::object filter, sol::this_state ts);
+
+    // Lua binding: focus(title | filter) -> boolean
+    static bool LuaFocus(sol::object target);
+
+private:
+    static void Update(const WindowInfo& window);
+    static void OnEvent(const WindowEvent& event);
+
+    static inline std::shared_ptr<const WindowInfo> active = std::make_shared<const WindowInfo>();
+    static inline std::mutex activeMutex;
+    static inline std::atomic<bool> attached = false;           // index is live
+};
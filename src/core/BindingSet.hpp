@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "../core/HotkeyManager.hpp"
+#include "../api/TimerManager.hpp"
+#include "../core/InputHooks.hpp"
+#include "../core/Hotstrings.hpp"
+#include "../core/ScriptEvents.hpp"
+#include "../core/Macro.hpp"
+#include "../core/InputRecorder.hpp"
+
+// Bindings and timers collected from a script that is still loading
+// While a new Lua state runs its top-level code, bind()/set_interval()/
+// set_timeout()/on_key_down()/on_key_up()/hotstring()/on()/emit() on that thread,
+// as well as threaded macros and replays, are redirected into a staging set instead of
+// going live. Once the script has loaded successfully, the set is swapped in
+// on the MessageLoop thread in a single step (HotkeyManager::Swap), so the old
+// version keeps handling input until the very last moment. Only the bindings
+// of that one script are replaced; other scripts are not touched
+struct BindingSet {
+    std::vector<HotkeyRequest> hotkeys;             // Staged hotkey bindings, in call order
+    std::vector<std::pair<int, TimerData>> timers;  // Staged timers by handle
+    std::vector<KeyBinding> keys;                   // Staged key handlers, in call order
+    std::vector<HotstringData> hotstrings;          // Staged hotstrings, in call order
+    std::vector<ScriptHandler> handlers;            // Staged event handlers, in call order
+    std::vector<ScriptEmit> emits;                  // Events emitted while loading, sent after the swap
+    std::vector<std::shared_ptr<MacroRun>> macros;  // Threaded macros started while loading, launched after the swap
+    std::vector<std::shared_ptr<ReplayRun>> replays; // Replays started while loading, launched after the swap
+    std::string script;                             // Top-level script the set replaces the bindings of
+    bool swapped = false;                           // Set by the MessageLoop once the set is live; guarded by HotkeyManager::swapMutex
+
+    // Staging set for bindings made on the calling thread, or nullptr to bind live
+    static inline thread_local BindingSet* staging = nullptr;
+};
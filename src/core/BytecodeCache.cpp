@@ -0,0 +1,171 @@
+#include "../core/BytecodeCache.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    std::atomic<uint64_t> tempCounter = 0;   // Makes temporary file names unique within the process
+
+    long ProcessId() {
+#ifdef _WIN32
+        return (long)_getpid();
+#else
+        return (long)getpid();
+#endif
+    }
+
+    bool ReadFile(const std::string& path, std::string& out) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    int Writer(lua_State*, const void* data, size_t size, void* userdata) {
+        auto* buffer = static_cast<std::string*>(userdata);
+        buffer->append(static_cast<const char*>(data), size);
+        return 0;
+    }
+}
+
+int BytecodeCache::Load(lua_State* L, const std::string& path) {
+    std::string source;
+    if (!ReadFile(path, source)) {
+        lua_pushstring(L, ("cannot open " + path).c_str());
+        return LUA_ERRFILE;
+    }
+
+    std::string chunkName = "@" + path;
+    Header header;
+    std::memcpy(header.magic, "MKBC", 4);
+    header.luaVersion = LUA_VERSION_NUM;
+    header.sourceHash = Hash(source.data(), source.size());
+    header.sourceSize = source.size();
+
+    std::string cachePath = CachePath(path);
+    if (enabled) {
+        std::string cached;
+        if (ReadFile(cachePath, cached) && cached.size() > sizeof(Header) &&
+            std::memcmp(cached.data(), &header, sizeof(Header)) == 0) {
+            const char* chunk = cached.data() + sizeof(Header);
+            if (luaL_loadbufferx(L, chunk, cached.size() - sizeof(Header), chunkName.c_str(), "b") == LUA_OK) {
+                return LUA_OK;
+            }
+            lua_pop(L, 1);  // Corrupt or foreign bytecode; recompile below
+        }
+    }
+
+    // Skip a leading #! line like luaL_loadfile does
+    size_t offset = 0;
+    if (source.compare(0, 1, "#") == 0) {
+        offset = source.find('\n');
+        if (offset == std::string::npos) offset = source.size();
+    }
+
+    int status = luaL_loadbufferx(L, source.data() + offset, source.size() - offset, chunkName.c_str(), "t");
+    if (status == LUA_OK && enabled) Store(L, cachePath, header);
+    return status;
+}
+
+void BytecodeCache::ScriptFile(sol::state& lua, const std::string& path) {
+    lua_State* L = lua.lua_state();
+    if (Load(L, path) != LUA_OK) {
+        std::string message = lua_tostring(L, -1);
+        lua_pop(L, 1);
+        throw sol::error(message);
+    }
+
+    sol::protected_function chunk(L, -1);
+    lua_pop(L, 1);
+    sol::protected_function_result result = chunk();
+    if (!result.valid()) {
+        sol::error err = result;
+        throw err;
+    }
+}
+
+void BytecodeCache::InstallSearcher(sol::state& lua) {
+    sol::table searchers = lua["package"]["searchers"];
+    lua_State* L = lua.lua_state();
+
+    // Shift entries 2..n up by one and put ours at 2, after the preload searcher
+    searchers.push();
+    int n = (int)lua_rawlen(L, -1);
+    for (int i = n; i >= 2; --i) {
+        lua_rawgeti(L, -1, i);
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_pushcfunction(L, &BytecodeCache::Searcher);
+    lua_rawseti(L, -2, 2);
+    lua_pop(L, 1);
+}
+
+uint64_t BytecodeCache::Hash(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string BytecodeCache::CachePath(const std::string& path) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.luac", (unsigned long long)Hash(path.data(), path.size()));
+    return directory + "/" + name;
+}
+
+void BytecodeCache::Store(lua_State* L, const std::string& cachePath, const Header& header) {
+    std::string data(reinterpret_cast<const char*>(&header), sizeof(Header));
+    if (lua_dump(L, Writer, &data, 0) != 0) return;
+
+    // Write to a temporary file and rename, so readers never see a partial cache
+    // Workers requiring the same module (and other MoonKey processes) each
+    // get a temporary file of their own
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    std::string temp = cachePath + "." + std::to_string(ProcessId()) + "." +
+                       std::to_string(tempCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+    bool written;
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        written = file.write(data.data(), data.size()) && file.flush();
+    }
+    if (!written) {
+        std::filesystem::remove(temp, ec);
+        return;
+    }
+    std::filesystem::rename(temp, cachePath, ec);
+    if (ec) std::filesystem::remove(temp, ec);
+}
+
+int BytecodeCache::Searcher(lua_State* L) {
+    const char* name = luaL_checkstring(L, 1);
+
+    // package.searchpath(name, package.path)
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchpath");
+    lua_pushstring(L, name);
+    lua_getfield(L, -3, "path");
+    lua_call(L, 2, 2);
+    if (lua_isnil(L, -2)) {
+        return 1;  // Error message listing the tried paths
+    }
+
+    std::string path = lua_tostring(L, -2);
+    lua_settop(L, 1);
+    if (Load(L, path) != LUA_OK) {
+        return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s", name, path.c_str(), lua_tostring(L, -1));
+    }
+    lua_pushstring(L, path.c_str());
+    return 2;
+}
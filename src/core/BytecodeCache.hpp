@@ -0,0 +1,48 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <cstdint>
+#include <string>
+
+// On-disk cache of precompiled Lua chunks
+// Each script gets one cache file (named after its path) holding the chunk
+// produced by lua_dump plus a header with the Lua version and a hash of the
+// source it was compiled from. A load reads the source, and if the header
+// still matches, loads the dumped chunk instead of parsing the source again.
+// Any mismatch or corrupt file falls back to compiling the source and
+// rewriting the cache. Both main.lua and modules found through `require`
+// go through the cache.
+struct BytecodeCache {
+    // Cache location; kept outside the watched scripts directory so writing
+    // the cache does not trigger a reload
+    static inline std::string directory = ".moonkey-cache";
+
+    // Set to false to always compile from source
+    static inline bool enabled = true;
+
+    // Loads a script as a chunk, like luaL_loadfile
+    // L: Lua state; on success the chunk is pushed, on failure the error message
+    // path: Script file
+    // Returns: LUA_OK or a Lua error status
+    static int Load(lua_State* L, const std::string& path);
+
+    // Loads and runs a script, like sol::state::script_file
+    // Throws sol::error if the script fails to compile or run
+    static void ScriptFile(sol::state& lua, const std::string& path);
+
+    // Adds a package searcher that loads modules through the cache
+    // Inserted ahead of the standard Lua file searcher
+    static void InstallSearcher(sol::state& lua);
+
+private:
+    struct Header {
+        char magic[4];            // "MKBC"
+        uint32_t luaVersion;      // LUA_VERSION_NUM the chunk was dumped with
+        uint64_t sourceHash;      // FNV-1a of the source text
+        uint64_t sourceSize;
+    };
+
+    static uint64_t Hash(const char* data, size_t size);
+    static std::string CachePath(const std::string& path);
+    static void Store(lua_State* L, const std::string& cachePath, const Header& header);
+    static int Searcher(lua_State* L);
+};
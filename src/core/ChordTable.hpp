@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "../platform/WindowProvider.hpp"
+
+// Dispatch table for hotkeys keyed by chord (modifiers + virtual key)
+// A dense 4096-entry index maps every (ALT|CTRL|SHIFT|WIN, vk) pair to a slot,
+// so lookup is one array read. Each chord holds an ordered list of handlers:
+// the first context-scoped handler whose window filter matches wins, and the
+// first global handler is the fallback.
+// Handler must expose a `context` member with IsGlobal() and Matches(WindowInfo).
+template <typename Handler>
+class ChordTable {
+public:
+    static constexpr int ModMask = 0xF;     // ALT, CTRL, SHIFT, WIN
+    static constexpr int Size = 16 * 256;
+
+    struct Chord {
+        int mods = 0;
+        int vk = 0;
+        bool registered = false;            // Chord is registered with the OS
+        std::vector<Handler> scoped;        // Window-scoped handlers, registration order
+        std::vector<Handler> global;        // Global handlers, first one is the fallback
+    };
+
+    ChordTable() { index.fill(Empty); }
+
+    // Chord key for a modifier/vk pair; also used as the OS hotkey ID
+    // Flags outside ModMask (e.g. MOD_NOREPEAT) are ignored
+    static int Key(int mods, int vk) { return ((mods & ModMask) << 8) | (vk & 0xFF); }
+
+    // Appends a handler to its chord
+    // Returns the chord so the caller can register it with the OS
+    Chord& Add(int mods, int vk, Handler handler) {
+        Chord& chord = Ensure(Key(mods, vk), mods & ModMask, vk & 0xFF);
+        (handler.context.IsGlobal() ? chord.global : chord.scoped).push_back(std::move(handler));
+        return chord;
+    }
+
+    // Finds the chord for a key; nullptr if nothing is bound
+    Chord* Find(int key) {
+        if (key < 0 || key >= Size || index[key] == Empty) return nullptr;
+        return &chords[index[key]];
+    }
+
+    // Picks the handler for a chord press
+    // active: Returns the active window snapshot; only called when the
+    //         chord has window-scoped handlers
+    // Returns nullptr if no handler applies
+    template <typename ActiveWindow>
+    const Handler* Resolve(int key, ActiveWindow&& active) {
+        Chord* chord = Find(key);
+        if (!chord) return nullptr;
+        if (!chord->scoped.empty()) {
+            const WindowInfo& window = active();
+            for (const auto& handler : chord->scoped) {
+                if (handler.context.Matches(window)) return &handler;
+            }
+        }
+        return chord->global.empty() ? nullptr : &chord->global.front();
+    }
+
+    // Removes every handler for which pred(handler) is true
+    // Returns: Keys of chords left without handlers; they stay in the table
+    //          until Remove() so the caller can release the OS registration
+    template <typename Pred>
+    std::vector<int> RemoveHandlers(Pred&& pred) {
+        std::vector<int> emptied;
+        for (auto& chord : chords) {
+            size_t before = chord.scoped.size() + chord.global.size();
+            std::erase_if(chord.scoped, pred);
+            std::erase_if(chord.global, pred);
+            if (before > 0 && chord.scoped.empty() && chord.global.empty()) emptied.push_back(Key(chord.mods, chord.vk));
+        }
+        return emptied;
+    }
+
+    // Removes a chord and all its handlers
+    void Remove(int key) {
+        if (key < 0 || key >= Size || index[key] == Empty) return;
+        uint16_t slot = index[key];
+        index[key] = Empty;
+        if (slot != chords.size() - 1) {
+            chords[slot] = std::move(chords.back());
+            index[Key(chords[slot].mods, chords[slot].vk)] = slot;
+        }
+        chords.pop_back();
+    }
+
+    // All bound chords
+    std::vector<Chord>& All() { return chords; }
+
+    // Total number of handlers across chords
+    size_t HandlerCount() const {
+        size_t count = 0;
+        for (const auto& chord : chords) count += chord.scoped.size() + chord.global.size();
+        return count;
+    }
+
+    void Clear() {
+        index.fill(Empty);
+        chords.clear();
+    }
+
+private:
+    static constexpr uint16_t Empty = 0xFFFF;
+
+    Chord& Ensure(int key, int mods, int vk) {
+        if (index[key] == Empty) {
+            index[key] = (uint16_t)chords.size();
+            Chord& chord = chords.emplace_back();
+            chord.mods = mods;
+            chord.vk = vk;
+        }
+        return chords[index[key]];
+    }
+
+    std::array<uint16_t, Size> index;   // Chord key -> slot in chords
+    std::vector<Chord> chords;          // Densely packed bound chords
+};
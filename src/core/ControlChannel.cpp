@@ -0,0 +1,136 @@
+#include "../core/ControlChannel.hpp"
+#include "../core/CoroutineScheduler.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../core/ScriptModules.hpp"
+#include "../core/ScriptState.hpp"
+#include "../core/Stats.hpp"
+#include "../utils/Log.hpp"
+#include <thread>
+
+using ControlProtocol::Op;
+using ControlProtocol::Status;
+
+void ControlChannel::Start(EventDispatcher& events) {
+    dispatcher = &events;
+    std::thread([] {
+        std::string error;
+        server->Run(endpoint, { &ControlChannel::OnData, &ControlChannel::OnClosed }, error);
+        Log::Err() << "[Error] Control channel unavailable: " << error;
+    }).detach();
+}
+
+void ControlChannel::Expose(const std::string& name, ScriptFunction fn, std::string owner) {
+    const ScriptState* state = &ScriptState::From(fn->lua_state());
+    std::lock_guard<std::mutex> lock(actionsMutex);
+    actions[name] = { std::move(fn), std::move(owner), state };
+}
+
+void ControlChannel::CancelState(const ScriptState& state) {
+    std::lock_guard<std::mutex> lock(actionsMutex);
+    std::erase_if(actions, [&](const auto& entry) { return entry.second.state == &state; });
+}
+
+void ControlChannel::Bind(sol::state& lua) {
+    lua.set_function("expose", [](const std::string& name, sol::function fn, sol::this_state ts) {
+        if (name.empty()) throw sol::error("expose: action name must not be empty");
+        Expose(name, ScriptHost::Share(fn), ScriptModules::CurrentOwner(ts));
+    });
+}
+
+void ControlChannel::OnData(uint64_t client, const char* data, size_t size) {
+    std::string& buffer = buffers[client];
+    buffer.append(data, size);
+
+    // Every complete frame of the read is handled before the next read
+    size_t offset = 0;
+    while (true) {
+        ControlProtocol::Message message;
+        size_t length = ControlProtocol::Parse(std::string_view(buffer).substr(offset), message);
+        if (length == 0) break;
+        if (length == SIZE_MAX) {
+            Log::Err() << "[Error] Control channel: malformed frame, dropping client";
+            server->Close(client);
+            buffer.clear();
+            return;
+        }
+        Handle(client, message);
+        offset += length;
+    }
+    buffer.erase(0, offset);
+}
+
+void ControlChannel::OnClosed(uint64_t client) {
+    buffers.erase(client);
+}
+
+void ControlChannel::Handle(uint64_t client, const ControlProtocol::Message& message) {
+    auto pending = std::make_shared<Pending>(client, message.id);
+
+    switch ((Op)message.code) {
+    case Op::Invoke: {
+        auto parts = ControlProtocol::Split(message.body);
+        ScriptFunction fn;
+        {
+            std::lock_guard<std::mutex> lock(actionsMutex);
+            auto it = actions.find(std::string(parts[0]));
+            if (it != actions.end()) fn = it->second.fn;
+        }
+        if (!fn) {
+            pending->Answer(Status::Error, "unknown action: " + std::string(parts[0]));
+            return;
+        }
+        ScriptArgs args;
+        args.reserve(parts.size() - 1);
+        for (size_t i = 1; i < parts.size(); ++i) args.push_back(ScriptValue{ std::string(parts[i]) });
+        // Answered once the action has run, or reached its first wait()
+        ScriptHost::Run(fn, [fn, args = std::move(args), pending] {
+            CoroutineScheduler::SpawnWith(*fn, args);
+            pending->Answer(Status::Ok, {});
+        });
+        return;
+    }
+    case Op::Stats:
+        pending->Answer(Status::Ok, Stats::Snapshot());
+        return;
+    case Op::Reload:
+        dispatcher->publish(ReloadRequested, std::vector<std::string>{ std::string(message.body) });
+        pending->Answer(Status::Ok, {});
+        return;
+    case Op::List:
+        // The hotkey table belongs to the MessageLoop thread
+        HotkeyManager::Post([pending] {
+            std::string out;
+            for (const auto& chord : HotkeyManager::hotkeys.All()) {
+                for (const auto* handlers : { &chord.scoped, &chord.global }) {
+                    for (const auto& handler : *handlers) {
+                        out += "hotkey\t" + std::to_string(chord.mods) + "\t" + std::to_string(chord.vk) + "\t" +
+                               handler.owner + "\t" + (handler.probe ? handler.probe->name : std::string()) + "\n";
+                    }
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(actionsMutex);
+                for (const auto& [name, action] : actions) out += "action\t" + name + "\t" + action.owner + "\n";
+            }
+            pending->Answer(Status::Ok, out);
+        });
+        return;
+    }
+    pending->Answer(Status::Error, "unknown request " + std::to_string(message.code));
+}
+
+void ControlChannel::Reply(uint64_t client, uint32_t id, Status status, std::string_view body) {
+    std::string frame;
+    frame.reserve(ControlProtocol::LengthSize + ControlProtocol::HeaderSize + body.size());
+    ControlProtocol::Append(frame, id, (uint8_t)status, body);
+    server->Send(client, std::move(frame));
+}
+
+void ControlChannel::Pending::Answer(Status status, std::string_view body) {
+    answered = true;
+    Reply(client, id, status, body);
+}
+
+ControlChannel::Pending::~Pending() {
+    if (!answered) Reply(client, id, Status::Error, "script unloaded");
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../core/ControlProtocol.hpp"
+#include "../core/ScriptHost.hpp"
+#include "../platform/ControlServer.hpp"
+#include "../utils/EventDispatcher.hpp"
+
+// Lets other local programs drive MoonKey (launchers, Stream Deck bridges,
+// test harnesses, moonkey-ctl)
+// Clients connect to the endpoint (ControlServer) and send ControlProtocol
+// frames. One I/O thread serves every client; an invoked action is queued
+// straight onto its script's worker, as if its hotkey had fired, without
+// going through the OS or the MessageLoop. Requests are handled as they
+// arrive, so a client may pipeline them.
+// Lua:
+//   expose("mute", function(...) send(KEY.F13) end)   -- moonkey-ctl invoke mute
+struct ControlChannel {
+    // Script names (empty for every script) a client asked to reload; handled by main
+    static inline const Event<std::vector<std::string>> ReloadRequested{ "OnControlReload" };
+
+    static inline std::unique_ptr<ControlServer> server = CreateDefaultControlServer(); // OS transport
+    static inline std::string endpoint = ControlProtocol::DefaultEndpoint();
+
+    // Starts serving on a thread of its own
+    // dispatcher: Receives ReloadRequested; must outlive the channel
+    static void Start(EventDispatcher& dispatcher);
+
+    // Makes fn invokable under name, replacing an earlier action of that name
+    static void Expose(const std::string& name, ScriptFunction fn, std::string owner);
+
+    // Drops the actions of a state
+    // Called on the state's worker when it is retired
+    static void CancelState(const ScriptState& state);
+
+    // Registers expose
+    static void Bind(sol::state& lua);
+
+private:
+    struct Action {
+        ScriptFunction fn;
+        std::string owner;        // Script module that exposed it
+        const ScriptState* state; // State fn lives in
+    };
+
+    // Answers one request exactly once; a request dropped before it was
+    // answered (its script went away first) gets an error reply
+    struct Pending {
+        Pending(uint64_t client, uint32_t id) : client(client), id(id) {}
+        uint64_t client;
+        uint32_t id;
+        bool answered = false;
+        void Answer(ControlProtocol::Status status, std::string_view body);
+        ~Pending();
+    };
+
+    // Server callbacks; I/O thread
+    static void OnData(uint64_t client, const char* data, size_t size);
+    static void OnClosed(uint64_t client);
+
+    // Handles one parsed request; I/O thread
+    static void Handle(uint64_t client, const ControlProtocol::Message& message);
+
+    static void Reply(uint64_t client, uint32_t id, ControlProtocol::Status status, std::string_view body);
+
+    static inline EventDispatcher* dispatcher = nullptr;
+    static inline std::unordered_map<uint64_t, std::string> buffers;   // Unparsed bytes per client; I/O thread only
+    static inline std::mutex actionsMutex;
+    static inline std::unordered_map<std::string, Action> actions;     // Guarded by actionsMutex
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Wire format of the control channel, shared by ControlChannel and moonkey-ctl
+// Every message is a frame: a 4-byte little-endian payload length, then the
+// payload. A payload starts with a 4-byte little-endian request ID and a
+// 1-byte code; the rest is the body. Requests carry an Op as their code,
+// replies a Status and the ID of the request they answer. A client may send
+// any number of requests without waiting for replies; replies can arrive out
+// of order, as actions of different scripts run on different workers.
+namespace ControlProtocol {
+    enum class Op : uint8_t {
+        Invoke = 1,   // Body: action name, each argument preceded by '\0'; reply body is empty
+        Stats = 2,    // Body: empty; reply body is a Stats::Snapshot() JSON line
+        Reload = 3,   // Body: script name, or empty for every script
+        List = 4,     // Body: empty; reply body has one tab-separated line per hotkey and action
+    };
+
+    enum class Status : uint8_t { Ok = 0, Error = 1 };  // Error replies carry the message as body
+
+    constexpr size_t LengthSize = 4;            // Frame length prefix
+    constexpr size_t HeaderSize = 5;            // Request ID and code at the start of a payload
+    constexpr size_t MaxPayload = 1 << 20;      // Larger frames are a protocol error
+
+    struct Message {
+        uint32_t id = 0;
+        uint8_t code = 0;
+        std::string_view body;    // Points into the parsed buffer
+    };
+
+    inline void PutU32(std::string& out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) out += (char)((value >> (8 * i)) & 0xFF);
+    }
+
+    inline uint32_t GetU32(const char* data) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= (uint32_t)(unsigned char)data[i] << (8 * i);
+        return value;
+    }
+
+    // Appends one frame to out
+    inline void Append(std::string& out, uint32_t id, uint8_t code, std::string_view body) {
+        PutU32(out, (uint32_t)(HeaderSize + body.size()));
+        PutU32(out, id);
+        out += (char)code;
+        out.append(body);
+    }
+
+    // Parses the frame at the front of buffer
+    // Returns the bytes it occupies, 0 if it is not complete yet, or
+    // SIZE_MAX if it is malformed
+    inline size_t Parse(std::string_view buffer, Message& message) {
+        if (buffer.size() < LengthSize) return 0;
+        uint32_t length = GetU32(buffer.data());
+        if (length < HeaderSize || length > MaxPayload) return SIZE_MAX;
+        if (buffer.size() < LengthSize + length) return 0;
+        message.id = GetU32(buffer.data() + LengthSize);
+        message.code = (uint8_t)buffer[LengthSize + 4];
+        message.body = buffer.substr(LengthSize + HeaderSize, length - HeaderSize);
+        return LengthSize + length;
+    }
+
+    // Splits an Invoke body into the action name followed by its arguments
+    inline std::vector<std::string_view> Split(std::string_view body) {
+        std::vector<std::string_view> parts;
+        size_t start = 0;
+        while (true) {
+            size_t end = body.find('\0', start);
+            parts.push_back(body.substr(start, end - start));
+            if (end == std::string_view::npos) return parts;
+            start = end + 1;
+        }
+    }
+
+    // Endpoint used unless MOONKEY_CONTROL names another one
+    // A named pipe on Windows; a Unix socket in the user's runtime directory elsewhere
+    inline std::string DefaultEndpoint() {
+        if (const char* endpoint = std::getenv("MOONKEY_CONTROL")) return endpoint;
+#ifdef _WIN32
+        return "\\\\.\\pipe\\moonkey";
+#else
+        if (const char* runtime = std::getenv("XDG_RUNTIME_DIR")) return std::string(runtime) + "/moonkey.sock";
+        return "/tmp/moonkey-" + std::to_string(getuid()) + ".sock";
+#endif
+    }
+}
@@ -0,0 +1,90 @@
+#include "../core/CoroutineScheduler.hpp"
+#include "../core/PrecisionClock.hpp"
+#include "../core/ScriptState.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <thread>
+
+void CoroutineScheduler::Update() {
+    Update(Now());
+}
+
+void CoroutineScheduler::Update(Clock::time_point now) {
+    while (!waiting.empty() && waiting.front().deadline <= now) {
+        std::pop_heap(waiting.begin(), waiting.end(), std::greater<>());
+        Entry entry = std::move(waiting.back());
+        waiting.pop_back();
+        if (entry.timed) PrecisionClock::Record(entry.deadline, now);
+        Resume(std::move(entry), 0);
+    }
+}
+
+std::optional<CoroutineScheduler::Clock::time_point> CoroutineScheduler::NextDeadline() {
+    if (waiting.empty()) return std::nullopt;
+    return waiting.front().deadline;
+}
+
+void CoroutineScheduler::CancelAll() {
+    for (const auto& entry : waiting) {
+        luaL_unref(entry.owner, LUA_REGISTRYINDEX, entry.ref);
+    }
+    waiting.clear();
+}
+
+void CoroutineScheduler::CancelState(const ScriptState& state) {
+    std::erase_if(waiting, [&](const Entry& entry) {
+        if (&ScriptState::From(entry.owner) != &state) return false;
+        luaL_unref(entry.owner, LUA_REGISTRYINDEX, entry.ref);
+        return true;
+    });
+    std::make_heap(waiting.begin(), waiting.end(), std::greater<>());
+}
+
+int CoroutineScheduler::Wait(lua_State* L, Clock::duration delay) {
+    if (L != running || !lua_isyieldable(L)) {
+        PrecisionClock::SleepUntil(Clock::now() + delay);
+        return 0;
+    }
+    requested = Now() + delay;
+    return lua_yield(L, 0);
+}
+
+int CoroutineScheduler::LuaWait(lua_State* L) {
+    double seconds = luaL_checknumber(L, 1);
+    return Wait(L, std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)));
+}
+
+int CoroutineScheduler::LuaSleep(lua_State* L) {
+    double ms = luaL_checknumber(L, 1);
+    return Wait(L, std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms)));
+}
+
+void CoroutineScheduler::Resume(Entry entry, int nargs) {
+    lua_State* previous = running;
+    running = entry.thread;
+    requested = Clock::time_point::min();
+    auto begin = entry.probe ? Clock::now() : Clock::time_point();
+    int nresults = 0;
+    int status = lua_resume(entry.thread, entry.owner, nargs, &nresults);
+    running = previous;
+    if (entry.probe) entry.busy += Clock::now() - begin;
+
+    if (status == LUA_YIELD) {
+        lua_pop(entry.thread, nresults);
+        // A plain coroutine.yield() resumes on the next loop iteration
+        entry.timed = requested != Clock::time_point::min();
+        entry.deadline = entry.timed ? requested : Now();
+        entry.seq = nextSeq++;
+        waiting.push_back(std::move(entry));
+        std::push_heap(waiting.begin(), waiting.end(), std::greater<>());
+        return;
+    }
+
+    if (status != LUA_OK) {
+        const char* message = lua_tostring(entry.thread, -1);
+        luaL_traceback(entry.thread, entry.thread, message ? message : "(error object is not a string)", 0);
+        Log::Err() << "[Lua Error] " << lua_tostring(entry.thread, -1);
+    }
+    if (entry.probe) entry.probe->Record(entry.busy, status != LUA_OK);
+    luaL_unref(entry.owner, LUA_REGISTRYINDEX, entry.ref);
+}
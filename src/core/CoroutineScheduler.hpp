@@ -0,0 +1,129 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "../core/Stats.hpp"
+#include "../core/Profiler.hpp"
+#include "../core/ScriptValue.hpp"
+
+struct ScriptState;
+
+// Runs Lua callbacks as coroutines so wait()/sleep() do not block the MessageLoop
+// Every hotkey and timer callback is started with Spawn(). When the callback
+// calls wait()/sleep() the coroutine yields back to the loop, which resumes
+// it once its deadline passes. Many waiting macros can interleave on one
+// thread this way. Every thread that runs Lua (the script workers) has a
+// scheduler of its own; a coroutine is always resumed where it started.
+struct CoroutineScheduler {
+    using Clock = std::chrono::steady_clock;
+
+    // Starts fn as a new coroutine and runs it until it finishes or yields
+    // fn: Lua function to run
+    // args: Arguments passed to fn
+    // Errors are logged with a traceback and do not propagate
+    template <typename... Args>
+    static void Spawn(const sol::function& fn, Args&&... args) {
+        SpawnProbed(nullptr, fn, std::forward<Args>(args)...);
+    }
+
+    // Same as Spawn(), charging the callback's run time to probe
+    // The time the coroutine spends suspended is not counted; the call is
+    // recorded when the callback returns or fails
+    template <typename... Args>
+    static void SpawnProbed(std::shared_ptr<Probe> probe, const sol::function& fn, Args&&... args) {
+        lua_State* L = fn.lua_state();
+        lua_State* co = lua_newthread(L);
+        int ref = luaL_ref(L, LUA_REGISTRYINDEX);   // Keeps the thread alive while suspended
+        Profiler::Attach(co);
+        fn.push(co);
+        (sol::stack::push(co, std::forward<Args>(args)), ...);
+        Resume({ {}, 0, L, co, ref, false, std::move(probe) }, (int)sizeof...(Args));
+    }
+
+    // Starts fn as a new coroutine with copied Lua values as its arguments
+    static void SpawnWith(const sol::function& fn, const ScriptArgs& args) {
+        lua_State* L = fn.lua_state();
+        lua_State* co = lua_newthread(L);
+        int ref = luaL_ref(L, LUA_REGISTRYINDEX);
+        Profiler::Attach(co);
+        fn.push(co);
+        for (const auto& arg : args) arg.Push(co);
+        Resume({ {}, 0, L, co, ref }, (int)args.size());
+    }
+
+    // Resumes every coroutine whose wait deadline has passed
+    static void Update();
+
+    // Same as Update() against an explicit clock reading
+    static void Update(Clock::time_point now);
+
+    // Get the earliest wait deadline
+    // Returns nullopt when no coroutine is waiting
+    static std::optional<Clock::time_point> NextDeadline();
+
+    // Drops every suspended coroutine of the calling thread without resuming it
+    static void CancelAll();
+
+    // Drops the suspended coroutines of one Lua state
+    // Used when a script is reloaded or unloaded, on the state's worker
+    static void CancelState(const ScriptState& state);
+
+    // Number of suspended coroutines on the calling thread
+    static size_t Pending() { return waiting.size(); }
+
+    // Time wait() deadlines count from on the calling thread
+    // The wall clock unless a VirtualClock is attached to this thread
+    static Clock::time_point Now() { return virtualNow ? *virtualNow : Clock::now(); }
+
+    // Makes Now() read *now on the calling thread; nullptr restores the wall clock
+    static void UseClock(const Clock::time_point* now) { virtualNow = now; }
+
+    // Suspends the calling coroutine for the given delay
+    // L: Calling Lua thread
+    // When L is not a coroutine started by Spawn() (e.g. the top-level
+    // script), it falls back to blocking the calling thread
+    // Returns: lua_CFunction result; use as `return CoroutineScheduler::Wait(L, d);`
+    static int Wait(lua_State* L, Clock::duration delay);
+
+    // Whether L is a coroutine started by Spawn() that can yield right now
+    static bool CanYield(lua_State* L) { return L == running && lua_isyieldable(L); }
+
+    // Suspends a coroutine for delay and continues in k, for C functions that
+    // need to wait more than once (see lua_yieldk)
+    // Only valid when CanYield(L) is true
+    static int YieldFor(lua_State* L, Clock::duration delay, lua_KContext ctx, lua_KFunction k) {
+        requested = Now() + delay;
+        return lua_yieldk(L, 0, ctx, k);
+    }
+
+    // Lua binding: wait(seconds)
+    static int LuaWait(lua_State* L);
+
+    // Lua binding: sleep(milliseconds)
+    static int LuaSleep(lua_State* L);
+
+private:
+    struct Entry {
+        Clock::time_point deadline;
+        unsigned long long seq;       // Keeps FIFO order for equal deadlines
+        lua_State* owner;             // State the thread reference lives in
+        lua_State* thread;            // Suspended coroutine
+        int ref;                      // Registry reference anchoring the thread
+        bool timed = false;           // Suspended by wait()/sleep() rather than a plain yield
+        std::shared_ptr<Probe> probe = nullptr; // Charged with the callback's run time, if any
+        Clock::duration busy{};       // Run time of the resumes so far
+        bool operator>(const Entry& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : seq > other.seq;
+        }
+    };
+
+    static void Resume(Entry entry, int nargs);
+
+    static inline thread_local std::vector<Entry> waiting;    // Min-heap keyed by deadline
+    static inline thread_local unsigned long long nextSeq = 0;
+    static inline thread_local lua_State* running = nullptr;  // Coroutine currently resumed by the scheduler
+    static inline thread_local Clock::time_point requested;   // Deadline requested by the last Wait()
+    static inline thread_local const Clock::time_point* virtualNow = nullptr; // Attached VirtualClock, if any
+};
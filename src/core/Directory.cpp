@@ -1,50 +1,53 @@
 #include "../core/Directory.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
 
-void Directory::DirectoryChangesLoop(winrt::hstring directoryPath, EventDispatcher& eventDispatcher) {
-    HANDLE hDir = CreateFileW(
-        directoryPath.c_str(),
-        FILE_LIST_DIRECTORY,
-        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
-        NULL,
-        OPEN_EXISTING,
-        FILE_FLAG_BACKUP_SEMANTICS,
-        NULL
-    );
-
-    if (hDir == INVALID_HANDLE_VALUE) {
-        std::wcerr << L"[Directory] Failed to open directory: " << directoryPath << std::endl;
+namespace {
+    // Editors touch swap and backup files next to the script; only .lua matters
+    bool IsScript(const std::string& path) {
+        return path.empty() || (path.size() > 4 && path.compare(path.size() - 4, 4, ".lua") == 0);
+    }
+}
+
+void Directory::DirectoryChangesLoop(std::string directoryPath, EventDispatcher& eventDispatcher) {
+    if (!watcher->Open(directoryPath)) {
+        Log::Err() << "[Directory] Failed to open directory: " << directoryPath;
         return;
     }
 
-    alignas(DWORD) BYTE buffer[1024];
-    DWORD bytesReturned;
-
-    std::wcout << L"[Directory] Monitoring: " << directoryPath << std::endl;
-
-    while(true) {
-        if (ReadDirectoryChangesW(
-            hDir,
-            buffer,
-            sizeof(buffer),
-            FALSE,
-            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
-            &bytesReturned,
-            NULL,
-            NULL
-        )) {
-            if (bytesReturned > 0) {
-                std::wcout << L"[Directory] Change detected in " 
-                          << std::wstring(directoryPath) << std::endl;
-                eventDispatcher.dispatch("OnDirectoryChange");
-            }
-        } else {
-            DWORD error = GetLastError();
-            std::wcerr << L"[Directory] Monitoring error: " << error 
-                      << L" for path: " << directoryPath << std::endl;
-            break; 
+    Log::Out() << "[Directory] Monitoring: " << directoryPath;
+
+    using Clock = std::chrono::steady_clock;
+    std::set<std::string> burst;
+    Clock::time_point first, last;
+    std::vector<std::string> changes;
+
+    while (true) {
+        std::optional<std::chrono::milliseconds> timeout;
+        if (!burst.empty()) {
+            auto now = Clock::now();
+            auto remaining = (std::min)(last + debounce, first + maxDelay) - now;
+            timeout = (std::max)(std::chrono::ceil<std::chrono::milliseconds>(remaining), std::chrono::milliseconds(0));
+        }
+
+        changes.clear();
+        if (!watcher->Read(changes, timeout)) break;
+
+        auto now = Clock::now();
+        for (auto& path : changes) {
+            if (!IsScript(path)) continue;
+            if (burst.empty()) first = now;
+            last = now;
+            burst.insert(std::move(path));
+        }
+
+        if (!burst.empty() && (now >= last + debounce || now >= first + maxDelay)) {
+            Log::Out() << "[Directory] Change detected in " << directoryPath
+                      << " (" << burst.size() << " file(s))";
+            eventDispatcher.publish(Changed, std::vector<std::string>(burst.begin(), burst.end()));
+            burst.clear();
         }
     }
-    
-    CloseHandle(hDir);
-    std::wcout << L"[Directory] Stopped monitoring: " << directoryPath << std::endl;
-}
\ No newline at end of file
+
+    Log::Out() << "[Directory] Stopped monitoring: " << directoryPath;
+}
@@ -1,18 +1,32 @@
 #pragma once
 #include <string>
-#include <winrt/Windows.Foundation.h>
-#include <windows.h>
-#include <iostream>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <memory>
 #include "../utils/EventDispatcher.hpp"
+#include "../platform/FileWatcher.hpp"
 
 // Directory monitoring for hot-reload functionality
-// Monitors a directory for file changes using Windows ReadDirectoryChangesW API
-// Triggers reload events when Lua scripts are modified
+// Monitors a directory tree for changes to Lua scripts through a FileWatcher
+// (ReadDirectoryChangesW on Windows, inotify on Linux). Bursts of writes are
+// coalesced over a debounce window and published as one reload event that
+// carries the changed file paths
 struct Directory {
+    static inline std::chrono::milliseconds debounce{ 75 };     // Quiet time before a burst is published
+    static inline std::chrono::milliseconds maxDelay{ 500 };    // Upper bound on how long a burst is held back
+    static inline std::unique_ptr<FileWatcher> watcher = CreateDefaultFileWatcher(); // OS watch backend
+
+    // Published once per coalesced burst with the changed script paths,
+    // relative to the watched directory ('/'-separated). An empty path means
+    // changes were lost and everything should reload
+    static inline const Event<std::vector<std::string>> Changed{ "OnDirectoryChange" };
+
     // Monitor directory for changes
-    // directoryPath: Directory to monitor (wide string)
+    // directoryPath: Directory to monitor, including subdirectories
     // eventDispatcher: Event dispatcher for change notifications
     // Runs in a dedicated thread to monitor file system changes without
-    // blocking the main application thread
-    static void DirectoryChangesLoop(winrt::hstring directoryPath, EventDispatcher& eventDispatcher);
-};
\ No newline at end of file
+    // blocking the main application thread. Publishes Changed to the
+    // dispatcher once per coalesced burst
+    static void DirectoryChangesLoop(std::string directoryPath, EventDispatcher& eventDispatcher);
+};
@@ -1,64 +1,245 @@
 #include "../core/HotkeyManager.hpp"
 #include "../api/TimerManager.hpp"
+#include "../core/BindingSet.hpp"
+#include "../core/ScriptModules.hpp"
+#include "../core/InputHooks.hpp"
+#include "../core/Hotstrings.hpp"
+#include "../core/ScriptEvents.hpp"
+#include "../core/Macro.hpp"
+#include "../core/InputRecorder.hpp"
+#include "../core/PrecisionClock.hpp"
+#include "../core/Screen.hpp"
+#include "../api/InputManager.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
 
 void HotkeyManager::MessageLoop() {
-    MSG msg = { 0 };
-    PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+    events->Attach();
+    WindowManager::Attach();
+    InputHooks::Start();
+    OsEvent event;
 
     while (true) {
+        tick.fetch_add(1, std::memory_order_relaxed);
+        // Anything queued after this point interrupts the spin below
+        woken.store(false, std::memory_order_relaxed);
+        if (shouldSwap) {
+            std::vector<BindingSet*> swaps;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                swaps.swap(pendingSwaps);
+                shouldSwap = false;
+            }
+            for (BindingSet* set : swaps) ApplySwap(*set);
+        }
         if (shouldClear) {
-            for (const auto& [id, _] : hotkeys) {
-                UnregisterHotKey(NULL, id);
+            for (auto& chord : hotkeys.All()) {
+                if (chord.registered) events->UnregisterHotkey(HotkeyId(chord));
+            }
+            hotkeys.Clear();
+            InputHooks::Clear();
+            Hotstrings::Clear();
+            ScriptEvents::Clear();
+            Macro::CancelAll();
+            InputRecorder::CancelAll();
+            {
+                // Posted work belongs to the state being torn down
+                std::lock_guard<std::mutex> lock(queueMutex);
+                tasks.clear();
             }
-            hotkeys.clear();
-            nextId = 1;
             shouldClear = false;
-            std::cout << "[System] Hotkeys cleared in MessageLoop." << std::endl;
+            shouldClear.notify_all();
+            Log::Out() << "[System] Hotkeys cleared in MessageLoop.";
         }
         {
             std::lock_guard<std::mutex> lock(queueMutex);
-            for (auto& req : registrationQueue) {
-                int id = nextId++;
-                if (RegisterHotKey(NULL, id, req.mods | MOD_NOREPEAT, req.vk)) {
-                    hotkeys[id] = { req.cb, req.windowTitle };
-                    std::cout << "[System] Registered ID: " << id << " | Window: " 
-                              << (req.windowTitle.empty() ? "Global" : req.windowTitle) << std::endl;
-                } else {
-                    std::cerr << "[Error] Failed to register hotkey. Error code: " << GetLastError() << std::endl;
+            if (!registrationQueue.empty()) {
+                for (auto& req : registrationQueue) {
+                    if (req.type == HotkeyRequest::Type::UnbindOwner) {
+                        auto emptied = hotkeys.RemoveHandlers([&](const HotKeyData& h) { return h.owner == req.owner; });
+                        for (int key : emptied) {
+                            auto* chord = hotkeys.Find(key);
+                            if (chord->registered) events->UnregisterHotkey(HotkeyId(*chord));
+                            hotkeys.Remove(key);
+                        }
+                        continue;
+                    }
+                    hotkeys.Add(req.mods, req.vk, { req.cb, req.context, req.owner, req.probe });
+                    Log::Out() << "[System] Bound chord: " << req.mods << "+" << req.vk << " | Window: " 
+                              << req.context.Describe();
                 }
+                registrationQueue.clear();
+
+                RegisterPending(hotkeys);
             }
-            registrationQueue.clear();
         }
 
+        std::vector<Task> posted;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            posted.swap(tasks);
+        }
+        for (auto& task : posted) task.run();
+        // Swaps, clears and posted work above only mark hotstrings changed
+        Hotstrings::Flush();
+
         TimerManager::Update();
 
-        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-            if (msg.message == WM_HOTKEY) {
-                int id = (int)msg.wParam;
-                if (hotkeys.count(id)) { 
-                    auto& data = hotkeys[id];
-                    if (data.targetWindow.empty() ) {
-                        data.callback();
-                    } else {
-                        std::string currentTitle = WindowManager::GetActiveWindowTitle();
-                        if (currentTitle.find(data.targetWindow) != std::string::npos) {
-                            data.callback();
-                        }
-                    }
-                }
+        while (events->Poll(event)) {
+            if (event.type == OsEvent::Type::Quit) return;
+            if (event.type == OsEvent::Type::DisplayChange) {
+                InputManager::sink->DisplayChanged();
+                Screen::Invalidate();
+                continue;
+            }
+            if (event.type == OsEvent::Type::Hotkey) {
+                // The active window is resolved at most once per event
+                std::shared_ptr<const WindowInfo> window;
+                const HotKeyData* handler = hotkeys.Resolve(event.id - 1, [&]() -> const WindowInfo& {
+                    window = WindowManager::ActiveWindow();
+                    return *window;
+                });
+                if (!handler) continue;
+                ScriptHost::Run(handler->callback, [fn = handler->callback, probe = handler->probe, observed = event.time] {
+                    Stats::dispatch.Record(std::chrono::steady_clock::now() - observed);
+                    CoroutineScheduler::SpawnProbed(probe, *fn);
+                });
             }
-            if (msg.message == WM_QUIT) return;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        InputHooks::Dispatch();
+        ScriptEvents::Drain();
+
+        // Coroutines and garbage collection live on the script workers, so
+        // only timers bound the wait here
+        auto deadline = TimerManager::NextDeadline();
+        if (!deadline) {
+            events->Wait(std::nullopt);
+            continue;
+        }
+        // Block on the event source until shortly before the deadline, then
+        // spend the last stretch in the precision clock. Input or queued work
+        // ends the spin early: it is handled first and the loop comes back
+        // round for the deadline, so a precise timer never holds up a hotkey
+        auto coarse = *deadline - PrecisionClock::Threshold();
+        if (std::chrono::steady_clock::now() < coarse) {
+            events->Wait(coarse);
+        } else {
+            PrecisionClock::SpinUntil(*deadline, [] { return woken.load(std::memory_order_acquire) || events->Pending(); });
+        }
+    }
+}
+
+void HotkeyManager::Add(int mods, int vk, ScriptFunction cb, WindowMatcher context, std::string owner) {
+    auto probe = Stats::ForBinding(Stats::hotkey, *cb);
+    if (BindingSet::staging) {
+        BindingSet::staging->hotkeys.push_back({ HotkeyRequest::Type::Bind, mods, vk, cb, std::move(context), std::move(owner), std::move(probe) });
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        registrationQueue.push_back({ HotkeyRequest::Type::Bind, mods, vk, cb, std::move(context), std::move(owner), std::move(probe) });
+    }
+    Wake();
+}
+
+void HotkeyManager::RemoveOwner(std::string owner) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        registrationQueue.push_back({ HotkeyRequest::Type::UnbindOwner, 0, 0, nullptr, {}, std::move(owner) });
     }
+    Wake();
 }
 
-void HotkeyManager::Add(int mods, int vk, sol::function cb, std::string windowTitle) {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    registrationQueue.push_back({ mods, vk, cb, windowTitle });
+void HotkeyManager::Post(std::function<void()> task, std::string owner) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        tasks.push_back({ std::move(owner), std::move(task) });
+    }
+    Wake();
 }
 
 void HotkeyManager::Clear() {
     shouldClear = true;
-    while(shouldClear) { std::this_thread::yield(); }
-}
\ No newline at end of file
+    Wake();
+    shouldClear.wait(true);
+}
+
+void HotkeyManager::Swap(BindingSet& set) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pendingSwaps.push_back(&set);
+        shouldSwap = true;
+    }
+    Wake();
+    std::unique_lock<std::mutex> lock(swapMutex);
+    swapDone.wait(lock, [&] { return set.swapped; });
+}
+
+void HotkeyManager::ApplySwap(BindingSet& set) {
+    auto start = std::chrono::steady_clock::now();
+    auto owned = [&](const std::string& owner) { return ScriptModules::BelongsTo(owner, set.script); };
+
+    {
+        // Anything the script still has queued was produced by its previous version
+        std::lock_guard<std::mutex> lock(queueMutex);
+        std::erase_if(registrationQueue, [&](const HotkeyRequest& req) { return owned(req.owner); });
+        std::erase_if(tasks, [&](const Task& task) { return owned(task.owner); });
+    }
+
+    auto emptied = hotkeys.RemoveHandlers([&](const HotKeyData& h) { return owned(h.owner); });
+    for (auto& req : set.hotkeys) {
+        hotkeys.Add(req.mods, req.vk, { req.cb, req.context, req.owner, req.probe });
+    }
+
+    // Chords that stay bound keep their OS registration
+    for (int key : emptied) {
+        auto* chord = hotkeys.Find(key);
+        if (!chord->scoped.empty() || !chord->global.empty()) continue;
+        if (chord->registered) events->UnregisterHotkey(HotkeyId(*chord));
+        hotkeys.Remove(key);
+    }
+    RegisterPending(hotkeys);
+
+    TimerManager::Replace(set.script, std::move(set.timers));
+    InputHooks::Replace(set.script, std::move(set.keys));
+    Hotstrings::Replace(set.script, std::move(set.hotstrings));
+    ScriptEvents::Replace(set.script, std::move(set.handlers), std::move(set.emits));
+    Macro::CancelScript(set.script);
+    for (auto& run : set.macros) Macro::Launch(std::move(run));
+    InputRecorder::CancelScript(set.script);
+    for (auto& run : set.replays) InputRecorder::Launch(std::move(run));
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    Stats::swap.Record(elapsed);
+    auto gap = std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+    Log::Out() << "[System] Swapped in " << set.hotkeys.size() << " binding(s) for " << set.script << " | "
+              << hotkeys.HandlerCount() << " on " << hotkeys.All().size() << " chord(s) in total | Dispatch paused for "
+              << gap.count() << " us";
+
+    // The set belongs to the waiting worker; it is not touched once released
+    {
+        std::lock_guard<std::mutex> lock(swapMutex);
+        set.swapped = true;
+    }
+    swapDone.notify_all();
+}
+
+void HotkeyManager::RegisterPending(ChordTable<HotKeyData>& table) {
+    // Ask the OS once per newly bound chord
+    std::vector<int> rejected;
+    for (auto& chord : table.All()) {
+        if (chord.registered) continue;
+        chord.registered = events->RegisterHotkey(HotkeyId(chord), chord.mods, chord.vk);
+        if (!chord.registered) rejected.push_back(ChordTable<HotKeyData>::Key(chord.mods, chord.vk));
+    }
+    for (int key : rejected) table.Remove(key);
+}
+
+int HotkeyManager::HotkeyId(const ChordTable<HotKeyData>::Chord& chord) {
+    return ChordTable<HotKeyData>::Key(chord.mods, chord.vk) + 1;
+}
+
+void HotkeyManager::Wake() {
+    woken.store(true, std::memory_order_release);
+    events->Wake();
+}
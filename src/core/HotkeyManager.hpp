@@ -1,53 +1,121 @@
 #pragma once
 #include <functional>
 #include <thread>
-#include <windows.h>
 #include <sol/sol.hpp>
-#include <map>
-#include <iostream>
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <memory>
+#include <condition_variable>
 #include "../api/WindowManager.hpp"
 #include "../api/TimerManager.hpp"
+#include "../platform/EventSource.hpp"
+#include "../core/ChordTable.hpp"
+#include "../core/Stats.hpp"
+#include "../core/ScriptHost.hpp"
 
 // Data structure for hotkey registration
 struct HotKeyData {
-    sol::function callback;       // Lua function to call when hotkey is pressed
-    std::string targetWindow;     // Optional window title for context-sensitive hotkeys
+    ScriptFunction callback;      // Lua function to call when hotkey is pressed
+    WindowMatcher context;        // Window filter for context-sensitive hotkeys (global if empty)
+    std::string owner;            // Script module that created the binding
+    std::shared_ptr<Probe> probe; // Call count and run time of the callback
 };
 
 // Hotkey registration request
 struct HotkeyRequest {
+    enum class Type { Bind, UnbindOwner } type;
     int mods;                     // Modifier keys (ALT, CTRL, etc.)
     int vk;                       // Virtual key code
-    sol::function cb;             // Callback function
-    std::string windowTitle;      // Target window title (empty for global)
+    ScriptFunction cb;            // Callback function
+    WindowMatcher context;        // Target window filter (global if empty)
+    std::string owner;            // Script module that created the binding
+    std::shared_ptr<Probe> probe = nullptr; // Probe of the binding (Bind only)
 };
 
-// Manages global hotkey registration and Windows message processing
-// The HotkeyManager runs a separate thread to process Windows messages
-// and execute hotkey callbacks. It supports both global hotkeys and
-// context-sensitive hotkeys tied to specific windows
+struct BindingSet;
+
+// Manages global hotkey registration and OS event processing
+// The HotkeyManager runs a separate thread to process OS events and decide
+// which callbacks fire; the callbacks themselves run on their scripts'
+// workers (ScriptHost). It supports both global hotkeys and
+// context-sensitive hotkeys tied to specific windows. The same chord can
+// be bound several times for different windows; the first matching
+// window-scoped binding wins and a global binding is the fallback
 struct HotkeyManager {
-    static inline std::map<int, HotKeyData> hotkeys;            // Registered hotkeys by ID
-    static inline int nextId = 1;                               // Next available hotkey ID
+    // Work posted to the MessageLoop thread
+    struct Task {
+        std::string owner;                                      // Script module the task belongs to, or empty
+        std::function<void()> run;
+    };
+
+    static inline ChordTable<HotKeyData> hotkeys;               // Bindings by chord
     static inline std::vector<HotkeyRequest> registrationQueue; // Queue for thread-safe registration
+    static inline std::vector<Task> tasks;                      // Work posted to the MessageLoop thread
     static inline std::mutex queueMutex;                        // Mutex for queue synchronization
     static inline std::atomic<bool> shouldClear = false;        // Flag to clear all hotkeys
+    static inline std::atomic<bool> shouldSwap = false;         // Flag to swap in pendingSwaps
+    static inline std::atomic<uint64_t> tick = 0;              // MessageLoop passes so far; tells callbacks of one pass apart
+    static inline std::vector<BindingSet*> pendingSwaps;        // Staged bindings waiting for Swap(); guarded by queueMutex
+    static inline std::mutex swapMutex;                         // Guards BindingSet::swapped
+    static inline std::condition_variable swapDone;             // Signalled after each swap
+    static inline std::unique_ptr<EventSource> events = CreateDefaultEventSource(); // OS event backend
 
-    // Windows message processing loop
-    // Runs in a separate thread to handle WM_HOTKEY messages
+    // Event processing loop
+    // Runs in a separate thread to handle hotkey events and timers
+    // Blocks on the event source until an OS event arrives, a registration
+    // or clear request is queued, or the next timer is due
     static void MessageLoop();
 
     // Registers a hotkey from Lua
     // mods: Modifier keys (MOD.ALT, MOD.CTRL, etc.)
     // vk: Virtual key code
     // cb: Lua callback function
-    // windowTitle: Optional window title for context-sensitive hotkeys
-    static void Add(int mods, int vk, sol::function cb, std::string windowTitle = "");
+    // context: Optional window filter for context-sensitive hotkeys
+    // owner: Script module that creates the binding (see ScriptModules::Owner)
+    // Requests are applied in batches on the MessageLoop thread, and each
+    // chord is registered with the OS only once
+    static void Add(int mods, int vk, ScriptFunction cb, WindowMatcher context = {}, std::string owner = "");
+
+    // Replaces the bindings and timers of one script with a staged set
+    // set: Bindings collected while the new version of set.script loaded
+    // Chords bound both before and after stay registered with the OS, so
+    // there is no window in which they are dead. Posted tasks and queued
+    // requests of the previous version are dropped; other scripts keep
+    // their bindings and queued work.
+    // Blocks until the MessageLoop thread has performed the swap; afterwards
+    // nothing new is dispatched to the previous Lua state
+    static void Swap(BindingSet& set);
+
+    // Removes every binding created by a script module
+    // Queued behind earlier Add() calls, so bindings added afterwards survive
+    static void RemoveOwner(std::string owner);
+
+    // Runs a task on the MessageLoop thread
+    // Used for changes to tables only the MessageLoop touches, such as
+    // adding a key handler
+    // owner: Script module the task belongs to; its tasks still queued when
+    //        that script is swapped are dropped, as are all tasks on Clear()
+    static void Post(std::function<void()> task, std::string owner = "");
 
     // Clears all registered hotkeys
     // Used during script reload to clean up old hotkeys
+    // Blocks until the MessageLoop thread has processed the request
     static void Clear();
-};
\ No newline at end of file
+
+    // Wakes the MessageLoop so it re-checks its queues and timers
+    // Safe to call from any thread
+    static void Wake();
+
+private:
+    static inline std::atomic<bool> woken = false;   // Wake() called since the loop last looked at its queues
+
+    // OS hotkey ID for a chord (chord key + 1)
+    static int HotkeyId(const ChordTable<HotKeyData>::Chord& chord);
+
+    // Registers every chord of the table not registered yet and drops the ones the OS rejects
+    static void RegisterPending(ChordTable<HotKeyData>& table);
+
+    // Performs a requested Swap() on the MessageLoop thread
+    static void ApplySwap(BindingSet& set);
+};
@@ -0,0 +1,202 @@
+#include "../core/Hotstrings.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../core/ScriptModules.hpp"
+#include "../core/BindingSet.hpp"
+#include "../core/InputHooks.hpp"
+#include "../core/TextInjector.hpp"
+#include "../api/InputManager.hpp"
+#include "../api/WindowManager.hpp"
+#include "../utils/Log.hpp"
+
+void Hotstrings::Add(const std::string& abbreviation, const sol::object& action, WindowMatcher context,
+                     HotstringOptions options, std::string owner) {
+    HotstringData data;
+    data.text = abbreviation;
+    data.abbreviation = TextInjector::DecodeUtf8(abbreviation);
+    data.options = options;
+    data.context = std::move(context);
+    data.owner = std::move(owner);
+    if (action.is<sol::function>()) {
+        data.callback = ScriptHost::Share(action.as<sol::function>());
+    } else if (action.is<std::string>()) {
+        data.replacement = action.as<std::string>();
+    } else {
+        Log::Err() << "[Error] hotstring '" << abbreviation << "' needs replacement text or a function";
+        return;
+    }
+    if (data.abbreviation.empty()) {
+        Log::Err() << "[Error] hotstring abbreviation cannot be empty";
+        return;
+    }
+
+    if (BindingSet::staging) {
+        BindingSet::staging->hotstrings.push_back(std::move(data));
+        return;
+    }
+    std::string tag = data.owner;
+    HotkeyManager::Post([data = std::move(data)]() {
+        entries.push_back(data);
+        dirty = true;
+    }, std::move(tag));
+}
+
+void Hotstrings::OnKey(const RawInput& input) {
+    if (entries.empty() || input.type != RawInput::Down) return;
+
+    switch (input.vk) {
+        case 0x01: case 0x02: case 0x04: case 0x05: case 0x06:  // Mouse buttons: caret may have moved
+            Reset();
+            return;
+        case 0x10: case 0x11: case 0x12: case 0x14:             // Modifiers and Caps Lock alone
+        case Vk::LShift: case Vk::RShift: case Vk::LControl: case Vk::RControl:
+        case Vk::LMenu: case Vk::RMenu: case Vk::LWin: case Vk::RWin:
+            return;
+    }
+    if (InputHooks::IsPressed(Vk::LControl) || InputHooks::IsPressed(Vk::RControl) ||
+        InputHooks::IsPressed(Vk::LMenu) || InputHooks::IsPressed(Vk::RMenu) ||
+        InputHooks::IsPressed(Vk::LWin) || InputHooks::IsPressed(Vk::RWin)) {
+        Reset();
+        return;
+    }
+
+    auto window = WindowManager::ActiveWindow();
+    if (window->handle != lastWindow) {
+        Reset();
+        lastWindow = window->handle;
+    }
+
+    if (input.vk == Vk::Back) {
+        Backspace();
+        return;
+    }
+    bool shift = InputHooks::IsPressed(Vk::LShift) || InputHooks::IsPressed(Vk::RShift);
+    char16_t c = InputManager::sink->KeyChar(input.vk, shift);
+    if (c == 0) {
+        Reset();
+        return;
+    }
+    Feed(c, *window);
+}
+
+void Hotstrings::Feed(char16_t c, const WindowInfo& window) {
+    // An end character completes whatever ended on the previous character
+    if (IsEndChar(c)) {
+        int index = Best(false, window);
+        if (index >= 0) {
+            Fire(index, entries[index].abbreviation.size() + 1, c);
+            return;
+        }
+    }
+
+    // Keep one character before the longest abbreviation for the word-start
+    // check; trim in chunks so appending stays amortized O(1)
+    history.push_back(c);
+    size_t keep = automaton.MaxLength() + 1;
+    if (history.size() > keep * 2) history.erase(0, history.size() - keep);
+    state = automaton.Step(state, c);
+
+    int index = Best(true, window);
+    if (index >= 0) Fire(index, entries[index].abbreviation.size(), 0);
+}
+
+void Hotstrings::Backspace() {
+    if (history.empty()) return;
+    history.pop_back();
+    // The automaton cannot step backwards; replay the short history instead
+    state = HotstringAutomaton::root;
+    for (char16_t c : history) state = automaton.Step(state, c);
+}
+
+int Hotstrings::Best(bool immediate, const WindowInfo& window) {
+    for (auto it = automaton.OutputsBegin(state); it != automaton.OutputsEnd(state); ++it) {
+        const HotstringData& entry = entries[*it];
+        if (entry.options.immediate != immediate) continue;
+
+        size_t length = entry.abbreviation.size();
+        if (history.size() < length) continue;
+        size_t start = history.size() - length;
+        if (entry.options.caseSensitive && history.compare(start, length, entry.abbreviation) != 0) continue;
+        if (!entry.options.inside && start > 0 && !IsEndChar(history[start - 1])) continue;
+        if (!entry.context.IsGlobal() && !entry.context.Matches(window)) continue;
+        return (int)*it;
+    }
+    return -1;
+}
+
+void Hotstrings::Fire(int index, size_t typed, char16_t endChar) {
+    const HotstringData& entry = entries[index];
+    Reset();
+
+    std::string end;
+    if (endChar) end = endChar == u'\n' ? "\n" : std::string(1, (char)endChar);  // End characters are ASCII
+    if (entry.options.erase) InputManager::EraseChars((int)typed);
+
+    if (entry.callback) {
+        ScriptHost::Call(entry.callback, nullptr, entry.text, end);
+    } else {
+        // Without erasing, the end character is already in place
+        InputManager::WriteText(entry.options.erase ? entry.replacement + end : entry.replacement);
+    }
+}
+
+void Hotstrings::Reset() {
+    state = HotstringAutomaton::root;
+    history.clear();
+}
+
+void Hotstrings::Flush() {
+    if (!dirty) return;
+    dirty = false;
+    Rebuild();
+}
+
+void Hotstrings::Rebuild() {
+    auto start = std::chrono::steady_clock::now();
+    automaton = HotstringAutomaton();
+    for (const auto& entry : entries) automaton.Add(entry.abbreviation);
+    automaton.Build();
+    state = HotstringAutomaton::root;
+    for (char16_t c : history) state = automaton.Step(state, c);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    Log::Out() << "[System] Compiled " << automaton.PatternCount() << " hotstring(s) into "
+              << automaton.StateCount() << " state(s) in " << elapsed.count() << " us";
+}
+
+void Hotstrings::Replace(const std::string& script, std::vector<HotstringData>&& staged) {
+    size_t removed = std::erase_if(entries, [&](const HotstringData& h) { return ScriptModules::BelongsTo(h.owner, script); });
+    if (removed == 0 && staged.empty()) return;
+    for (auto& entry : staged) entries.push_back(std::move(entry));
+    dirty = true;
+}
+
+void Hotstrings::RemoveOwner(const std::string& owner) {
+    if (std::erase_if(entries, [&](const HotstringData& h) { return h.owner == owner; })) dirty = true;
+}
+
+void Hotstrings::Clear() {
+    if (entries.empty()) return;
+    entries.clear();
+    dirty = true;
+}
+
+HotstringOptions Hotstrings::ParseOptions(const std::string& flags) {
+    HotstringOptions options;
+    for (size_t i = 0; i < flags.size(); ++i) {
+        switch (flags[i]) {
+            case '*': options.immediate = true; break;
+            case '?': options.inside = true; break;
+            case 'c': case 'C': options.caseSensitive = true; break;
+            case 'b': case 'B':
+                if (i + 1 < flags.size() && flags[i + 1] == '0') {
+                    options.erase = false;
+                    ++i;
+                }
+                break;
+            case ' ': break;
+            default:
+                Log::Err() << "[Error] Unknown hotstring option '" << flags[i] << "'";
+        }
+    }
+    return options;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../platform/InputCapture.hpp"
+#include "../utils/HotstringAutomaton.hpp"
+#include "../utils/WindowMatcher.hpp"
+#include "../core/ScriptHost.hpp"
+
+// Hotstring options, parsed from AutoHotkey-style flags
+struct HotstringOptions {
+    bool immediate = false;       // "*": fire on the last character, no end character needed
+    bool inside = false;          // "?": also fire inside a word
+    bool caseSensitive = false;   // "c": abbreviation must be typed with the same case
+    bool erase = true;            // "b0" turns off erasing the typed abbreviation
+};
+
+// One registered hotstring
+struct HotstringData {
+    std::string text;             // Abbreviation as given (UTF-8)
+    std::u16string abbreviation;  // Abbreviation as matched (UTF-16)
+    std::string replacement;      // Text typed in place of the abbreviation when callback is nil
+    ScriptFunction callback;      // Lua function called instead of typing a replacement, or nullptr
+    HotstringOptions options;
+    WindowMatcher context;        // Window filter (global if empty)
+    std::string owner;            // Script module that created the hotstring
+};
+
+// Text expansion over the keystroke stream
+// Fed every physical key press by InputHooks on the MessageLoop thread. The
+// typed characters drive a HotstringAutomaton, so the cost per keystroke does
+// not depend on the number of hotstrings. The typed-character buffer is reset
+// on focus change, mouse click, navigation keys and Ctrl/Alt/Win chords, like
+// AutoHotkey does. Hotstrings are only touched on the MessageLoop thread.
+struct Hotstrings {
+    // Characters that complete a hotstring without the "*" option
+    static inline const std::u16string endChars = u"-()[]{}':;\"/\\,.?! \t\n";
+
+    // Registers a hotstring from Lua
+    // abbreviation: Text that triggers the hotstring
+    // action: Replacement text, or a function called as fn(abbreviation, endChar)
+    // context: Optional window filter
+    // options: Matching rules
+    // owner: Script module that creates the hotstring (see ScriptModules::Owner)
+    static void Add(const std::string& abbreviation, const sol::object& action, WindowMatcher context,
+                    HotstringOptions options, std::string owner = "");
+
+    // Feeds one captured key transition; MessageLoop thread only
+    static void OnKey(const RawInput& input);
+
+    // Forgets the characters typed so far
+    static void Reset();
+
+    // Replaces the hotstrings of one script with a staged set; MessageLoop thread only
+    static void Replace(const std::string& script, std::vector<HotstringData>&& staged);
+
+    // Removes every hotstring created by a script module; MessageLoop thread only
+    static void RemoveOwner(const std::string& owner);
+
+    // Removes every hotstring; MessageLoop thread only
+    static void Clear();
+
+    // Recompiles the automaton if hotstrings changed since the last call
+    // MessageLoop thread only; called once per pass after the posted work
+    // and before input is dispatched, so a module that adds thousands of
+    // hotstrings costs one rebuild instead of one per hotstring
+    static void Flush();
+
+    // Parse AutoHotkey-style option flags ("*", "?", "c", "b0")
+    static HotstringOptions ParseOptions(const std::string& flags);
+
+private:
+    // Processes one typed character
+    static void Feed(char16_t c, const WindowInfo& window);
+
+    // Drops the last typed character
+    static void Backspace();
+
+    // Finds the longest hotstring ending in the current state that may fire
+    // Returns its index in entries, or -1
+    static int Best(bool immediate, const WindowInfo& window);
+
+    // Erases the abbreviation and runs the hotstring
+    static void Fire(int index, size_t typed, char16_t endChar);
+
+    // Recompiles the automaton after hotstrings changed
+    // Runs from Flush(), never on a keystroke; the characters typed so far
+    // are replayed so a word in progress still completes
+    static void Rebuild();
+
+    static bool IsEndChar(char16_t c) { return endChars.find(c) != std::u16string::npos; }
+
+    static inline std::vector<HotstringData> entries;  // Automaton pattern ID = index once Flush() has run
+    static inline bool dirty = false;                  // entries changed since the automaton was built
+    static inline HotstringAutomaton automaton;
+    static inline uint32_t state = HotstringAutomaton::root;
+    static inline std::u16string history;              // Characters typed since the last reset
+    static inline uintptr_t lastWindow = 0;            // Foreground window of the previous key
+};
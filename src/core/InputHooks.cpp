@@ -0,0 +1,130 @@
+#include "../core/InputHooks.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../core/ScriptModules.hpp"
+#include "../core/BindingSet.hpp"
+#include "../core/Hotstrings.hpp"
+#include "../core/InputRecorder.hpp"
+#include "../api/WindowManager.hpp"
+#include "../utils/Log.hpp"
+#include <iterator>
+
+void InputHooks::Start() {
+    if (!capture->Start(&InputHooks::OnInput)) {
+        Log::Err() << "[Error] Input capture unavailable; on_key_down/on_key_up/is_pressed are disabled.";
+    }
+}
+
+void InputHooks::OnInput(RawInput input) {
+    if (input.type == RawInput::Move) {
+        bool wasEmpty = false;
+        if (!ring.TryPush(input, wasEmpty)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        } else if (wasEmpty) {
+            HotkeyManager::Wake();
+        }
+        return;
+    }
+
+    int vk = input.vk & 0xFF;
+    uint64_t bit = uint64_t(1) << (vk & 63);
+    auto& word = keyState[vk >> 6];
+
+    if (input.type == RawInput::Down) {
+        if (word.fetch_or(bit, std::memory_order_relaxed) & bit) {
+            input.flags |= RawInput::Repeat;
+        } else {
+            downAt[vk] = input.time;
+        }
+    } else {
+        word.fetch_and(~bit, std::memory_order_relaxed);
+        if (downAt[vk]) {
+            auto held = std::chrono::duration_cast<std::chrono::microseconds>(Clock::duration(input.time - downAt[vk]));
+            input.held = (uint32_t)held.count();
+            downAt[vk] = 0;
+        }
+    }
+
+    bool wasEmpty = false;
+    if (!ring.TryPush(input, wasEmpty)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (wasEmpty) HotkeyManager::Wake();
+}
+
+void InputHooks::Add(bool up, int vk, ScriptFunction cb, WindowMatcher context, std::string owner) {
+    if (vk < 0 || vk > 255) {
+        Log::Err() << "[Error] Invalid key code for " << (up ? "on_key_up" : "on_key_down") << ": " << vk;
+        return;
+    }
+    if (BindingSet::staging) {
+        BindingSet::staging->keys.push_back({ up, vk, { cb, std::move(context), std::move(owner) } });
+        return;
+    }
+    std::string tag = owner;
+    HotkeyManager::Post([up, vk, cb, context = std::move(context), owner = std::move(owner)]() {
+        (up ? upHandlers : downHandlers)[vk].push_back({ cb, context, owner });
+    }, std::move(tag));
+}
+
+void InputHooks::Dispatch() {
+    RawInput batch[256];
+    uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost) Log::Err() << "[System] Input ring overflow, dropped " << lost << " event(s)";
+
+    while (size_t count = ring.PopBatch(batch, std::size(batch))) {
+        dispatched.fetch_add(count, std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            const RawInput& input = batch[i];
+            // Our own SendInput output must not re-trigger handlers or hotstrings
+            if (input.flags & RawInput::Injected) continue;
+            InputRecorder::OnInput(input);
+            if (input.type == RawInput::Move) continue;
+            Hotstrings::OnKey(input);
+
+            // Auto-repeat types characters but is not a new press
+            if (input.flags & RawInput::Repeat) continue;
+
+            auto& handlers = (input.type == RawInput::Up ? upHandlers : downHandlers)[input.vk & 0xFF];
+            if (handlers.empty()) continue;
+
+            // The active window is resolved at most once per event
+            std::shared_ptr<const WindowInfo> window;
+            for (const auto& handler : handlers) {
+                if (!handler.context.IsGlobal()) {
+                    if (!window) window = WindowManager::ActiveWindow();
+                    if (!handler.context.Matches(*window)) continue;
+                }
+                if (input.type == RawInput::Up) {
+                    ScriptHost::Call(handler.callback, nullptr, (int)input.vk, input.held / 1000.0);
+                } else {
+                    ScriptHost::Call(handler.callback, nullptr, (int)input.vk);
+                }
+            }
+        }
+    }
+}
+
+void InputHooks::Replace(const std::string& script, std::vector<KeyBinding>&& staged) {
+    auto remove = [&](std::vector<KeyHandler>& handlers) {
+        std::erase_if(handlers, [&](const KeyHandler& h) { return ScriptModules::BelongsTo(h.owner, script); });
+    };
+    for (auto& handlers : downHandlers) remove(handlers);
+    for (auto& handlers : upHandlers) remove(handlers);
+    for (auto& binding : staged) {
+        (binding.up ? upHandlers : downHandlers)[binding.vk].push_back(std::move(binding.handler));
+    }
+}
+
+void InputHooks::RemoveOwner(const std::string& owner) {
+    auto remove = [&](std::vector<KeyHandler>& handlers) {
+        std::erase_if(handlers, [&](const KeyHandler& h) { return h.owner == owner; });
+    };
+    for (auto& handlers : downHandlers) remove(handlers);
+    for (auto& handlers : upHandlers) remove(handlers);
+}
+
+void InputHooks::Clear() {
+    for (auto& handlers : downHandlers) handlers.clear();
+    for (auto& handlers : upHandlers) handlers.clear();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../platform/InputCapture.hpp"
+#include "../utils/SpscRing.hpp"
+#include "../utils/WindowMatcher.hpp"
+#include "../core/ScriptHost.hpp"
+
+// Lua handler for key or mouse button transitions
+struct KeyHandler {
+    ScriptFunction callback;      // Lua function called with (vk) or (vk, held_ms)
+    WindowMatcher context;        // Window filter (global if empty)
+    std::string owner;            // Script module that created the handler
+};
+
+// Handler registration made while a script loads
+struct KeyBinding {
+    bool up;                      // on_key_up rather than on_key_down
+    int vk;                       // Virtual key code
+    KeyHandler handler;
+};
+
+// Low-level keyboard and mouse button observation
+// The capture thread (the OS hook on Windows) updates a key-state bitmap and
+// pushes compact timestamped events into a lock-free SPSC ring; it wakes the
+// MessageLoop only when the ring goes from empty to non-empty. The loop
+// drains the ring in batches and posts on_key_down/on_key_up handlers to
+// their scripts' workers. Handlers are only touched on the MessageLoop thread.
+struct InputHooks {
+    using Clock = std::chrono::steady_clock;
+    using Ring = SpscRing<RawInput, 4096>;
+
+    static inline std::unique_ptr<InputCapture> capture = CreateDefaultInputCapture(); // OS input backend
+    static inline Ring ring;                                    // Capture thread -> MessageLoop
+    static inline std::array<std::atomic<uint64_t>, 4> keyState{}; // Bit per virtual key, set while down
+    static inline std::atomic<uint64_t> dropped = 0;            // Events lost to a full ring
+    static inline std::atomic<uint64_t> dispatched = 0;         // Events drained by the MessageLoop
+
+    // Starts the capture; called once from the MessageLoop thread
+    static void Start();
+
+    // Checks whether a key or mouse button is currently held
+    // vk: Virtual key code
+    // Reads the bitmap only; no system call. Keys already held when the
+    // capture started count as released until they go down again
+    static bool IsPressed(int vk) {
+        if (vk < 0 || vk > 255) return false;
+        return (keyState[vk >> 6].load(std::memory_order_relaxed) >> (vk & 63)) & 1;
+    }
+
+    // Registers a handler from Lua
+    // up: true for on_key_up, false for on_key_down
+    // vk: Virtual key code (KEY.* including KEY.LBUTTON etc.)
+    // cb: Lua callback
+    // context: Optional window filter
+    // owner: Script module that creates the handler (see ScriptModules::Owner)
+    static void Add(bool up, int vk, ScriptFunction cb, WindowMatcher context = {}, std::string owner = "");
+
+    // Drains the ring and runs matching handlers; MessageLoop thread only
+    static void Dispatch();
+
+    // Replaces the handlers of one script with a staged set; MessageLoop thread only
+    static void Replace(const std::string& script, std::vector<KeyBinding>&& staged);
+
+    // Removes every handler created by a script module; MessageLoop thread only
+    static void RemoveOwner(const std::string& owner);
+
+    // Removes every handler; MessageLoop thread only
+    static void Clear();
+
+private:
+    // Runs on the capture thread for every transition
+    static void OnInput(RawInput input);
+
+    static inline std::array<int64_t, 256> downAt{};            // Capture thread: time of last Down per key
+    static inline std::array<std::vector<KeyHandler>, 256> downHandlers;
+    static inline std::array<std::vector<KeyHandler>, 256> upHandlers;
+};
@@ -0,0 +1,290 @@
+#include "../core/InputRecorder.hpp"
+#include "../core/InputHooks.hpp"
+#include "../core/BindingSet.hpp"
+#include "../core/ScriptState.hpp"
+#include "../core/PrecisionClock.hpp"
+#include "../api/InputManager.hpp"
+#include "../utils/Log.hpp"
+#include <cmath>
+#include <iterator>
+#include <thread>
+#include <tuple>
+
+namespace {
+    const char* ReplayMeta = "MoonKey.Replay";
+
+    // Converts a record to sink input; false for events the sink cannot produce
+    bool ToEvent(const InputLogRecord& record, InputEvent& event) {
+        bool up = record.kind == InputLogRecord::KeyUp;
+        switch (record.kind == InputLogRecord::Move ? -1 : record.vk) {
+            case -1:   event = InputEvent::Move(record.x, record.y); return true;
+            case 0x01: event = InputEvent::Button(0, up); return true;
+            case 0x02: event = InputEvent::Button(1, up); return true;
+            case 0x04: event = InputEvent::Button(2, up); return true;
+            case 0x05: case 0x06: return false;    // X buttons have no InputEvent form
+            default:   event = InputEvent::Key(record.vk, up); return true;
+        }
+    }
+}
+
+void InputRecorder::Start() {
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writer = InputLogWriter();
+        idle = writer.GetMark();
+        held.reset();
+        startTicks = Clock::now().time_since_epoch().count();
+    }
+    if (recording.exchange(true)) Log::Out() << "[System] Recording restarted";
+    InputHooks::capture->ReportMoves(true);
+}
+
+int64_t InputRecorder::Stop(const std::string& path, std::string& error) {
+    if (!recording.exchange(false)) {
+        error = "not recording";
+        return -1;
+    }
+    InputHooks::capture->ReportMoves(false);
+
+    std::lock_guard<std::mutex> lock(writerMutex);
+    // Keys still held are the hotkey that stopped the recording; replaying
+    // them would only trigger it again
+    if (held.any()) writer.Truncate(idle);
+
+    int64_t count = (int64_t)writer.Count();
+    bool saved = writer.Save(path);
+    writer = InputLogWriter();
+    if (!saved) {
+        error = "cannot write " + path;
+        return -1;
+    }
+    return count;
+}
+
+void InputRecorder::Append(const RawInput& input) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (!recording.load(std::memory_order_relaxed) || input.time < startTicks) return;
+
+    InputLogRecord record;
+    record.time = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::duration(input.time - startTicks)).count();
+    if (input.type == RawInput::Move) {
+        record.kind = InputLogRecord::Move;
+        record.x = input.x;
+        record.y = input.y;
+    } else {
+        uint8_t vk = (uint8_t)input.vk;
+        if (input.type == RawInput::Down) {
+            if (held.none()) idle = writer.GetMark();
+            held.set(vk);
+            record.kind = InputLogRecord::KeyDown;
+        } else {
+            // Release of a key that was already down when recording started
+            // (typically the record_start hotkey)
+            if (!held.test(vk)) return;
+            held.reset(vk);
+            record.kind = InputLogRecord::KeyUp;
+        }
+        record.vk = vk;
+    }
+    writer.Append(record);
+}
+
+std::shared_ptr<ReplayRun> InputRecorder::Open(const std::string& path, double speed, std::string& error) {
+    if (!(speed > 0)) {
+        error = "speed must be greater than 0";
+        return nullptr;
+    }
+    auto run = std::make_shared<ReplayRun>();
+    if (!run->file.Open(path)) {
+        error = "cannot open " + path;
+        return nullptr;
+    }
+    if (!run->reader.Open(run->file.Data(), run->file.Size(), error)) {
+        error = path + ": " + error;
+        return nullptr;
+    }
+    run->speed = speed;
+    return run;
+}
+
+void InputRecorder::Execute(ReplayRun& run) {
+    InputSink& sink = *InputManager::sink;
+    InputEvent batch[64];
+    size_t pending = 0;
+    std::bitset<256> down;        // Keys and buttons pressed by this replay
+    size_t nextRelease = releaseBytes;
+
+    auto start = Clock::now();
+    Clock::time_point batchDue = start;
+    InputLogRecord record;
+    while (run.reader.Next(record)) {
+        auto due = start + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::micro>((double)record.time / run.speed));
+
+        // Events recorded at the same instant go out as one batch
+        if (pending && (due != batchDue || pending == std::size(batch))) {
+            sink.Send(batch, pending);
+            pending = 0;
+        }
+        if (pending == 0) {
+            if (run.token->Cancelled()) break;
+            if (due > Clock::now()) {
+                if (!run.token->SleepUntil(due)) break;
+                PrecisionClock::Record(due);
+            }
+            batchDue = due;
+        }
+
+        InputEvent event;
+        if (!ToEvent(record, event)) continue;
+        if (record.kind != InputLogRecord::Move) down.set(record.vk, record.kind == InputLogRecord::KeyDown);
+        batch[pending++] = event;
+
+        if (run.reader.Offset() >= nextRelease) {
+            run.file.Release(run.reader.Offset());
+            nextRelease = run.reader.Offset() + releaseBytes;
+        }
+    }
+    // The last batch is already due, even when the loop ended on a cancel
+    if (pending) sink.Send(batch, pending);
+
+    // Never leave a key or button stuck down after a cancel or a cut-off recording
+    pending = 0;
+    for (int vk = 0; vk < 256; ++vk) {
+        InputLogRecord release;
+        release.kind = InputLogRecord::KeyUp;
+        release.vk = (uint8_t)vk;
+        if (!down.test(vk) || !ToEvent(release, batch[pending])) continue;
+        if (++pending == std::size(batch)) {
+            sink.Send(batch, pending);
+            pending = 0;
+        }
+    }
+    if (pending) sink.Send(batch, pending);
+    run.file.Close();
+    run.finished = true;
+}
+
+void InputRecorder::Launch(std::shared_ptr<ReplayRun> run) {
+    Track(run);
+    std::thread([run] { InputRecorder::Execute(*run); }).detach();
+}
+
+void InputRecorder::Track(const std::shared_ptr<ReplayRun>& run) {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    std::erase_if(active, [](const std::weak_ptr<ReplayRun>& r) { return r.expired(); });
+    active.push_back(run);
+}
+
+void InputRecorder::CancelAll() {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    for (auto& weak : active) {
+        if (auto run = weak.lock()) run->token->Cancel();
+    }
+    active.clear();
+}
+
+void InputRecorder::CancelScript(const std::string& script) {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    std::erase_if(active, [&](const std::weak_ptr<ReplayRun>& weak) {
+        auto run = weak.lock();
+        if (!run) return true;
+        if (run->script != script) return false;
+        run->token->Cancel();
+        return true;
+    });
+}
+
+bool InputRecorder::Compact(const std::string& path, uint64_t interval, uint64_t& before, uint64_t& after, std::string& error) {
+    InputLogWriter out;
+    {
+        MappedFile file;
+        InputLogReader reader;
+        if (!file.Open(path)) {
+            error = "cannot open " + path;
+            return false;
+        }
+        if (!reader.Open(file.Data(), file.Size(), error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        after = InputLog::Compact(reader, out, interval);
+        before = reader.Count();
+    }
+    // The mapping is closed above so the file can be replaced on Windows
+    if (!out.Save(path, InputLog::Compacted)) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+void InputRecorder::Bind(sol::state& lua) {
+    lua_State* L = lua.lua_state();
+
+    static const luaL_Reg methods[] = {
+        { "cancel", &InputRecorder::LuaCancel },
+        { "running", &InputRecorder::LuaRunning },
+        { nullptr, nullptr },
+    };
+    luaL_newmetatable(L, ReplayMeta);
+    lua_createtable(L, 0, 2);
+    luaL_setfuncs(L, methods, 0);
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, &InputRecorder::LuaGc);
+    lua_setfield(L, -2, "__gc");
+    lua_pop(L, 1);
+
+    lua.set_function("record_start", &InputRecorder::Start);
+    lua.set_function("record_stop", [](const std::string& path) {
+        std::string error;
+        int64_t count = Stop(path, error);
+        if (count < 0) throw sol::error("record_stop: " + error);
+        return count;
+    });
+    lua.set_function("replay", [](const std::string& path, sol::optional<double> speed, sol::this_state ts) -> sol::object {
+        std::string error;
+        auto run = Open(path, speed.value_or(1.0), error);
+        if (!run) throw sol::error("replay: " + error);
+        run->script = ScriptState::From(ts).name;
+
+        if (BindingSet::staging) {
+            // Started by a script that is still loading; goes live with its bindings
+            BindingSet::staging->replays.push_back(run);
+        } else {
+            Launch(run);
+        }
+
+        lua_State* L = ts;
+        void* memory = lua_newuserdatauv(L, sizeof(std::shared_ptr<ReplayRun>), 0);
+        new (memory) std::shared_ptr<ReplayRun>(std::move(run));
+        luaL_setmetatable(L, ReplayMeta);
+        sol::object handle(L, -1);
+        lua_pop(L, 1);
+        return handle;
+    });
+    lua.set_function("record_compact", [](const std::string& path, sol::optional<double> ms) {
+        uint64_t interval = ms ? (uint64_t)std::llround((std::max)(0.0, *ms * 1000.0)) : compactInterval;
+        uint64_t before = 0, after = 0;
+        std::string error;
+        if (!Compact(path, interval, before, after, error)) throw sol::error("record_compact: " + error);
+        return std::make_tuple(before, after);
+    });
+}
+
+int InputRecorder::LuaCancel(lua_State* L) {
+    auto& run = *static_cast<std::shared_ptr<ReplayRun>*>(luaL_checkudata(L, 1, ReplayMeta));
+    run->token->Cancel();
+    return 0;
+}
+
+int InputRecorder::LuaRunning(lua_State* L) {
+    auto& run = *static_cast<std::shared_ptr<ReplayRun>*>(luaL_checkudata(L, 1, ReplayMeta));
+    lua_pushboolean(L, !run->finished && !run->token->Cancelled());
+    return 1;
+}
+
+int InputRecorder::LuaGc(lua_State* L) {
+    static_cast<std::shared_ptr<ReplayRun>*>(lua_touserdata(L, 1))->~shared_ptr();
+    return 0;
+}
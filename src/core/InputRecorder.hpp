@@ -0,0 +1,103 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../core/Macro.hpp"
+#include "../platform/InputCapture.hpp"
+#include "../platform/MappedFile.hpp"
+#include "../utils/InputLog.hpp"
+
+// State of one replay of a recording
+struct ReplayRun {
+    MappedFile file;
+    InputLogReader reader;
+    double speed = 1.0;           // Playback rate; 2 = twice as fast
+    std::shared_ptr<CancelToken> token = std::make_shared<CancelToken>();
+    std::atomic<bool> finished = false;
+    std::string script;           // Script that started the replay
+};
+
+// Records real keyboard and mouse input and replays it
+// Recording taps the InputHooks stream on the MessageLoop thread and encodes
+// events into memory in the InputLog format; record_stop writes the file.
+// Replay maps the file and streams it on a dedicated thread, sending the
+// events of each instant as one batch through InputManager's sink and
+// sleeping on the precision clock in between. Injected input (including
+// our own replays and macros) is never recorded.
+// Lua:
+//   record_start()
+//   record_stop("combo.mkr")          -- returns the number of events
+//   local r = replay("combo.mkr", 1.5)  r:cancel()  r:running()
+//   record_compact("combo.mkr", 4)
+struct InputRecorder {
+    using Clock = std::chrono::steady_clock;
+
+    static inline uint64_t compactInterval = 4000;    // Default record_compact spacing in microseconds
+    static inline size_t releaseBytes = 1 << 20;      // Replay hands mapped pages back every this many bytes
+
+    // Starts recording, discarding any recording in progress
+    static void Start();
+
+    // Stops recording and writes the log to path
+    // error: Set when nothing was recording or the file cannot be written
+    // Returns the number of events written, or -1 on failure
+    static int64_t Stop(const std::string& path, std::string& error);
+
+    // Adds a captured event to the recording; MessageLoop thread only
+    static void OnInput(const RawInput& input) {
+        if (recording.load(std::memory_order_relaxed)) Append(input);
+    }
+
+    // Opens a recording for replay
+    // speed: Playback rate, > 0
+    // Returns nullptr with error set if the file is not a readable recording
+    static std::shared_ptr<ReplayRun> Open(const std::string& path, double speed, std::string& error);
+
+    // Replays a run to completion on the calling thread
+    static void Execute(ReplayRun& run);
+
+    // Starts a run on its own thread
+    static void Launch(std::shared_ptr<ReplayRun> run);
+
+    // Cancels every running replay
+    // Used during script reload so replays do not outlive their script
+    static void CancelAll();
+
+    // Cancels the replays started by one script
+    // Used when that script is reloaded or unloaded
+    static void CancelScript(const std::string& script);
+
+    // Compacts a recording in place
+    // interval: Minimum spacing of kept cursor moves in microseconds
+    // before/after: Set to the record counts
+    // Returns false with error set if the file cannot be read or written
+    static bool Compact(const std::string& path, uint64_t interval, uint64_t& before, uint64_t& after, std::string& error);
+
+    // Registers record_start/record_stop/replay/record_compact
+    static void Bind(sol::state& lua);
+
+private:
+    static void Append(const RawInput& input);
+    static void Track(const std::shared_ptr<ReplayRun>& run);
+
+    // Lua glue; a replay handle is a full userdata holding a shared_ptr<ReplayRun>
+    static int LuaCancel(lua_State* L);
+    static int LuaRunning(lua_State* L);
+    static int LuaGc(lua_State* L);
+
+    static inline std::atomic<bool> recording = false;
+    static inline std::mutex writerMutex;
+    static inline InputLogWriter writer;              // Guarded by writerMutex
+    static inline InputLogWriter::Mark idle;          // Writer state when no key was last held; guarded by writerMutex
+    static inline std::bitset<256> held;              // Keys down since Start; guarded by writerMutex
+    static inline int64_t startTicks = 0;             // steady_clock ticks at Start; guarded by writerMutex
+
+    static inline std::mutex activeMutex;
+    static inline std::vector<std::weak_ptr<ReplayRun>> active;  // Runs CancelAll() reaches
+};
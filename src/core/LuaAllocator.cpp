@@ -0,0 +1,101 @@
+#include "../core/LuaAllocator.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+LuaAllocator::~LuaAllocator() {
+    for (void* slab : slabs) std::free(slab);
+}
+
+void* LuaAllocator::Alloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+    auto* self = static_cast<LuaAllocator*>(ud);
+    if (nsize == 0) {
+        if (ptr) self->Release(ptr, osize);
+        return nullptr;
+    }
+    // Without a block, osize is the type of object being created
+    if (!ptr) return self->Allocate(nsize);
+    return self->Resize(ptr, osize, nsize);
+}
+
+void* LuaAllocator::Allocate(size_t size) {
+    void* block;
+    if (size <= maxPooled) {
+        size_t cls = ClassOf(size);
+        if (FreeBlock* head = freeLists[cls]) {
+            freeLists[cls] = head->next;
+            block = head;
+        } else {
+            block = Carve(cls);
+        }
+    } else {
+        block = std::malloc(size);
+    }
+    if (!block) return nullptr;
+
+    Add(allocations, uint64_t{ 1 });
+    Grow(size);
+    return block;
+}
+
+void LuaAllocator::Release(void* block, size_t size) {
+    Add(inUse, 0 - size);
+    if (size > maxPooled) {
+        std::free(block);
+        return;
+    }
+    size_t cls = ClassOf(size);
+    auto* freed = static_cast<FreeBlock*>(block);
+    freed->next = freeLists[cls];
+    freeLists[cls] = freed;
+}
+
+void* LuaAllocator::Resize(void* block, size_t osize, size_t nsize) {
+    bool pooled = osize <= maxPooled;
+    // Same class: the block already has room
+    if (pooled && nsize <= maxPooled && ClassOf(osize) == ClassOf(nsize)) {
+        Grow(nsize - osize);
+        return block;
+    }
+    // Both on the system heap: let realloc grow in place when it can
+    if (!pooled && nsize > maxPooled) {
+        void* moved = std::realloc(block, nsize);
+        if (!moved) return nullptr;
+        Grow(nsize - osize);
+        return moved;
+    }
+
+    void* moved = Allocate(nsize);
+    if (!moved) return nullptr;
+    std::memcpy(moved, block, (std::min)(osize, nsize));
+    Release(block, osize);
+    return moved;
+}
+
+void* LuaAllocator::Carve(size_t cls) {
+    size_t size = (cls + 1) * granularity;
+    if ((size_t)(end - cursor) < size) {
+        // Hand the tail of the old slab to the free lists before starting a new one
+        while (cursor && end - cursor >= (ptrdiff_t)granularity) {
+            size_t tail = (std::min)((size_t)(end - cursor), maxPooled) / granularity * granularity;
+            auto* freed = reinterpret_cast<FreeBlock*>(cursor);
+            freed->next = freeLists[ClassOf(tail)];
+            freeLists[ClassOf(tail)] = freed;
+            cursor += tail;
+        }
+        void* slab = std::malloc(slabSize);
+        if (!slab) return nullptr;
+        slabs.push_back(slab);
+        Add(reserved, slabSize);
+        cursor = static_cast<std::byte*>(slab);
+        end = cursor + slabSize;
+    }
+    void* block = cursor;
+    cursor += size;
+    return block;
+}
+
+void LuaAllocator::Grow(size_t delta) {
+    Add(inUse, delta);
+    if (InUse() > Peak()) peak.store(InUse(), std::memory_order_relaxed);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Memory allocator for one Lua state (lua_Alloc)
+// Blocks up to maxPooled bytes come from per-size-class free lists carved
+// out of large slabs, so the small strings, tables and closures a callback
+// churns through are recycled without going to the system heap. Freed blocks
+// return to their class's list; slabs are only released with the allocator.
+// Larger blocks go to malloc/realloc. Lua passes the old size on every
+// resize and free, so blocks carry no header.
+// Not thread-safe: a Lua state is only ever used by one thread at a time.
+// The counters are relaxed atomics so other threads may read them.
+class LuaAllocator {
+public:
+    static constexpr size_t granularity = 16;      // Size class step; also the block alignment
+    static constexpr size_t maxPooled = 256;       // Largest pooled block
+    static constexpr size_t slabSize = 64 * 1024;
+
+    LuaAllocator() = default;
+    LuaAllocator(const LuaAllocator&) = delete;
+    LuaAllocator& operator=(const LuaAllocator&) = delete;
+    ~LuaAllocator();
+
+    // lua_Alloc entry point; ud is the LuaAllocator
+    static void* Alloc(void* ud, void* ptr, size_t osize, size_t nsize);
+
+    // Bytes currently allocated by Lua
+    size_t InUse() const { return inUse.load(std::memory_order_relaxed); }
+
+    // Highest InUse() so far
+    size_t Peak() const { return peak.load(std::memory_order_relaxed); }
+
+    // Allocations so far, including resizes that moved a block
+    uint64_t Allocations() const { return allocations.load(std::memory_order_relaxed); }
+
+    // Bytes held in slabs, used or free
+    size_t Reserved() const { return reserved.load(std::memory_order_relaxed); }
+
+    // Starts Peak() over from the current usage
+    void ResetPeak() { peak.store(InUse(), std::memory_order_relaxed); }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t classCount = maxPooled / granularity;
+
+    // Size class of a pooled size (1 - maxPooled)
+    static size_t ClassOf(size_t size) { return (size - 1) / granularity; }
+
+    void* Allocate(size_t size);
+    void Release(void* block, size_t size);
+    void* Resize(void* block, size_t osize, size_t nsize);
+
+    // Adds to InUse() (delta may wrap to subtract) and raises Peak() with it
+    void Grow(size_t delta);
+
+    // Carves a block of a class from the current slab, starting a new one when it runs out
+    void* Carve(size_t cls);
+
+    // Single-writer counter update; unsigned wrap-around makes negative deltas work
+    template <class T>
+    static void Add(std::atomic<T>& counter, T delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::array<FreeBlock*, classCount> freeLists{};
+    std::byte* cursor = nullptr;   // Unused part of the newest slab
+    std::byte* end = nullptr;
+    std::vector<void*> slabs;
+
+    std::atomic<size_t> inUse = 0;
+    std::atomic<size_t> peak = 0;
+    std::atomic<size_t> reserved = 0;
+    std::atomic<uint64_t> allocations = 0;
+};
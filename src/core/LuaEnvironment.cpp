@@ -0,0 +1,99 @@
+#include "../core/LuaEnvironment.hpp"
+#include "../api/InputManager.hpp"
+#include "../api/TimerManager.hpp"
+#include "../api/WindowManager.hpp"
+#include "../core/BytecodeCache.hpp"
+#include "../core/ControlChannel.hpp"
+#include "../core/CoroutineScheduler.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../core/Hotstrings.hpp"
+#include "../core/InputHooks.hpp"
+#include "../core/InputRecorder.hpp"
+#include "../core/Macro.hpp"
+#include "../core/MousePath.hpp"
+#include "../core/PrecisionClock.hpp"
+#include "../core/Processes.hpp"
+#include "../core/Profiler.hpp"
+#include "../core/Screen.hpp"
+#include "../core/ScriptEvents.hpp"
+#include "../core/ScriptHost.hpp"
+#include "../core/ScriptModules.hpp"
+#include "../core/ScriptState.hpp"
+#include "../core/ScriptValue.hpp"
+#include "../core/Stats.hpp"
+#include "../core/Store.hpp"
+#include "../utils/KeyCodes.hpp"
+#include "../utils/Log.hpp"
+#include <string>
+
+void SetupLuaEnvironment(sol::state& lua) {
+    lua.open_libraries(sol::lib::base, sol::lib::package, sol::lib::string, sol::lib::os, sol::lib::io);
+    ScriptModules::Install(lua);
+    BytecodeCache::InstallSearcher(lua);
+
+    // Lua API functions
+    lua.set_function("log", [](const std::string& m) { Log::Out() << "[Lua]: " << m; });
+    lua.set_function("bind", [](int mods, int vk, sol::function cb, sol::object window, sol::this_state ts) {
+        HotkeyManager::Add(mods, vk, ScriptHost::Share(cb), WindowManager::ParseFilter(window), ScriptModules::CurrentOwner(ts));
+    });
+    lua.set_function("send", &InputManager::SimulateKeyPress);
+    lua.set_function("focus", &WindowManager::LuaFocus);
+    lua.set_function("windows", &WindowManager::LuaWindows);
+    lua.set_function("write", [](const std::string& text, sol::object options) { InputManager::WriteText(text, InputManager::ParseWriteOptions(options)); });
+    lua.set_function("wait", &CoroutineScheduler::LuaWait);
+    lua.set_function("sleep", &CoroutineScheduler::LuaSleep);
+    lua.set_function("mouse_move", &InputManager::SetMousePos);
+    lua.set_function("mouse_click", &InputManager::MouseClick);
+    lua.set_function("mouse_pos", &InputManager::GetMousePos);
+    lua.set_function("mouse_xy", &InputManager::LuaMouseXY);
+    lua.set_function("set_interval", [](int ms, sol::function cb, sol::object window, sol::optional<std::string> policy, sol::this_state ts) {
+        return TimerManager::Add(ms, ScriptHost::Share(cb), WindowManager::ParseFilter(window), TimerManager::ParsePolicy(policy.value_or("skip")),
+                                 ScriptModules::CurrentOwner(ts));
+    });
+    lua.set_function("set_timeout", [](int ms, sol::function cb, sol::object window, sol::this_state ts) {
+        return TimerManager::AddTimeout(ms, ScriptHost::Share(cb), WindowManager::ParseFilter(window), ScriptModules::CurrentOwner(ts));
+    });
+    lua.set_function("clear_timer", [](int handle, sol::this_state ts) { TimerManager::Cancel(handle, ScriptState::From(ts).name); });
+    lua.set_function("set_timing", &PrecisionClock::LuaSetTiming);
+    lua.set_function("timing_stats", &PrecisionClock::LuaTimingStats);
+    lua.set_function("stats", &Stats::LuaStats);
+    lua.set_function("stats_dump", &Stats::LuaDump);
+    lua.set_function("gc_mode", &ScriptState::LuaGcMode);
+    lua.set_function("on_key_down", [](int vk, sol::function cb, sol::object window, sol::this_state ts) {
+        InputHooks::Add(false, vk, ScriptHost::Share(cb), WindowManager::ParseFilter(window), ScriptModules::CurrentOwner(ts));
+    });
+    lua.set_function("on_key_up", [](int vk, sol::function cb, sol::object window, sol::this_state ts) {
+        InputHooks::Add(true, vk, ScriptHost::Share(cb), WindowManager::ParseFilter(window), ScriptModules::CurrentOwner(ts));
+    });
+    lua.set_function("is_pressed", &InputHooks::IsPressed);
+    lua.set_function("hotstring", [](const std::string& abbreviation, sol::object action, sol::object window, sol::optional<std::string> options,
+                                     sol::this_state ts) {
+        Hotstrings::Add(abbreviation, action, WindowManager::ParseFilter(window), Hotstrings::ParseOptions(options.value_or("")),
+                        ScriptModules::CurrentOwner(ts));
+    });
+    lua.set_function("on", [](const std::string& name, sol::function cb, sol::this_state ts) {
+        ScriptEvents::On(name, ScriptHost::Share(cb), ScriptModules::CurrentOwner(ts));
+    });
+    lua.set_function("emit", [](const std::string& name, sol::variadic_args args) {
+        // Copied out of this state so handlers in other scripts can receive them
+        ScriptArgs values;
+        values.reserve(args.size());
+        for (auto arg : args) values.push_back(ScriptValue::From(sol::object(arg)));
+        ScriptEvents::Emit(name, std::move(values));
+    });
+
+    Macro::Bind(lua);
+    InputRecorder::Bind(lua);
+    Profiler::Bind(lua);
+    Screen::Bind(lua);
+    Processes::Bind(lua);
+    ControlChannel::Bind(lua);
+    Store::Bind(lua);
+    MousePath::Bind(lua);
+    KeyCodes::Bind(lua);
+}
+
+void ResetLuaEnvironment(sol::state& lua) {
+    lua.collect_garbage();
+    SetupLuaEnvironment(lua);
+}
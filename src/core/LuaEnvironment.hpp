@@ -0,0 +1,12 @@
+#pragma once
+#include <sol/sol.hpp>
+
+// Initializes the Lua environment with all API functions
+// Sets up all exposed C++ functions and constants. This is
+// ScriptHost::environment for MoonKey and for moonkey-bench alike, so
+// benchmarks run scripts against exactly the API users get.
+void SetupLuaEnvironment(sol::state& lua);
+
+// Cleans and reinitializes the Lua environment
+// Called during hot-reload to reset the scripting environment
+void ResetLuaEnvironment(sol::state& lua);
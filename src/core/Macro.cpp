@@ -0,0 +1,323 @@
+#include "../core/Macro.hpp"
+#include "../core/CoroutineScheduler.hpp"
+#include "../core/BindingSet.hpp"
+#include "../core/ScriptState.hpp"
+#include "../core/TextInjector.hpp"
+#include "../core/PrecisionClock.hpp"
+#include "../platform/SystemTimer.hpp"
+#include "../api/InputManager.hpp"
+#include "../api/WindowManager.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+    const char* HandleMeta = "MoonKey.Macro";
+    const char* RunMeta = "MoonKey.MacroRun";
+}
+
+void CancelToken::Cancel() {
+    cancelled = true;
+}
+
+bool CancelToken::SleepUntil(Clock::time_point deadline) {
+    auto coarse = deadline - PrecisionClock::Threshold();
+    for (auto now = Clock::now(); now < coarse; now = Clock::now()) {
+        SystemTimer::SleepUntil((std::min)(coarse, now + cancelLatency));
+        if (Cancelled()) return false;
+    }
+    return PrecisionClock::SpinUntil(deadline, &cancelled);
+}
+
+std::shared_ptr<MacroProgram> Macro::Compile(const sol::table& steps, std::string& error) {
+    auto program = std::make_shared<MacroProgram>();
+    bool hasDelay = false;
+    if (!CompileSteps(steps, *program, error, hasDelay)) return nullptr;
+    return program;
+}
+
+bool Macro::CompileSteps(const sol::table& steps, MacroProgram& program, std::string& error, bool& hasDelay) {
+    size_t count = steps.size();
+    for (size_t i = 1; i <= count; ++i) {
+        sol::object entry = steps[i];
+        if (!entry.is<sol::table>()) {
+            error = "step " + std::to_string(i) + " is not a table";
+            return false;
+        }
+        sol::table step = entry.as<sol::table>();
+        std::string op = step.get_or<std::string>(1, "");
+
+        if (op == "down" || op == "up" || op == "tap") {
+            uint16_t vk = (uint16_t)step.get_or(2, 0);
+            if (op == "tap") {
+                const InputEvent tap[2] = { InputEvent::Key(vk, false), InputEvent::Key(vk, true) };
+                AddEvents(program, tap, 2);
+            } else {
+                InputEvent key = InputEvent::Key(vk, op == "up");
+                AddEvents(program, &key, 1);
+            }
+        } else if (op == "text") {
+            TextPlan plan = TextInjector::Build(TextInjector::DecodeUtf8(step.get_or<std::string>(2, "")), *InputManager::sink);
+            AddEvents(program, plan.events.data(), plan.events.size());
+        } else if (op == "move") {
+            InputEvent move = InputEvent::Move(step.get_or(2, 0), step.get_or(3, 0));
+            AddEvents(program, &move, 1);
+        } else if (op == "click" || op == "press" || op == "release") {
+            int button = step.get_or(2, 0);
+            if (op == "click") {
+                const InputEvent click[2] = { InputEvent::Button(button, false), InputEvent::Button(button, true) };
+                AddEvents(program, click, 2);
+            } else {
+                InputEvent press = InputEvent::Button(button, op == "release");
+                AddEvents(program, &press, 1);
+            }
+        } else if (op == "wait") {
+            double ms = step.get_or(2, 0.0);
+            if (!(ms >= 0)) {
+                error = "step " + std::to_string(i) + ": wait needs a non-negative duration";
+                return false;
+            }
+            program.ops.push_back({ MacroOp::Type::Delay, (uint32_t)std::llround((std::min)(ms * 1000.0, 4e9)), 0 });
+            hasDelay = true;
+        } else if (op == "loop" || op == "if_window") {
+            sol::object body = step[3];
+            if (!body.is<sol::table>()) {
+                error = "step " + std::to_string(i) + ": " + op + " needs a step list as its third element";
+                return false;
+            }
+
+            size_t head = program.ops.size();
+            if (op == "loop") {
+                sol::object times = step[2];
+                uint32_t n = MacroOp::Forever;
+                if (times.is<double>()) {
+                    double value = times.as<double>();
+                    n = std::isinf(value) ? MacroOp::Forever : (uint32_t)(std::max)(0.0, value);
+                }
+                program.ops.push_back({ MacroOp::Type::Loop, n, 0 });
+            } else {
+                program.windows.push_back(WindowManager::ParseFilter(step[2]));
+                program.ops.push_back({ MacroOp::Type::IfWindow, (uint32_t)program.windows.size() - 1, 0 });
+            }
+
+            bool bodyDelay = false;
+            if (!CompileSteps(body.as<sol::table>(), program, error, bodyDelay)) return false;
+            if (op == "loop" && program.ops[head].a == MacroOp::Forever && !bodyDelay) {
+                error = "step " + std::to_string(i) + ": an endless loop needs a wait step";
+                return false;
+            }
+            hasDelay = hasDelay || bodyDelay;
+
+            if (op == "loop") program.ops.push_back({ MacroOp::Type::EndLoop, 0, 0 });
+            program.ops[head].b = (uint32_t)program.ops.size();
+        } else {
+            error = "step " + std::to_string(i) + ": unknown action '" + op + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+void Macro::AddEvents(MacroProgram& program, const InputEvent* events, size_t count) {
+    if (count == 0) return;
+    // Extend the previous Send when nothing sits between the two
+    bool merge = !program.ops.empty() && program.ops.back().type == MacroOp::Type::Send &&
+                 program.ops.back().a + program.ops.back().b == program.events.size();
+    if (!merge) program.ops.push_back({ MacroOp::Type::Send, (uint32_t)program.events.size(), 0 });
+    program.events.insert(program.events.end(), events, events + count);
+    program.ops.back().b += (uint32_t)count;
+}
+
+std::optional<Macro::Clock::duration> Macro::Advance(MacroRun& run, InputSink& sink) {
+    const MacroProgram& program = *run.program;
+    while (run.pc < program.ops.size()) {
+        if (run.token->Cancelled()) return std::nullopt;
+
+        const MacroOp& op = program.ops[run.pc++];
+        switch (op.type) {
+            case MacroOp::Type::Send:
+                sink.Send(program.events.data() + op.a, op.b);
+                break;
+            case MacroOp::Type::Delay:
+                if (op.a == 0) break;
+                return std::chrono::microseconds(op.a);
+            case MacroOp::Type::Loop:
+                if (op.a == 0) {
+                    run.pc = op.b;
+                } else {
+                    run.loops.push_back({ run.pc, op.a });
+                }
+                break;
+            case MacroOp::Type::EndLoop: {
+                auto& frame = run.loops.back();
+                if (frame.remaining == MacroOp::Forever || --frame.remaining > 0) {
+                    run.pc = frame.start;
+                } else {
+                    run.loops.pop_back();
+                }
+                break;
+            }
+            case MacroOp::Type::IfWindow:
+                if (!program.windows[op.a].Matches(*WindowManager::ActiveWindow())) run.pc = op.b;
+                break;
+        }
+    }
+    return std::nullopt;
+}
+
+void Macro::Execute(MacroRun& run, InputSink& sink) {
+    run.deadline = Clock::now();
+    while (auto delay = Advance(run, sink)) {
+        run.deadline += *delay;
+        if (!run.token->SleepUntil(run.deadline)) break;
+        PrecisionClock::Record(run.deadline);
+    }
+    run.finished = true;
+}
+
+void Macro::Launch(std::shared_ptr<MacroRun> run) {
+    Track(run);
+    std::thread([run] { Macro::Execute(*run, *InputManager::sink); }).detach();
+}
+
+void Macro::Track(const std::shared_ptr<MacroRun>& run) {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    std::erase_if(active, [](const std::weak_ptr<MacroRun>& r) { return r.expired(); });
+    active.push_back(run);
+}
+
+void Macro::CancelAll() {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    for (auto& weak : active) {
+        if (auto run = weak.lock()) run->token->Cancel();
+    }
+    active.clear();
+}
+
+void Macro::CancelScript(const std::string& script) {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    std::erase_if(active, [&](const std::weak_ptr<MacroRun>& weak) {
+        auto run = weak.lock();
+        if (!run) return true;
+        if (run->script != script) return false;
+        run->token->Cancel();
+        return true;
+    });
+}
+
+void Macro::Bind(sol::state& lua) {
+    lua_State* L = lua.lua_state();
+
+    static const luaL_Reg methods[] = {
+        { "run", &Macro::LuaRun },
+        { "cancel", &Macro::LuaCancel },
+        { "running", &Macro::LuaRunning },
+        { nullptr, nullptr },
+    };
+    luaL_newmetatable(L, HandleMeta);
+    lua_createtable(L, 0, 3);
+    luaL_setfuncs(L, methods, 0);
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, &Macro::LuaGc);
+    lua_setfield(L, -2, "__gc");
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, RunMeta);
+    lua_pushcfunction(L, &Macro::LuaRunGc);
+    lua_setfield(L, -2, "__gc");
+    lua_pop(L, 1);
+
+    auto macro = lua.create_table();
+    macro.set_function("compile", [](sol::table steps, sol::this_state ts) -> sol::object {
+        std::string error;
+        auto program = Compile(steps, error);
+        if (!program) throw sol::error("macro.compile: " + error);
+
+        lua_State* L = ts;
+        PushHandle(L, std::move(program));
+        sol::object handle(L, -1);
+        lua_pop(L, 1);
+        return handle;
+    });
+    lua["macro"] = macro;
+}
+
+void Macro::PushHandle(lua_State* L, std::shared_ptr<const MacroProgram> program) {
+    void* memory = lua_newuserdatauv(L, sizeof(Handle), 0);
+    new (memory) Handle{ std::move(program), nullptr };
+    luaL_setmetatable(L, HandleMeta);
+}
+
+int Macro::LuaRun(lua_State* L) {
+    auto* handle = static_cast<Handle*>(luaL_checkudata(L, 1, HandleMeta));
+    bool threaded = false;
+    if (lua_istable(L, 2)) {
+        lua_getfield(L, 2, "thread");
+        threaded = lua_toboolean(L, -1);
+        lua_pop(L, 1);
+    }
+
+    auto run = std::make_shared<MacroRun>();
+    run->program = handle->program;
+    run->script = ScriptState::From(L).name;
+    handle->current = run;
+
+    if (threaded) {
+        if (BindingSet::staging) {
+            // Started by a script that is still loading; goes live with its bindings
+            BindingSet::staging->macros.push_back(run);
+        } else {
+            Launch(run);
+        }
+        return 0;
+    }
+    if (!CoroutineScheduler::CanYield(L)) {
+        // Top level of a script: nothing else to run meanwhile, so just block
+        Track(run);
+        Execute(*run, *InputManager::sink);
+        return 0;
+    }
+
+    // Keep the run alive on this coroutine's stack while it is suspended
+    Track(run);
+    lua_settop(L, 1);
+    void* memory = lua_newuserdatauv(L, sizeof(std::shared_ptr<MacroRun>), 0);
+    new (memory) std::shared_ptr<MacroRun>(run);
+    luaL_setmetatable(L, RunMeta);
+    run->deadline = CoroutineScheduler::Now();
+    return LuaContinue(L, LUA_OK, lua_gettop(L));
+}
+
+int Macro::LuaContinue(lua_State* L, int, lua_KContext ctx) {
+    auto& run = *static_cast<std::shared_ptr<MacroRun>*>(lua_touserdata(L, (int)ctx));
+    auto delay = Advance(*run, *InputManager::sink);
+    if (!delay) {
+        run->finished = true;
+        return 0;
+    }
+    run->deadline += *delay;
+    auto remaining = (std::max)(run->deadline - CoroutineScheduler::Now(), Clock::duration::zero());
+    return CoroutineScheduler::YieldFor(L, remaining, ctx, &Macro::LuaContinue);
+}
+
+int Macro::LuaCancel(lua_State* L) {
+    auto* handle = static_cast<Handle*>(luaL_checkudata(L, 1, HandleMeta));
+    if (handle->current) handle->current->token->Cancel();
+    return 0;
+}
+
+int Macro::LuaRunning(lua_State* L) {
+    auto* handle = static_cast<Handle*>(luaL_checkudata(L, 1, HandleMeta));
+    lua_pushboolean(L, handle->current && !handle->current->finished);
+    return 1;
+}
+
+int Macro::LuaGc(lua_State* L) {
+    static_cast<Handle*>(lua_touserdata(L, 1))->~Handle();
+    return 0;
+}
+
+int Macro::LuaRunGc(lua_State* L) {
+    static_cast<std::shared_ptr<MacroRun>*>(lua_touserdata(L, 1))->~shared_ptr();
+    return 0;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../platform/InputSink.hpp"
+#include "../utils/WindowMatcher.hpp"
+
+// One instruction of a compiled macro
+struct MacroOp {
+    enum class Type : uint8_t {
+        Send,                     // Submit events[a .. a + b) as one batch
+        Delay,                    // Wait a microseconds
+        Loop,                     // Repeat the body a times (Forever = until cancelled); b = index after EndLoop
+        EndLoop,                  // Jump back to the body start of the innermost Loop
+        IfWindow                  // Skip to b unless windows[a] matches the active window
+    };
+    static constexpr uint32_t Forever = 0xFFFFFFFF;
+
+    Type type;
+    uint32_t a = 0;
+    uint32_t b = 0;
+};
+
+// Compiled macro: a flat instruction buffer plus the data it refers to
+// Adjacent input steps are merged into one Send, and text is converted to
+// key events at compile time, so running a macro makes no Lua calls and no
+// allocations
+struct MacroProgram {
+    std::vector<MacroOp> ops;
+    std::vector<InputEvent> events;     // Input of every Send op, in order
+    std::vector<WindowMatcher> windows; // Conditions of IfWindow ops
+};
+
+// Cancellation flag shared between a running macro and whoever may stop it
+struct CancelToken {
+    using Clock = std::chrono::steady_clock;
+
+    void Cancel();
+    bool Cancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    // Sleeps until deadline unless cancelled first
+    // Uses the precision clock, sleeping in slices so a cancel is noticed
+    // within cancelLatency
+    // Returns false if the token was cancelled
+    bool SleepUntil(Clock::time_point deadline);
+
+    static inline Clock::duration cancelLatency = std::chrono::milliseconds(10); // Longest uninterrupted sleep
+
+private:
+    std::atomic<bool> cancelled = false;
+};
+
+// State of one run of a macro
+struct MacroRun {
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+        uint32_t start;           // First op of the loop body
+        uint32_t remaining;       // Iterations left, or MacroOp::Forever
+    };
+
+    std::shared_ptr<const MacroProgram> program;
+    std::shared_ptr<CancelToken> token = std::make_shared<CancelToken>();
+    uint32_t pc = 0;
+    std::vector<Frame> loops;
+    Clock::time_point deadline;   // Schedule of the next step; delays add to it, so timing does not drift
+    std::atomic<bool> finished = false;
+    std::string script;           // Script that started the run
+};
+
+// Compiles and runs macros
+// Lua:
+//   local m = macro.compile{ {"down", KEY.W}, {"wait", 50}, {"up", KEY.W} }
+//   m:run()                -- inline; yields between steps inside callbacks
+//   m:run{ thread = true } -- on a dedicated thread; returns immediately
+//   m:cancel()  m:running()
+struct Macro {
+    using Clock = std::chrono::steady_clock;
+
+    // Builds a program from a Lua step list
+    // steps: Array of steps, see docs/api-reference.md
+    // error: Set to a description of the first invalid step
+    // Returns nullptr if the list is invalid
+    static std::shared_ptr<MacroProgram> Compile(const sol::table& steps, std::string& error);
+
+    // Executes ops until the next delay or the end
+    // Returns the delay to wait before calling again, or nullopt when the
+    // program ended or the run was cancelled
+    static std::optional<Clock::duration> Advance(MacroRun& run, InputSink& sink);
+
+    // Runs a program to completion on the calling thread
+    static void Execute(MacroRun& run, InputSink& sink);
+
+    // Starts a run on its own thread
+    static void Launch(std::shared_ptr<MacroRun> run);
+
+    // Cancels every running macro
+    // Used during script reload so threaded macros do not outlive their script
+    static void CancelAll();
+
+    // Cancels the running macros started by one script
+    // Used when that script is reloaded or unloaded
+    static void CancelScript(const std::string& script);
+
+    // Creates the Lua `macro` table
+    static void Bind(sol::state& lua);
+
+    // Pushes a macro object for a program, as returned by macro.compile
+    static void PushHandle(lua_State* L, std::shared_ptr<const MacroProgram> program);
+
+    // Lua binding m:run([options]); expects the macro object at index 1
+    // Also used by generators such as mouse_path that run what they compile
+    static int LuaRun(lua_State* L);
+
+private:
+    static bool CompileSteps(const sol::table& steps, MacroProgram& program, std::string& error, bool& hasDelay);
+    static void AddEvents(MacroProgram& program, const InputEvent* events, size_t count);
+    static void Track(const std::shared_ptr<MacroRun>& run);
+
+    // Lua glue; a compiled macro is a full userdata holding a Handle
+    struct Handle {
+        std::shared_ptr<const MacroProgram> program;
+        std::shared_ptr<MacroRun> current;  // Latest run
+    };
+    static int LuaContinue(lua_State* L, int status, lua_KContext ctx);
+    static int LuaCancel(lua_State* L);
+    static int LuaRunning(lua_State* L);
+    static int LuaGc(lua_State* L);
+    static int LuaRunGc(lua_State* L);
+
+    static inline std::mutex activeMutex;
+    static inline std::vector<std::weak_ptr<MacroRun>> active;  // Runs CancelAll() reaches
+};
@@ -0,0 +1,239 @@
+#include "../core/MousePath.hpp"
+#include "../api/InputManager.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    double Ease(PathSpec::Ease ease, double t) {
+        switch (ease) {
+            case PathSpec::Ease::In:    return t * t;
+            case PathSpec::Ease::Out:   return 1 - (1 - t) * (1 - t);
+            case PathSpec::Ease::InOut: return t < 0.5 ? 4 * t * t * t : 1 - std::pow(2 - 2 * t, 3) / 2;
+            default:                    return t;
+        }
+    }
+
+    // Reads {x, y} or {x = .., y = ..}
+    bool ReadPoint(const sol::object& value, PathSpec::Point& point) {
+        if (!value.is<sol::table>()) return false;
+        sol::table t = value.as<sol::table>();
+        sol::optional<double> x = t["x"], y = t["y"];
+        if (!x) x = t.get<sol::optional<double>>(1);
+        if (!y) y = t.get<sol::optional<double>>(2);
+        if (!x || !y) return false;
+        point = { *x, *y };
+        return true;
+    }
+}
+
+std::vector<PathSample> MousePath::Generate(const PathSpec& spec) {
+    std::vector<PathSample> samples;
+    if (spec.points.empty()) return samples;
+
+    const auto& start = spec.points.front();
+    int lastX = (int)std::lround(start.x);
+    int lastY = (int)std::lround(start.y);
+    if (spec.jump) samples.push_back({ 0, lastX, lastY });
+
+    // Cumulative segment lengths for constant-speed polylines
+    std::vector<double> lengths(spec.points.size(), 0.0);
+    for (size_t i = 1; i < spec.points.size(); ++i) {
+        lengths[i] = lengths[i - 1] + std::hypot(spec.points[i].x - spec.points[i - 1].x, spec.points[i].y - spec.points[i - 1].y);
+    }
+
+    double micros = (std::max)(spec.duration, 0.0) * 1000.0;
+    size_t count = (std::max)((size_t)std::ceil(micros / 1e6 * spec.rate), (size_t)1);
+    std::vector<PathSpec::Point> scratch;
+    for (size_t i = 1; i <= count; ++i) {
+        double progress = (double)i / count;
+        auto point = Evaluate(spec, lengths, Ease(spec.ease, progress), scratch);
+        int x = (int)std::lround(point.x);
+        int y = (int)std::lround(point.y);
+        if (x == lastX && y == lastY && i != count) continue;
+        samples.push_back({ (uint32_t)std::llround(micros * progress), x, y });
+        lastX = x;
+        lastY = y;
+    }
+    return samples;
+}
+
+PathSpec::Point MousePath::Evaluate(const PathSpec& spec, const std::vector<double>& lengths, double t,
+                                    std::vector<PathSpec::Point>& scratch) {
+    const auto& points = spec.points;
+    if (points.size() == 1) return points.front();
+
+    if (spec.curve == PathSpec::Curve::Bezier) {
+        // de Casteljau: repeated linear interpolation between the control points
+        scratch.assign(points.begin(), points.end());
+        for (size_t level = scratch.size() - 1; level > 0; --level) {
+            for (size_t i = 0; i < level; ++i) {
+                scratch[i].x += (scratch[i + 1].x - scratch[i].x) * t;
+                scratch[i].y += (scratch[i + 1].y - scratch[i].y) * t;
+            }
+        }
+        return scratch.front();
+    }
+
+    double target = std::clamp(t, 0.0, 1.0) * lengths.back();
+    if (lengths.back() <= 0) return points.back();
+    size_t segment = (size_t)(std::upper_bound(lengths.begin(), lengths.end(), target) - lengths.begin());
+    segment = std::clamp(segment, (size_t)1, points.size() - 1);
+    double span = lengths[segment] - lengths[segment - 1];
+    double f = span > 0 ? (target - lengths[segment - 1]) / span : 1.0;
+    const auto& a = points[segment - 1];
+    const auto& b = points[segment];
+    return { a.x + (b.x - a.x) * f, a.y + (b.y - a.y) * f };
+}
+
+std::shared_ptr<MacroProgram> MousePath::Compile(const std::vector<PathSample>& samples) {
+    auto program = std::make_shared<MacroProgram>();
+    program->ops.reserve(samples.size() * 2);
+    program->events.reserve(samples.size());
+    uint32_t at = 0;
+    for (const auto& sample : samples) {
+        if (sample.time > at) {
+            program->ops.push_back({ MacroOp::Type::Delay, sample.time - at, 0 });
+            at = sample.time;
+        }
+        program->ops.push_back({ MacroOp::Type::Send, (uint32_t)program->events.size(), 1 });
+        program->events.push_back(InputEvent::Move(sample.x, sample.y));
+    }
+    return program;
+}
+
+bool MousePath::Parse(const sol::object& path, const sol::object& options, InputSink& sink,
+                      PathSpec& spec, bool& threaded, std::string& error) {
+    if (!path.is<sol::table>()) {
+        error = "expects a point list or a table with 'to'";
+        return false;
+    }
+    sol::table args = path.as<sol::table>();
+    sol::object target = args["to"];
+    bool toForm = target.valid();
+    // The `to` form carries its options in the same table
+    sol::table opts = !toForm && options.is<sol::table>() ? options.as<sol::table>() : args;
+
+    spec = {};
+    PathSpec::Point start;
+    sol::object from = opts["from"];
+    if (from.valid()) {
+        if (!ReadPoint(from, start)) {
+            error = "'from' must be a point {x, y}";
+            return false;
+        }
+        spec.jump = true;
+    } else {
+        int x = 0, y = 0;
+        sink.GetCursorPos(x, y);
+        start = { (double)x, (double)y };
+    }
+    spec.points.push_back(start);
+
+    // Point list: every entry; `to` form: the via points, then the target
+    sol::table list = args;
+    if (toForm) {
+        sol::object via = args["via"];
+        if (via.valid() && !via.is<sol::table>()) {
+            error = "'via' must be a point list";
+            return false;
+        }
+        list = via.valid() ? via.as<sol::table>() : sol::table();
+    }
+    if (list.valid()) {
+        for (size_t i = 1; i <= list.size(); ++i) {
+            PathSpec::Point point;
+            if (!ReadPoint(list[i], point)) {
+                error = "point " + std::to_string(i) + " must be {x, y}";
+                return false;
+            }
+            spec.points.push_back(point);
+        }
+    }
+    if (toForm) {
+        PathSpec::Point end;
+        if (!ReadPoint(target, end)) {
+            error = "'to' must be a point {x, y}";
+            return false;
+        }
+        spec.points.push_back(end);
+    }
+    if (spec.points.size() < 2) {
+        error = "needs at least one point to move to";
+        return false;
+    }
+
+    std::string curve = opts.get_or<std::string>("curve", "linear");
+    if (curve == "bezier") {
+        spec.curve = PathSpec::Curve::Bezier;
+    } else if (curve == "ease") {
+        spec.ease = PathSpec::Ease::InOut;
+    } else if (curve != "linear") {
+        error = "unknown curve '" + curve + "'";
+        return false;
+    }
+    if (auto ease = opts.get<sol::optional<std::string>>("ease")) {
+        if (*ease == "in") spec.ease = PathSpec::Ease::In;
+        else if (*ease == "out") spec.ease = PathSpec::Ease::Out;
+        else if (*ease == "inout" || *ease == "in_out") spec.ease = PathSpec::Ease::InOut;
+        else if (*ease == "none") spec.ease = PathSpec::Ease::None;
+        else {
+            error = "unknown ease '" + *ease + "'";
+            return false;
+        }
+    }
+
+    spec.duration = opts.get_or("duration", defaultDuration);
+    spec.rate = opts.get_or("rate", defaultRate);
+    if (!(spec.duration >= 0) || !(spec.rate > 0)) {
+        error = "duration must be >= 0 and rate > 0";
+        return false;
+    }
+    // Keeps sample times within 32-bit microseconds
+    spec.duration = (std::min)(spec.duration, 3600000.0);
+    spec.rate = (std::min)(spec.rate, maxRate);
+    threaded = opts.get_or("thread", false);
+
+    // A Bezier between just two points bows sideways through two generated control points
+    if (spec.curve == PathSpec::Curve::Bezier && spec.points.size() == 2) {
+        double bend = opts.get_or("bend", defaultBend);
+        auto a = spec.points[0];
+        auto b = spec.points[1];
+        double nx = -(b.y - a.y) * bend;
+        double ny = (b.x - a.x) * bend;
+        spec.points.insert(spec.points.begin() + 1, { { a.x + (b.x - a.x) / 3 + nx, a.y + (b.y - a.y) / 3 + ny },
+                                                      { a.x + (b.x - a.x) * 2 / 3 + nx, a.y + (b.y - a.y) * 2 / 3 + ny } });
+    }
+    return true;
+}
+
+void MousePath::Bind(sol::state& lua) {
+    lua.set_function("mouse_path", &MousePath::LuaMousePath);
+}
+
+std::shared_ptr<MacroProgram> MousePath::Prepare(lua_State* L, bool& threaded) {
+    PathSpec spec;
+    std::string error;
+    if (!Parse(sol::object(L, 1), sol::object(L, 2), *InputManager::sink, spec, threaded, error)) {
+        lua_pushstring(L, ("mouse_path: " + error).c_str());
+        return nullptr;
+    }
+    return Compile(Generate(spec));
+}
+
+int MousePath::LuaMousePath(lua_State* L) {
+    bool threaded = false;
+    auto program = Prepare(L, threaded);
+    if (!program) return lua_error(L);
+
+    // Run it exactly like m:run{ thread = threaded } on a fresh macro object
+    lua_settop(L, 0);
+    Macro::PushHandle(L, std::move(program));
+    lua_createtable(L, 0, 1);
+    lua_pushboolean(L, threaded);
+    lua_setfield(L, -2, "thread");
+    if (!threaded) return Macro::LuaRun(L);
+
+    Macro::LuaRun(L);
+    lua_settop(L, 1);
+    return 1;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../core/Macro.hpp"
+#include "../platform/InputSink.hpp"
+
+// Shape and timing of a generated cursor movement
+struct PathSpec {
+    enum class Curve {
+        Linear,                   // Straight segments through the points at constant speed
+        Bezier                    // One Bezier curve; points between start and end are control points
+    };
+    enum class Ease {
+        None,                     // Constant pace
+        In,                       // Accelerate from rest
+        Out,                      // Decelerate to rest
+        InOut                     // Accelerate, then decelerate
+    };
+    struct Point {
+        double x;
+        double y;
+    };
+
+    std::vector<Point> points;    // Start first, end last, in virtual-desktop pixels
+    Curve curve = Curve::Linear;
+    Ease ease = Ease::None;
+    double duration = 0;          // Milliseconds from start to end
+    double rate = 0;              // Samples per second
+    bool jump = false;            // Move to the start point first instead of starting from the cursor
+};
+
+// One cursor position of a trajectory
+struct PathSample {
+    uint32_t time;                // Microseconds since the movement started
+    int x;                        // Virtual-desktop pixels
+    int y;
+};
+
+// Generates cursor trajectories natively and runs them on the macro engine
+// A path is sampled once into timestamped positions and compiled into a
+// MacroProgram of single-move Sends separated by Delays, so playback gets
+// the macro engine's drift-free precision timing, coroutine-friendly inline
+// runs, threaded runs and cancellation, with no Lua calls per step.
+// Lua:
+//   mouse_path{ to = {800, 600}, curve = "bezier", duration = 300 }
+//   mouse_path({ {100, 100}, {400, 120}, {420, 500} }, { duration = 500, ease = "inout" })
+//   local m = mouse_path{ to = {0, 0}, duration = 2000, thread = true }  m:cancel()
+struct MousePath {
+    static inline double defaultDuration = 200;  // Milliseconds
+    static inline double defaultRate = 250;      // Samples per second
+    static inline double maxRate = 1000;
+    static inline double defaultBend = 0.2;      // Bezier bow without control points, as a fraction of the distance
+
+    // Samples a path at spec.rate
+    // Samples that land on the same pixel as the previous one are dropped;
+    // the end point is always included
+    static std::vector<PathSample> Generate(const PathSpec& spec);
+
+    // Converts samples into a program that moves the cursor at their timestamps
+    static std::shared_ptr<MacroProgram> Compile(const std::vector<PathSample>& samples);
+
+    // Reads mouse_path arguments
+    // path: Point list, or a table with `to` (plus `via` control points) and options
+    // options: Option table for the point-list form
+    // sink: Supplies the cursor position the path starts from unless `from` is given
+    // Returns false with error set if the arguments are invalid
+    static bool Parse(const sol::object& path, const sol::object& options, InputSink& sink,
+                      PathSpec& spec, bool& threaded, std::string& error);
+
+    // Registers mouse_path
+    static void Bind(sol::state& lua);
+
+private:
+    // Position on the path at progress t (0-1), after easing
+    static PathSpec::Point Evaluate(const PathSpec& spec, const std::vector<double>& lengths, double t,
+                                    std::vector<PathSpec::Point>& scratch);
+
+    // Parses and compiles the arguments at stack indexes 1 and 2
+    // On failure leaves an error message on the stack and returns nullptr
+    static std::shared_ptr<MacroProgram> Prepare(lua_State* L, bool& threaded);
+
+    static int LuaMousePath(lua_State* L);
+};
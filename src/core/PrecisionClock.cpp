@@ -0,0 +1,56 @@
+#include "../core/PrecisionClock.hpp"
+#include "../platform/SystemTimer.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <thread>
+
+void PrecisionClock::SleepUntil(Clock::time_point deadline) {
+    auto coarse = deadline - Threshold();
+    if (Clock::now() < coarse) SystemTimer::SleepUntil(coarse);
+    SpinUntil(deadline);
+}
+
+bool PrecisionClock::SpinUntil(Clock::time_point deadline, const std::atomic<bool>* cancel) {
+    return SpinUntil(deadline, [cancel] { return cancel && cancel->load(std::memory_order_relaxed); });
+}
+
+bool PrecisionClock::SpinUntil(Clock::time_point deadline, const std::function<bool()>& stop) {
+    SpinMode current = mode.load(std::memory_order_relaxed);
+    if (current == SpinMode::Sleep) {
+        if (Clock::now() < deadline) SystemTimer::SleepUntil(deadline);
+        return !stop();
+    }
+    while (Clock::now() < deadline) {
+        if (stop()) return false;
+        if (current == SpinMode::Yield) std::this_thread::yield();
+    }
+    return !stop();
+}
+
+SpinMode PrecisionClock::ParseMode(const std::string& name) {
+    if (name == "spin") return SpinMode::Spin;
+    if (name == "yield") return SpinMode::Yield;
+    if (name == "sleep") return SpinMode::Sleep;
+    Log::Err() << "[Error] Unknown spin mode '" << name << "', using yield";
+    return SpinMode::Yield;
+}
+
+void PrecisionClock::LuaSetTiming(sol::table options) {
+    if (auto spin = options.get<sol::optional<double>>("spin")) {
+        auto threshold = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>((std::max)(0.0, *spin)));
+        spinThreshold = threshold.count();
+    }
+    if (auto name = options.get<sol::optional<std::string>>("mode")) mode = ParseMode(*name);
+}
+
+sol::table PrecisionClock::LuaTimingStats(sol::optional<bool> reset, sol::this_state ts) {
+    sol::state_view lua(ts);
+    sol::table stats = lua.create_table();
+    stats["count"] = lateness.Count();
+    stats["mean"] = lateness.Mean() / 1000.0;
+    stats["p50"] = lateness.Percentile(0.50) / 1000.0;
+    stats["p99"] = lateness.Percentile(0.99) / 1000.0;
+    stats["max"] = lateness.Max() / 1000.0;
+    if (reset.value_or(false)) lateness.Reset();
+    return stats;
+}
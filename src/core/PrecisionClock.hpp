@@ -0,0 +1,63 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include "../utils/Histogram.hpp"
+
+// How the last stretch before a deadline is spent
+enum class SpinMode {
+    Spin,                         // Busy-wait; most precise, burns a core for spinThreshold
+    Yield,                        // Busy-wait with yields between clock reads
+    Sleep                         // No spinning; OS timer precision only
+};
+
+// Precision timing service
+// Sleeps with the OS timer until spinThreshold before the deadline, then
+// spins or yields up to the exact target. spinThreshold is the CPU budget
+// knob: it bounds how long a wait can keep a core busy. Every piece of
+// scheduled work (coroutine resumes, timer callbacks, macro steps) records
+// how late it actually ran in a histogram that scripts can query.
+struct PrecisionClock {
+    using Clock = std::chrono::steady_clock;
+
+    static inline std::atomic<Clock::duration::rep> spinThreshold =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(1000)).count(); // Busy tail length
+    static inline std::atomic<SpinMode> mode = SpinMode::Yield;
+    static inline Histogram lateness;             // Microseconds past the deadline
+
+    // Blocks the calling thread until deadline
+    static void SleepUntil(Clock::time_point deadline);
+
+    // Busy-waits until deadline unless *cancel becomes true
+    // Returns false if cancelled
+    static bool SpinUntil(Clock::time_point deadline, const std::atomic<bool>* cancel = nullptr);
+
+    // Busy-waits until deadline unless stop() returns true
+    // stop is checked between clock reads, so it must be cheap
+    // Returns false if stopped
+    static bool SpinUntil(Clock::time_point deadline, const std::function<bool()>& stop);
+
+    // Time before a deadline at which the OS sleep should end
+    static Clock::duration Threshold() {
+        if (mode.load(std::memory_order_relaxed) == SpinMode::Sleep) return Clock::duration::zero();
+        return Clock::duration(spinThreshold.load(std::memory_order_relaxed));
+    }
+
+    // Records how late work scheduled for deadline ran
+    static void Record(Clock::time_point deadline, Clock::time_point now = Clock::now()) {
+        auto late = std::chrono::duration_cast<std::chrono::microseconds>(now - deadline).count();
+        lateness.Record(late > 0 ? (uint64_t)late : 0);
+    }
+
+    // Parse a spin mode name ("spin", "yield", "sleep")
+    static SpinMode ParseMode(const std::string& name);
+
+    // Lua binding: set_timing{ spin = ms, mode = "spin" | "yield" | "sleep" }
+    static void LuaSetTiming(sol::table options);
+
+    // Lua binding: timing_stats([reset])
+    // Returns: { count, mean, p50, p99, max } lateness in milliseconds
+    static sol::table LuaTimingStats(sol::optional<bool> reset, sol::this_state ts);
+};
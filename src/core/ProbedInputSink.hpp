@@ -0,0 +1,32 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <utility>
+#include "../platform/InputSink.hpp"
+#include "../core/Stats.hpp"
+
+// InputSink decorator that times every Send batch
+// Forwards everything to the wrapped sink; a batch the OS only partly
+// accepted counts as an error
+class ProbedInputSink : public InputSink {
+public:
+    ProbedInputSink(std::unique_ptr<InputSink> inner, Probe& probe) : inner(std::move(inner)), probe(probe) {}
+
+    size_t Send(const InputEvent* events, size_t count) override {
+        auto start = Probe::Clock::now();
+        size_t sent = inner->Send(events, count);
+        probe.Record(Probe::Clock::now() - start, sent < count);
+        return sent;
+    }
+
+    bool MapChar(char16_t c, uint16_t& vk, bool& shift) override { return inner->MapChar(c, vk, shift); }
+    char16_t KeyChar(uint16_t vk, bool shift) override { return inner->KeyChar(vk, shift); }
+    bool SetClipboardText(const std::u16string& text) override { return inner->SetClipboardText(text); }
+    std::optional<std::u16string> GetClipboardText() override { return inner->GetClipboardText(); }
+    void GetCursorPos(int& x, int& y) override { inner->GetCursorPos(x, y); }
+    void DisplayChanged() override { inner->DisplayChanged(); }
+
+private:
+    std::unique_ptr<InputSink> inner;
+    Probe& probe;
+};
@@ -0,0 +1,260 @@
+#include "../core/Processes.hpp"
+#include "../core/CoroutineScheduler.hpp"
+#include "../core/ScriptState.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <string_view>
+#include <thread>
+
+namespace {
+    const char* ProcessMeta = "MoonKey.Process";
+
+    std::shared_ptr<ProcessRun>& CheckHandle(lua_State* L) {
+        return *static_cast<std::shared_ptr<ProcessRun>*>(luaL_checkudata(L, 1, ProcessMeta));
+    }
+}
+
+void Processes::Start() {
+    std::call_once(started, [] {
+        std::thread([] {
+            launcher->Run({ &Processes::OnOutput, &Processes::OnExit });
+        }).detach();
+    });
+}
+
+std::shared_ptr<ProcessRun> Processes::Spawn(lua_State* L, const std::string& command, const sol::optional<sol::table>& options,
+                                             std::string& error) {
+    ProcessLauncher::Options launch;
+    launch.command = command;
+    auto run = std::make_shared<ProcessRun>();
+    run->id = nextId++;
+    run->state = &ScriptState::From(L);
+
+    if (options) {
+        const sol::table& table = *options;
+        if (auto fn = table.get<sol::optional<sol::function>>("on_stdout")) run->onStdout = ScriptHost::Share(*fn);
+        if (auto fn = table.get<sol::optional<sol::function>>("on_stderr")) run->onStderr = ScriptHost::Share(*fn);
+        if (auto fn = table.get<sol::optional<sol::function>>("on_exit")) run->onExit = ScriptHost::Share(*fn);
+        launch.cwd = table.get_or<std::string>("cwd", "");
+        if (auto env = table.get<sol::optional<sol::table>>("env")) {
+            for (const auto& [key, value] : *env) {
+                if (!key.is<std::string>() || !value.is<std::string>()) {
+                    error = "env entries must be strings";
+                    return nullptr;
+                }
+                launch.env.emplace_back(key.as<std::string>(), value.as<std::string>());
+            }
+        }
+    }
+
+    Start();
+    {
+        // Registered first: output can arrive before Launch returns
+        std::lock_guard<std::mutex> lock(runsMutex);
+        runs[run->id] = run;
+    }
+    if (!launcher->Launch(run->id, launch, error)) {
+        std::lock_guard<std::mutex> lock(runsMutex);
+        runs.erase(run->id);
+        return nullptr;
+    }
+    return run;
+}
+
+void Processes::CancelState(const ScriptState& state) {
+    std::lock_guard<std::mutex> lock(runsMutex);
+    for (auto& [id, run] : runs) {
+        if (run->state != &state) continue;
+        run->cancelled = true;
+        launcher->Kill(id);
+        // A paused child would never be read to the end
+        launcher->Resume(id);
+    }
+}
+
+std::shared_ptr<ProcessRun> Processes::Find(uint64_t id) {
+    std::lock_guard<std::mutex> lock(runsMutex);
+    auto it = runs.find(id);
+    return it == runs.end() ? nullptr : it->second;
+}
+
+bool Processes::OnOutput(uint64_t id, ProcessLauncher::Stream stream, const char* data, size_t size) {
+    auto run = Find(id);
+    if (!run || run->cancelled) return true;
+    int index = stream == ProcessLauncher::Stream::Stdout ? 0 : 1;
+    const ScriptFunction& fn = index == 0 ? run->onStdout : run->onStderr;
+    if (!fn) return true;
+
+    // Only complete lines go out; the tail waits for the next read
+    std::string& partial = run->partial[index];
+    size_t last = std::string_view(data, size).rfind('\n');
+    if (last == std::string_view::npos) {
+        partial.append(data, size);
+        if (partial.size() < maxLine) return true;
+        Deliver(run, fn, std::move(partial));
+        partial.clear();
+    } else {
+        std::string block = std::move(partial);
+        block.append(data, last);
+        partial.assign(data + last + 1, size - last - 1);
+        Deliver(run, fn, std::move(block));
+    }
+
+    if (run->queued.load(std::memory_order_relaxed) < maxQueued || run->unthrottled) return true;
+    // The worker resumes reading once it has caught up; check again in case
+    // it already did between the load above and the flag
+    run->paused = true;
+    if (run->queued.load() < maxQueued / 2 && run->paused.exchange(false)) return true;
+    return false;
+}
+
+void Processes::OnExit(uint64_t id, int code) {
+    std::shared_ptr<ProcessRun> run;
+    {
+        std::lock_guard<std::mutex> lock(runsMutex);
+        auto it = runs.find(id);
+        if (it == runs.end()) return;
+        run = std::move(it->second);
+        runs.erase(it);
+    }
+    if (!run->cancelled) {
+        // Output without a final newline still counts as a line
+        if (!run->partial[0].empty()) Deliver(run, run->onStdout, std::move(run->partial[0]));
+        if (!run->partial[1].empty()) Deliver(run, run->onStderr, std::move(run->partial[1]));
+        if (run->onExit) ScriptHost::Call(run->onExit, nullptr, code);
+    }
+    {
+        std::lock_guard<std::mutex> lock(run->mutex);
+        run->code = code;
+        run->finished = true;
+    }
+    run->done.notify_all();
+}
+
+void Processes::Deliver(const std::shared_ptr<ProcessRun>& run, const ScriptFunction& fn, std::string block) {
+    size_t size = block.size();
+    run->queued.fetch_add(size, std::memory_order_relaxed);
+    ScriptHost::Run(fn, [run, fn, block = std::move(block), size] {
+        lua_State* L = fn->lua_state();
+        PushLines(L, block);
+        sol::table lines(L, -1);
+        lua_pop(L, 1);
+        CoroutineScheduler::Spawn(*fn, lines);
+
+        size_t left = run->queued.fetch_sub(size) - size;
+        if (left < maxQueued / 2 && run->paused.exchange(false)) launcher->Resume(run->id);
+    });
+}
+
+void Processes::PushLines(lua_State* L, const std::string& block) {
+    int count = (int)std::count(block.begin(), block.end(), '\n') + 1;
+    lua_createtable(L, count, 0);
+    size_t start = 0;
+    for (int i = 1; i <= count; ++i) {
+        size_t end = block.find('\n', start);
+        if (end == std::string::npos) end = block.size();
+        size_t length = end - start;
+        if (length > 0 && block[start + length - 1] == '\r') --length;
+        lua_pushlstring(L, block.data() + start, length);
+        lua_rawseti(L, -2, i);
+        start = end + 1;
+    }
+}
+
+void Processes::Bind(sol::state& lua) {
+    lua_State* L = lua.lua_state();
+
+    static const luaL_Reg methods[] = {
+        { "kill", &Processes::LuaKill },
+        { "wait", &Processes::LuaWait },
+        { "running", &Processes::LuaRunning },
+        { nullptr, nullptr },
+    };
+    luaL_newmetatable(L, ProcessMeta);
+    lua_createtable(L, 0, 3);
+    luaL_setfuncs(L, methods, 0);
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, &Processes::LuaGc);
+    lua_setfield(L, -2, "__gc");
+    lua_pop(L, 1);
+
+    lua.set_function("spawn", [](const std::string& command, sol::optional<sol::table> options, sol::this_state ts) -> sol::object {
+        std::string error;
+        auto run = Spawn(ts, command, options, error);
+        if (!run) throw sol::error("spawn: " + error);
+
+        lua_State* L = ts;
+        void* memory = lua_newuserdatauv(L, sizeof(std::shared_ptr<ProcessRun>), 0);
+        new (memory) std::shared_ptr<ProcessRun>(std::move(run));
+        luaL_setmetatable(L, ProcessMeta);
+        sol::object handle(L, -1);
+        lua_pop(L, 1);
+        return handle;
+    });
+}
+
+int Processes::LuaKill(lua_State* L) {
+    auto& run = CheckHandle(L);
+    if (!run->finished) launcher->Kill(run->id);
+    return 0;
+}
+
+int Processes::LuaRunning(lua_State* L) {
+    auto& run = CheckHandle(L);
+    lua_pushboolean(L, !run->finished);
+    return 1;
+}
+
+int Processes::LuaWait(lua_State* L) {
+    CheckHandle(L);
+    lua_Integer deadline = -1;
+    if (!lua_isnoneornil(L, 2)) {
+        auto timeout = std::chrono::duration<double>((std::max)(0.0, (double)luaL_checknumber(L, 2)));
+        deadline = (Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout)).time_since_epoch().count();
+    }
+    // The handle and the deadline stay on the stack across yields
+    lua_settop(L, 2);
+    lua_pushinteger(L, deadline);
+    return LuaWaitContinue(L, LUA_OK, 0);
+}
+
+int Processes::LuaWaitContinue(lua_State* L, int, lua_KContext) {
+    auto& run = CheckHandle(L);
+    lua_Integer deadline = lua_tointeger(L, 3);
+
+    if (!CoroutineScheduler::CanYield(L)) {
+        // Top level of a script: block. Its output callbacks cannot run until
+        // the script is done, so the child must not pause waiting for them
+        run->unthrottled = true;
+        if (run->paused.exchange(false)) launcher->Resume(run->id);
+        std::unique_lock<std::mutex> lock(run->mutex);
+        auto finished = [&] { return run->finished.load(); };
+        if (deadline < 0) {
+            run->done.wait(lock, finished);
+        } else {
+            run->done.wait_until(lock, Clock::time_point(Clock::duration(deadline)), finished);
+        }
+        run->unthrottled = false;
+        if (finished()) lua_pushinteger(L, run->code);
+        else lua_pushnil(L);
+        return 1;
+    }
+
+    if (run->finished) {
+        lua_pushinteger(L, run->code);
+        return 1;
+    }
+    auto now = Clock::now();
+    if (deadline >= 0 && now.time_since_epoch().count() >= deadline) {
+        lua_pushnil(L);
+        return 1;
+    }
+    auto next = now + pollInterval;
+    if (deadline >= 0) next = (std::min)(next, Clock::time_point(Clock::duration(deadline)));
+    return CoroutineScheduler::YieldFor(L, next - now, 0, &Processes::LuaWaitContinue);
+}
+
+int Processes::LuaGc(lua_State* L) {
+    static_cast<std::shared_ptr<ProcessRun>*>(lua_touserdata(L, 1))->~shared_ptr();
+    return 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "../core/ScriptHost.hpp"
+#include "../platform/ProcessLauncher.hpp"
+
+// State of one spawned child process
+struct ProcessRun {
+    uint64_t id = 0;
+    ScriptFunction onStdout;      // Called with batches of lines, or nullptr to discard
+    ScriptFunction onStderr;
+    ScriptFunction onExit;        // Called with the exit code, or nullptr
+    const ScriptState* state = nullptr;  // State that started it; killed when that state retires
+    std::string partial[2];       // Unterminated last line per stream; I/O thread only
+    std::atomic<size_t> queued = 0;      // Output bytes posted to the script but not yet delivered
+    std::atomic<bool> paused = false;    // Reading stopped until the script catches up
+    std::atomic<bool> unthrottled = false; // A blocking wait() is pending; never pause
+    std::atomic<bool> cancelled = false; // Killed because its script went away; output is dropped
+    std::atomic<bool> finished = false;
+    std::atomic<int> code = -1;
+    std::mutex mutex;
+    std::condition_variable done; // Signalled when finished
+};
+
+// Runs commands without blocking any script or the dispatcher
+// One I/O thread reads the output of every child through the platform's
+// asynchronous I/O (ProcessLauncher). Output is split into lines and
+// delivered in batches: each read becomes one call of on_stdout/on_stderr
+// with a table of the complete lines it contained, run as a coroutine on
+// the script's worker. When a script falls more than maxQueued bytes behind,
+// reading pauses, so the child blocks on its pipe instead of memory growing.
+// on_exit runs after the last output. Children of a script are killed when
+// it is reloaded or unloaded.
+// Lua:
+//   local p = spawn("make -j8", { on_stdout = function(lines) end, on_exit = function(code) end,
+//                                 cwd = "C:/src", env = { CC = "clang" } })
+//   p:wait(30)  p:kill()  p:running()
+struct Processes {
+    using Clock = std::chrono::steady_clock;
+
+    static inline std::unique_ptr<ProcessLauncher> launcher = CreateDefaultProcessLauncher(); // OS process backend
+    static inline size_t maxQueued = 4 << 20;     // Undelivered output bytes at which reading pauses
+    static inline size_t maxLine = 1 << 20;       // Longer lines are delivered in pieces
+    static inline Clock::duration pollInterval = std::chrono::milliseconds(10); // wait() check period in coroutines
+
+    // Starts a child process
+    // options: Callbacks, working directory and environment, see Lua above
+    // Returns nullptr with error set if it could not be started
+    static std::shared_ptr<ProcessRun> Spawn(lua_State* L, const std::string& command, const sol::optional<sol::table>& options,
+                                             std::string& error);
+
+    // Kills the children started by a state
+    // Called on the state's worker when it is retired
+    static void CancelState(const ScriptState& state);
+
+    // Registers spawn and the handle methods
+    static void Bind(sol::state& lua);
+
+private:
+    // Starts the I/O thread on first use
+    static void Start();
+
+    // Launcher callbacks; I/O thread
+    static bool OnOutput(uint64_t id, ProcessLauncher::Stream stream, const char* data, size_t size);
+    static void OnExit(uint64_t id, int code);
+
+    // Posts a block of complete lines to the script
+    static void Deliver(const std::shared_ptr<ProcessRun>& run, const ScriptFunction& fn, std::string block);
+
+    // Pushes a block of '\n'-separated lines as an array, dropping '\r' line ends
+    static void PushLines(lua_State* L, const std::string& block);
+
+    static std::shared_ptr<ProcessRun> Find(uint64_t id);
+
+    // Lua glue; a handle is a full userdata holding a shared_ptr<ProcessRun>
+    static int LuaKill(lua_State* L);
+    static int LuaWait(lua_State* L);
+    static int LuaWaitContinue(lua_State* L, int status, lua_KContext ctx);
+    static int LuaRunning(lua_State* L);
+    static int LuaGc(lua_State* L);
+
+    static inline std::once_flag started;
+    static inline std::atomic<uint64_t> nextId = 1;
+    static inline std::mutex runsMutex;
+    static inline std::unordered_map<uint64_t, std::shared_ptr<ProcessRun>> runs;  // Running children; guarded by runsMutex
+};
@@ -0,0 +1,124 @@
+#include "../core/Profiler.hpp"
+#include "../platform/SystemTimer.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Raises Profiler's sample flag at a fixed rate
+    class Sampler {
+    public:
+        ~Sampler() { Stop(); }
+
+        void Start(Profiler::Clock::duration interval, std::atomic<int64_t>& flag) {
+            Stop();
+            running = true;
+            thread = std::thread([this, interval, &flag] {
+                for (auto next = Profiler::Clock::now() + interval; running.load(std::memory_order_relaxed); next += interval) {
+                    SystemTimer::SleepUntil(next);
+                    flag.store(Profiler::Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+                }
+            });
+        }
+
+        void Stop() {
+            running = false;
+            if (thread.joinable()) thread.join();
+        }
+
+    private:
+        std::atomic<bool> running = false;
+        std::thread thread;
+    };
+
+    Sampler sampler;
+}
+
+void Profiler::Start(lua_State* L, Clock::duration interval) {
+    Stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        functions.clear();
+        samples = 0;
+    }
+    intervalTicks = interval.count();
+    tickAt = 0;
+    active = true;
+    lua_sethook(L, &Profiler::Hook, LUA_MASKCOUNT, hookCount);
+    sampler.Start(interval, tickAt);
+}
+
+void Profiler::Stop() {
+    // Hooks still installed on coroutines remove themselves on their next call
+    active = false;
+    sampler.Stop();
+}
+
+void Profiler::Hook(lua_State* L, lua_Debug*) {
+    if (!active.load(std::memory_order_relaxed)) {
+        lua_sethook(L, nullptr, 0, 0);
+        return;
+    }
+    if (tickAt.load(std::memory_order_relaxed) == 0) return;
+    int64_t at = tickAt.exchange(0, std::memory_order_relaxed);
+    if (at == 0) return;
+    // A flag raised while no Lua code ran belongs to idle time
+    if (Clock::now().time_since_epoch().count() - at > 2 * intervalTicks.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++samples;
+    lua_Debug frame;
+    for (int level = 0; level < (int)maxDepth && lua_getstack(L, level, &frame); ++level) {
+        if (!lua_getinfo(L, "Sn", &frame) || frame.what[0] == 'C') continue;
+
+        std::string source = std::string(frame.short_src) + ":" + std::to_string(frame.linedefined);
+        Function& function = functions[source];
+        if (function.source.empty()) function.source = source;
+        if (function.name.empty()) function.name = frame.name ? frame.name : (frame.what[0] == 'm' ? "(main chunk)" : "");
+        if (level == 0) ++function.self;
+        if (function.lastSample != samples) {
+            ++function.total;
+            function.lastSample = samples;
+        }
+    }
+}
+
+sol::table Profiler::Report(sol::this_state ts) {
+    std::vector<Function> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [source, function] : functions) sorted.push_back(function);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Function& a, const Function& b) {
+        return a.self != b.self ? a.self > b.self : a.total > b.total;
+    });
+
+    double ms = std::chrono::duration<double, std::milli>(Clock::duration(intervalTicks.load())).count();
+    sol::state_view lua(ts);
+    sol::table report = lua.create_table();
+    int index = 1;
+    for (const auto& function : sorted) {
+        sol::table entry = lua.create_table();
+        entry["name"] = function.name.empty() ? "?" : function.name;
+        entry["source"] = function.source;
+        entry["self"] = function.self * ms;
+        entry["total"] = function.total * ms;
+        entry["samples"] = function.self;
+        report[index++] = entry;
+    }
+    return report;
+}
+
+void Profiler::Bind(sol::state& lua) {
+    auto profiler = lua.create_table();
+    profiler.set_function("start", [](sol::optional<double> ms, sol::this_state ts) {
+        double interval = (std::max)(ms.value_or(1.0), 0.05);
+        Start(ts, std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(interval)));
+    });
+    profiler.set_function("stop", [](sol::this_state ts) {
+        Stop();
+        return Report(ts);
+    });
+    profiler.set_function("report", &Profiler::Report);
+    lua["profiler"] = profiler;
+}
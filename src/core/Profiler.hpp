@@ -0,0 +1,66 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Opt-in sampling profiler for Lua code
+// A sampler thread raises a flag every interval; a count hook installed with
+// lua_sethook checks the flag every hookCount VM instructions and, when it is
+// set, charges one sample to the running function (self time) and to every
+// function on the Lua stack (total time). Time spent in C functions is
+// charged to the Lua function that called them. While stopped no hook is
+// installed, so the profiler costs nothing.
+// Lua:
+//   profiler.start()            -- or profiler.start(0.5) for 0.5 ms samples
+//   local report = profiler.stop()
+//   for _, f in ipairs(report) do log(f.name .. " " .. f.self .. " ms") end
+struct Profiler {
+    using Clock = std::chrono::steady_clock;
+
+    static inline int hookCount = 1000;       // VM instructions between flag checks
+    static inline size_t maxDepth = 64;       // Stack levels charged with total time
+
+    // Starts profiling, discarding earlier results
+    // L: Lua thread that calls profiler.start; it is profiled from now on
+    // interval: Time represented by one sample
+    static void Start(lua_State* L, Clock::duration interval);
+
+    // Stops profiling; results stay available to Report
+    static void Stop();
+
+    // Installs the hook on a new coroutine while profiling
+    // Called by CoroutineScheduler for every callback it starts
+    static void Attach(lua_State* co) {
+        if (active.load(std::memory_order_relaxed)) lua_sethook(co, &Profiler::Hook, LUA_MASKCOUNT, hookCount);
+    }
+
+    // Lua binding: profiler.report()
+    // Returns: Array of { name, source, self, total, samples }, times in
+    // milliseconds, sorted by self time
+    static sol::table Report(sol::this_state ts);
+
+    // Creates the Lua `profiler` table
+    static void Bind(sol::state& lua);
+
+private:
+    static void Hook(lua_State* L, lua_Debug* ar);
+
+    struct Function {
+        std::string name;         // Function name as seen by its caller, if known
+        std::string source;       // "main.lua:12"
+        uint64_t self = 0;        // Samples taken inside the function
+        uint64_t total = 0;       // Samples taken while the function was on the stack
+        uint64_t lastSample = 0;  // Sample that last counted towards total (recursion is counted once)
+    };
+
+    static inline std::atomic<bool> active = false;
+    static inline std::atomic<int64_t> tickAt = 0;        // Clock ticks when the sampler last raised the flag; 0 = consumed
+    static inline std::atomic<int64_t> intervalTicks = 0;
+    static inline std::mutex mutex;
+    static inline std::unordered_map<std::string, Function> functions;  // By source; guarded by mutex
+    static inline uint64_t samples = 0;                                 // Guarded by mutex
+};
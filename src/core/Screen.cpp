@@ -0,0 +1,157 @@
+#include "../core/Screen.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../core/CoroutineScheduler.hpp"
+#include "../core/PrecisionClock.hpp"
+#include <algorithm>
+#include <tuple>
+
+namespace {
+    int ClampTolerance(lua_Integer tolerance) {
+        return (int)std::clamp<lua_Integer>(tolerance, 0, 255);
+    }
+}
+
+std::shared_ptr<const Frame> Screen::Acquire(const ScreenRect& requested) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ScreenRect area = requested.Intersect(source->Bounds());
+    if (area.Empty()) return nullptr;
+
+    uint64_t tick = HotkeyManager::tick.load(std::memory_order_relaxed);
+    auto now = Clock::now();
+    bool fresh = cached && cachedTick == tick && now - capturedAt <= maxAge;
+    if (fresh && cached->area.Contains(area)) return cached;
+    // Cover what this pass has already looked at, so the next query hits the cache
+    if (fresh) area = area.Union(cached->area);
+
+    // Reuse the pixel buffer unless a caller still holds the old frame
+    auto frame = cached && cached.use_count() == 1 ? cached : std::make_shared<Frame>();
+    if (!source->Capture(area, *frame)) {
+        cached.reset();
+        return nullptr;
+    }
+    cached = frame;
+    cachedTick = tick;
+    capturedAt = now;
+    return frame;
+}
+
+void Screen::Invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cached.reset();
+}
+
+std::optional<uint32_t> Screen::PixelGet(int x, int y) {
+    auto frame = Acquire({ x, y, 1, 1 });
+    if (!frame) return std::nullopt;
+    return frame->image.At(x - frame->area.x, y - frame->area.y) & 0x00FFFFFF;
+}
+
+std::optional<std::pair<int, int>> Screen::ImageFind(const std::string& path, std::optional<ScreenRect> region,
+                                                     int tolerance, std::string& error) {
+    auto needle = LoadTemplate(path, error);
+    if (!needle) return std::nullopt;
+
+    ScreenRect area = region ? *region : source->Bounds();
+    auto frame = Acquire(area);
+    if (!frame) return std::nullopt;
+
+    // The frame may be larger than the region when it was captured for other queries too
+    area = area.Intersect(frame->area);
+    int x = 0, y = 0;
+    if (!ImageSearch::Find(frame->image, area.x - frame->area.x, area.y - frame->area.y, area.width, area.height,
+                           *needle, tolerance, x, y)) {
+        return std::nullopt;
+    }
+    return std::make_pair(x + frame->area.x, y + frame->area.y);
+}
+
+std::shared_ptr<const ImageTemplate> Screen::LoadTemplate(const std::string& path, std::string& error) {
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        error = "cannot open " + path;
+        return nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = templates.find(path);
+        if (it != templates.end() && it->second.modified == modified) return it->second.image;
+    }
+
+    Bitmap bitmap;
+    if (!ImageSearch::LoadBmp(path, bitmap, error)) return nullptr;
+    auto image = std::make_shared<const ImageTemplate>(ImageSearch::Prepare(std::move(bitmap)));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    templates[path] = { modified, image };
+    return image;
+}
+
+void Screen::Bind(sol::state& lua) {
+    lua.set_function("pixel_get", [](int x, int y) {
+        return PixelGet(x, y);
+    });
+    lua.set_function("pixel_wait", &Screen::LuaPixelWait);
+    lua.set_function("image_find", [](const std::string& path, sol::optional<sol::table> region,
+                                      sol::optional<lua_Integer> tolerance, sol::this_state ts) {
+        std::optional<ScreenRect> area;
+        if (region) {
+            sol::optional<int> w = (*region)["w"], h = (*region)["h"];
+            if (!w || !h) throw sol::error("image_find: region needs w and h");
+            area = ScreenRect{ region->get_or("x", 0), region->get_or("y", 0), *w, *h };
+        }
+
+        std::string error;
+        auto found = ImageFind(path, area, ClampTolerance(tolerance.value_or(0)), error);
+        if (!error.empty()) throw sol::error("image_find: " + error);
+        if (!found) return std::make_tuple(sol::object(sol::lua_nil), sol::object(sol::lua_nil));
+        return std::make_tuple(sol::make_object(ts, found->first), sol::make_object(ts, found->second));
+    });
+}
+
+int Screen::LuaPixelWait(lua_State* L) {
+    luaL_checkinteger(L, 1);
+    luaL_checkinteger(L, 2);
+    luaL_checkinteger(L, 3);
+    luaL_optinteger(L, 4, 0);
+    lua_Integer deadline = -1;
+    if (!lua_isnoneornil(L, 5)) {
+        auto timeout = std::chrono::duration<double, std::milli>((std::max)(0.0, (double)luaL_checknumber(L, 5)));
+        deadline = (Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout)).time_since_epoch().count();
+    }
+    // The arguments and the deadline stay on the stack across yields
+    lua_settop(L, 5);
+    lua_pushinteger(L, deadline);
+    return LuaPixelWaitContinue(L, LUA_OK, 0);
+}
+
+int Screen::LuaPixelWaitContinue(lua_State* L, int, lua_KContext) {
+    int x = (int)lua_tointeger(L, 1);
+    int y = (int)lua_tointeger(L, 2);
+    uint32_t color = (uint32_t)lua_tointeger(L, 3);
+    int tolerance = ClampTolerance(luaL_optinteger(L, 4, 0));
+    lua_Integer deadline = lua_tointeger(L, 6);
+
+    while (true) {
+        auto pixel = PixelGet(x, y);
+        if (pixel && ImageSearch::Matches(*pixel, color, tolerance)) {
+            lua_pushboolean(L, 1);
+            return 1;
+        }
+        auto now = Clock::now();
+        if (deadline >= 0 && now.time_since_epoch().count() >= deadline) {
+            lua_pushboolean(L, 0);
+            return 1;
+        }
+        auto next = now + pollInterval;
+        if (deadline >= 0) next = (std::min)(next, Clock::time_point(Clock::duration(deadline)));
+
+        if (CoroutineScheduler::CanYield(L)) {
+            // Resumed in a later MessageLoop pass, so the next check captures afresh
+            return CoroutineScheduler::YieldFor(L, next - now, 0, &Screen::LuaPixelWaitContinue);
+        }
+        // Top level of a script: block, and drop the frame since no pass separates the checks
+        PrecisionClock::SleepUntil(next);
+        Invalidate();
+    }
+}
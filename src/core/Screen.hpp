@@ -0,0 +1,73 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "../platform/FrameSource.hpp"
+#include "../utils/ImageSearch.hpp"
+
+// Pixel and image queries against the screen
+// Queries read a cached Frame instead of capturing each time: a frame is
+// reused while the MessageLoop is still in the same pass and the frame is
+// younger than maxAge. When a query needs pixels outside the cached frame,
+// the recapture covers both areas, so a callback that checks several spots
+// captures once. Templates are decoded once and reloaded when their file
+// changes.
+// Lua:
+//   local c = pixel_get(100, 200)                      -- 0xRRGGBB or nil
+//   pixel_wait(100, 200, 0xFF0000, 10, 5000)           -- true once red, false on timeout
+//   local x, y = image_find("button.bmp", { x = 0, y = 0, w = 800, h = 600 }, 8)
+struct Screen {
+    using Clock = std::chrono::steady_clock;
+
+    static inline std::unique_ptr<FrameSource> source = CreateDefaultFrameSource(); // Capture backend
+    static inline Clock::duration maxAge = std::chrono::milliseconds(16);        // Oldest frame a query may reuse
+    static inline Clock::duration pollInterval = std::chrono::milliseconds(10);  // pixel_wait check period
+
+    // Returns a frame covering area, capturing only if the cache cannot serve it
+    // area is clipped to the virtual desktop; nullptr if nothing is left or
+    // capture fails
+    static std::shared_ptr<const Frame> Acquire(const ScreenRect& area);
+
+    // Drops the cached frame so the next query captures
+    static void Invalidate();
+
+    // Color of a screen pixel as 0xRRGGBB; nullopt off-screen
+    static std::optional<uint32_t> PixelGet(int x, int y);
+
+    // Finds a template image on the screen
+    // region: Screen area to search; the whole virtual desktop if not set
+    // tolerance: Allowed per-channel difference, 0-255
+    // Returns the screen position of the template's top-left pixel; nullopt
+    // with error set if the template cannot be loaded
+    static std::optional<std::pair<int, int>> ImageFind(const std::string& path, std::optional<ScreenRect> region,
+                                                        int tolerance, std::string& error);
+
+    // Registers pixel_get/pixel_wait/image_find
+    static void Bind(sol::state& lua);
+
+private:
+    struct CachedTemplate {
+        std::filesystem::file_time_type modified;
+        std::shared_ptr<const ImageTemplate> image;
+    };
+
+    // Decoded template for path; reloaded when the file's timestamp changes
+    static std::shared_ptr<const ImageTemplate> LoadTemplate(const std::string& path, std::string& error);
+
+    // Lua glue; pixel_wait yields between checks inside callbacks
+    static int LuaPixelWait(lua_State* L);
+    static int LuaPixelWaitContinue(lua_State* L, int status, lua_KContext ctx);
+
+    static inline std::mutex mutex;
+    static inline std::shared_ptr<Frame> cached;                  // Guarded by mutex
+    static inline uint64_t cachedTick = 0;                        // MessageLoop pass of cached; guarded by mutex
+    static inline Clock::time_point capturedAt;                   // Guarded by mutex
+    static inline std::unordered_map<std::string, CachedTemplate> templates; // By path; guarded by mutex
+};
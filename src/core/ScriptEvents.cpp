@@ -0,0 +1,73 @@
+#include "../core/ScriptEvents.hpp"
+#include "../core/ScriptModules.hpp"
+#include "../core/BindingSet.hpp"
+#include <algorithm>
+
+void ScriptEvents::On(const std::string& name, ScriptFunction cb, std::string owner) {
+    if (BindingSet::staging) {
+        BindingSet::staging->handlers.push_back({ name, std::move(cb), std::move(owner) });
+        return;
+    }
+    std::string tag = owner;
+    HotkeyManager::Post([handler = ScriptHandler{ name, std::move(cb), std::move(owner) }]() {
+        Register(handler);
+    }, std::move(tag));
+}
+
+void ScriptEvents::Emit(const std::string& name, ScriptArgs args) {
+    if (BindingSet::staging) {
+        // Handlers of the loading script are not live yet
+        BindingSet::staging->emits.push_back({ name, std::move(args) });
+        return;
+    }
+    dispatcher.publish(Find(name), std::move(args));
+}
+
+void ScriptEvents::Drain() {
+    dispatcher.drain();
+}
+
+void ScriptEvents::Register(ScriptHandler handler) {
+    const Event<ScriptArgs>& event = Find(handler.name);
+    if (event.id >= handlers.size()) {
+        handlers.resize(event.id + 1);
+        subscribed.resize(event.id + 1, false);
+    }
+    if (!subscribed[event.id]) {
+        EventId id = event.id;
+        dispatcher.subscribe(event, [id](const ScriptArgs& args) { Deliver(id, args); });
+        subscribed[event.id] = true;
+    }
+    handlers[event.id].push_back(std::move(handler));
+}
+
+void ScriptEvents::Deliver(EventId id, const ScriptArgs& args) {
+    for (const auto& handler : handlers[id]) {
+        ScriptHost::CallWith(handler.callback, args);
+    }
+}
+
+const Event<ScriptArgs>& ScriptEvents::Find(const std::string& name) {
+    auto it = interned.find(name);
+    if (it == interned.end()) it = interned.try_emplace(name, name).first;
+    return it->second;
+}
+
+void ScriptEvents::Replace(const std::string& script, std::vector<ScriptHandler>&& staged, std::vector<ScriptEmit>&& emits) {
+    for (auto& list : handlers) {
+        std::erase_if(list, [&](const ScriptHandler& h) { return ScriptModules::BelongsTo(h.owner, script); });
+    }
+    for (auto& handler : staged) Register(std::move(handler));
+    for (auto& emit : emits) dispatcher.publish(Find(emit.name), std::move(emit.args));
+}
+
+void ScriptEvents::RemoveOwner(const std::string& owner) {
+    for (auto& list : handlers) {
+        std::erase_if(list, [&](const ScriptHandler& h) { return h.owner == owner; });
+    }
+}
+
+void ScriptEvents::Clear() {
+    dispatcher.discard();
+    for (auto& list : handlers) list.clear();
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../core/HotkeyManager.hpp"
+#include "../core/ScriptHost.hpp"
+#include "../core/ScriptValue.hpp"
+#include "../utils/EventDispatcher.hpp"
+
+// Lua handler for a named event
+struct ScriptHandler {
+    std::string name;             // Event name
+    ScriptFunction callback;      // Lua function called with the emitted arguments
+    std::string owner;            // Script module that created the handler
+};
+
+// Event emitted while a script loads
+struct ScriptEmit {
+    std::string name;
+    ScriptArgs args;
+};
+
+// Named events between Lua scripts (on/emit)
+// Emitting queues the event on a dispatcher owned by the MessageLoop thread;
+// it is delivered on the next loop pass, after the emitting callback has
+// returned or yielded, and every handler runs as its own coroutine on its
+// script's worker. Arguments are copied out of the emitting state
+// (ScriptValue), so events can cross between scripts.
+// Handlers are only touched on the MessageLoop thread.
+struct ScriptEvents {
+    static inline EventDispatcher dispatcher{ &HotkeyManager::Wake };  // Drained by the MessageLoop
+
+    // Registers a handler from Lua
+    // name: Event name
+    // cb: Lua callback, called with the arguments passed to emit()
+    // owner: Script module that creates the handler (see ScriptModules::Owner)
+    static void On(const std::string& name, ScriptFunction cb, std::string owner = "");
+
+    // Queues an event from Lua
+    // name: Event name
+    // args: Values passed to every handler
+    static void Emit(const std::string& name, ScriptArgs args);
+
+    // Delivers queued events; MessageLoop thread only
+    static void Drain();
+
+    // Replaces the handlers of one script with a staged set and queues the
+    // staged emits; MessageLoop thread only
+    // Queued events are kept: they hold copies, not references into the old state
+    static void Replace(const std::string& script, std::vector<ScriptHandler>&& staged, std::vector<ScriptEmit>&& emits);
+
+    // Removes every handler created by a script module; MessageLoop thread only
+    static void RemoveOwner(const std::string& owner);
+
+    // Removes every handler and drops queued events; MessageLoop thread only
+    static void Clear();
+
+private:
+    // Adds a handler on the MessageLoop thread
+    static void Register(ScriptHandler handler);
+
+    // Runs the handlers of one event
+    static void Deliver(EventId id, const ScriptArgs& args);
+
+    // Event of a name, interned through the registry only the first time
+    // the calling thread uses it; emitting then takes no lock but the
+    // dispatcher's queue
+    static const Event<ScriptArgs>& Find(const std::string& name);
+
+    static inline std::vector<std::vector<ScriptHandler>> handlers;  // Handlers by event ID
+    static inline std::vector<bool> subscribed;                      // Event IDs the dispatcher forwards
+    static inline thread_local std::unordered_map<std::string, Event<ScriptArgs>> interned;  // Events by name, per thread
+};
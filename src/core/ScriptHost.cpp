@@ -0,0 +1,200 @@
+#include "../core/ScriptHost.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../core/BindingSet.hpp"
+#include "../core/BytecodeCache.hpp"
+#include "../core/ScriptModules.hpp"
+#include "../core/PrecisionClock.hpp"
+#include "../core/Stats.hpp"
+#include "../core/Processes.hpp"
+#include "../core/ControlChannel.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <filesystem>
+
+void ScriptHost::Start() {
+    // Fixed from here on: every worker's states read it
+    ScriptModules::SetRoot(root);
+    size_t count = workerCount ? workerCount : std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 2, 4);
+    for (size_t i = 0; i < count; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->thread = std::thread(&ScriptHost::Loop, std::ref(*worker));
+        worker->thread.detach();
+        workers.push_back(std::move(worker));
+    }
+    Log::Out() << "[System] Started " << count << " script worker(s)";
+}
+
+std::vector<std::string> ScriptHost::Scan() {
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(root, ec)) {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".lua") {
+            names.push_back(entry.path().filename().string());
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+void ScriptHost::Load(const std::string& name) {
+    Script& script = Find(name);
+    Post(script.worker, [name, &script] { LoadOnWorker(name, script); });
+}
+
+void ScriptHost::Unload(const std::string& name) {
+    Script& script = Find(name);
+    Post(script.worker, [name, &script] { UnloadOnWorker(name, script); });
+}
+
+void ScriptHost::ReloadModules(const std::vector<std::string>& changes) {
+    std::lock_guard<std::mutex> lock(scriptsMutex);
+    for (auto& [name, script] : scripts) {
+        Post(script.worker, [&script, changes] {
+            if (script.state) ScriptModules::Reload(script.state->lua, changes);
+        });
+    }
+}
+
+ScriptFunction ScriptHost::Share(sol::function fn) {
+    // Anchored through the main thread, which outlives the coroutine fn may have come from
+    lua_State* L = fn.lua_state();
+    auto* shared = new sol::function(sol::main_thread(L, L), fn);
+    auto state = ScriptState::From(L).shared_from_this();
+    return ScriptFunction(shared, [state = std::move(state)](const sol::function* f) mutable {
+        // Releasing the reference touches the state, so it happens on the
+        // worker; the state reference moves along so the state is destroyed there too
+        size_t worker = state->worker;
+        Post(worker, [f, state = std::move(state)] { delete f; });
+    });
+}
+
+void ScriptHost::Run(const ScriptFunction& fn, std::function<void()> task) {
+    ScriptState& state = State(fn);
+    if (state.retired.load(std::memory_order_relaxed)) return;
+    Post(state.worker, [fn, task = std::move(task)] {
+        if (Live(fn)) task();
+    });
+}
+
+void ScriptHost::CallWith(const ScriptFunction& fn, ScriptArgs args) {
+    Run(fn, [fn, args = std::move(args)] { CoroutineScheduler::SpawnWith(*fn, args); });
+}
+
+void ScriptHost::Post(size_t index, std::function<void()> task) {
+    // Nothing runs scripts before Start() or after the pool is gone
+    if (index >= workers.size()) return;
+    Worker& worker = *workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    worker.posted.store(true, std::memory_order_release);
+    worker.wake.notify_one();
+}
+
+void ScriptHost::Loop(Worker& worker) {
+    std::vector<std::function<void()>> batch;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            batch.swap(worker.tasks);
+            worker.posted.store(false, std::memory_order_relaxed);
+        }
+        for (auto& task : batch) task();
+        batch.clear();
+        CoroutineScheduler::Update();
+
+        // Garbage is collected between callbacks; a slice that leaves work
+        // over goes round the loop so queued calls run first
+        auto deadline = CoroutineScheduler::NextDeadline();
+        bool more = false;
+        for (auto& state : worker.live) more |= state->CollectIdle(deadline);
+        if (more) continue;
+
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        auto ready = [&] { return !worker.tasks.empty(); };
+        if (!deadline) {
+            worker.wake.wait(lock, ready);
+            continue;
+        }
+        // Sleep until shortly before the next resume, then spend the last
+        // stretch in the precision clock; a posted task ends the spin early
+        auto coarse = *deadline - PrecisionClock::Threshold();
+        if (Clock::now() < coarse) {
+            worker.wake.wait_until(lock, coarse, ready);
+        } else if (!ready()) {
+            lock.unlock();
+            PrecisionClock::SpinUntil(*deadline, &worker.posted);
+        }
+    }
+}
+
+void ScriptHost::LoadOnWorker(const std::string& name, Script& script) {
+    Log::Out() << "[System] Loading script " << name << "...";
+    auto start = Clock::now();
+    auto state = std::make_shared<ScriptState>(name, script.worker);
+    environment(state->lua);
+
+    BindingSet staged;
+    staged.script = name;
+    BindingSet::staging = &staged;
+    bool loaded = false;
+    try {
+        BytecodeCache::ScriptFile(state->lua, root + "/" + name);
+        loaded = true;
+    }
+    catch (const sol::error& e) {
+        Log::Err() << "[Lua Error] " << e.what();
+    }
+    BindingSet::staging = nullptr;
+
+    if (!loaded) {
+        state->retired = true;
+        CoroutineScheduler::CancelState(*state);
+        Processes::CancelState(*state);
+        ControlChannel::CancelState(*state);
+        Stats::reload.Record(Clock::now() - start, true);
+        if (script.state) Log::Err() << "[System] Keeping the previous version of " << name << " running.";
+        return;
+    }
+
+    // The previous state handles input until the swap, then goes away
+    HotkeyManager::Swap(staged);
+    Retire(script);
+    script.state = state;
+    state->Hold();
+    workers[script.worker]->live.push_back(std::move(state));
+
+    auto elapsed = Clock::now() - start;
+    Stats::reload.Record(elapsed);
+    Log::Out() << "[System] Script " << name << " loaded in "
+               << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms";
+}
+
+void ScriptHost::UnloadOnWorker(const std::string& name, Script& script) {
+    if (!script.state) return;
+    BindingSet none;
+    none.script = name;
+    HotkeyManager::Swap(none);
+    Retire(script);
+    Log::Out() << "[System] Unloaded script " << name;
+}
+
+void ScriptHost::Retire(Script& script) {
+    if (!script.state) return;
+    script.state->retired = true;
+    CoroutineScheduler::CancelState(*script.state);
+    Processes::CancelState(*script.state);
+    ControlChannel::CancelState(*script.state);
+    std::erase(workers[script.worker]->live, script.state);
+    script.state.reset();
+}
+
+ScriptHost::Script& ScriptHost::Find(const std::string& name) {
+    std::lock_guard<std::mutex> lock(scriptsMutex);
+    auto it = scripts.find(name);
+    if (it == scripts.end()) {
+        it = scripts.emplace(name, Script{ nextWorker++ % workers.size(), nullptr }).first;
+    }
+    return it->second;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../core/ScriptState.hpp"
+#include "../core/ScriptValue.hpp"
+#include "../core/CoroutineScheduler.hpp"
+
+// Lua function that any thread may hold, copy and drop
+// The function itself is only touched on its script's worker: ScriptHost
+// runs it there, and the last reference is released there too. It keeps its
+// ScriptState alive, so dispatchers never see a dangling state.
+using ScriptFunction = std::shared_ptr<const sol::function>;
+
+// Runs every top-level script in its own Lua state on a small worker pool
+// Each .lua file directly in the scripts directory is a top-level script;
+// modules it requires (in subdirectories) load into its state. A script is
+// pinned to one worker for its whole life, so its callbacks run in order,
+// while scripts on different workers run in parallel. The MessageLoop stays
+// the dispatcher: it decides which binding fires and posts the call to the
+// owning worker's queue instead of running Lua itself. Loading, reloading and
+// unloading a script happen on its worker and swap only that script's
+// bindings, so the others keep running untouched.
+struct ScriptHost {
+    using Clock = std::chrono::steady_clock;
+
+    static inline std::string root = "scripts";              // Scripts directory; fixed once Start() has run
+    static inline size_t workerCount = 0;                     // Pool size; 0 picks one from the core count
+    static inline std::function<void(sol::state&)> environment; // Registers the Lua API in a new state
+
+    // Starts the worker threads; called once before scripts are loaded
+    static void Start();
+
+    // Top-level scripts currently in the scripts directory, sorted by name
+    static std::vector<std::string> Scan();
+
+    // Loads a script, or reloads it into a fresh state
+    // name: File name relative to the scripts directory, e.g. "main.lua"
+    // Runs on the script's worker. The previous state keeps handling input
+    // until the new one has loaded; if loading fails it stays live.
+    static void Load(const std::string& name);
+
+    // Removes a script's bindings and destroys its state
+    static void Unload(const std::string& name);
+
+    // Re-runs changed modules in every script that has them loaded
+    // changes: Paths relative to the scripts directory
+    static void ReloadModules(const std::vector<std::string>& changes);
+
+    // Wraps a Lua function for use outside its worker
+    // Must be called on the thread running fn's state
+    static ScriptFunction Share(sol::function fn);
+
+    // Whether a function's script is still live
+    static bool Live(const ScriptFunction& fn) { return !State(fn).retired.load(std::memory_order_relaxed); }
+
+    // Queues a task on the worker of fn's script
+    // The task is skipped if the script has been replaced or unloaded by the
+    // time the worker gets to it
+    static void Run(const ScriptFunction& fn, std::function<void()> task);
+
+    // Calls fn as a new coroutine on its worker
+    // probe: Charged with the callback's run time, or nullptr
+    // args: Plain C++ values passed to fn
+    template <typename... Args>
+    static void Call(const ScriptFunction& fn, std::shared_ptr<Probe> probe, Args... args) {
+        Run(fn, [fn, probe = std::move(probe), args...]() mutable {
+            CoroutineScheduler::SpawnProbed(std::move(probe), *fn, std::move(args)...);
+        });
+    }
+
+    // Calls fn as a new coroutine on its worker with copied Lua values
+    static void CallWith(const ScriptFunction& fn, ScriptArgs args);
+
+    // Queues a task on a worker
+    static void Post(size_t worker, std::function<void()> task);
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::vector<std::function<void()>> tasks;            // Guarded by mutex
+        std::atomic<bool> posted = false;                     // Tasks queued since the worker last took them
+        std::vector<std::shared_ptr<ScriptState>> live;      // States hosted here; worker thread only
+    };
+
+    // One top-level script
+    struct Script {
+        size_t worker;
+        std::shared_ptr<ScriptState> state;                   // Live state; worker thread only
+    };
+
+    static ScriptState& State(const ScriptFunction& fn) { return ScriptState::From(fn->lua_state()); }
+
+    // Worker thread body: runs posted tasks, resumes waiting coroutines and
+    // collects garbage in the gaps
+    static void Loop(Worker& worker);
+
+    // Worker side of Load/Unload
+    static void LoadOnWorker(const std::string& name, Script& script);
+    static void UnloadOnWorker(const std::string& name, Script& script);
+
+    // Takes a state out of service on its worker: drops its suspended
+    // coroutines and stops collecting it; the state itself goes away with
+    // the last ScriptFunction that refers to it
+    static void Retire(Script& script);
+
+    // Script entry for a name, assigning a worker to new scripts
+    static Script& Find(const std::string& name);
+
+    static inline std::vector<std::unique_ptr<Worker>> workers;
+    static inline std::mutex scriptsMutex;
+    static inline std::map<std::string, Script> scripts;      // By name; entries are never erased; guarded by scriptsMutex
+    static inline size_t nextWorker = 0;                      // Guarded by scriptsMutex
+};
@@ -0,0 +1,109 @@
+#include "../core/ScriptModules.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../api/TimerManager.hpp"
+#include "../core/BytecodeCache.hpp"
+#include "../core/InputHooks.hpp"
+#include "../core/Hotstrings.hpp"
+#include "../core/ScriptEvents.hpp"
+#include "../core/ScriptState.hpp"
+#include "../core/Stats.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+void ScriptModules::Install(sol::state& lua) {
+    std::string path = lua["package"]["path"];
+    lua["package"]["path"] = root + "/?.lua;" + root + "/?/init.lua;" + path;
+
+    sol::protected_function require = lua["require"];
+    lua.set_function("require", [require](const std::string& name) -> sol::object {
+        // Files directly in the scripts directory run as scripts of their own
+        std::error_code ec;
+        if (name.find('.') == std::string::npos && std::filesystem::is_regular_file(root + "/" + name + ".lua", ec)) {
+            throw sol::error("module '" + name + "' is a top-level script; move shared modules into a subdirectory");
+        }
+        loading.push_back(name);
+        sol::protected_function_result result = require(name);
+        loading.pop_back();
+        if (!result.valid()) {
+            sol::error err = result;
+            throw err;
+        }
+        return result.get<sol::object>();
+    });
+}
+
+std::string ScriptModules::CurrentOwner(lua_State* L) {
+    return Owner(ScriptState::From(L).name, loading.empty() ? std::string() : loading.back());
+}
+
+std::string ScriptModules::Owner(const std::string& script, const std::string& module) {
+    return module.empty() ? script : script + ":" + module;
+}
+
+bool ScriptModules::BelongsTo(const std::string& owner, const std::string& script) {
+    return owner.size() >= script.size() && owner.compare(0, script.size(), script) == 0 &&
+           (owner.size() == script.size() || owner[script.size()] == ':');
+}
+
+std::optional<std::string> ScriptModules::ScriptName(const std::string& path) {
+    if (path.size() <= 4 || path.compare(path.size() - 4, 4, ".lua") != 0) return std::nullopt;
+    if (path.find_first_of("/\\") != std::string::npos) return std::nullopt;
+    return path;
+}
+
+std::optional<std::string> ScriptModules::ModuleName(const std::string& path) {
+    if (path.size() <= 4 || path.compare(path.size() - 4, 4, ".lua") != 0) return std::nullopt;
+    if (ScriptName(path)) return std::nullopt;
+
+    std::string name = path.substr(0, path.size() - 4);
+    if (name.size() > 5 && name.compare(name.size() - 5, 5, "/init") == 0) name.resize(name.size() - 5);
+    std::replace(name.begin(), name.end(), '/', '.');
+    return name;
+}
+
+void ScriptModules::Reload(sol::state_view lua, const std::vector<std::string>& changes) {
+    sol::table loaded = lua["package"]["loaded"];
+    sol::protected_function require = lua["require"];
+    const std::string& script = ScriptState::From(lua.lua_state()).name;
+
+    for (const auto& path : changes) {
+        auto name = ModuleName(path);
+        if (!name || loaded[*name].get_type() == sol::type::lua_nil) continue;
+        auto start = std::chrono::steady_clock::now();
+
+        // Compile first so a broken save keeps the running version;
+        // this also refreshes the bytecode cache that require then hits
+        lua_State* L = lua.lua_state();
+        int status = BytecodeCache::Load(L, root + "/" + path);
+        if (status != LUA_OK) {
+            Log::Err() << "[Lua Error] " << lua_tostring(L, -1);
+            lua_pop(L, 1);
+            Stats::reload.Record(std::chrono::steady_clock::now() - start, true);
+            continue;
+        }
+        lua_pop(L, 1);
+
+        // Queued ahead of the bindings the module makes when it runs again
+        std::string owner = Owner(script, *name);
+        HotkeyManager::RemoveOwner(owner);
+        TimerManager::CancelOwner(owner);
+        HotkeyManager::Post([owner]() {
+            InputHooks::RemoveOwner(owner);
+            Hotstrings::RemoveOwner(owner);
+            ScriptEvents::RemoveOwner(owner);
+        }, owner);
+        loaded[*name] = sol::lua_nil;
+
+        sol::protected_function_result result = require(*name);
+        if (!result.valid()) {
+            sol::error err = result;
+            Log::Err() << "[Lua Error] " << err.what();
+            Stats::reload.Record(std::chrono::steady_clock::now() - start, true);
+            continue;
+        }
+        Stats::reload.Record(std::chrono::steady_clock::now() - start);
+        Log::Out() << "[System] Reloaded module: " << *name << " in " << script;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Module-level hot reload for modules required by top-level scripts
+// Modules live in subdirectories of the scripts directory and are loaded
+// through `require` into the state of the script that requires them. Bindings
+// and timers are tagged with an owner: the script's name, plus the module
+// name while a module runs ("main.lua:games.diablo"). When only a module
+// changes, its bindings can be dropped and the module re-run in the live
+// state, keeping everything else warm
+struct ScriptModules {
+    // Sets the scripts directory
+    // Called once by ScriptHost::Start, before any worker creates a state;
+    // states only read it afterwards
+    static void SetRoot(const std::string& directory) { root = directory; }
+
+    // Prepares a fresh state
+    // Adds root/?.lua and root/?/init.lua to package.path and wraps
+    // `require` to track which module is loading
+    static void Install(sol::state& lua);
+
+    // Owner tag for bindings created by Lua thread L
+    // Returns: Owner(script of L, module currently being required on this thread)
+    static std::string CurrentOwner(lua_State* L);
+
+    // Owner tag of a script, or of one of its modules when module is not empty
+    static std::string Owner(const std::string& script, const std::string& module);
+
+    // Whether an owner tag belongs to a script or one of its modules
+    static bool BelongsTo(const std::string& owner, const std::string& script);
+
+    // Top-level script for a changed path
+    // path: Path relative to the scripts directory
+    // Returns: "main.lua" for "main.lua", or nullopt for files in subdirectories
+    static std::optional<std::string> ScriptName(const std::string& path);
+
+    // Module name for a changed path
+    // path: Path relative to the scripts directory, e.g. "lib/chat.lua"
+    // Returns: "lib.chat" ("lib" for "lib/init.lua"), or nullopt for top-level scripts
+    static std::optional<std::string> ModuleName(const std::string& path);
+
+    // Re-runs changed modules that are currently loaded
+    // lua: Live state of a script; must be called on its worker
+    // A module that fails to compile is left as it was. Modules that were
+    // never required are ignored
+    static void Reload(sol::state_view lua, const std::vector<std::string>& changes);
+
+private:
+    static inline std::string root = "scripts";                       // Written only before the workers start
+    static inline thread_local std::vector<std::string> loading;   // Stack of modules being required
+};
@@ -0,0 +1,78 @@
+#include "../core/ScriptState.hpp"
+#include "../core/PrecisionClock.hpp"
+#include "../core/Stats.hpp"
+#include <algorithm>
+
+ScriptState::ScriptState(std::string name, size_t worker)
+    : name(std::move(name)), worker(worker), lua(sol::default_at_panic, &LuaAllocator::Alloc, &allocator) {
+    // Coroutines inherit the main thread's extra space, so From() works on any of them
+    *static_cast<ScriptState**>(lua_getextraspace(lua.lua_state())) = this;
+    SetGcMode(defaultMode);
+}
+
+ScriptState& ScriptState::From(lua_State* L) {
+    return **static_cast<ScriptState**>(lua_getextraspace(L));
+}
+
+void ScriptState::SetGcMode(GcMode mode) {
+    lua_gc(lua.lua_state(), mode == GcMode::Generational ? LUA_GCGEN : LUA_GCINC, 0, 0);
+    gcMode = mode;
+    Rebase();
+}
+
+void ScriptState::Hold() {
+    lua_gc(lua.lua_state(), LUA_GCSTOP);
+    held = true;
+    Rebase();
+}
+
+bool ScriptState::CollectIdle(std::optional<Clock::time_point> deadline) {
+    size_t used = allocator.InUse();
+    if (!held || used < threshold) return false;
+
+    auto start = Clock::now();
+    auto until = start + idleBudget;
+    bool near = deadline && *deadline - PrecisionClock::Threshold() < until;
+    // No gap before the next callback: wait for one unless memory is overdue,
+    // and then do a single step
+    if (near && used < overdue) return false;
+
+    lua_State* L = lua.lua_state();
+    bool finished = false;
+    do {
+        // A generational step is a whole young (or, when due, major) collection
+        finished = lua_gc(L, LUA_GCSTEP, 0) != 0 || gcMode == GcMode::Generational;
+    } while (!finished && !near && Clock::now() < until);
+
+    Stats::gc.Record(Clock::now() - start);
+    if (finished) Rebase();
+    return !finished && !near;
+}
+
+void ScriptState::Rebase() {
+    size_t used = allocator.InUse();
+    // Mirrors Lua's own defaults: a 200% pause, a 20% minor multiplier
+    double factor = gcMode == GcMode::Generational ? 0.2 : 1.0;
+    size_t growth = (std::max)((size_t)(used * factor), minGrowth);
+    threshold = used + growth;
+    overdue = threshold + growth;
+}
+
+const char* ScriptState::Name(GcMode mode) {
+    return mode == GcMode::Generational ? "generational" : "incremental";
+}
+
+std::string ScriptState::LuaGcMode(sol::optional<std::string> mode, sol::this_state ts) {
+    ScriptState& state = From(ts);
+    std::string previous = Name(state.gcMode);
+    if (!mode) return previous;
+
+    if (*mode == "generational") {
+        state.SetGcMode(GcMode::Generational);
+    } else if (*mode == "incremental") {
+        state.SetGcMode(GcMode::Incremental);
+    } else {
+        throw sol::error("gc_mode: unknown mode '" + *mode + "'");
+    }
+    return previous;
+}
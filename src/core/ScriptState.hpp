@@ -0,0 +1,78 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include "../core/LuaAllocator.hpp"
+
+// A Lua state with its own pooled allocator and scheduled garbage collection
+// Every top-level script gets one; it is created, run and destroyed on the
+// script's worker (see ScriptHost). While a script loads, Lua collects on
+// its own as usual. Once the state goes live (Hold), the automatic collector
+// is stopped and the worker runs bounded collection steps in its idle gaps (CollectIdle),
+// so a callback or a timed macro is never paused by the collector. A
+// collection is due when memory has grown by the mode's growth factor since
+// the last one; if no gap comes along and usage reaches twice that, one step
+// runs between callbacks anyway. States are shared-owned: callbacks handed to
+// other threads keep theirs alive until they are released (ScriptFunction).
+// Lua:
+//   gc_mode("incremental")   -- returns the previous mode
+struct ScriptState : std::enable_shared_from_this<ScriptState> {
+    using Clock = std::chrono::steady_clock;
+
+    enum class GcMode {
+        Incremental,              // Whole-heap cycles in small steps; lowest step latency
+        Generational              // Frequent young collections; suits short-lived callback garbage
+    };
+
+    static inline GcMode defaultMode = GcMode::Generational;
+    static inline Clock::duration idleBudget = std::chrono::microseconds(500); // Longest collection slice per gap
+    static inline size_t minGrowth = 64 * 1024;                                // Bytes allocated before a collection is due
+
+    // name: Script file, relative to the scripts directory
+    // worker: Index of the ScriptHost worker that runs the state
+    ScriptState(std::string name, size_t worker);
+    ScriptState(const ScriptState&) = delete;
+    ScriptState& operator=(const ScriptState&) = delete;
+
+    const std::string name;
+    const size_t worker;
+    std::atomic<bool> retired = false; // Replaced or unloaded; work still queued for it is dropped
+    LuaAllocator allocator;       // Declared before lua so it outlives the state
+    sol::state lua;
+
+    // The ScriptState a Lua thread belongs to
+    // Only reads a pointer next to L, so any thread may call it
+    static ScriptState& From(lua_State* L);
+
+    // Switches the collector mode; switching to generational runs a full collection
+    void SetGcMode(GcMode mode);
+    GcMode GetGcMode() const { return gcMode; }
+
+    // Stops automatic collection; from now on CollectIdle does it
+    // Called on the state's worker once the script is live
+    void Hold();
+
+    // Runs collection steps if a collection is due, for at most idleBudget
+    // and only while deadline (the next timer or resume) is not near
+    // Returns true if work remains, false if the heap is within its budget
+    bool CollectIdle(std::optional<Clock::time_point> deadline);
+
+    // Lua binding: gc_mode([mode])
+    static std::string LuaGcMode(sol::optional<std::string> mode, sol::this_state ts);
+
+    // Lua name of a mode
+    static const char* Name(GcMode mode);
+
+private:
+    // Sets the next collection threshold from the current usage
+    void Rebase();
+
+    GcMode gcMode = GcMode::Incremental;
+    bool held = false;
+    size_t threshold = 0;         // InUse() at which the next collection is due
+    size_t overdue = 0;           // InUse() at which it runs even without a gap
+};
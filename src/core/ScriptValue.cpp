@@ -0,0 +1,68 @@
+#include "../core/ScriptValue.hpp"
+#include <type_traits>
+
+ScriptValue ScriptValue::From(lua_State* L, int index, int depth) {
+    index = lua_absindex(L, index);
+    switch (lua_type(L, index)) {
+        case LUA_TBOOLEAN:
+            return { (bool)lua_toboolean(L, index) };
+        case LUA_TNUMBER:
+            if (lua_isinteger(L, index)) return { lua_tointeger(L, index) };
+            return { lua_tonumber(L, index) };
+        case LUA_TSTRING: {
+            size_t length = 0;
+            const char* text = lua_tolstring(L, index, &length);
+            return { std::string(text, length) };
+        }
+        case LUA_TTABLE: {
+            // Deeper levels (including the back edge of a cycle) are cut off
+            if (depth >= maxDepth || !lua_checkstack(L, 3)) return {};
+            auto table = std::make_shared<ScriptTable>();
+            lua_pushnil(L);
+            while (lua_next(L, index)) {
+                ScriptValue key = From(L, -2, depth + 1);
+                if (!std::holds_alternative<std::monostate>(key.value)) {
+                    table->entries.emplace_back(std::move(key), From(L, -1, depth + 1));
+                }
+                lua_pop(L, 1);
+            }
+            return { std::shared_ptr<const ScriptTable>(std::move(table)) };
+        }
+        default:
+            return {};
+    }
+}
+
+ScriptValue ScriptValue::From(const sol::object& object) {
+    lua_State* L = object.lua_state();
+    if (!L) return {};
+    object.push(L);
+    ScriptValue value = From(L, -1);
+    lua_pop(L, 1);
+    return value;
+}
+
+void ScriptValue::Push(lua_State* L) const {
+    luaL_checkstack(L, 3, "nested table too deep");
+    std::visit([L](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+            lua_pushnil(L);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            lua_pushboolean(L, v);
+        } else if constexpr (std::is_same_v<T, lua_Integer>) {
+            lua_pushinteger(L, v);
+        } else if constexpr (std::is_same_v<T, lua_Number>) {
+            lua_pushnumber(L, v);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            lua_pushlstring(L, v.data(), v.size());
+        } else {
+            lua_createtable(L, 0, (int)v->entries.size());
+            for (const auto& [key, value] : v->entries) {
+                key.Push(L);
+                value.Push(L);
+                lua_rawset(L, -3);
+            }
+        }
+    }, value);
+}
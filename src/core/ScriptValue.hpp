@@ -0,0 +1,36 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+struct ScriptTable;
+
+// Lua value copied out of its state, so it can be handed to another script
+// Tables are copied deeply; anything nested deeper than maxDepth levels,
+// which includes the back edge of a cycle, becomes nil, as do functions,
+// userdata and coroutines, which cannot leave their state
+struct ScriptValue {
+    static constexpr int maxDepth = 16;
+
+    std::variant<std::monostate, bool, lua_Integer, lua_Number, std::string, std::shared_ptr<const ScriptTable>> value;
+
+    // Copies the value at index of L's stack
+    static ScriptValue From(lua_State* L, int index, int depth = 0);
+
+    // Copies a value held by sol
+    static ScriptValue From(const sol::object& object);
+
+    // Pushes a fresh copy onto L's stack
+    void Push(lua_State* L) const;
+};
+
+// Copied table entries, in traversal order
+struct ScriptTable {
+    std::vector<std::pair<ScriptValue, ScriptValue>> entries;
+};
+
+// Arguments passed between scripts
+using ScriptArgs = std::vector<ScriptValue>;
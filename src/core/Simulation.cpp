@@ -0,0 +1,31 @@
+#include "../core/Simulation.hpp"
+#include "../api/InputManager.hpp"
+#include "../api/WindowManager.hpp"
+#include "../core/HotkeyManager.hpp"
+#include "../core/InputHooks.hpp"
+#include "../core/ProbedInputSink.hpp"
+#include "../core/Screen.hpp"
+#include "../core/Stats.hpp"
+#include <memory>
+
+namespace {
+    // Moves backend into slot and returns it with its concrete type
+    template <typename Backend, typename Interface>
+    Backend* Replace(std::unique_ptr<Interface>& slot) {
+        auto backend = std::make_unique<Backend>();
+        Backend* raw = backend.get();
+        slot = std::move(backend);
+        return raw;
+    }
+}
+
+void Simulation::Install() {
+    events = Replace<MemoryEventSource>(HotkeyManager::events);
+    windows = Replace<MemoryWindowProvider>(WindowManager::provider);
+    capture = Replace<SyntheticInputCapture>(InputHooks::capture);
+    screen = Replace<MemoryFrameSource>(Screen::source);
+
+    auto recording = std::make_unique<RecordingInputSink>();
+    sink = recording.get();
+    InputManager::sink = std::make_unique<ProbedInputSink>(std::move(recording), Stats::send);
+}
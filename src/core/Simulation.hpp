@@ -0,0 +1,28 @@
+#pragma once
+#include "../platform/MemoryEventSource.hpp"
+#include "../platform/MemoryFrameSource.hpp"
+#include "../platform/MemoryWindowProvider.hpp"
+#include "../platform/RecordingInputSink.hpp"
+#include "../platform/SyntheticInputCapture.hpp"
+#include "../core/VirtualClock.hpp"
+
+// Headless desktop for benchmarks and tests
+// Install() swaps the OS backends of hotkeys, windows, keyboard hooks,
+// input injection and screen capture for their in-memory counterparts, on
+// any platform, and keeps typed pointers to them so the caller can play the
+// user: press chords, type keys, switch windows and read back what scripts
+// sent. Everything above the backends (MessageLoop, worker pool, Lua API)
+// is the real engine. Timers and coroutine waits follow the wall clock
+// unless a VirtualClock drives them from their own thread. Processes, the
+// store and the control channel keep their OS implementations.
+struct Simulation {
+    static inline MemoryEventSource* events = nullptr;        // Behind HotkeyManager::events
+    static inline MemoryWindowProvider* windows = nullptr;    // Behind WindowManager::provider
+    static inline SyntheticInputCapture* capture = nullptr;   // Behind InputHooks::capture
+    static inline RecordingInputSink* sink = nullptr;         // Behind InputManager::sink, still probed
+    static inline MemoryFrameSource* screen = nullptr;        // Behind Screen::source
+
+    // Installs the simulated backends
+    // Must run before the MessageLoop starts and before any script loads
+    static void Install();
+};
@@ -0,0 +1,193 @@
+#include "../core/Stats.hpp"
+#include "../core/ScriptState.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace {
+    // Background thread appending snapshots to a file
+    class Dumper {
+    public:
+        ~Dumper() { Stop(); }
+
+        void Start(std::string path, Probe::Clock::duration interval) {
+            Stop();
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = false;
+            thread = std::thread([this, path = std::move(path), interval] { Run(path, interval); });
+        }
+
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            if (thread.joinable()) thread.join();
+        }
+
+    private:
+        void Run(const std::string& path, Probe::Clock::duration interval) {
+            auto next = Probe::Clock::now() + interval;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!wake.wait_until(lock, next, [this] { return stopping; })) {
+                next += interval;
+                std::ofstream file(path, std::ios::app);
+                if (!(file << Stats::Snapshot() << '\n')) {
+                    Log::Err() << "[Error] Cannot write stats to " << path;
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;    // Guarded by mutex
+        std::thread thread;
+    };
+
+    Dumper dumper;
+
+    std::string JsonString(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if ((unsigned char)c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+        return out + "\"";
+    }
+
+    std::string JsonProbe(const Probe& probe) {
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+                      "\"calls\":%llu,\"errors\":%llu,\"mean_us\":%.1f,\"p50_us\":%llu,\"p99_us\":%llu,\"max_us\":%llu",
+                      (unsigned long long)probe.latency.Count(), (unsigned long long)probe.errors.load(),
+                      probe.latency.Mean(), (unsigned long long)probe.latency.Percentile(0.50),
+                      (unsigned long long)probe.latency.Percentile(0.99), (unsigned long long)probe.latency.Max());
+        return buffer;
+    }
+
+    void Fill(sol::table& table, const Probe& probe) {
+        table["calls"] = probe.latency.Count();
+        table["errors"] = probe.errors.load();
+        table["mean"] = probe.latency.Mean() / 1000.0;
+        table["p50"] = probe.latency.Percentile(0.50) / 1000.0;
+        table["p99"] = probe.latency.Percentile(0.99) / 1000.0;
+        table["max"] = probe.latency.Max() / 1000.0;
+    }
+
+    double Total(const Probe& probe) {
+        return probe.latency.Mean() * (double)probe.latency.Count();
+    }
+}
+
+std::shared_ptr<Probe> Stats::ForBinding(Probe& category, const sol::function& callback) {
+    std::string name = "?";
+    if (lua_State* L = callback.lua_state()) {
+        lua_Debug ar;
+        callback.push(L);
+        if (lua_getinfo(L, ">S", &ar)) {
+            name = ar.linedefined > 0 ? std::string(ar.short_src) + ":" + std::to_string(ar.linedefined) : ar.short_src;
+        }
+    }
+
+    auto probe = std::make_shared<Probe>(std::move(name), &category);
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::erase_if(registry, [](const std::weak_ptr<Probe>& p) { return p.expired(); });
+    registry.push_back(probe);
+    return probe;
+}
+
+std::vector<std::shared_ptr<Probe>> Stats::Bindings() {
+    std::vector<std::shared_ptr<Probe>> live;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::erase_if(registry, [&](const std::weak_ptr<Probe>& weak) {
+        auto probe = weak.lock();
+        if (probe) live.push_back(std::move(probe));
+        return !probe;
+    });
+    std::sort(live.begin(), live.end(), [](const auto& a, const auto& b) { return Total(*a) > Total(*b); });
+    return live;
+}
+
+void Stats::Reset() {
+    for (Probe* probe : { &hotkey, &timer, &send, &reload, &gc, &dispatch, &swap }) probe->Reset();
+    for (auto& probe : Bindings()) probe->Reset();
+}
+
+std::string Stats::Snapshot() {
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+    std::string out = "{\"time_ms\":" + std::to_string(now.count());
+    for (Probe* probe : { &hotkey, &timer, &send, &reload, &gc, &dispatch, &swap }) {
+        out += ",\"" + probe->name + "\":{" + JsonProbe(*probe) + "}";
+    }
+    out += ",\"bindings\":[";
+    bool first = true;
+    for (auto& probe : Bindings()) {
+        if (!first) out += ",";
+        first = false;
+        out += "{\"name\":" + JsonString(probe->name) + ",\"kind\":\"" + probe->category->name + "\"," + JsonProbe(*probe) + "}";
+    }
+    return out + "]}";
+}
+
+void Stats::Dump(const std::string& path, Probe::Clock::duration interval) {
+    if (path.empty()) {
+        dumper.Stop();
+        return;
+    }
+    dumper.Start(path, interval);
+}
+
+sol::table Stats::LuaStats(sol::optional<bool> reset, sol::this_state ts) {
+    sol::state_view lua(ts);
+    sol::table result = lua.create_table();
+    for (Probe* probe : { &hotkey, &timer, &send, &reload, &gc, &dispatch, &swap }) {
+        sol::table entry = lua.create_table();
+        Fill(entry, *probe);
+        result[probe->name] = entry;
+    }
+
+    sol::table bindings = lua.create_table();
+    int index = 1;
+    for (auto& probe : Bindings()) {
+        sol::table entry = lua.create_table();
+        entry["name"] = probe->name;
+        entry["kind"] = probe->category->name;
+        entry["total"] = Total(*probe) / 1000.0;
+        Fill(entry, *probe);
+        bindings[index++] = entry;
+    }
+    result["bindings"] = bindings;
+
+    ScriptState& state = ScriptState::From(ts);
+    sol::table memory = lua.create_table();
+    memory["used"] = state.allocator.InUse();
+    memory["peak"] = state.allocator.Peak();
+    memory["reserved"] = state.allocator.Reserved();
+    memory["allocations"] = state.allocator.Allocations();
+    memory["gc_mode"] = ScriptState::Name(state.GetGcMode());
+    result["lua"] = memory;
+
+    if (reset.value_or(false)) {
+        Reset();
+        state.allocator.ResetPeak();
+    }
+    return result;
+}
+
+void Stats::LuaDump(sol::optional<std::string> path, sol::optional<double> seconds) {
+    double interval = (std::max)(seconds.value_or(60.0), 0.1);
+    Dump(path.value_or(""), std::chrono::duration_cast<Probe::Clock::duration>(std::chrono::duration<double>(interval)));
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../utils/Histogram.hpp"
+
+// Call counter and latency histogram of one instrumented site
+// Recording is lock-free and safe from any thread. A probe that belongs to
+// a single binding also feeds the probe of its category, so the category
+// totals cover bindings that have since been removed
+struct Probe {
+    using Clock = std::chrono::steady_clock;
+
+    explicit Probe(std::string name, Probe* category = nullptr)
+        : name(std::move(name)), category(category) {}
+
+    // Records one call
+    // elapsed: Time the call took
+    // failed: The call raised an error or did not complete
+    void Record(Clock::duration elapsed, bool failed = false) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        latency.Record(us > 0 ? (uint64_t)us : 0);
+        if (failed) errors.fetch_add(1, std::memory_order_relaxed);
+        if (category) category->Record(elapsed, failed);
+    }
+
+    void Reset() {
+        latency.Reset();
+        errors.store(0, std::memory_order_relaxed);
+    }
+
+    const std::string name;       // Category name, or where a binding's callback is defined ("main.lua:12")
+    Probe* const category;        // Totals this probe also feeds, or nullptr for a category
+    std::atomic<uint64_t> errors = 0;
+    Histogram latency;            // Microseconds per call; its count is the call count
+};
+
+// Runtime instrumentation
+// Category probes cover hotkey and timer callbacks (Lua run time of the
+// whole callback, excluding time spent suspended in wait/sleep), SendInput
+// batches, script reloads and garbage collection slices. Every hotkey and timer additionally gets a
+// probe of its own, so slow bindings can be told apart. dispatch times each
+// hotkey event from the event source to its callback starting on the
+// script's worker: loop wake-up, chord resolution and the worker queue. swap
+// times how long each reload holds up dispatch while the MessageLoop trades
+// a script's bindings for the new ones.
+// Lua:
+//   local s = stats()              -- s.hotkey.p99, s.bindings[1].name, ...
+//   stats_dump("stats.jsonl", 60)  -- append a JSON snapshot every minute
+//   stats_dump()                   -- stop dumping
+struct Stats {
+    static inline Probe hotkey{ "hotkey" };
+    static inline Probe timer{ "timer" };
+    static inline Probe send{ "send" };
+    static inline Probe reload{ "reload" };
+    static inline Probe gc{ "gc" };
+    static inline Probe dispatch{ "dispatch" };
+    static inline Probe swap{ "swap" };
+
+    // Creates the probe of one binding
+    // category: Probe the binding's calls also count towards
+    // callback: Lua function whose definition names the probe; must belong
+    //           to the Lua thread running on the calling OS thread
+    static std::shared_ptr<Probe> ForBinding(Probe& category, const sol::function& callback);
+
+    // Resets every probe
+    static void Reset();
+
+    // One-line JSON snapshot of every probe, latencies in microseconds
+    static std::string Snapshot();
+
+    // Starts appending Snapshot() lines to path every interval; an empty path stops
+    static void Dump(const std::string& path, Probe::Clock::duration interval);
+
+    // Lua binding: stats([reset])
+    // Returns: { hotkey, timer, send, reload, gc, dispatch, swap, bindings } with latencies in
+    // milliseconds; bindings are sorted by total run time, slowest first;
+    // lua holds the calling state's memory counters
+    static sol::table LuaStats(sol::optional<bool> reset, sol::this_state ts);
+
+    // Lua binding: stats_dump([path], [seconds])
+    static void LuaDump(sol::optional<std::string> path, sol::optional<double> seconds);
+
+private:
+    // Live binding probes, pruned as bindings go away
+    static std::vector<std::shared_ptr<Probe>> Bindings();
+
+    static inline std::mutex registryMutex;
+    static inline std::vector<std::weak_ptr<Probe>> registry;  // Guarded by registryMutex
+};
@@ -0,0 +1,376 @@
+#include "../core/Store.hpp"
+#include "../core/ScriptState.hpp"
+#include "../core/ScriptValue.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+
+namespace {
+    constexpr char Magic[4] = { 'M', 'K', 'K', 'V' };
+    constexpr size_t PayloadPrefix = 1 + 4;   // Type byte and key length
+
+    // FNV-1a; detects records torn by a crash, not tampering
+    uint32_t Checksum(const uint8_t* data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    StoreLog::Type TypeOf(const Store::Value* value) {
+        if (!value) return StoreLog::Erase;
+        return (StoreLog::Type)(value->index() + 1);
+    }
+
+    size_t ValueSize(const Store::Value* value) {
+        if (!value) return 0;
+        if (auto text = std::get_if<std::string>(value)) return text->size();
+        return std::holds_alternative<bool>(*value) ? 1 : 8;
+    }
+
+    // Size of the record for a write
+    size_t RecordSize(const std::string& key, const Store::Value* value) {
+        return sizeof(StoreLog::RecordHeader) + PayloadPrefix + key.size() + ValueSize(value);
+    }
+
+    // Encodes a record at out, which has room for RecordSize bytes
+    void EncodeRecord(uint8_t* out, const std::string& key, const Store::Value* value) {
+        uint8_t* payload = out + sizeof(StoreLog::RecordHeader);
+        uint8_t* at = payload;
+        *at++ = TypeOf(value);
+        uint32_t keyLength = (uint32_t)key.size();
+        std::memcpy(at, &keyLength, 4);
+        at += 4;
+        std::memcpy(at, key.data(), key.size());
+        at += key.size();
+        if (value) {
+            std::visit([&](const auto& v) {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, bool>) {
+                    *at++ = v ? 1 : 0;
+                } else if constexpr (std::is_same_v<T, std::string>) {
+                    std::memcpy(at, v.data(), v.size());
+                    at += v.size();
+                } else {
+                    std::memcpy(at, &v, 8);
+                    at += 8;
+                }
+            }, *value);
+        }
+        StoreLog::RecordHeader header = { (uint32_t)(at - payload), Checksum(payload, (size_t)(at - payload)) };
+        std::memcpy(out, &header, sizeof(header));
+    }
+
+    // Decodes a record's payload; returns false if it is malformed
+    bool DecodePayload(const uint8_t* payload, uint32_t length, std::string& key, std::optional<Store::Value>& value) {
+        if (length < PayloadPrefix) return false;
+        uint8_t type = payload[0];
+        uint32_t keyLength;
+        std::memcpy(&keyLength, payload + 1, 4);
+        if (keyLength > length - PayloadPrefix) return false;
+        key.assign(reinterpret_cast<const char*>(payload + PayloadPrefix), keyLength);
+        const uint8_t* data = payload + PayloadPrefix + keyLength;
+        size_t size = length - PayloadPrefix - keyLength;
+
+        switch (type) {
+        case StoreLog::Erase:
+            value.reset();
+            return size == 0;
+        case StoreLog::Boolean:
+            if (size != 1) return false;
+            value = data[0] != 0;
+            return true;
+        case StoreLog::Integer: {
+            if (size != 8) return false;
+            lua_Integer integer;
+            std::memcpy(&integer, data, 8);
+            value = integer;
+            return true;
+        }
+        case StoreLog::Number: {
+            if (size != 8) return false;
+            lua_Number number;
+            std::memcpy(&number, data, 8);
+            value = number;
+            return true;
+        }
+        case StoreLog::String:
+            value = std::string(reinterpret_cast<const char*>(data), size);
+            return true;
+        }
+        return false;
+    }
+
+    // Converts a Lua value; fails for tables and anything that cannot be stored
+    bool FromScript(const ScriptValue& script, std::optional<Store::Value>& value) {
+        return std::visit([&](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::monostate>) {
+                value.reset();
+                return true;
+            } else if constexpr (std::is_same_v<T, std::shared_ptr<const ScriptTable>>) {
+                return false;
+            } else {
+                value = v;
+                return true;
+            }
+        }, script.value);
+    }
+
+    sol::object ToLua(lua_State* L, const Store::Value& value) {
+        ScriptValue script;
+        std::visit([&](const auto& v) { script.value = v; }, value);
+        script.Push(L);
+        sol::object object(L, -1);
+        lua_pop(L, 1);
+        return object;
+    }
+}
+
+bool Store::Open(const std::string& path) {
+    std::unique_lock lock(mutex);
+    file.Close();
+    entries.clear();
+    used = 0;
+    live = 0;
+    filePath = path;
+    if (!file.Open(path)) return false;
+    if (!Load()) {
+        file.Close();
+        return false;
+    }
+    if (used > compactThreshold && used - sizeof(StoreLog::Header) - live > live) CompactLocked();
+    return true;
+}
+
+void Store::Close() {
+    std::unique_lock lock(mutex);
+    file.Flush(true);
+    file.Close();
+}
+
+bool Store::Load() {
+    if (file.Size() == 0) {
+        // New store
+        if (!file.Resize(minCapacity)) return false;
+        StoreLog::Header header = {};
+        std::memcpy(header.magic, Magic, 4);
+        header.version = StoreLog::version;
+        std::memcpy(file.Data(), &header, sizeof(header));
+        used = sizeof(header);
+        return true;
+    }
+    StoreLog::Header header;
+    if (file.Size() < sizeof(header)) return false;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, 4) != 0 || header.version != StoreLog::version) return false;
+
+    const uint8_t* data = file.Data();
+    size_t size = file.Size();
+    size_t offset = sizeof(header);
+    bool torn = false;
+    std::string key;
+    std::optional<Value> value;
+    while (offset + sizeof(StoreLog::RecordHeader) <= size) {
+        StoreLog::RecordHeader record;
+        std::memcpy(&record, data + offset, sizeof(record));
+        if (record.length == 0) break;
+        const uint8_t* payload = data + offset + sizeof(record);
+        if (record.length > size - offset - sizeof(record) || Checksum(payload, record.length) != record.checksum ||
+            !DecodePayload(payload, record.length, key, value)) {
+            torn = true;
+            break;
+        }
+        uint32_t bytes = (uint32_t)(sizeof(record) + record.length);
+        auto it = entries.find(key);
+        if (it != entries.end()) live -= it->second.bytes;
+        if (!value) {
+            if (it != entries.end()) entries.erase(it);
+        } else if (it != entries.end()) {
+            it->second = { std::move(*value), bytes };
+            live += bytes;
+        } else {
+            entries.emplace(key, Entry{ std::move(*value), bytes });
+            live += bytes;
+        }
+        offset += bytes;
+    }
+    used = offset;
+    // New records go here; whatever follows (a torn write, or bytes left
+    // behind a zeroed header) must not be mistaken for them later. A clean
+    // tail is only read, so its pages stay untouched
+    uint8_t* tail = file.Data() + used;
+    if (torn || std::any_of(tail, tail + (size - used), [](uint8_t byte) { return byte != 0; })) {
+        std::memset(tail, 0, size - used);
+    }
+    if (torn) Log::Err() << "[System] Store " << filePath << ": dropped an incomplete write at the end";
+    return true;
+}
+
+uint32_t Store::Append(const std::string& key, const Value* value) {
+    size_t bytes = RecordSize(key, value);
+    if (!file.IsOpen()) return (uint32_t)bytes;
+    if (used + bytes > file.Size()) {
+        size_t capacity = std::max(file.Size(), minCapacity);
+        while (capacity < used + bytes) capacity *= 2;
+        if (!file.Resize(capacity)) {
+            Log::Err() << "[Error] Store " << filePath << " cannot grow; the value of " << key.substr(key.find('\0') + 1)
+                       << " will not persist";
+            return (uint32_t)bytes;
+        }
+    }
+    EncodeRecord(file.Data() + used, key, value);
+    used += bytes;
+    return (uint32_t)bytes;
+}
+
+void Store::Write(const std::string& key, const Value* value) {
+    auto it = entries.find(key);
+    if (!value) {
+        if (it == entries.end()) return;
+        live -= it->second.bytes;
+        entries.erase(it);
+        Append(key, nullptr);
+    } else {
+        uint32_t bytes = Append(key, value);
+        if (it != entries.end()) {
+            live -= it->second.bytes;
+            it->second = { *value, bytes };
+        } else {
+            entries.emplace(key, Entry{ *value, bytes });
+        }
+        live += bytes;
+    }
+    // More than half of the log is overwritten values
+    if (used > compactThreshold && used - sizeof(StoreLog::Header) - live > live) CompactLocked();
+}
+
+std::optional<Store::Value> Store::Get(const std::string& key) {
+    std::shared_lock lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) return std::nullopt;
+    return it->second.value;
+}
+
+void Store::Set(const std::string& key, const std::optional<Value>& value) {
+    std::unique_lock lock(mutex);
+    Write(key, value ? &*value : nullptr);
+}
+
+std::optional<Store::Value> Store::Incr(const std::string& key, const Value& by) {
+    std::unique_lock lock(mutex);
+    Value current = lua_Integer(0);
+    auto it = entries.find(key);
+    if (it != entries.end()) current = it->second.value;
+
+    Value result;
+    auto* a = std::get_if<lua_Integer>(&current);
+    auto* b = std::get_if<lua_Integer>(&by);
+    if (a && b) {
+        // Wraps around like Lua integer arithmetic
+        result = (lua_Integer)((uint64_t)*a + (uint64_t)*b);
+    } else {
+        auto number = [](const Value& v) -> std::optional<lua_Number> {
+            if (auto i = std::get_if<lua_Integer>(&v)) return (lua_Number)*i;
+            if (auto n = std::get_if<lua_Number>(&v)) return *n;
+            return std::nullopt;
+        };
+        auto x = number(current), y = number(by);
+        if (!x || !y) return std::nullopt;
+        result = *x + *y;
+    }
+    Write(key, &result);
+    return result;
+}
+
+void Store::Compact() {
+    std::unique_lock lock(mutex);
+    CompactLocked();
+}
+
+void Store::CompactLocked() {
+    if (!file.IsOpen()) return;
+    size_t length = sizeof(StoreLog::Header) + live;
+    std::string temp = filePath + ".tmp";
+    {
+        // Written in full and flushed before it replaces the old log
+        WritableMappedFile out;
+        if (!out.Open(temp) || !out.Resize(std::max(minCapacity, length * 2))) {
+            Log::Err() << "[Error] Store " << filePath << ": cannot write " << temp;
+            return;
+        }
+        std::memcpy(out.Data(), file.Data(), sizeof(StoreLog::Header));
+        size_t offset = sizeof(StoreLog::Header);
+        for (const auto& [key, entry] : entries) {
+            EncodeRecord(out.Data() + offset, key, &entry.value);
+            offset += entry.bytes;
+        }
+        out.Flush(true);
+    }
+
+    // A mapped file cannot be replaced on Windows
+    file.Close();
+    std::error_code error;
+    std::filesystem::rename(temp, filePath, error);
+    if (error) {
+        Log::Err() << "[Error] Store " << filePath << ": cannot replace it: " << error.message();
+        std::filesystem::remove(temp, error);
+    } else {
+        used = length;
+    }
+    if (!file.Open(filePath)) {
+        Log::Err() << "[Error] Store " << filePath << " cannot be reopened; new values will not persist";
+    }
+}
+
+size_t Store::Count() {
+    std::shared_lock lock(mutex);
+    return entries.size();
+}
+
+std::string Store::Key(const std::string& script, std::string_view name) {
+    // Script names cannot contain '\0', so no two namespaces overlap
+    std::string key;
+    key.reserve(script.size() + 1 + name.size());
+    key += script;
+    key += '\0';
+    key += name;
+    return key;
+}
+
+sol::object Store::LuaGet(const std::string& name, sol::object fallback, sol::this_state ts) {
+    auto value = Get(Key(ScriptState::From(ts).name, name));
+    if (!value) return fallback;
+    return ToLua(ts, *value);
+}
+
+void Store::LuaSet(const std::string& name, sol::object value, sol::this_state ts) {
+    std::optional<Value> stored;
+    if (!FromScript(ScriptValue::From(value), stored)) {
+        throw sol::error("store.set: only booleans, numbers and strings can be stored");
+    }
+    Set(Key(ScriptState::From(ts).name, name), stored);
+}
+
+sol::object Store::LuaIncr(const std::string& name, sol::optional<sol::object> by, sol::this_state ts) {
+    std::optional<Value> step = lua_Integer(1);
+    if (by && (!FromScript(ScriptValue::From(*by), step) || !step || std::holds_alternative<bool>(*step) ||
+               std::holds_alternative<std::string>(*step))) {
+        throw sol::error("store.incr: the increment must be a number");
+    }
+    auto result = Incr(Key(ScriptState::From(ts).name, name), *step);
+    if (!result) throw sol::error("store.incr: the value of '" + name + "' is not a number");
+    return ToLua(ts, *result);
+}
+
+void Store::Bind(sol::state& lua) {
+    auto store = lua.create_table();
+    store.set_function("get", &Store::LuaGet);
+    store.set_function("set", &Store::LuaSet);
+    store.set_function("incr", &Store::LuaIncr);
+    lua["store"] = store;
+}
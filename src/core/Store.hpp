@@ -0,0 +1,131 @@
+#pragma once
+#include <sol/sol.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include "../platform/WritableMappedFile.hpp"
+
+// Store file format
+// A 16-byte header followed by an append-only log of records:
+//   header: "MKKV", version, 11 reserved bytes
+//   record: payload length (u32 LE), FNV-1a of the payload (u32 LE), payload
+//   payload: type byte, key length (u32 LE), key, value
+//            (bool: 1 byte; integer, number: 8 bytes; string: the rest; erase: nothing)
+// The file is longer than the log; the unused tail is zero, and a zero
+// length ends the log.
+namespace StoreLog {
+    constexpr uint8_t version = 1;
+
+    enum Type : uint8_t {
+        Erase,
+        Boolean,
+        Integer,
+        Number,
+        String
+    };
+
+#pragma pack(push, 1)
+    struct Header {
+        char magic[4];
+        uint8_t version;
+        uint8_t reserved[11];
+    };
+
+    struct RecordHeader {
+        uint32_t length;
+        uint32_t checksum;
+    };
+#pragma pack(pop)
+    static_assert(sizeof(Header) == 16);
+    static_assert(sizeof(RecordHeader) == 8);
+}
+
+// Persistent key-value store shared by all scripts
+// Values survive reloads and restarts. Every key lives in the namespace of
+// the script that wrote it, so scripts cannot clash. Reads are served from
+// an in-memory table. Writes update the table and append a record to the
+// log in a memory-mapped file: no system call and no fsync, yet a crash of
+// MoonKey loses nothing, since the data is already in the OS page cache.
+// After a crash of the OS the last records may be torn; loading stops at
+// the first record whose checksum fails, so the store comes back as of an
+// earlier write. Once more than half of a log above compactThreshold is
+// overwritten values, it is rewritten with only the live ones.
+// Lua:
+//   store.set("mode", "gaming")            -- nil deletes
+//   local mode = store.get("mode", "default")
+//   local n = store.incr("presses")        -- or store.incr("score", 2.5)
+struct Store {
+    // Stored value; Lua nil is the absence of one
+    using Value = std::variant<bool, lua_Integer, lua_Number, std::string>;
+
+    static inline std::string path = "moonkey.store";           // Store file, relative to the working directory
+    static inline size_t compactThreshold = 1 << 20;            // Log bytes below which it is never compacted
+    static inline size_t minCapacity = 64 * 1024;               // Initial file length; grows by doubling
+
+    // Opens a store file and loads it, replacing the values in memory
+    // Returns false if it cannot be used; values then only live in memory
+    static bool Open(const std::string& file);
+
+    // Writes the log back to disk and closes the file
+    static void Close();
+
+    // Returns the value of key, or nullopt if it is not set
+    static std::optional<Value> Get(const std::string& key);
+
+    // Sets key; nullopt deletes it
+    static void Set(const std::string& key, const std::optional<Value>& value);
+
+    // Adds by to the number under key; a missing key counts as 0
+    // Integers stay integers; anything else gives a float
+    // Returns the new value, or nullopt if the current value is not a number
+    static std::optional<Value> Incr(const std::string& key, const Value& by);
+
+    // Rewrites the log with only the live values
+    static void Compact();
+
+    // Number of keys set
+    static size_t Count();
+
+    // Key of name in a script's namespace
+    static std::string Key(const std::string& script, std::string_view name);
+
+    // Registers the store table
+    static void Bind(sol::state& lua);
+
+private:
+    struct Entry {
+        Value value;
+        uint32_t bytes;           // Size of the record holding it in the log
+    };
+
+    // Appends a record; value nullptr erases; mutex held exclusively
+    // Returns the record size
+    static uint32_t Append(const std::string& key, const Value* value);
+
+    // Applies one write to the table and the log; mutex held exclusively
+    static void Write(const std::string& key, const Value* value);
+
+    // Reads the log into the table; mutex held exclusively
+    // Returns false if the file is not a store
+    static bool Load();
+
+    // Compaction with the mutex already held exclusively
+    static void CompactLocked();
+
+    // Lua glue
+    static sol::object LuaGet(const std::string& name, sol::object fallback, sol::this_state ts);
+    static void LuaSet(const std::string& name, sol::object value, sol::this_state ts);
+    static sol::object LuaIncr(const std::string& name, sol::optional<sol::object> by, sol::this_state ts);
+
+    static inline std::shared_mutex mutex;
+    static inline std::unordered_map<std::string, Entry> entries;  // Guarded by mutex
+    static inline WritableMappedFile file;                          // Guarded by mutex
+    static inline std::string filePath;                              // Path of file
+    static inline size_t used = 0;                                   // Log end: header plus records
+    static inline size_t live = 0;                                   // Bytes of records holding current values
+};
@@ -0,0 +1,194 @@
+#include "../core/TextInjector.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <thread>
+
+void TextInjector::Write(const std::string& text, const WriteOptions& options, InputSink& sink) {
+    std::u16string units = DecodeUtf8(text);
+    if (units.empty()) return;
+
+    if (options.pasteThreshold > 0 && units.size() >= options.pasteThreshold && Paste(units, sink)) return;
+
+    TextPlan plan = Build(units, sink);
+    const InputEvent* events = plan.events.data();
+
+    switch (options.pacing) {
+    case PacingMode::None: {
+        size_t batch = (std::max)(options.batchSize, (size_t)1);
+        for (size_t i = 0; i < plan.events.size(); i += batch) {
+            if (!SendAll(sink, events + i, (std::min)(batch, plan.events.size() - i))) return;
+        }
+        break;
+    }
+    case PacingMode::Fixed: {
+        size_t begin = 0;
+        for (size_t end : plan.charEnds) {
+            if (!SendAll(sink, events + begin, end - begin)) return;
+            begin = end;
+            std::this_thread::sleep_for(options.delay);
+        }
+        // Trailing Shift release
+        SendAll(sink, events + begin, plan.events.size() - begin);
+        break;
+    }
+    case PacingMode::Adaptive: {
+        size_t chars = 8;
+        auto gap = std::chrono::milliseconds(1);
+        size_t begin = 0, next = 0;
+        while (begin < plan.events.size()) {
+            next = (std::min)(next + chars, plan.charEnds.size());
+            size_t end = next < plan.charEnds.size() ? plan.charEnds[next - 1] : plan.events.size();
+            size_t accepted = sink.Send(events + begin, end - begin);
+            if (accepted < end - begin) {
+                // Resume from the first rejected event with smaller, slower bursts
+                begin += accepted;
+                next = std::upper_bound(plan.charEnds.begin(), plan.charEnds.end(), begin) - plan.charEnds.begin();
+                chars = (std::max)(chars / 2, (size_t)1);
+                gap = (std::min)(gap * 2, std::chrono::milliseconds(64));
+                if (gap == std::chrono::milliseconds(64) && accepted == 0) {
+                    Log::Err() << "[Error] Text input was blocked.";
+                    return;
+                }
+            } else {
+                begin = end;
+                chars = (std::min)(chars * 2, (size_t)256);
+                gap = (std::max)(gap / 2, std::chrono::milliseconds(1));
+            }
+            if (begin < plan.events.size()) std::this_thread::sleep_for(gap);
+        }
+        break;
+    }
+    }
+}
+
+TextPlan TextInjector::Build(const std::u16string& text, InputSink& sink) {
+    TextPlan plan;
+    plan.events.reserve(text.size() * 2 + 2);
+    plan.charEnds.reserve(text.size());
+
+    bool shiftHeld = false;
+    auto setShift = [&](bool down) {
+        if (down == shiftHeld) return;
+        plan.events.push_back(InputEvent::Key(Vk::Shift, !down));
+        shiftHeld = down;
+    };
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        char16_t c = text[i];
+
+        // CRLF and lone CR/LF all become a single Enter
+        if (c == u'\r' && i + 1 < text.size() && text[i + 1] == u'\n') continue;
+        if (c == u'\r' || c == u'\n') {
+            setShift(false);
+            plan.events.push_back(InputEvent::Key(Vk::Return, false));
+            plan.events.push_back(InputEvent::Key(Vk::Return, true));
+            plan.charEnds.push_back(plan.events.size());
+            continue;
+        }
+
+        uint16_t vk;
+        bool shift;
+        if (sink.MapChar(c, vk, shift)) {
+            setShift(shift);
+            plan.events.push_back(InputEvent::Key(vk, false));
+            plan.events.push_back(InputEvent::Key(vk, true));
+        } else {
+            // Not on the layout: send the UTF-16 unit directly (surrogate halves one after another)
+            setShift(false);
+            plan.events.push_back(InputEvent::Unicode(c, false));
+            plan.events.push_back(InputEvent::Unicode(c, true));
+            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < text.size()) {
+                ++i;
+                plan.events.push_back(InputEvent::Unicode(text[i], false));
+                plan.events.push_back(InputEvent::Unicode(text[i], true));
+            }
+        }
+        plan.charEnds.push_back(plan.events.size());
+    }
+    setShift(false);
+    return plan;
+}
+
+std::u16string TextInjector::DecodeUtf8(const std::string& text) {
+    std::u16string out;
+    out.reserve(text.size());
+
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char lead = (unsigned char)text[i];
+        char32_t cp;
+        size_t length;
+        if (lead < 0x80)                { cp = lead; length = 1; }
+        else if ((lead & 0xE0) == 0xC0) { cp = lead & 0x1F; length = 2; }
+        else if ((lead & 0xF0) == 0xE0) { cp = lead & 0x0F; length = 3; }
+        else if ((lead & 0xF8) == 0xF0) { cp = lead & 0x07; length = 4; }
+        else { out.push_back(u'�'); ++i; continue; }
+
+        bool valid = i + length <= text.size();
+        for (size_t k = 1; valid && k < length; ++k) {
+            unsigned char next = (unsigned char)text[i + k];
+            valid = (next & 0xC0) == 0x80;
+            cp = (cp << 6) | (next & 0x3F);
+        }
+        if (!valid || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            out.push_back(u'�');
+            ++i;
+            continue;
+        }
+        i += length;
+
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            out.push_back((char16_t)(0xD800 + (cp >> 10)));
+            out.push_back((char16_t)(0xDC00 + (cp & 0x3FF)));
+        } else {
+            out.push_back((char16_t)cp);
+        }
+    }
+    return out;
+}
+
+PacingMode TextInjector::ParsePacing(const std::string& name) {
+    if (name == "fixed") return PacingMode::Fixed;
+    if (name == "adaptive") return PacingMode::Adaptive;
+    return PacingMode::None;
+}
+
+bool TextInjector::SendAll(InputSink& sink, const InputEvent* events, size_t count) {
+    // Only sends that get nothing through count towards giving up, so a
+    // long batch the OS takes in parts still arrives whole
+    int stalls = 0;
+    while (count > 0) {
+        size_t accepted = sink.Send(events, count);
+        events += accepted;
+        count -= accepted;
+        if (count == 0) break;
+        stalls = accepted > 0 ? 0 : stalls + 1;
+        if (stalls == 4) {
+            Log::Err() << "[Error] Text input was blocked.";
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5 << stalls));
+    }
+    return true;
+}
+
+bool TextInjector::Paste(const std::u16string& text, InputSink& sink) {
+    auto previous = sink.GetClipboardText();
+    if (!sink.SetClipboardText(text)) return false;
+
+    const InputEvent keys[] = {
+        InputEvent::Key(Vk::Control, false), InputEvent::Key(Vk::V, false),
+        InputEvent::Key(Vk::V, true), InputEvent::Key(Vk::Control, true),
+    };
+    if (!SendAll(sink, keys, 4)) return false;
+
+    // The target reads the clipboard asynchronously, so restore it later
+    if (previous) {
+        std::thread([&sink, text, restore = std::move(*previous)]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            if (sink.GetClipboardText() == text) sink.SetClipboardText(restore);
+        }).detach();
+    }
+    return true;
+}
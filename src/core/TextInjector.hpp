@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../platform/InputSink.hpp"
+
+// How keystrokes of a write() call are spread over time
+enum class PacingMode {
+    None,       // Send everything in large batches as fast as the OS accepts it
+    Fixed,      // One character at a time with a fixed delay in between
+    Adaptive    // Bursts that grow while input is accepted and shrink when it is not
+};
+
+// Per-call options for text injection
+struct WriteOptions {
+    PacingMode pacing = PacingMode::None;
+    std::chrono::milliseconds delay{ 15 };  // Delay between characters for Fixed pacing
+    size_t batchSize = 4096;                // Maximum events per submission for None pacing
+    size_t pasteThreshold = 0;              // Paste through the clipboard from this many characters (0 = never)
+};
+
+// Fully built event sequence for a piece of text
+struct TextPlan {
+    std::vector<InputEvent> events;
+    std::vector<size_t> charEnds;   // events index just past each character's events
+};
+
+// Text injection engine behind InputManager::WriteText
+// Builds the whole event sequence up front: characters on the current layout
+// become virtual key events (Shift is held across runs of shifted characters),
+// everything else becomes Unicode events, so no character is dropped. The
+// sequence is then submitted in batches according to the pacing mode, or
+// pasted through the clipboard for very long strings.
+struct TextInjector {
+    // Types text through the sink
+    // text: UTF-8 string
+    static void Write(const std::string& text, const WriteOptions& options, InputSink& sink);
+
+    // Builds the event sequence for text without sending it
+    static TextPlan Build(const std::u16string& text, InputSink& sink);
+
+    // Decodes UTF-8 into UTF-16; invalid sequences become U+FFFD
+    static std::u16string DecodeUtf8(const std::string& text);
+
+    // Parses a pacing mode name from Lua ("none", "fixed", "adaptive")
+    // Unknown names fall back to None
+    static PacingMode ParsePacing(const std::string& name);
+
+private:
+    // Sends events, retrying the part the OS did not accept
+    // Returns false if input stayed blocked
+    static bool SendAll(InputSink& sink, const InputEvent* events, size_t count);
+
+    // Puts text on the clipboard and sends Ctrl+V
+    // The previous clipboard text is restored shortly afterwards
+    static bool Paste(const std::u16string& text, InputSink& sink);
+};
@@ -0,0 +1,39 @@
+#include "../core/VirtualClock.hpp"
+#include "../api/TimerManager.hpp"
+#include "../core/CoroutineScheduler.hpp"
+#include <algorithm>
+
+VirtualClock::~VirtualClock() {
+    if (attached) CoroutineScheduler::UseClock(nullptr);
+}
+
+void VirtualClock::Attach() {
+    CoroutineScheduler::UseClock(&now);
+    attached = true;
+}
+
+void VirtualClock::AdvanceTimers(Clock::duration step) {
+    now += step;
+    TimerManager::Update(now);
+}
+
+bool VirtualClock::NextTimer() {
+    auto next = TimerManager::NextDeadline();
+    if (!next) return false;
+    now = (std::max)(now, *next);
+    TimerManager::Update(now);
+    return true;
+}
+
+void VirtualClock::AdvanceCoroutines(Clock::duration step) {
+    now += step;
+    CoroutineScheduler::Update(now);
+}
+
+bool VirtualClock::NextCoroutine() {
+    auto next = CoroutineScheduler::NextDeadline();
+    if (!next) return false;
+    now = (std::max)(now, *next);
+    CoroutineScheduler::Update(now);
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+
+// Clock that only moves when told to
+// Drives the timer heap and the coroutine scheduler through their explicit
+// clock readings (TimerManager::Update(now), CoroutineScheduler::Update(now)),
+// so schedules are checked against exact times and a benchmark pays for the
+// scheduling alone. The timer methods must run on the MessageLoop thread and
+// the coroutine methods on the worker whose coroutines they resume; inside a
+// task posted there, the owning loop does not run its own Update() meanwhile.
+// Coroutines measure their waits from this clock once it is attached.
+class VirtualClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit VirtualClock(Clock::time_point start = Clock::now()) : now(start) {}
+    ~VirtualClock();
+
+    VirtualClock(const VirtualClock&) = delete;
+    VirtualClock& operator=(const VirtualClock&) = delete;
+
+    // Makes wait()/sleep() on the calling thread count from this clock
+    // Detached again when the clock is destroyed, which must happen on the
+    // same thread
+    void Attach();
+
+    // Current virtual time
+    Clock::time_point Now() const { return now; }
+
+    // Moves time forward by step and fires the timers due by then
+    void AdvanceTimers(Clock::duration step);
+
+    // Moves time to the next timer deadline and fires what is due there
+    // Returns false when no timer is registered
+    bool NextTimer();
+
+    // Moves time forward by step and resumes the coroutines due by then
+    void AdvanceCoroutines(Clock::duration step);
+
+    // Moves time to the next wait deadline and resumes what is due there
+    // Returns false when no coroutine is waiting
+    bool NextCoroutine();
+
+private:
+    Clock::time_point now;
+    bool attached = false;
+};
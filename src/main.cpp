@@ -1,53 +1,31 @@
 #include <sol/sol.hpp>
-#include <iostream>
 #include <filesystem>
 #include <thread>
-#include <chrono>
+#include <algorithm>
+#include <set>
 #include "core/HotkeyManager.hpp"
-#include "api/InputManager.hpp"
-#include "api/WindowManager.hpp"
-#include "utils/KeyCodes.hpp"
 #include "core/Directory.hpp"
-#include "api/TimerManager.hpp"
-
-std::atomic<bool> needReload = false;
-
-// Initializes the Lua environment with all API functions
-// Sets up all exposed C++ functions and constants
-void SetupLuaEnvironment(sol::state& lua) {
-    lua.open_libraries(sol::lib::base, sol::lib::package, sol::lib::string);
-
-    // Lua API functions
-    lua.set_function("log", [](const std::string& m) { std::cout << "[Lua]: " << m << std::endl; });
-    lua.set_function("bind", &HotkeyManager::Add);
-    lua.set_function("send", &InputManager::SimulateKeyPress);
-    lua.set_function("focus", [](const std::string& windowTitle) { WindowManager::SetFocusToWindow(windowTitle); });
-    lua.set_function("write", [](const std::string& text) { InputManager::WriteText(text); });
-    lua.set_function("wait", [](float seconds) { std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(seconds * 1000))); });
-    lua.set_function("sleep", [](float milliseconds) { std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(milliseconds))); });
-    lua.set_function("mouse_move", &InputManager::SetMousePos);
-    lua.set_function("mouse_click", &InputManager::MouseClick);
-    lua.set_function("mouse_pos", &InputManager::GetMousePos);
-    lua.set_function("set_interval", &TimerManager::Add);
-
-    KeyCodes::Bind(lua);
-}
-
-// Cleans and reinitializes the Lua environment
-// Called during hot-reload to reset the scripting environment
-void ResetLuaEnvironment(sol::state& lua) {
-    lua.collect_garbage();
-    SetupLuaEnvironment(lua);
-}
+#include "core/ScriptModules.hpp"
+#include "core/ScriptHost.hpp"
+#include "core/ControlChannel.hpp"
+#include "core/Store.hpp"
+#include "core/LuaEnvironment.hpp"
+#include "utils/Log.hpp"
 
 // Main application entry point
 // Initializes all subsystems and runs the main loop with hot-reload capability
 int main() {
+    // Owned by this thread; the directory thread publishes into it
     EventDispatcher dispatcher;
+    std::set<std::string> changed;
 
     // Subscribe for hot-reload events
-    dispatcher.subscribe("OnDirectoryChange", [&]() {
-        needReload = true;
+    dispatcher.subscribe(Directory::Changed, [&](const std::vector<std::string>& paths) {
+        changed.insert(paths.begin(), paths.end());
+    });
+    // Reloads asked for over the control channel take the same path
+    dispatcher.subscribe(ControlChannel::ReloadRequested, [&](const std::vector<std::string>& names) {
+        changed.insert(names.begin(), names.end());
     });
     
     // Start hotkey message loop in separate thread
@@ -55,34 +33,62 @@ int main() {
     msgThread.detach();
 
     // Start directory monitoring thread
-    std::thread dirThread(Directory::DirectoryChangesLoop, L"scripts", std::ref(dispatcher));
+    std::thread dirThread(Directory::DirectoryChangesLoop, ScriptHost::root, std::ref(dispatcher));
     dirThread.detach();
 
-    const std::string path = "scripts/main.lua";
+    // Serve local control clients (moonkey-ctl, launchers)
+    ControlChannel::Start(dispatcher);
 
-    // Main loop with hot-reload support
+    // Persistent values must be loaded before any script reads them
+    if (!Store::Open(Store::path)) {
+        Log::Err() << "[Error] Cannot open " << Store::path << "; store values will not persist";
+    }
+
+    // Every top-level script gets its own state on the worker pool
+    ScriptHost::environment = SetupLuaEnvironment;
+    ScriptHost::Start();
+    std::set<std::string> loaded;
+    for (const auto& name : ScriptHost::Scan()) {
+        ScriptHost::Load(name);
+        loaded.insert(name);
+    }
+
+    // Wait for reload signals; a changed script is reloaded on its own,
+    // changed modules are re-run in place in the scripts that use them
     while (true) {
-        sol::state lua;
-        SetupLuaEnvironment(lua);
-        needReload = false;
+        dispatcher.wait();
+        dispatcher.drain();
 
-        std::cout << "[System] Loading script..." << std::endl;
+        std::vector<std::string> changes(changed.begin(), changed.end());
+        changed.clear();
+        if (changes.empty()) continue;
 
-        try { 
-            lua.script_file(path); 
-        } 
-        catch (const sol::error& e) { 
-            std::cerr << "[Lua Error] " << e.what() << std::endl; 
-        }
-        
-        // Wait for reload signal
-        while (!needReload) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::find(changes.begin(), changes.end(), std::string()) != changes.end()) {
+            // Changes were lost: rebuild everything from what is on disk
+            Log::Out() << "[System] Reloading all scripts...";
+            auto names = ScriptHost::Scan();
+            for (const auto& name : loaded) {
+                if (std::find(names.begin(), names.end(), name) == names.end()) ScriptHost::Unload(name);
+            }
+            loaded = std::set<std::string>(names.begin(), names.end());
+            for (const auto& name : names) ScriptHost::Load(name);
+            continue;
         }
 
-        std::cout << "[System] Reloading environment..." << std::endl;
-        HotkeyManager::Clear();
+        std::vector<std::string> modules;
+        for (const auto& change : changes) {
+            auto name = ScriptModules::ScriptName(change);
+            if (!name) {
+                modules.push_back(change);
+            } else if (std::filesystem::exists(ScriptHost::root + "/" + *name)) {
+                ScriptHost::Load(*name);
+                loaded.insert(*name);
+            } else if (loaded.erase(*name)) {
+                ScriptHost::Unload(*name);
+            }
+        }
+        if (!modules.empty()) ScriptHost::ReloadModules(modules);
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Local stream endpoint that other processes connect to
+// One I/O thread (the one in Run) serves every client through the OS's
+// asynchronous I/O, so clients cost no thread of their own. The server
+// only moves bytes; framing is up to the handler.
+class ControlServer {
+public:
+    struct Handler {
+        // Bytes received from a client
+        std::function<void(uint64_t client, const char* data, size_t size)> data;
+        // A client disconnected or was dropped; no data follows
+        std::function<void(uint64_t client)> closed;
+    };
+
+    static inline size_t maxBacklog = 16 << 20;   // Unsent bytes at which a client that does not read is dropped
+
+    virtual ~ControlServer() = default;
+
+    // Listens on endpoint and runs the I/O loop, delivering to handler
+    // Called once, on a dedicated thread; only returns if listening fails,
+    // with error set
+    virtual void Run(const std::string& endpoint, Handler handler, std::string& error) = 0;
+
+    // Sends bytes to a client; safe to call from any thread
+    // Bytes the client cannot take yet are queued; ignored once it is gone
+    virtual void Send(uint64_t client, std::string data) = 0;
+
+    // Disconnects a client; safe to call from any thread
+    virtual void Close(uint64_t client) = 0;
+};
+
+// Creates the control server for the current platform
+// Win32ControlServer (named pipe) on Windows, EpollControlServer (Unix socket) on Linux
+std::unique_ptr<ControlServer> CreateDefaultControlServer();
@@ -0,0 +1,187 @@
+#ifdef __linux__
+#include "EpollControlServer.hpp"
+#include "../utils/Log.hpp"
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    // epoll data of the listening socket; clients are numbered from 1
+    constexpr uint64_t ListenerTag = 0;
+}
+
+std::unique_ptr<ControlServer> CreateDefaultControlServer() {
+    return std::make_unique<EpollControlServer>();
+}
+
+EpollControlServer::~EpollControlServer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [id, client] : clients) close(client.fd);
+    if (listener >= 0) {
+        close(listener);
+        unlink(path.c_str());
+    }
+    if (epoll >= 0) close(epoll);
+}
+
+void EpollControlServer::Run(const std::string& endpoint, Handler handler, std::string& error) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (endpoint.size() >= sizeof(address.sun_path)) {
+        error = "socket path too long: " + endpoint;
+        return;
+    }
+    std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (listener < 0 || epoll < 0) {
+        error = std::strerror(errno);
+        return;
+    }
+    // A socket file nobody answers on is left over from a crash
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool taken = connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    close(probe);
+    if (taken) {
+        error = endpoint + " is in use by another instance";
+        return;
+    }
+    // Only ever remove a socket: a mistyped endpoint must not delete a file
+    struct stat existing;
+    if (lstat(endpoint.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            error = endpoint + " exists and is not a socket";
+            return;
+        }
+        unlink(endpoint.c_str());
+    }
+
+    // Owner-only from the start; other users must not drive our input
+    mode_t mask = umask(0077);
+    int bound = bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    umask(mask);
+    if (bound != 0 || listen(listener, SOMAXCONN) != 0) {
+        error = endpoint + ": " + std::strerror(errno);
+        return;
+    }
+    path = endpoint;
+    epoll_event event = { EPOLLIN, {} };
+    event.data.u64 = ListenerTag;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+
+    std::vector<char> buffer(readSize);
+    epoll_event events[64];
+    while (true) {
+        int count = epoll_wait(epoll, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            error = std::strerror(errno);
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == ListenerTag) {
+                int fd;
+                while ((fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    uint64_t client = nextId++;
+                    clients[client].fd = fd;
+                    epoll_event added = { EPOLLIN, {} };
+                    added.data.u64 = client;
+                    epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &added);
+                }
+                continue;
+            }
+
+            if (events[i].events & EPOLLOUT) {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = clients.find(id);
+                if (it != clients.end() && !Flush(id, it->second)) {
+                    Drop(id);
+                    handler.closed(id);
+                    continue;
+                }
+            }
+            if (!(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) continue;
+
+            // Only this thread closes sockets, so the descriptor stays valid outside the lock
+            int fd;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = clients.find(id);
+                if (it == clients.end()) continue;
+                fd = it->second.fd;
+            }
+            ssize_t length = read(fd, buffer.data(), buffer.size());
+            if (length < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+            if (length > 0) {
+                handler.data(id, buffer.data(), (size_t)length);
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                Drop(id);
+            }
+            handler.closed(id);
+        }
+    }
+}
+
+void EpollControlServer::Send(uint64_t id, std::string data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = clients.find(id);
+    if (it == clients.end()) return;
+    Client& client = it->second;
+    client.outbox += data;
+    if (!client.writable) {
+        // The I/O thread writes the rest once there is room
+        if (client.outbox.size() > maxBacklog) shutdown(client.fd, SHUT_RDWR);
+        return;
+    }
+    // A failed write surfaces as a hang-up on the I/O thread
+    if (!Flush(id, client)) shutdown(client.fd, SHUT_RDWR);
+}
+
+void EpollControlServer::Close(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = clients.find(id);
+    // The I/O thread sees the hang-up and drops it
+    if (it != clients.end()) shutdown(it->second.fd, SHUT_RDWR);
+}
+
+bool EpollControlServer::Flush(uint64_t id, Client& client) {
+    size_t written = 0;
+    while (written < client.outbox.size()) {
+        ssize_t sent = send(client.fd, client.outbox.data() + written, client.outbox.size() - written, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) return false;
+            break;
+        }
+        written += (size_t)sent;
+    }
+    client.outbox.erase(0, written);
+    bool writable = client.outbox.empty();
+    if (writable != client.writable) {
+        client.writable = writable;
+        epoll_event event = { writable ? (uint32_t)EPOLLIN : (uint32_t)(EPOLLIN | EPOLLOUT), {} };
+        event.data.u64 = id;
+        epoll_ctl(epoll, EPOLL_CTL_MOD, client.fd, &event);
+    }
+    return true;
+}
+
+void EpollControlServer::Drop(uint64_t id) {
+    auto it = clients.find(id);
+    if (it == clients.end()) return;
+    epoll_ctl(epoll, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    close(it->second.fd);
+    clients.erase(it);
+}
+#endif
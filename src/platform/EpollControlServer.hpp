@@ -0,0 +1,43 @@
+#pragma once
+#ifdef __linux__
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "ControlServer.hpp"
+
+// Linux control server on a Unix domain socket, served with epoll
+// The socket file is created with owner-only permissions. Replies are
+// written straight from the sending thread when the socket has room; only
+// what does not fit waits for EPOLLOUT on the I/O thread
+class EpollControlServer : public ControlServer {
+public:
+    static inline size_t readSize = 64 * 1024;    // Bytes per read
+
+    ~EpollControlServer() override;
+
+    void Run(const std::string& endpoint, Handler handler, std::string& error) override;
+    void Send(uint64_t client, std::string data) override;
+    void Close(uint64_t client) override;
+
+private:
+    struct Client {
+        int fd = -1;
+        std::string outbox;       // Bytes not written yet
+        bool writable = true;     // EPOLLOUT is not armed
+    };
+
+    // Writes as much of a client's outbox as the socket takes; mutex held
+    // Returns false if the connection failed
+    bool Flush(uint64_t id, Client& client);
+
+    // Closes a client and forgets it; I/O thread, mutex held
+    void Drop(uint64_t id);
+
+    int epoll = -1;
+    int listener = -1;
+    std::string path;
+    uint64_t nextId = 1;          // I/O thread only
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Client> clients;  // Guarded by mutex
+};
+#endif
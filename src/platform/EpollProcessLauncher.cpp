@@ -0,0 +1,252 @@
+#ifdef __linux__
+#include "EpollProcessLauncher.hpp"
+#include "../utils/Log.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <string_view>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+    // Low bits of the epoll data tell the three descriptors of a child apart
+    constexpr uint64_t PidTag = 2;
+
+    uint64_t Tag(uint64_t id, uint64_t tag) { return (id << 2) | tag; }
+
+    // Our environment with the overrides applied
+    std::vector<std::string> BuildEnvironment(const std::vector<std::pair<std::string, std::string>>& overrides) {
+        std::vector<std::string> entries;
+        for (char** entry = environ; *entry; ++entry) {
+            std::string_view text(*entry);
+            std::string_view name = text.substr(0, text.find('='));
+            bool replaced = false;
+            for (const auto& [key, value] : overrides) replaced |= key == name;
+            if (!replaced) entries.emplace_back(text);
+        }
+        for (const auto& [key, value] : overrides) entries.push_back(key + "=" + value);
+        return entries;
+    }
+}
+
+std::unique_ptr<ProcessLauncher> CreateDefaultProcessLauncher() {
+    return std::make_unique<EpollProcessLauncher>();
+}
+
+EpollProcessLauncher::EpollProcessLauncher() {
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+}
+
+EpollProcessLauncher::~EpollProcessLauncher() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [id, child] : children) {
+        for (int fd : child.pipes) {
+            if (fd >= 0) close(fd);
+        }
+        if (child.pidfd >= 0) close(child.pidfd);
+    }
+    if (epoll >= 0) close(epoll);
+}
+
+bool EpollProcessLauncher::Launch(uint64_t id, const Options& options, std::string& error) {
+    if (epoll < 0) {
+        error = "epoll unavailable";
+        return false;
+    }
+    int out[2], err[2];
+    if (pipe2(out, O_CLOEXEC) != 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    if (pipe2(err, O_CLOEXEC) != 0) {
+        error = std::strerror(errno);
+        close(out[0]);
+        close(out[1]);
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, out[1], 1);
+    posix_spawn_file_actions_adddup2(&actions, err[1], 2);
+    if (!options.cwd.empty()) posix_spawn_file_actions_addchdir_np(&actions, options.cwd.c_str());
+
+    // Own process group so Kill reaches the whole tree; default signal
+    // dispositions and an empty mask, whatever the spawning thread had
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t none, all;
+    sigemptyset(&none);
+    sigfillset(&all);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setsigdefault(&attr, &all);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    std::vector<std::string> environment = BuildEnvironment(options.env);
+    std::vector<char*> envp;
+    envp.reserve(environment.size() + 1);
+    for (auto& entry : environment) envp.push_back(entry.data());
+    envp.push_back(nullptr);
+    std::string command = options.command;
+    char shell[] = "/bin/sh", flag[] = "-c";
+    char* argv[] = { shell, flag, command.data(), nullptr };
+
+    pid_t pid = -1;
+    int rc = posix_spawn(&pid, "/bin/sh", &actions, &attr, argv, envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(out[1]);
+    close(err[1]);
+    if (rc != 0) {
+        error = std::strerror(rc);
+        close(out[0]);
+        close(err[0]);
+        return false;
+    }
+
+    int pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+    if (pidfd < 0) {
+        error = std::string("pidfd_open: ") + std::strerror(errno);
+        kill(-pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        close(out[0]);
+        close(err[0]);
+        return false;
+    }
+    fcntl(out[0], F_SETFL, fcntl(out[0], F_GETFL) | O_NONBLOCK);
+    fcntl(err[0], F_SETFL, fcntl(err[0], F_GETFL) | O_NONBLOCK);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Child& child = children[id];
+    child.pid = pid;
+    child.pipes[0] = out[0];
+    child.pipes[1] = err[0];
+    child.pidfd = pidfd;
+    for (uint64_t stream = 0; stream < 2; ++stream) {
+        epoll_event event = { EPOLLIN, {} };
+        event.data.u64 = Tag(id, stream);
+        epoll_ctl(epoll, EPOLL_CTL_ADD, child.pipes[stream], &event);
+    }
+    epoll_event event = { EPOLLIN, {} };
+    event.data.u64 = Tag(id, PidTag);
+    epoll_ctl(epoll, EPOLL_CTL_ADD, pidfd, &event);
+    return true;
+}
+
+void EpollProcessLauncher::Kill(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = children.find(id);
+    // Until it is reaped the pid (and its group) cannot be reused
+    if (it != children.end() && it->second.pidfd >= 0) kill(-it->second.pid, SIGKILL);
+}
+
+void EpollProcessLauncher::Resume(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = children.find(id);
+    if (it == children.end()) return;
+    if (!it->second.paused) {
+        // The handler asked for a pause that this thread has not applied yet
+        it->second.resumed = true;
+        return;
+    }
+    it->second.paused = false;
+    Watch(id, it->second, true);
+}
+
+void EpollProcessLauncher::Watch(uint64_t id, Child& child, bool watched) {
+    // Removed rather than masked: a hung-up pipe reports EPOLLHUP whatever the mask
+    for (uint64_t stream = 0; stream < 2; ++stream) {
+        if (child.pipes[stream] < 0) continue;
+        epoll_event event = { EPOLLIN, {} };
+        event.data.u64 = Tag(id, stream);
+        epoll_ctl(epoll, watched ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, child.pipes[stream], &event);
+    }
+}
+
+bool EpollProcessLauncher::Finish(uint64_t id) {
+    auto it = children.find(id);
+    if (it == children.end()) return false;
+    const Child& child = it->second;
+    if (child.pipes[0] >= 0 || child.pipes[1] >= 0 || child.pidfd >= 0) return false;
+    children.erase(it);
+    return true;
+}
+
+void EpollProcessLauncher::Run(Handler handler) {
+    std::vector<char> buffer(readSize);
+    epoll_event events[64];
+    while (true) {
+        int count = epoll_wait(epoll, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            Log::Err() << "[Error] Process I/O loop stopped: " << std::strerror(errno);
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            uint64_t id = events[i].data.u64 >> 2;
+            uint64_t tag = events[i].data.u64 & 3;
+            int code = 0;
+            bool finished = false;
+
+            if (tag == PidTag) {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = children.find(id);
+                if (it == children.end() || it->second.pidfd < 0) continue;
+                Child& child = it->second;
+                int status = 0;
+                if (waitpid(child.pid, &status, WNOHANG) != child.pid) continue;
+                child.code = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+                close(child.pidfd);
+                child.pidfd = -1;
+                code = child.code;
+                finished = Finish(id);
+            } else {
+                // Only this thread closes pipes, so the descriptor stays valid outside the lock
+                int fd;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto it = children.find(id);
+                    // A paused child may still have a report in this batch
+                    if (it == children.end() || it->second.pipes[tag] < 0 || it->second.paused) continue;
+                    fd = it->second.pipes[tag];
+                }
+                // One read per readiness report; epoll is level-triggered, so
+                // a busy child cannot starve the others
+                ssize_t length = read(fd, buffer.data(), buffer.size());
+                if (length < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                if (length > 0) {
+                    if (handler.output(id, (Stream)tag, buffer.data(), (size_t)length)) continue;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto it = children.find(id);
+                    if (it == children.end() || it->second.paused) continue;
+                    if (it->second.resumed) {
+                        it->second.resumed = false;
+                    } else {
+                        it->second.paused = true;
+                        Watch(id, it->second, false);
+                    }
+                    continue;
+                }
+                // End of file, or an error that ends the stream just the same
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = children.find(id);
+                if (it == children.end()) continue;
+                if (!it->second.paused) epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+                close(fd);
+                it->second.pipes[tag] = -1;
+                code = it->second.code;
+                finished = Finish(id);
+            }
+            if (finished) handler.exit(id, code);
+        }
+    }
+}
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#ifdef __linux__
+#include <mutex>
+#include <unordered_map>
+#include <sys/types.h>
+#include "ProcessLauncher.hpp"
+
+// Linux process launcher using posix_spawn and epoll
+// Children run in a process group of their own, so Kill also reaches what
+// the shell started. Their non-blocking pipes and a pidfd per child are
+// watched by one epoll instance, so exits arrive through the same wait as
+// output. Pausing a child takes its pipes out of the interest set; the
+// child then blocks once the pipe buffer is full
+class EpollProcessLauncher : public ProcessLauncher {
+public:
+    static inline size_t readSize = 64 * 1024;    // Bytes per read; matches the default pipe buffer
+
+    EpollProcessLauncher();
+    ~EpollProcessLauncher() override;
+
+    void Run(Handler handler) override;
+    bool Launch(uint64_t id, const Options& options, std::string& error) override;
+    void Kill(uint64_t id) override;
+    void Resume(uint64_t id) override;
+
+private:
+    struct Child {
+        pid_t pid = -1;
+        int pipes[2] = { -1, -1 };    // Read ends of stdout and stderr; -1 after end of file
+        int pidfd = -1;               // -1 once the exit has been reaped
+        int code = 0;
+        bool paused = false;
+        bool resumed = false;         // Resume() arrived before the pause it answers
+    };
+
+    // Adds a child's open pipes to the interest set, or removes them; mutex held
+    void Watch(uint64_t id, Child& child, bool watched);
+
+    // Removes a child whose pipes are closed and exit reaped; mutex held
+    // Returns true if it was removed and its exit should be reported
+    bool Finish(uint64_t id);
+
+    int epoll = -1;
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Child> children;  // By caller ID; guarded by mutex
+};
+#endif
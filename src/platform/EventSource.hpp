@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <optional>
+
+// Event delivered by the OS event source to the hotkey message loop
+struct OsEvent {
+    enum class Type {
+        Hotkey,                   // Registered hotkey was pressed (id = hotkey ID)
+        DisplayChange,            // Monitors were added, removed, moved or resized
+        Quit                      // Loop should stop
+    };
+
+    Type type = Type::Hotkey;
+    int id = 0;                                 // Hotkey ID for Hotkey events
+    std::chrono::steady_clock::time_point time; // When the event was observed
+};
+
+// Source of OS input events for the hotkey message loop
+// Abstracts RegisterHotKey/MsgWaitForMultipleObjects so the loop can block
+// on a single wait primitive, and so an in-memory backend can drive it
+// without a desktop session
+class EventSource {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~EventSource() = default;
+
+    // Called once on the loop thread before any other call from that thread
+    virtual void Attach() {}
+
+    // Registers a hotkey for the loop thread
+    // id: Hotkey ID reported back in OsEvent::id
+    // mods: Modifier keys (MOD.ALT, MOD.CTRL, etc.)
+    // vk: Virtual key code
+    // Returns false if the OS refused the registration
+    virtual bool RegisterHotkey(int id, int mods, int vk) = 0;
+
+    // Releases a hotkey previously registered with RegisterHotkey
+    virtual void UnregisterHotkey(int id) = 0;
+
+    // Retrieves the next pending event without blocking
+    // Returns false when no event is pending
+    virtual bool Poll(OsEvent& event) = 0;
+
+    // Blocks until an event is pending, Wake() is called or the deadline passes
+    // deadline: Absolute wake-up time, or nullopt to wait indefinitely
+    virtual void Wait(std::optional<Clock::time_point> deadline) = 0;
+
+    // Whether an event is waiting to be polled
+    // Called on the loop thread between clock reads while it spins towards a
+    // timer deadline, so it must be cheap
+    virtual bool Pending() = 0;
+
+    // Interrupts a pending or upcoming Wait() from any thread
+    // A wake issued while the loop is busy is remembered, so the next Wait()
+    // returns immediately
+    virtual void Wake() = 0;
+};
+
+// Creates the event source for the current platform
+// Win32EventSource on Windows, MemoryEventSource elsewhere
+std::unique_ptr<EventSource> CreateDefaultEventSource();
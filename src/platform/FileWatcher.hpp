@@ -0,0 +1,29 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Recursive directory change notifications
+// Abstracts ReadDirectoryChangesW so hot reload can be driven by inotify
+// (or a test double) off Windows
+class FileWatcher {
+public:
+    virtual ~FileWatcher() = default;
+
+    // Starts watching a directory and its subdirectories
+    // Returns false if the directory cannot be watched
+    virtual bool Open(const std::string& directory) = 0;
+
+    // Waits for changes and appends the changed file paths
+    // changes: Receives paths relative to the watched directory, '/'-separated.
+    //          An empty path means events were lost and anything may have changed
+    // timeout: How long to wait, or nullopt to wait until something changes
+    // Returns false on a fatal error; the watcher cannot be used afterwards
+    virtual bool Read(std::vector<std::string>& changes, std::optional<std::chrono::milliseconds> timeout) = 0;
+};
+
+// Creates the file watcher for the current platform
+// Win32FileWatcher on Windows, InotifyFileWatcher on Linux
+std::unique_ptr<FileWatcher> CreateDefaultFileWatcher();
@@ -0,0 +1,66 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include "../utils/Bitmap.hpp"
+
+// Rectangle in virtual-desktop pixels
+// The origin may be negative when a monitor sits left of or above the primary one
+struct ScreenRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool Empty() const { return width <= 0 || height <= 0; }
+
+    bool Contains(const ScreenRect& other) const {
+        return other.x >= x && other.y >= y && other.x + other.width <= x + width &&
+               other.y + other.height <= y + height;
+    }
+
+    // Overlap of two rectangles; empty if they do not intersect
+    ScreenRect Intersect(const ScreenRect& other) const {
+        int left = (std::max)(x, other.x);
+        int top = (std::max)(y, other.y);
+        int right = (std::min)(x + width, other.x + other.width);
+        int bottom = (std::min)(y + height, other.y + other.height);
+        return { left, top, (std::max)(right - left, 0), (std::max)(bottom - top, 0) };
+    }
+
+    // Smallest rectangle covering both; an empty side is ignored
+    ScreenRect Union(const ScreenRect& other) const {
+        if (Empty()) return other;
+        if (other.Empty()) return *this;
+        int left = (std::min)(x, other.x);
+        int top = (std::min)(y, other.y);
+        int right = (std::max)(x + width, other.x + other.width);
+        int bottom = (std::max)(y + height, other.y + other.height);
+        return { left, top, right - left, bottom - top };
+    }
+};
+
+// Captured part of the screen
+struct Frame {
+    ScreenRect area;              // Screen rectangle the image covers
+    Bitmap image;                 // area.width x area.height pixels
+};
+
+// Source of screen pixels
+// Abstracts screen capture so the matching engine can run against in-memory
+// bitmaps off Windows, in tests and in benchmarks
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // Virtual desktop rectangle spanning all monitors
+    virtual ScreenRect Bounds() = 0;
+
+    // Copies area into out, reusing its buffer when the size is unchanged
+    // area must lie within Bounds()
+    // Returns false if the screen cannot be read
+    virtual bool Capture(const ScreenRect& area, Frame& out) = 0;
+};
+
+// Creates the frame source for the current platform
+// Win32FrameSource on Windows, MemoryFrameSource elsewhere
+std::unique_ptr<FrameSource> CreateDefaultFrameSource();
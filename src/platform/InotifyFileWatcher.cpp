@@ -0,0 +1,79 @@
+#ifdef __linux__
+#include "InotifyFileWatcher.hpp"
+#include <filesystem>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    constexpr uint32_t WatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+}
+
+std::unique_ptr<FileWatcher> CreateDefaultFileWatcher() {
+    return std::make_unique<InotifyFileWatcher>();
+}
+
+InotifyFileWatcher::~InotifyFileWatcher() {
+    if (fd >= 0) close(fd);
+}
+
+bool InotifyFileWatcher::Open(const std::string& directory) {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return false;
+    root = directory;
+    AddTree("");
+    return !watches.empty();
+}
+
+void InotifyFileWatcher::AddTree(const std::string& relative) {
+    std::filesystem::path path = relative.empty() ? std::filesystem::path(root) : std::filesystem::path(root) / relative;
+    int wd = inotify_add_watch(fd, path.c_str(), WatchMask);
+    if (wd < 0) return;
+    watches[wd] = relative;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+        if (entry.is_directory(ec)) {
+            std::string child = entry.path().filename().string();
+            AddTree(relative.empty() ? child : relative + "/" + child);
+        }
+    }
+}
+
+bool InotifyFileWatcher::Read(std::vector<std::string>& changes, std::optional<std::chrono::milliseconds> timeout) {
+    pollfd pfd = { fd, POLLIN, 0 };
+    int ready = poll(&pfd, 1, timeout ? (int)timeout->count() : -1);
+    if (ready < 0) return errno == EINTR;
+    if (ready == 0) return true;
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (char* p = buffer; p < buffer + length;) {
+            auto* event = (inotify_event*)p;
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                changes.push_back("");
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches.erase(event->wd);
+                continue;
+            }
+            auto it = watches.find(event->wd);
+            if (it == watches.end() || event->len == 0) continue;
+
+            std::string path = it->second.empty() ? event->name : it->second + "/" + event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) AddTree(path);
+                continue;
+            }
+            changes.push_back(std::move(path));
+        }
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+#ifdef __linux__
+#include <unordered_map>
+#include "FileWatcher.hpp"
+
+// Linux file watcher using inotify
+// Watches every subdirectory; directories created later are added as they
+// appear. A queue overflow is reported as an empty path
+class InotifyFileWatcher : public FileWatcher {
+public:
+    ~InotifyFileWatcher() override;
+
+    bool Open(const std::string& directory) override;
+    bool Read(std::vector<std::string>& changes, std::optional<std::chrono::milliseconds> timeout) override;
+
+private:
+    void AddTree(const std::string& relative);
+
+    int fd = -1;
+    std::string root;
+    std::unordered_map<int, std::string> watches;   // Watch descriptor -> directory relative to root
+};
+#endif
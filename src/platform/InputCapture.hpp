@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Raw key or mouse button transition observed by an input capture
+// Mouse buttons are reported with their virtual key codes (VK_LBUTTON, ...),
+// so keys and buttons share one code space. Cursor moves are only reported
+// while enabled with InputCapture::ReportMoves
+struct RawInput {
+    enum Type : uint8_t {
+        Down,
+        Up,
+        Move                      // Cursor moved to (x, y); vk is 0
+    };
+    enum Flags : uint8_t {
+        Injected = 1,             // Synthesized by SendInput (ours or another program's)
+        Repeat = 2                // Auto-repeat of a key that is already down
+    };
+
+    int64_t time = 0;             // steady_clock ticks when the transition happened
+    uint32_t held = 0;            // For Up: microseconds since the matching Down
+    uint16_t vk = 0;              // Virtual key code
+    uint8_t type = Down;
+    uint8_t flags = 0;
+    int32_t x = 0;                // For Move: cursor position in screen pixels
+    int32_t y = 0;
+};
+
+// Source of low-level keyboard and mouse button events
+// The handler is invoked on the capture's own thread for every transition
+// and must return quickly; on Windows it runs inside the low-level hook,
+// which stalls system input while it runs
+class InputCapture {
+public:
+    using Handler = std::function<void(const RawInput&)>;
+
+    virtual ~InputCapture() = default;
+
+    // Starts delivering events to handler
+    // Returns false if the capture could not be installed
+    virtual bool Start(Handler handler) = 0;
+
+    // Stops delivering events; no handler call is in progress on return
+    virtual void Stop() = 0;
+
+    // Enables or disables Move events
+    // Off by default: the cursor reports at the mouse polling rate, which
+    // only input recording needs
+    void ReportMoves(bool enabled) { moves.store(enabled, std::memory_order_relaxed); }
+
+protected:
+    std::atomic<bool> moves = false;
+};
+
+// Creates the input capture for the current platform
+// Win32InputCapture on Windows, SyntheticInputCapture elsewhere
+std::unique_ptr<InputCapture> CreateDefaultInputCapture();
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+// Virtual key codes used by the engine itself (Windows values)
+namespace Vk {
+    constexpr uint16_t Back    = 0x08;
+    constexpr uint16_t Tab     = 0x09;
+    constexpr uint16_t Return  = 0x0D;
+    constexpr uint16_t Shift   = 0x10;
+    constexpr uint16_t Control = 0x11;
+    constexpr uint16_t V       = 'V';
+    constexpr uint16_t LWin    = 0x5B;
+    constexpr uint16_t RWin    = 0x5C;
+    constexpr uint16_t LShift  = 0xA0;
+    constexpr uint16_t RShift  = 0xA1;
+    constexpr uint16_t LControl = 0xA2;
+    constexpr uint16_t RControl = 0xA3;
+    constexpr uint16_t LMenu   = 0xA4;
+    constexpr uint16_t RMenu   = 0xA5;
+}
+
+// One synthetic input event
+// Compact, platform-neutral form of a SendInput INPUT record
+struct InputEvent {
+    enum class Type : uint8_t {
+        Key,          // Virtual key press/release (code = VK)
+        Unicode,      // Layout-independent character (code = UTF-16 unit)
+        MouseMove,    // Absolute cursor move to (x, y) in virtual-desktop pixels
+        MouseButton   // Mouse button press/release (code = 0 left, 1 right, 2 middle)
+    };
+
+    Type type = Type::Key;
+    bool up = false;              // Release instead of press
+    uint16_t code = 0;
+    int x = 0;
+    int y = 0;
+
+    static InputEvent Key(uint16_t vk, bool up) { return { Type::Key, up, vk, 0, 0 }; }
+    static InputEvent Unicode(char16_t unit, bool up) { return { Type::Unicode, up, (uint16_t)unit, 0, 0 }; }
+    static InputEvent Move(int x, int y) { return { Type::MouseMove, false, 0, x, y }; }
+    static InputEvent Button(int button, bool up) { return { Type::MouseButton, up, (uint16_t)button, 0, 0 }; }
+};
+
+// Destination for synthetic input
+// Abstracts SendInput and the few OS queries input injection depends on, so
+// the injection engines can be exercised against a recording sink off Windows
+class InputSink {
+public:
+    virtual ~InputSink() = default;
+
+    // Submits events as one batch, in order
+    // Returns: Number of events the OS accepted (less than count if input was blocked)
+    virtual size_t Send(const InputEvent* events, size_t count) = 0;
+
+    // Maps a character to a key on the current keyboard layout
+    // Returns false if the layout cannot produce it with at most Shift held
+    virtual bool MapChar(char16_t c, uint16_t& vk, bool& shift) = 0;
+
+    // Character a key produces on the foreground window's keyboard layout
+    // Returns 0 for keys that produce no character (arrows, dead keys, ...)
+    virtual char16_t KeyChar(uint16_t vk, bool shift) = 0;
+
+    // Replaces the clipboard contents with text
+    virtual bool SetClipboardText(const std::u16string& text) = 0;
+
+    // Reads the clipboard as text; nullopt if it holds no text
+    virtual std::optional<std::u16string> GetClipboardText() = 0;
+
+    // Reads the current cursor position in screen pixels
+    virtual void GetCursorPos(int& x, int& y) = 0;
+
+    // Drops cached display metrics after monitors were added, removed,
+    // moved or resized
+    virtual void DisplayChanged() {}
+};
+
+// Creates the input sink for the current platform
+// Win32InputSink on Windows, RecordingInputSink elsewhere
+std::unique_ptr<InputSink> CreateDefaultInputSink();
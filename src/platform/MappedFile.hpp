@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file
+// Windows: CreateFileMapping/MapViewOfFile. Elsewhere: mmap with sequential
+// read-ahead. Pages are loaded on demand, so a file of any length can be
+// streamed with a resident set of a few pages; Release drops the ones a
+// sequential reader has finished with
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps path; returns false if it cannot be opened or is empty
+    bool Open(const std::string& path);
+
+    // Unmaps the file
+    void Close();
+
+    // Hints that bytes before offset will not be read again
+    // Their pages leave the working set; the mapping stays valid
+    void Release(size_t offset);
+
+    const uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t released = 0;          // Bytes already handed back by Release
+#ifdef _WIN32
+    void* mapping = nullptr;      // File mapping object handle
+#endif
+};
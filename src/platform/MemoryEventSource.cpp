@@ -0,0 +1,86 @@
+#include "MemoryEventSource.hpp"
+#include <thread>
+
+#ifndef _WIN32
+std::unique_ptr<EventSource> CreateDefaultEventSource() {
+    return std::make_unique<MemoryEventSource>();
+}
+#endif
+
+bool MemoryEventSource::RegisterHotkey(int id, int mods, int vk) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chords.emplace(std::make_pair(mods, vk), id).second;
+}
+
+void MemoryEventSource::UnregisterHotkey(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = chords.begin(); it != chords.end(); ++it) {
+        if (it->second == id) {
+            chords.erase(it);
+            return;
+        }
+    }
+}
+
+bool MemoryEventSource::Poll(OsEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.empty()) return false;
+    event = pending.front();
+    pending.pop_front();
+    return true;
+}
+
+void MemoryEventSource::Wait(std::optional<Clock::time_point> deadline) {
+    if (auto interval = Clock::duration(pollInterval.load(std::memory_order_relaxed)); interval.count() > 0) {
+        auto until = Clock::now() + interval;
+        std::this_thread::sleep_until(deadline && *deadline < until ? *deadline : until);
+        std::lock_guard<std::mutex> lock(mutex);
+        woken = false;
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    auto ready = [this] { return woken || !pending.empty(); };
+    if (deadline) {
+        cv.wait_until(lock, *deadline, ready);
+    } else {
+        cv.wait(lock, ready);
+    }
+    woken = false;
+}
+
+bool MemoryEventSource::Pending() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !pending.empty();
+}
+
+void MemoryEventSource::Wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        woken = true;
+    }
+    cv.notify_one();
+}
+
+void MemoryEventSource::Inject(const OsEvent& event) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(event);
+    }
+    cv.notify_one();
+}
+
+bool MemoryEventSource::InjectHotkey(int mods, int vk) {
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = chords.find({ mods, vk });
+        if (it == chords.end()) return false;
+        id = it->second;
+    }
+    Inject({ OsEvent::Type::Hotkey, id, Clock::now() });
+    return true;
+}
+
+void MemoryEventSource::Quit() {
+    Inject({ OsEvent::Type::Quit, 0, Clock::now() });
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <utility>
+#include "EventSource.hpp"
+
+// In-memory event source
+// Keeps registered hotkeys in a table and lets callers inject events from
+// any thread. Used as the default backend off Windows and to drive the
+// message loop from tests and benchmarks
+class MemoryEventSource : public EventSource {
+public:
+    bool RegisterHotkey(int id, int mods, int vk) override;
+    void UnregisterHotkey(int id) override;
+    bool Poll(OsEvent& event) override;
+    void Wait(std::optional<Clock::time_point> deadline) override;
+    bool Pending() override;
+    void Wake() override;
+
+    // Queues an arbitrary event and wakes the loop
+    void Inject(const OsEvent& event);
+
+    // Simulates pressing a registered chord
+    // Returns false if no hotkey is registered for mods + vk
+    bool InjectHotkey(int mods, int vk);
+
+    // Asks the loop to stop
+    void Quit();
+
+    // When set, Wait() ignores events and wakes and sleeps for this long (or
+    // until its deadline), so the loop polls like it did before it blocked on
+    // its event source. Lets benchmarks compare both strategies on the real
+    // loop; set it before the loop next waits
+    std::atomic<Clock::rep> pollInterval = 0;
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<OsEvent> pending;              // Events not yet polled
+    std::map<std::pair<int, int>, int> chords; // (mods, vk) -> hotkey ID
+    bool woken = false;                       // Wake() called since last Wait()
+};
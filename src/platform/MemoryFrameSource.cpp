@@ -0,0 +1,35 @@
+#include "MemoryFrameSource.hpp"
+#include <cstring>
+
+#ifndef _WIN32
+std::unique_ptr<FrameSource> CreateDefaultFrameSource() {
+    return std::make_unique<MemoryFrameSource>();
+}
+#endif
+
+ScreenRect MemoryFrameSource::Bounds() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return { originX, originY, screen.width, screen.height };
+}
+
+bool MemoryFrameSource::Capture(const ScreenRect& area, Frame& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    captures.fetch_add(1, std::memory_order_relaxed);
+    ScreenRect bounds{ originX, originY, screen.width, screen.height };
+    if (area.Empty() || !bounds.Contains(area)) return false;
+
+    out.area = area;
+    if (out.image.width != area.width || out.image.height != area.height) out.image.Resize(area.width, area.height);
+    for (int row = 0; row < area.height; ++row) {
+        std::memcpy(out.image.Row(row), screen.Row(area.y - originY + row) + (area.x - originX),
+                    (size_t)area.width * sizeof(uint32_t));
+    }
+    return true;
+}
+
+void MemoryFrameSource::SetScreen(Bitmap image, int x, int y) {
+    std::lock_guard<std::mutex> lock(mutex);
+    screen = std::move(image);
+    originX = x;
+    originY = y;
+}
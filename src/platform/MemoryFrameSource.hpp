@@ -0,0 +1,29 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "FrameSource.hpp"
+
+// In-memory frame source
+// The screen is whatever bitmap was last passed to SetScreen(); the desktop
+// is empty until then. Used as the default backend off Windows and to drive
+// pixel and image queries from tests and benchmarks
+class MemoryFrameSource : public FrameSource {
+public:
+    ScreenRect Bounds() override;
+    bool Capture(const ScreenRect& area, Frame& out) override;
+
+    // Replaces the screen contents
+    // x, y: Virtual-desktop position of the bitmap's top-left pixel
+    void SetScreen(Bitmap screen, int x = 0, int y = 0);
+
+    // Number of Capture() calls so far; lets callers check frame caching
+    uint64_t Captures() const { return captures.load(std::memory_order_relaxed); }
+
+private:
+    std::mutex mutex;
+    Bitmap screen;
+    int originX = 0;
+    int originY = 0;
+    std::atomic<uint64_t> captures = 0;
+};
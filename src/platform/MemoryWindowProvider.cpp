@@ -0,0 +1,88 @@
+#include "MemoryWindowProvider.hpp"
+#include <algorithm>
+
+#ifndef _WIN32
+std::unique_ptr<WindowProvider> CreateDefaultWindowProvider() {
+    return std::make_unique<MemoryWindowProvider>();
+}
+#endif
+
+WindowInfo MemoryWindowProvider::Foreground() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return foreground;
+}
+
+std::vector<WindowInfo> MemoryWindowProvider::Enumerate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return windows;
+}
+
+void MemoryWindowProvider::Attach(Listener onWindowEvent) {
+    std::lock_guard<std::mutex> lock(mutex);
+    listener = std::move(onWindowEvent);
+}
+
+bool MemoryWindowProvider::Activate(std::uintptr_t handle) {
+    WindowInfo window;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(windows.begin(), windows.end(), [&](const WindowInfo& w) { return w.handle == handle; });
+        if (it == windows.end()) return false;
+        window = *it;
+    }
+    SetForeground(window);
+    return true;
+}
+
+void MemoryWindowProvider::Create(const WindowInfo& window) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::erase_if(windows, [&](const WindowInfo& w) { return w.handle == window.handle; });
+        windows.insert(windows.begin(), window);
+    }
+    Notify(WindowEvent::Type::Created, window);
+}
+
+void MemoryWindowProvider::Destroy(std::uintptr_t handle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!std::erase_if(windows, [&](const WindowInfo& w) { return w.handle == handle; })) return;
+        if (foreground.handle == handle) foreground = {};
+    }
+    WindowInfo window;
+    window.handle = handle;
+    Notify(WindowEvent::Type::Destroyed, window);
+}
+
+void MemoryWindowProvider::Rename(std::uintptr_t handle, const std::string& title) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(windows.begin(), windows.end(), [&](const WindowInfo& w) { return w.handle == handle; });
+        if (it == windows.end()) return;
+        it->title = title;
+        if (foreground.handle == handle) foreground.title = title;
+    }
+    WindowInfo window;
+    window.handle = handle;
+    window.title = title;
+    Notify(WindowEvent::Type::Renamed, window);
+}
+
+void MemoryWindowProvider::SetForeground(const WindowInfo& window) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::erase_if(windows, [&](const WindowInfo& w) { return w.handle == window.handle; });
+        if (window.handle) windows.insert(windows.begin(), window);
+        foreground = window;
+    }
+    Notify(WindowEvent::Type::Foreground, window);
+}
+
+void MemoryWindowProvider::Notify(WindowEvent::Type type, const WindowInfo& window) {
+    Listener notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        notify = listener;
+    }
+    if (notify) notify({ type, window });
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <mutex>
+#include <vector>
+#include "WindowProvider.hpp"
+
+// In-memory window provider
+// Keeps a simulated desktop of windows in z-order. Create/Destroy/Rename/
+// SetForeground change it and notify the listener like the native hooks do.
+// Used as the default backend off Windows and to drive filters and the
+// window index from tests and benchmarks
+class MemoryWindowProvider : public WindowProvider {
+public:
+    WindowInfo Foreground() override;
+    std::vector<WindowInfo> Enumerate() override;
+    void Attach(Listener onWindowEvent) override;
+    bool Activate(std::uintptr_t handle) override;
+
+    // Adds a window on top of the others
+    void Create(const WindowInfo& window);
+
+    // Removes a window
+    void Destroy(std::uintptr_t handle);
+
+    // Changes the title of a window
+    void Rename(std::uintptr_t handle, const std::string& title);
+
+    // Makes the window the foreground window, adding it if it is new
+    // The listener runs on the calling thread, as for every other change
+    void SetForeground(const WindowInfo& window);
+
+private:
+    // Calls the listener outside the lock
+    void Notify(WindowEvent::Type type, const WindowInfo& window);
+
+    std::mutex mutex;
+    std::vector<WindowInfo> windows; // Topmost first
+    WindowInfo foreground;
+    Listener listener;
+};
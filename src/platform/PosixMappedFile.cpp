@@ -0,0 +1,44 @@
+#ifndef _WIN32
+#include "MappedFile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    // The mapping keeps the file referenced after the descriptor is closed
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+
+    madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+    data = static_cast<const uint8_t*>(view);
+    size = (size_t)info.st_size;
+    released = 0;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) munmap(const_cast<uint8_t*>(data), size);
+    data = nullptr;
+    size = 0;
+    released = 0;
+}
+
+void MappedFile::Release(size_t offset) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t end = (offset < size ? offset : size) / page * page;
+    if (!data || end <= released) return;
+    madvise(const_cast<uint8_t*>(data) + released, end - released, MADV_DONTNEED);
+    released = end;
+}
+#endif
@@ -0,0 +1,20 @@
+#ifndef _WIN32
+#include "SystemTimer.hpp"
+#include <cerrno>
+#include <thread>
+#include <time.h>
+
+void SystemTimer::SleepUntil(std::chrono::steady_clock::time_point deadline) {
+#if defined(__linux__)
+    // libstdc++ and libc++ both build steady_clock on CLOCK_MONOTONIC
+    auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    if (since <= 0) return;
+    timespec ts;
+    ts.tv_sec = (time_t)(since / 1000000000);
+    ts.tv_nsec = (long)(since % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
+#endif
@@ -0,0 +1,66 @@
+#ifndef _WIN32
+#include "WritableMappedFile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool WritableMappedFile::Open(const std::string& path) {
+    Close();
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        Close();
+        return false;
+    }
+    size = (size_t)info.st_size;
+    if (!Map()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void WritableMappedFile::Close() {
+    if (data) munmap(data, size);
+    if (fd >= 0) close(fd);
+    data = nullptr;
+    size = 0;
+    fd = -1;
+}
+
+bool WritableMappedFile::Map() {
+    data = nullptr;
+    if (size == 0) return true;
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) return false;
+    data = static_cast<uint8_t*>(view);
+    return true;
+}
+
+bool WritableMappedFile::Resize(size_t length) {
+    if (fd < 0) return false;
+    if (ftruncate(fd, (off_t)length) != 0) return false;
+    if (data) munmap(data, size);
+    size_t previous = size;
+    size = length;
+    if (Map()) return true;
+    // Out of address space: fall back to the old length
+    size = previous;
+    ftruncate(fd, (off_t)previous);
+    Map();
+    return false;
+}
+
+void WritableMappedFile::Flush(bool wait) {
+    if (!data) return;
+    msync(data, size, wait ? MS_SYNC : MS_ASYNC);
+    if (wait) fsync(fd);
+}
+
+bool WritableMappedFile::IsOpen() const {
+    return fd >= 0;
+}
+#endif
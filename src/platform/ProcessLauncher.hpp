@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Child processes whose output is read with the OS's asynchronous I/O
+// Every child gets pipes for stdout and stderr that one I/O thread (the one
+// in Run) reads as data arrives, so any number of children cost a single
+// thread and nobody blocks on a read. The exit of a child is reported after
+// both of its pipes have reached end of file, so no output follows it.
+class ProcessLauncher {
+public:
+    enum class Stream : uint8_t { Stdout, Stderr };
+
+    struct Options {
+        std::string command;                                    // Command line, run through the system shell
+        std::string cwd;                                        // Working directory, or empty to inherit ours
+        std::vector<std::pair<std::string, std::string>> env;   // Variables set on top of our environment
+    };
+
+    struct Handler {
+        // Output read from a child; return false to stop reading it until Resume()
+        std::function<bool(uint64_t id, Stream stream, const char* data, size_t size)> output;
+        // A child exited; code is its exit status, or 128 + signal on POSIX
+        std::function<void(uint64_t id, int code)> exit;
+    };
+
+    virtual ~ProcessLauncher() = default;
+
+    // Runs the I/O loop, delivering notifications to handler; never returns
+    // Called once, on a dedicated thread
+    virtual void Run(Handler handler) = 0;
+
+    // Starts a child; safe to call from any thread
+    // id: Non-zero caller identifier passed back in notifications
+    // Returns false with error set if the process could not be started
+    virtual bool Launch(uint64_t id, const Options& options, std::string& error) = 0;
+
+    // Terminates a child and everything it started; safe to call from any thread
+    // Ignored once the child has exited
+    virtual void Kill(uint64_t id) = 0;
+
+    // Resumes reading a child paused by the output handler; safe to call from any thread
+    // May arrive while the handler that asked for the pause is still running;
+    // the pause is then skipped
+    virtual void Resume(uint64_t id) = 0;
+};
+
+// Creates the process launcher for the current platform
+// Win32ProcessLauncher (I/O completion port) on Windows, EpollProcessLauncher on Linux
+std::unique_ptr<ProcessLauncher> CreateDefaultProcessLauncher();
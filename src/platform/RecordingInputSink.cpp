@@ -0,0 +1,105 @@
+#include "RecordingInputSink.hpp"
+#include <array>
+#include <cstring>
+
+#ifndef _WIN32
+std::unique_ptr<InputSink> CreateDefaultInputSink() {
+    return std::make_unique<RecordingInputSink>();
+}
+#endif
+
+size_t RecordingInputSink::Send(const InputEvent* batch, size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.insert(events.end(), batch, batch + count);
+        ++batches;
+        for (size_t i = 0; i < count; ++i) {
+            if (batch[i].type == InputEvent::Type::MouseMove) {
+                cursorX = batch[i].x;
+                cursorY = batch[i].y;
+            }
+        }
+    }
+    if (observer) observer(batch, count);
+    return count;
+}
+
+bool RecordingInputSink::MapChar(char16_t c, uint16_t& vk, bool& shift) {
+    static const char* shifted = ")!@#$%^&*(";
+    static const struct { char plain, upper; uint16_t vk; } punctuation[] = {
+        { ';', ':', 0xBA }, { '=', '+', 0xBB }, { ',', '<', 0xBC }, { '-', '_', 0xBD },
+        { '.', '>', 0xBE }, { '/', '?', 0xBF }, { '`', '~', 0xC0 }, { '[', '{', 0xDB },
+        { '\\', '|', 0xDC }, { ']', '}', 0xDD }, { '\'', '"', 0xDE },
+    };
+
+    shift = false;
+    if (c >= 'a' && c <= 'z') { vk = (uint16_t)(c - 'a' + 'A'); return true; }
+    if (c >= 'A' && c <= 'Z') { vk = (uint16_t)c; shift = true; return true; }
+    if (c >= '0' && c <= '9') { vk = (uint16_t)c; return true; }
+    if (c == ' ') { vk = 0x20; return true; }
+    if (c == '\t') { vk = Vk::Tab; return true; }
+    if (c < 0x80) {
+        if (const char* p = std::strchr(shifted, (char)c); p && c != 0) {
+            vk = (uint16_t)('0' + (p - shifted));
+            shift = true;
+            return true;
+        }
+        for (const auto& key : punctuation) {
+            if (c == (char16_t)key.plain || c == (char16_t)key.upper) {
+                vk = key.vk;
+                shift = c == (char16_t)key.upper;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+char16_t RecordingInputSink::KeyChar(uint16_t vk, bool shift) {
+    // Inverse of MapChar over printable ASCII, plus Return
+    static const auto table = [this] {
+        std::array<std::array<char16_t, 2>, 256> keys{};
+        for (char16_t c = 0x20; c < 0x7F; ++c) {
+            uint16_t key;
+            bool shifted;
+            if (MapChar(c, key, shifted) && key < 256) keys[key][shifted] = c;
+        }
+        keys[Vk::Tab] = { u'\t', u'\t' };
+        keys[Vk::Return] = { u'\n', u'\n' };
+        return keys;
+    }();
+    return vk < 256 ? table[vk][shift] : 0;
+}
+
+bool RecordingInputSink::SetClipboardText(const std::u16string& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    clipboard = text;
+    return true;
+}
+
+std::optional<std::u16string> RecordingInputSink::GetClipboardText() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return clipboard;
+}
+
+void RecordingInputSink::GetCursorPos(int& x, int& y) {
+    std::lock_guard<std::mutex> lock(mutex);
+    x = cursorX;
+    y = cursorY;
+}
+
+std::vector<InputEvent> RecordingInputSink::Events() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return events;
+}
+
+size_t RecordingInputSink::Batches() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return batches;
+}
+
+void RecordingInputSink::Reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+    batches = 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "InputSink.hpp"
+
+// Input sink that records events instead of injecting them
+// Uses a US QWERTY layout for MapChar and keeps the clipboard in memory.
+// Used as the default backend off Windows and to check event sequences and
+// measure throughput in tests and benchmarks
+class RecordingInputSink : public InputSink {
+public:
+    // Sees every batch as it is sent, on the sending thread
+    using Observer = std::function<void(const InputEvent* events, size_t count)>;
+
+    size_t Send(const InputEvent* events, size_t count) override;
+    bool MapChar(char16_t c, uint16_t& vk, bool& shift) override;
+    char16_t KeyChar(uint16_t vk, bool shift) override;
+    bool SetClipboardText(const std::u16string& text) override;
+    std::optional<std::u16string> GetClipboardText() override;
+    void GetCursorPos(int& x, int& y) override;
+
+    // Copies of everything sent so far
+    std::vector<InputEvent> Events();
+
+    // Number of Send() calls so far
+    size_t Batches();
+
+    // Forgets recorded events and batches
+    void Reset();
+
+    // Sets the observer; must happen before any input is sent
+    // Lets benchmarks timestamp events the moment they leave the engine
+    void Observe(Observer callback) { observer = std::move(callback); }
+
+private:
+    std::mutex mutex;
+    std::vector<InputEvent> events;
+    size_t batches = 0;
+    Observer observer;
+    std::optional<std::u16string> clipboard;
+    int cursorX = 0;
+    int cursorY = 0;
+};
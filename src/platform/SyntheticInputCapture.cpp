@@ -0,0 +1,47 @@
+#include "SyntheticInputCapture.hpp"
+
+#ifndef _WIN32
+std::unique_ptr<InputCapture> CreateDefaultInputCapture() {
+    return std::make_unique<SyntheticInputCapture>();
+}
+#endif
+
+bool SyntheticInputCapture::Start(Handler h) {
+    handler = std::move(h);
+    return true;
+}
+
+void SyntheticInputCapture::Stop() {
+    handler = nullptr;
+}
+
+void SyntheticInputCapture::Emit(int vk, bool down, bool injected) {
+    if (!handler) return;
+    RawInput input;
+    input.time = std::chrono::steady_clock::now().time_since_epoch().count();
+    input.vk = (uint16_t)vk;
+    input.type = down ? RawInput::Down : RawInput::Up;
+    input.flags = injected ? RawInput::Injected : 0;
+    handler(input);
+}
+
+void SyntheticInputCapture::EmitMove(int x, int y, bool injected) {
+    if (!handler || !moves.load(std::memory_order_relaxed)) return;
+    RawInput input;
+    input.time = std::chrono::steady_clock::now().time_since_epoch().count();
+    input.type = RawInput::Move;
+    input.flags = injected ? RawInput::Injected : 0;
+    input.x = x;
+    input.y = y;
+    handler(input);
+}
+
+size_t SyntheticInputCapture::Generate(size_t count, const std::vector<int>& keys) {
+    if (keys.empty()) return 0;
+    for (size_t i = 0; i < count; ++i) {
+        int vk = keys[i % keys.size()];
+        Emit(vk, true);
+        Emit(vk, false);
+    }
+    return count * 2;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "InputCapture.hpp"
+
+// Input capture driven by the caller
+// Events are emitted on the calling thread, which plays the role of the hook
+// thread; only one thread may emit at a time. Used as the default backend
+// off Windows and to measure ring throughput and handler latency
+class SyntheticInputCapture : public InputCapture {
+public:
+    bool Start(Handler handler) override;
+    void Stop() override;
+
+    // Emits a single transition stamped with the current time
+    // vk: Virtual key code
+    // down: true for a press, false for a release
+    // injected: Mark the event as synthesized input
+    void Emit(int vk, bool down, bool injected = false);
+
+    // Emits a cursor move stamped with the current time
+    // Dropped unless ReportMoves is enabled, like a real capture
+    void EmitMove(int x, int y, bool injected = false);
+
+    // Emits count press/release pairs, cycling through keys
+    // Returns the number of events emitted (2 per press)
+    size_t Generate(size_t count, const std::vector<int>& keys);
+
+private:
+    Handler handler;
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <chrono>
+
+// Most precise blocking sleep the OS offers
+// Windows: a per-thread high-resolution waitable timer (falls back to a
+// regular waitable timer before Windows 10 1803). Linux and other POSIX
+// systems: clock_nanosleep on CLOCK_MONOTONIC with an absolute deadline.
+// Still subject to scheduler wake-up latency; PrecisionClock covers the
+// last stretch
+namespace SystemTimer {
+    // Blocks the calling thread until deadline
+    void SleepUntil(std::chrono::steady_clock::time_point deadline);
+}
@@ -0,0 +1,194 @@
+#ifdef _WIN32
+#include "Win32ControlServer.hpp"
+#include "../utils/Log.hpp"
+
+namespace {
+    std::wstring Widen(const std::string& text) {
+        if (text.empty()) return {};
+        int length = MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), nullptr, 0);
+        std::wstring wide(length, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), wide.data(), length);
+        return wide;
+    }
+
+    std::string LastError(const char* what) {
+        return std::string(what) + " failed (error " + std::to_string(GetLastError()) + ")";
+    }
+}
+
+std::unique_ptr<ControlServer> CreateDefaultControlServer() {
+    return std::make_unique<Win32ControlServer>();
+}
+
+Win32ControlServer::~Win32ControlServer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [id, client] : clients) {
+        if (client.pipe != INVALID_HANDLE_VALUE) CloseHandle(client.pipe);
+    }
+    if (port) CloseHandle(port);
+}
+
+bool Win32ControlServer::Listen(std::string& error) {
+    // Only the first instance may create the name, so a second MoonKey fails instead of sharing it
+    DWORD flags = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (nextId == 1 ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+    HANDLE pipe = CreateNamedPipeW(name.c_str(), flags, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                   PIPE_UNLIMITED_INSTANCES, readSize, readSize, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        error = LastError("CreateNamedPipe");
+        return false;
+    }
+    uint64_t id = nextId++;
+    CreateIoCompletionPort(pipe, port, 0, 0);
+    Client& client = clients[id];
+    client.pipe = pipe;
+    client.read = std::make_unique<Operation>();
+    client.read->kind = Operation::Kind::Connect;
+    client.read->id = id;
+    client.read->buffer.resize(readSize);
+    client.write = std::make_unique<Operation>();
+    client.write->kind = Operation::Kind::Write;
+    client.write->id = id;
+
+    // The connect is reported through the port like a read; a client that
+    // connected before the call is reported by hand
+    client.read->pending = true;
+    if (!ConnectNamedPipe(pipe, &client.read->overlapped)) {
+        DWORD status = GetLastError();
+        if (status == ERROR_PIPE_CONNECTED) {
+            PostQueuedCompletionStatus(port, 0, 0, &client.read->overlapped);
+        } else if (status != ERROR_IO_PENDING) {
+            error = LastError("ConnectNamedPipe");
+            CloseHandle(pipe);
+            clients.erase(id);
+            return false;
+        }
+    }
+    return true;
+}
+
+void Win32ControlServer::IssueRead(Client& client) {
+    Operation& read = *client.read;
+    read.kind = Operation::Kind::Read;
+    read.overlapped = {};
+    if (!ReadFile(client.pipe, read.buffer.data(), readSize, nullptr, &read.overlapped) &&
+        GetLastError() != ERROR_IO_PENDING) {
+        Shut(client);
+        return;
+    }
+    // Completes through the port even when ReadFile finished at once
+    read.pending = true;
+}
+
+void Win32ControlServer::IssueWrite(Client& client) {
+    Operation& write = *client.write;
+    if (write.pending || client.outbox.empty() || client.pipe == INVALID_HANDLE_VALUE) return;
+    write.buffer.assign(client.outbox.begin(), client.outbox.end());
+    client.outbox.clear();
+    write.overlapped = {};
+    if (!WriteFile(client.pipe, write.buffer.data(), (DWORD)write.buffer.size(), nullptr, &write.overlapped) &&
+        GetLastError() != ERROR_IO_PENDING) {
+        Shut(client);
+        return;
+    }
+    write.pending = true;
+}
+
+void Win32ControlServer::Shut(Client& client) {
+    if (client.pipe == INVALID_HANDLE_VALUE) return;
+    CloseHandle(client.pipe);
+    client.pipe = INVALID_HANDLE_VALUE;
+}
+
+bool Win32ControlServer::Finish(uint64_t id) {
+    auto it = clients.find(id);
+    if (it == clients.end()) return false;
+    Client& client = it->second;
+    if (client.pipe != INVALID_HANDLE_VALUE || client.read->pending || client.write->pending) return false;
+    bool connected = client.connected;
+    clients.erase(it);
+    return connected;
+}
+
+void Win32ControlServer::Send(uint64_t id, std::string data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = clients.find(id);
+    if (it == clients.end() || !it->second.connected) return;
+    Client& client = it->second;
+    client.outbox += data;
+    if (client.outbox.size() > maxBacklog) {
+        Shut(client);
+        return;
+    }
+    // Overlapped writes may be issued from any thread; the completion arrives at the port
+    IssueWrite(client);
+}
+
+void Win32ControlServer::Close(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = clients.find(id);
+    if (it != clients.end() && it->second.connected) Shut(it->second);
+}
+
+void Win32ControlServer::Run(const std::string& endpoint, Handler handler, std::string& error) {
+    name = Widen(endpoint);
+    port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if (!port) {
+        error = LastError("CreateIoCompletionPort");
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!Listen(error)) return;
+    }
+
+    while (true) {
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED* overlapped = nullptr;
+        BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, INFINITE);
+        if (!ok && !overlapped) {
+            error = LastError("GetQueuedCompletionStatus");
+            return;
+        }
+        // Operations outlive their pending I/O: a client is only removed once none is pending
+        auto* operation = reinterpret_cast<Operation*>(overlapped);
+        uint64_t id = operation->id;
+
+        if (operation->kind == Operation::Kind::Read && ok && bytes > 0) {
+            // Only this thread touches the read buffer
+            handler.data(id, operation->buffer.data(), bytes);
+        }
+
+        bool closed = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            operation->pending = false;
+            auto it = clients.find(id);
+            if (it == clients.end()) continue;
+            Client& client = it->second;
+            switch (operation->kind) {
+            case Operation::Kind::Connect: {
+                if (ok) client.connected = true;
+                else Shut(client);
+                // Someone must always be listening, whether or not this client made it
+                std::string listenError;
+                if (!Listen(listenError)) Log::Err() << "[Error] Control channel: " << listenError;
+                if (client.connected) IssueRead(client);
+                break;
+            }
+            case Operation::Kind::Read:
+                // ERROR_BROKEN_PIPE (the client went away) or a read aborted by Shut()
+                if (!ok) Shut(client);
+                else if (client.pipe != INVALID_HANDLE_VALUE) IssueRead(client);
+                break;
+            case Operation::Kind::Write:
+                if (!ok) Shut(client);
+                else IssueWrite(client);
+                break;
+            }
+            closed = Finish(id);
+        }
+        if (closed) handler.closed(id);
+    }
+}
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ControlServer.hpp"
+
+// Windows control server on a named pipe, served with an I/O completion port
+// A fresh pipe instance always waits in ConnectNamedPipe, and every
+// connected instance has one overlapped read and at most one overlapped
+// write in flight; all of them complete at the same port. Remote clients
+// are rejected and the pipe's default security only admits our own user
+class Win32ControlServer : public ControlServer {
+public:
+    static inline DWORD readSize = 64 * 1024;     // Bytes per read and pipe buffer size
+
+    ~Win32ControlServer() override;
+
+    void Run(const std::string& endpoint, Handler handler, std::string& error) override;
+    void Send(uint64_t client, std::string data) override;
+    void Close(uint64_t client) override;
+
+private:
+    // One overlapped operation; overlapped comes first so a completion maps back to it
+    struct Operation {
+        enum class Kind { Connect, Read, Write };
+        OVERLAPPED overlapped = {};
+        Kind kind = Kind::Read;
+        uint64_t id = 0;
+        bool pending = false;
+        std::vector<char> buffer;     // Read: receives data; Write: bytes being written
+    };
+
+    struct Client {
+        HANDLE pipe = INVALID_HANDLE_VALUE;   // INVALID_HANDLE_VALUE once closed
+        std::unique_ptr<Operation> read;
+        std::unique_ptr<Operation> write;
+        std::string outbox;                   // Bytes waiting for the current write
+        bool connected = false;
+    };
+
+    // Creates the next pipe instance and waits for a client on it; mutex held
+    bool Listen(std::string& error);
+
+    // Issues a client's next read; mutex held
+    void IssueRead(Client& client);
+
+    // Writes the outbox if no write is in flight; mutex held
+    void IssueWrite(Client& client);
+
+    // Closes a client's pipe, which aborts its pending operations; mutex held
+    void Shut(Client& client);
+
+    // Forgets a closed client once no operation of it is pending; mutex held
+    // Returns true if it was removed and its closing should be reported
+    bool Finish(uint64_t id);
+
+    HANDLE port = nullptr;
+    std::wstring name;
+    uint64_t nextId = 1;                   // Guarded by mutex
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Client> clients;  // Including the one waiting to connect; guarded by mutex
+};
+#endif
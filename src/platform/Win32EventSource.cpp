@@ -0,0 +1,112 @@
+#ifdef _WIN32
+#include "Win32EventSource.hpp"
+#include "../utils/Log.hpp"
+
+std::unique_ptr<EventSource> CreateDefaultEventSource() {
+    return std::make_unique<Win32EventSource>();
+}
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace {
+    // Posted to the loop thread's queue when the display configuration changes
+    constexpr UINT DisplayChangedMessage = WM_APP + 1;
+}
+
+Win32EventSource::Win32EventSource() {
+    wakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!timer) timer = CreateWaitableTimerW(NULL, FALSE, NULL);
+}
+
+Win32EventSource::~Win32EventSource() {
+    if (displayWindow) DestroyWindow(displayWindow);
+    if (wakeEvent) CloseHandle(wakeEvent);
+    if (timer) CloseHandle(timer);
+}
+
+void Win32EventSource::Attach() {
+    // Force creation of the thread message queue
+    MSG msg = { 0 };
+    PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+
+    WNDCLASSA wc = {};
+    wc.lpfnWndProc = DisplayProc;
+    wc.hInstance = GetModuleHandleA(NULL);
+    wc.lpszClassName = "MoonKeyDisplayWatcher";
+    RegisterClassA(&wc);
+    displayWindow = CreateWindowExA(WS_EX_TOOLWINDOW, wc.lpszClassName, "", WS_POPUP, 0, 0, 0, 0,
+                                    NULL, NULL, wc.hInstance, NULL);
+    if (!displayWindow) Log::Err() << "[Error] Failed to create display watcher window. Error code: " << GetLastError();
+}
+
+LRESULT CALLBACK Win32EventSource::DisplayProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
+    // Runs on the loop thread while Poll() dispatches; surface it as a queue message
+    if (message == WM_DISPLAYCHANGE) PostThreadMessage(GetCurrentThreadId(), DisplayChangedMessage, 0, 0);
+    return DefWindowProcA(hwnd, message, wParam, lParam);
+}
+
+bool Win32EventSource::RegisterHotkey(int id, int mods, int vk) {
+    if (RegisterHotKey(NULL, id, mods | MOD_NOREPEAT, vk)) return true;
+    Log::Err() << "[Error] Failed to register hotkey. Error code: " << GetLastError();
+    return false;
+}
+
+void Win32EventSource::UnregisterHotkey(int id) {
+    UnregisterHotKey(NULL, id);
+}
+
+bool Win32EventSource::Poll(OsEvent& event) {
+    MSG msg;
+    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+        if (msg.message == WM_HOTKEY) {
+            event = { OsEvent::Type::Hotkey, (int)msg.wParam, Clock::now() };
+            return true;
+        }
+        if (msg.message == DisplayChangedMessage && msg.hwnd == NULL) {
+            event = { OsEvent::Type::DisplayChange, 0, Clock::now() };
+            return true;
+        }
+        if (msg.message == WM_QUIT) {
+            event = { OsEvent::Type::Quit, 0, Clock::now() };
+            return true;
+        }
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+    return false;
+}
+
+void Win32EventSource::Wait(std::optional<Clock::time_point> deadline) {
+    DWORD timeout = INFINITE;
+    DWORD count = 1;
+    HANDLE handles[2] = { wakeEvent, timer };
+    if (deadline) {
+        auto remaining = *deadline - Clock::now();
+        if (remaining <= Clock::duration::zero()) return;
+        // Relative due time in 100 ns units (negative = relative)
+        LARGE_INTEGER due;
+        due.QuadPart = -(LONGLONG)(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+        if (timer && SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE)) {
+            count = 2;
+        } else {
+            // Round up so we never wake before the deadline and spin
+            auto ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+            timeout = ms >= (long long)INFINITE ? INFINITE - 1 : (DWORD)ms;
+        }
+    }
+    MsgWaitForMultipleObjectsEx(count, handles, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    if (count == 2) CancelWaitableTimer(timer);
+}
+
+bool Win32EventSource::Pending() {
+    // Messages of any kind that arrived since the queue was last examined
+    return HIWORD(GetQueueStatus(QS_ALLINPUT)) != 0;
+}
+
+void Win32EventSource::Wake() {
+    SetEvent(wakeEvent);
+}
+#endif
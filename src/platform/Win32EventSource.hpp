@@ -0,0 +1,33 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include "EventSource.hpp"
+
+// Windows event source backed by the thread message queue
+// Hotkeys are registered with RegisterHotKey for the loop thread. A hidden
+// top-level window receives the WM_DISPLAYCHANGE broadcast (message-only
+// windows do not) and reposts it to the queue. Wait()
+// blocks in MsgWaitForMultipleObjectsEx on the message queue, an auto-reset
+// event used by Wake() and a high-resolution waitable timer for the
+// deadline (timeouts of the wait call itself are rounded to the system tick)
+class Win32EventSource : public EventSource {
+public:
+    Win32EventSource();
+    ~Win32EventSource() override;
+
+    void Attach() override;
+    bool RegisterHotkey(int id, int mods, int vk) override;
+    void UnregisterHotkey(int id) override;
+    bool Poll(OsEvent& event) override;
+    void Wait(std::optional<Clock::time_point> deadline) override;
+    bool Pending() override;
+    void Wake() override;
+
+private:
+    static LRESULT CALLBACK DisplayProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
+
+    HWND displayWindow = NULL;    // Receives WM_DISPLAYCHANGE
+    HANDLE wakeEvent = NULL;      // Signaled by Wake()
+    HANDLE timer = NULL;          // Signaled at the Wait() deadline
+};
+#endif
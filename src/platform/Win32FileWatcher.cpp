@@ -0,0 +1,88 @@
+#ifdef _WIN32
+#include "Win32FileWatcher.hpp"
+#include "../utils/Log.hpp"
+
+std::unique_ptr<FileWatcher> CreateDefaultFileWatcher() {
+    return std::make_unique<Win32FileWatcher>();
+}
+
+Win32FileWatcher::~Win32FileWatcher() {
+    if (directoryHandle != INVALID_HANDLE_VALUE) {
+        CancelIoEx(directoryHandle, &overlapped);
+        CloseHandle(directoryHandle);
+    }
+    if (overlapped.hEvent) CloseHandle(overlapped.hEvent);
+}
+
+bool Win32FileWatcher::Open(const std::string& directory) {
+    directoryHandle = CreateFileA(
+        directory.c_str(),
+        FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+        NULL
+    );
+    if (directoryHandle == INVALID_HANDLE_VALUE) return false;
+
+    overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    return Issue();
+}
+
+bool Win32FileWatcher::Issue() {
+    ResetEvent(overlapped.hEvent);
+    pending = ReadDirectoryChangesW(
+        directoryHandle,
+        buffer.data(),
+        (DWORD)(buffer.size() * sizeof(DWORD)),
+        TRUE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+        NULL,
+        &overlapped,
+        NULL
+    );
+    if (!pending) {
+        Log::Err() << "[Directory] Monitoring error: " << GetLastError();
+    }
+    return pending;
+}
+
+bool Win32FileWatcher::Read(std::vector<std::string>& changes, std::optional<std::chrono::milliseconds> timeout) {
+    if (!pending && !Issue()) return false;
+
+    DWORD wait = timeout ? (DWORD)timeout->count() : INFINITE;
+    if (WaitForSingleObject(overlapped.hEvent, wait) != WAIT_OBJECT_0) return true;
+
+    DWORD bytes = 0;
+    pending = false;
+    if (!GetOverlappedResult(directoryHandle, &overlapped, &bytes, FALSE)) {
+        DWORD error = GetLastError();
+        if (error != ERROR_NOTIFY_ENUM_DIR) {
+            Log::Err() << "[Directory] Monitoring error: " << error;
+            return false;
+        }
+        bytes = 0;
+    }
+
+    if (bytes == 0) {
+        // Buffer overflowed; the individual changes are lost
+        changes.push_back("");
+        return Issue();
+    }
+
+    auto* info = (const FILE_NOTIFY_INFORMATION*)buffer.data();
+    while (true) {
+        int length = (int)(info->FileNameLength / sizeof(WCHAR));
+        int size = WideCharToMultiByte(CP_UTF8, 0, info->FileName, length, NULL, 0, NULL, NULL);
+        std::string path(size, '\0');
+        WideCharToMultiByte(CP_UTF8, 0, info->FileName, length, path.data(), size, NULL, NULL);
+        for (char& c : path) if (c == '\\') c = '/';
+        changes.push_back(std::move(path));
+
+        if (info->NextEntryOffset == 0) break;
+        info = (const FILE_NOTIFY_INFORMATION*)((const BYTE*)info + info->NextEntryOffset);
+    }
+    return Issue();
+}
+#endif
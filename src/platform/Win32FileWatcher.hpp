@@ -0,0 +1,25 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include <vector>
+#include "FileWatcher.hpp"
+
+// Windows file watcher using overlapped ReadDirectoryChangesW
+// Uses a 64 KB buffer (the largest size that also works on network shares);
+// an overflow is reported as an empty path
+class Win32FileWatcher : public FileWatcher {
+public:
+    ~Win32FileWatcher() override;
+
+    bool Open(const std::string& directory) override;
+    bool Read(std::vector<std::string>& changes, std::optional<std::chrono::milliseconds> timeout) override;
+
+private:
+    bool Issue();
+
+    HANDLE directoryHandle = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped = {};
+    bool pending = false;                       // A read is outstanding
+    std::vector<DWORD> buffer = std::vector<DWORD>(64 * 1024 / sizeof(DWORD));
+};
+#endif
@@ -0,0 +1,67 @@
+#ifdef _WIN32
+#include "Win32FrameSource.hpp"
+#include <cstring>
+
+std::unique_ptr<FrameSource> CreateDefaultFrameSource() {
+    return std::make_unique<Win32FrameSource>();
+}
+
+Win32FrameSource::~Win32FrameSource() {
+    if (memory) {
+        if (previous) SelectObject(memory, previous);
+        DeleteDC(memory);
+    }
+    if (dib) DeleteObject(dib);
+}
+
+ScreenRect Win32FrameSource::Bounds() {
+    return { GetSystemMetrics(SM_XVIRTUALSCREEN), GetSystemMetrics(SM_YVIRTUALSCREEN),
+             GetSystemMetrics(SM_CXVIRTUALSCREEN), GetSystemMetrics(SM_CYVIRTUALSCREEN) };
+}
+
+bool Win32FrameSource::Capture(const ScreenRect& area, Frame& out) {
+    if (area.Empty()) return false;
+    HDC screen = GetDC(NULL);
+    if (!screen) return false;
+
+    bool ok = Prepare(screen, area.width, area.height) &&
+              BitBlt(memory, 0, 0, area.width, area.height, screen, area.x, area.y, SRCCOPY | CAPTUREBLT);
+    ReleaseDC(NULL, screen);
+    if (!ok) return false;
+
+    GdiFlush();
+    out.area = area;
+    if (out.image.width != area.width || out.image.height != area.height) out.image.Resize(area.width, area.height);
+    std::memcpy(out.image.pixels.data(), bits, out.image.pixels.size() * sizeof(uint32_t));
+    return true;
+}
+
+bool Win32FrameSource::Prepare(HDC screen, int width, int height) {
+    if (!memory) {
+        memory = CreateCompatibleDC(screen);
+        if (!memory) return false;
+    }
+    if (dib && dibWidth == width && dibHeight == height) return true;
+
+    BITMAPINFO info{};
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = width;
+    info.bmiHeader.biHeight = -height; // Top-down rows
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    void* pixels = nullptr;
+    HBITMAP created = CreateDIBSection(screen, &info, DIB_RGB_COLORS, &pixels, NULL, 0);
+    if (!created) return false;
+
+    HGDIOBJ old = SelectObject(memory, created);
+    if (!previous) previous = old;
+    if (dib) DeleteObject(dib);
+    dib = created;
+    bits = pixels;
+    dibWidth = width;
+    dibHeight = height;
+    return true;
+}
+#endif
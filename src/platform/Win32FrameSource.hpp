@@ -0,0 +1,29 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include "FrameSource.hpp"
+
+// Windows frame source
+// BitBlts the screen into a top-down 32-bit DIB section, which has exactly
+// the Bitmap pixel layout, then copies it out. The DIB and memory DC are kept
+// between captures of the same size. Coordinates are physical pixels when
+// the process is DPI aware
+class Win32FrameSource : public FrameSource {
+public:
+    ~Win32FrameSource() override;
+
+    ScreenRect Bounds() override;
+    bool Capture(const ScreenRect& area, Frame& out) override;
+
+private:
+    // Recreates the DIB section when the capture size changes
+    bool Prepare(HDC screen, int width, int height);
+
+    HDC memory = NULL;
+    HBITMAP dib = NULL;
+    HGDIOBJ previous = NULL;      // Bitmap selected into memory before dib
+    void* bits = nullptr;         // Pixels of dib
+    int dibWidth = 0;
+    int dibHeight = 0;
+};
+#endif
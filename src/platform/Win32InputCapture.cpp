@@ -0,0 +1,117 @@
+#ifdef _WIN32
+#include "Win32InputCapture.hpp"
+#include "../utils/Log.hpp"
+
+std::unique_ptr<InputCapture> CreateDefaultInputCapture() {
+    return std::make_unique<Win32InputCapture>();
+}
+
+Win32InputCapture::~Win32InputCapture() {
+    Stop();
+}
+
+bool Win32InputCapture::Start(Handler h) {
+    if (thread.joinable()) return false;
+    handler = std::move(h);
+    instance = this;
+
+    std::promise<bool> started;
+    auto result = started.get_future();
+    thread = std::thread([this](std::promise<bool> p) { Run(p); }, std::move(started));
+    if (result.get()) return true;
+
+    thread.join();
+    instance = nullptr;
+    return false;
+}
+
+void Win32InputCapture::Stop() {
+    if (!thread.joinable()) return;
+    PostThreadMessage(threadId, WM_QUIT, 0, 0);
+    thread.join();
+    if (instance == this) instance = nullptr;
+}
+
+void Win32InputCapture::Run(std::promise<bool>& started) {
+    threadId = GetCurrentThreadId();
+    // Hook callbacks run on this thread; keep it ahead of normal work
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+    HINSTANCE module = GetModuleHandle(NULL);
+    HHOOK keyboard = SetWindowsHookExW(WH_KEYBOARD_LL, KeyboardProc, module, 0);
+    HHOOK mouse = SetWindowsHookExW(WH_MOUSE_LL, MouseProc, module, 0);
+    if (!keyboard || !mouse) {
+        Log::Err() << "[Error] Failed to install input hooks. Error code: " << GetLastError();
+        if (keyboard) UnhookWindowsHookEx(keyboard);
+        if (mouse) UnhookWindowsHookEx(mouse);
+        started.set_value(false);
+        return;
+    }
+    started.set_value(true);
+
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+
+    UnhookWindowsHookEx(keyboard);
+    UnhookWindowsHookEx(mouse);
+}
+
+void Win32InputCapture::Deliver(int vk, bool down, bool injected) {
+    if (!instance || !instance->handler) return;
+    RawInput input;
+    input.time = std::chrono::steady_clock::now().time_since_epoch().count();
+    input.vk = (uint16_t)vk;
+    input.type = down ? RawInput::Down : RawInput::Up;
+    input.flags = injected ? RawInput::Injected : 0;
+    instance->handler(input);
+}
+
+void Win32InputCapture::DeliverMove(int x, int y, bool injected) {
+    if (!instance || !instance->handler) return;
+    RawInput input;
+    input.time = std::chrono::steady_clock::now().time_since_epoch().count();
+    input.type = RawInput::Move;
+    input.flags = injected ? RawInput::Injected : 0;
+    input.x = x;
+    input.y = y;
+    instance->handler(input);
+}
+
+LRESULT CALLBACK Win32InputCapture::KeyboardProc(int code, WPARAM wParam, LPARAM lParam) {
+    if (code == HC_ACTION) {
+        auto* info = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+        bool down = wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN;
+        Deliver((int)info->vkCode, down, (info->flags & LLKHF_INJECTED) != 0);
+    }
+    return CallNextHookEx(NULL, code, wParam, lParam);
+}
+
+LRESULT CALLBACK Win32InputCapture::MouseProc(int code, WPARAM wParam, LPARAM lParam) {
+    if (code == HC_ACTION) {
+        auto* info = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
+        bool injected = (info->flags & LLMHF_INJECTED) != 0;
+        switch (wParam) {
+            case WM_MOUSEMOVE:
+                if (instance && instance->moves.load(std::memory_order_relaxed)) {
+                    DeliverMove(info->pt.x, info->pt.y, injected);
+                }
+                break;
+            case WM_LBUTTONDOWN: Deliver(VK_LBUTTON, true, injected); break;
+            case WM_LBUTTONUP:   Deliver(VK_LBUTTON, false, injected); break;
+            case WM_RBUTTONDOWN: Deliver(VK_RBUTTON, true, injected); break;
+            case WM_RBUTTONUP:   Deliver(VK_RBUTTON, false, injected); break;
+            case WM_MBUTTONDOWN: Deliver(VK_MBUTTON, true, injected); break;
+            case WM_MBUTTONUP:   Deliver(VK_MBUTTON, false, injected); break;
+            case WM_XBUTTONDOWN:
+            case WM_XBUTTONUP:
+                Deliver(HIWORD(info->mouseData) == XBUTTON1 ? VK_XBUTTON1 : VK_XBUTTON2,
+                        wParam == WM_XBUTTONDOWN, injected);
+                break;
+        }
+    }
+    return CallNextHookEx(NULL, code, wParam, lParam);
+}
+#endif
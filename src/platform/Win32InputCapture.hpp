@@ -0,0 +1,32 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include <future>
+#include <thread>
+#include "InputCapture.hpp"
+
+// Windows input capture
+// Installs WH_KEYBOARD_LL and WH_MOUSE_LL hooks on a dedicated thread that
+// does nothing but pump messages, so hook callbacks never wait behind Lua
+// code. Wheel events are ignored; cursor moves are reported only while
+// ReportMoves is enabled
+class Win32InputCapture : public InputCapture {
+public:
+    ~Win32InputCapture() override;
+
+    bool Start(Handler handler) override;
+    void Stop() override;
+
+private:
+    void Run(std::promise<bool>& started);
+    static void Deliver(int vk, bool down, bool injected);
+    static void DeliverMove(int x, int y, bool injected);
+    static LRESULT CALLBACK KeyboardProc(int code, WPARAM wParam, LPARAM lParam);
+    static LRESULT CALLBACK MouseProc(int code, WPARAM wParam, LPARAM lParam);
+
+    static inline Win32InputCapture* instance = nullptr; // Target of the hook callbacks
+    Handler handler;
+    std::thread thread;
+    DWORD threadId = 0;
+};
+#endif
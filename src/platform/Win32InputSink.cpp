@@ -0,0 +1,113 @@
+#ifdef _WIN32
+#include "Win32InputSink.hpp"
+#include <algorithm>
+#include <cstring>
+
+std::unique_ptr<InputSink> CreateDefaultInputSink() {
+    return std::make_unique<Win32InputSink>();
+}
+
+size_t Win32InputSink::Send(const InputEvent* events, size_t count) {
+    if (count == 0) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    RefreshMetrics();
+
+    buffer.assign(count, INPUT{});
+    for (size_t i = 0; i < count; ++i) {
+        const InputEvent& e = events[i];
+        INPUT& input = buffer[i];
+        switch (e.type) {
+        case InputEvent::Type::Key:
+            input.type = INPUT_KEYBOARD;
+            input.ki.wVk = e.code;
+            input.ki.dwFlags = e.up ? KEYEVENTF_KEYUP : 0;
+            break;
+        case InputEvent::Type::Unicode:
+            input.type = INPUT_KEYBOARD;
+            input.ki.wScan = e.code;
+            input.ki.dwFlags = KEYEVENTF_UNICODE | (e.up ? KEYEVENTF_KEYUP : 0);
+            break;
+        case InputEvent::Type::MouseMove:
+            input.type = INPUT_MOUSE;
+            input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+            input.mi.dx = MulDiv(e.x - desktopLeft, 65535, desktopWidth - 1);
+            input.mi.dy = MulDiv(e.y - desktopTop, 65535, desktopHeight - 1);
+            break;
+        case InputEvent::Type::MouseButton:
+            input.type = INPUT_MOUSE;
+            if (e.code == 0)      input.mi.dwFlags = e.up ? MOUSEEVENTF_LEFTUP : MOUSEEVENTF_LEFTDOWN;
+            else if (e.code == 1) input.mi.dwFlags = e.up ? MOUSEEVENTF_RIGHTUP : MOUSEEVENTF_RIGHTDOWN;
+            else                  input.mi.dwFlags = e.up ? MOUSEEVENTF_MIDDLEUP : MOUSEEVENTF_MIDDLEDOWN;
+            break;
+        }
+    }
+    return SendInput((UINT)count, buffer.data(), sizeof(INPUT));
+}
+
+void Win32InputSink::RefreshMetrics() {
+    if (!metricsStale.exchange(false)) return;
+    desktopLeft = GetSystemMetrics(SM_XVIRTUALSCREEN);
+    desktopTop = GetSystemMetrics(SM_YVIRTUALSCREEN);
+    desktopWidth = (std::max)(GetSystemMetrics(SM_CXVIRTUALSCREEN), 2);
+    desktopHeight = (std::max)(GetSystemMetrics(SM_CYVIRTUALSCREEN), 2);
+}
+
+bool Win32InputSink::MapChar(char16_t c, uint16_t& vk, bool& shift) {
+    SHORT result = VkKeyScanW((WCHAR)c);
+    if (result == -1) return false;
+    BYTE state = HIBYTE(result);
+    if (state & ~1) return false;   // Needs Ctrl/Alt (AltGr); use a Unicode event instead
+    vk = LOBYTE(result);
+    shift = (state & 1) != 0;
+    return true;
+}
+
+char16_t Win32InputSink::KeyChar(uint16_t vk, bool shift) {
+    BYTE state[256] = {};
+    if (shift) state[VK_SHIFT] = 0x80;
+    HKL layout = GetKeyboardLayout(GetWindowThreadProcessId(GetForegroundWindow(), NULL));
+    WCHAR buffer[4];
+    // Flag 0x4 leaves the kernel's dead-key state alone, so typing is not disturbed
+    int count = ToUnicodeEx(vk, MapVirtualKeyExW(vk, MAPVK_VK_TO_VSC, layout), state, buffer, 4, 0x4, layout);
+    return count == 1 ? (char16_t)buffer[0] : 0;
+}
+
+bool Win32InputSink::SetClipboardText(const std::u16string& text) {
+    if (!OpenClipboard(NULL)) return false;
+    EmptyClipboard();
+    size_t bytes = (text.size() + 1) * sizeof(char16_t);
+    HGLOBAL memory = GlobalAlloc(GMEM_MOVEABLE, bytes);
+    bool ok = false;
+    if (memory) {
+        void* data = GlobalLock(memory);
+        std::memcpy(data, text.c_str(), bytes);
+        GlobalUnlock(memory);
+        ok = SetClipboardData(CF_UNICODETEXT, memory) != NULL;
+        if (!ok) GlobalFree(memory);
+    }
+    CloseClipboard();
+    return ok;
+}
+
+std::optional<std::u16string> Win32InputSink::GetClipboardText() {
+    if (!OpenClipboard(NULL)) return std::nullopt;
+    std::optional<std::u16string> text;
+    HANDLE memory = GetClipboardData(CF_UNICODETEXT);
+    if (memory) {
+        if (auto data = (const char16_t*)GlobalLock(memory)) {
+            text = std::u16string(data);
+            GlobalUnlock(memory);
+        }
+    }
+    CloseClipboard();
+    return text;
+}
+
+void Win32InputSink::GetCursorPos(int& x, int& y) {
+    POINT p = { 0, 0 };
+    ::GetCursorPos(&p);
+    x = p.x;
+    y = p.y;
+}
+#endif
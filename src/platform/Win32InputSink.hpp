@@ -0,0 +1,36 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "InputSink.hpp"
+
+// Windows input sink
+// Converts each batch to an INPUT array and submits it with a single SendInput call
+// Safe to call from any thread: script workers, threaded macros, replays and
+// clipboard restores all send input concurrently
+class Win32InputSink : public InputSink {
+public:
+    size_t Send(const InputEvent* events, size_t count) override;
+    bool MapChar(char16_t c, uint16_t& vk, bool& shift) override;
+    char16_t KeyChar(uint16_t vk, bool shift) override;
+    bool SetClipboardText(const std::u16string& text) override;
+    std::optional<std::u16string> GetClipboardText() override;
+    void GetCursorPos(int& x, int& y) override;
+    void DisplayChanged() override { metricsStale = true; }
+
+private:
+    // Reads the virtual desktop rectangle if it changed since the last batch
+    // mutex held
+    void RefreshMetrics();
+
+    std::mutex mutex;             // Guards buffer and the desktop rectangle
+    std::vector<INPUT> buffer;    // Reused between batches
+    std::atomic<bool> metricsStale = true;
+    int desktopLeft = 0;          // Virtual desktop rectangle that absolute
+    int desktopTop = 0;           // mouse coordinates (0-65535) span
+    int desktopWidth = 1;
+    int desktopHeight = 1;
+};
+#endif
@@ -0,0 +1,52 @@
+#ifdef _WIN32
+#include "MappedFile.hpp"
+#include <windows.h>
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length) || length.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    // The mapping keeps the file open; the handle itself is no longer needed
+    HANDLE map = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!map) return false;
+
+    void* view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(map);
+        return false;
+    }
+    mapping = map;
+    data = static_cast<const uint8_t*>(view);
+    size = (size_t)length.QuadPart;
+    released = 0;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    data = nullptr;
+    mapping = nullptr;
+    size = 0;
+    released = 0;
+}
+
+void MappedFile::Release(size_t offset) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    size_t page = info.dwPageSize;
+    size_t end = (offset < size ? offset : size) / page * page;
+    if (!data || end <= released) return;
+    // Unlocking pages that are not locked removes them from the working set
+    VirtualUnlock(const_cast<uint8_t*>(data) + released, end - released);
+    released = end;
+}
+#endif
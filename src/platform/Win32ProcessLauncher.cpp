@@ -0,0 +1,297 @@
+#ifdef _WIN32
+#include "Win32ProcessLauncher.hpp"
+#include "../utils/Log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+namespace {
+    // Completion keys; jobs report with their child's ID, which is never 0 or ~0
+    constexpr ULONG_PTR ReadKey = 0;
+    constexpr ULONG_PTR ResumeKey = ~ULONG_PTR(0);
+
+    std::wstring Widen(const std::string& text) {
+        if (text.empty()) return {};
+        int length = MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), nullptr, 0);
+        std::wstring wide(length, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), wide.data(), length);
+        return wide;
+    }
+
+    std::string LastError(const char* what) {
+        return std::string(what) + " failed (error " + std::to_string(GetLastError()) + ")";
+    }
+
+    // Unicode environment block: ours with the overrides applied, sorted by name
+    std::wstring BuildEnvironment(const std::vector<std::pair<std::string, std::string>>& overrides) {
+        std::vector<std::wstring> entries;
+        std::vector<std::wstring> names;
+        for (const auto& [key, value] : overrides) names.push_back(Widen(key));
+
+        if (wchar_t* block = GetEnvironmentStringsW()) {
+            for (const wchar_t* entry = block; *entry; entry += wcslen(entry) + 1) {
+                std::wstring text(entry);
+                // Entries such as "=C:=C:\dir" start with '='; their name includes it
+                std::wstring name = text.substr(0, text.find(L'=', 1));
+                bool replaced = std::any_of(names.begin(), names.end(),
+                                            [&](const std::wstring& n) { return _wcsicmp(n.c_str(), name.c_str()) == 0; });
+                if (!replaced) entries.push_back(std::move(text));
+            }
+            FreeEnvironmentStringsW(block);
+        }
+        for (size_t i = 0; i < overrides.size(); ++i) entries.push_back(names[i] + L"=" + Widen(overrides[i].second));
+        std::sort(entries.begin(), entries.end(),
+                  [](const std::wstring& a, const std::wstring& b) { return _wcsicmp(a.c_str(), b.c_str()) < 0; });
+
+        std::wstring result;
+        for (const auto& entry : entries) {
+            result += entry;
+            result += L'\0';
+        }
+        result += L'\0';
+        return result;
+    }
+
+    // Overlapped read end and inheritable write end of a fresh pipe
+    bool CreatePipePair(HANDLE& read, HANDLE& write, std::string& error) {
+        static std::atomic<uint64_t> serial = 0;
+        std::string name = "\\\\.\\pipe\\moonkey-" + std::to_string(GetCurrentProcessId()) + "-" + std::to_string(serial++);
+        read = CreateNamedPipeA(name.c_str(), PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                PIPE_TYPE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 0,
+                                Win32ProcessLauncher::readSize, 0, nullptr);
+        if (read == INVALID_HANDLE_VALUE) {
+            error = LastError("CreateNamedPipe");
+            return false;
+        }
+        SECURITY_ATTRIBUTES inherit = { sizeof(inherit), nullptr, TRUE };
+        write = CreateFileA(name.c_str(), GENERIC_WRITE, 0, &inherit, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (write == INVALID_HANDLE_VALUE) {
+            error = LastError("CreateFile on pipe");
+            CloseHandle(read);
+            return false;
+        }
+        return true;
+    }
+}
+
+std::unique_ptr<ProcessLauncher> CreateDefaultProcessLauncher() {
+    return std::make_unique<Win32ProcessLauncher>();
+}
+
+Win32ProcessLauncher::Win32ProcessLauncher() {
+    port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+}
+
+Win32ProcessLauncher::~Win32ProcessLauncher() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [id, child] : children) {
+        for (auto& read : child.reads) {
+            if (read->pipe != INVALID_HANDLE_VALUE) CloseHandle(read->pipe);
+        }
+        CloseHandle(child.process);
+        CloseHandle(child.job);
+    }
+    if (port) CloseHandle(port);
+}
+
+bool Win32ProcessLauncher::Launch(uint64_t id, const Options& options, std::string& error) {
+    if (!port) {
+        error = "I/O completion port unavailable";
+        return false;
+    }
+
+    HANDLE readEnds[2] = {}, writeEnds[2] = {};
+    for (int i = 0; i < 2; ++i) {
+        if (!CreatePipePair(readEnds[i], writeEnds[i], error)) {
+            for (int j = 0; j < i; ++j) {
+                CloseHandle(readEnds[j]);
+                CloseHandle(writeEnds[j]);
+            }
+            return false;
+        }
+    }
+    SECURITY_ATTRIBUTES inherit = { sizeof(inherit), nullptr, TRUE };
+    HANDLE input = CreateFileA("NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, &inherit, OPEN_EXISTING, 0, nullptr);
+    auto closeAll = [&](bool readsToo) {
+        for (int i = 0; i < 2; ++i) {
+            CloseHandle(writeEnds[i]);
+            if (readsToo) CloseHandle(readEnds[i]);
+        }
+        if (input != INVALID_HANDLE_VALUE) CloseHandle(input);
+    };
+
+    // Only the child's own pipe ends are inherited
+    HANDLE inherited[3] = { input, writeEnds[0], writeEnds[1] };
+    SIZE_T attributeSize = 0;
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &attributeSize);
+    std::vector<char> attributeBuffer(attributeSize);
+    auto* attributes = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributeBuffer.data());
+    InitializeProcThreadAttributeList(attributes, 1, 0, &attributeSize);
+    UpdateProcThreadAttribute(attributes, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, inherited, sizeof(inherited), nullptr, nullptr);
+
+    STARTUPINFOEXW startup = {};
+    startup.StartupInfo.cb = sizeof(startup);
+    startup.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+    startup.StartupInfo.hStdInput = input;
+    startup.StartupInfo.hStdOutput = writeEnds[0];
+    startup.StartupInfo.hStdError = writeEnds[1];
+    startup.lpAttributeList = attributes;
+
+    std::wstring commandLine = L"cmd.exe /d /s /c \"" + Widen(options.command) + L"\"";
+    std::wstring environment = BuildEnvironment(options.env);
+    std::wstring cwd = Widen(options.cwd);
+
+    // Started suspended so it is in its job before it can start anything
+    PROCESS_INFORMATION info = {};
+    BOOL created = CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, TRUE,
+                                  CREATE_SUSPENDED | CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT | EXTENDED_STARTUPINFO_PRESENT,
+                                  environment.data(), cwd.empty() ? nullptr : cwd.c_str(), &startup.StartupInfo, &info);
+    DeleteProcThreadAttributeList(attributes);
+    if (!created) {
+        error = LastError("CreateProcess");
+        closeAll(true);
+        return false;
+    }
+    closeAll(false);
+
+    // The job ends with us, so children never outlive MoonKey
+    HANDLE job = CreateJobObjectW(nullptr, nullptr);
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+    limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+    JOBOBJECT_ASSOCIATE_COMPLETION_PORT association = { reinterpret_cast<PVOID>(static_cast<ULONG_PTR>(id)), port };
+    if (!job || !SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits, sizeof(limits)) ||
+        !SetInformationJobObject(job, JobObjectAssociateCompletionPortInformation, &association, sizeof(association)) ||
+        !AssignProcessToJobObject(job, info.hProcess)) {
+        error = LastError("Job setup");
+        TerminateProcess(info.hProcess, 1);
+        CloseHandle(info.hThread);
+        CloseHandle(info.hProcess);
+        if (job) CloseHandle(job);
+        for (HANDLE read : readEnds) CloseHandle(read);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Child& child = children[id];
+        child.process = info.hProcess;
+        child.job = job;
+        for (int i = 0; i < 2; ++i) {
+            auto read = std::make_unique<Read>();
+            read->id = id;
+            read->stream = (Stream)i;
+            read->pipe = readEnds[i];
+            read->buffer.resize(readSize);
+            CreateIoCompletionPort(read->pipe, port, ReadKey, 0);
+            Issue(*read);
+            child.reads[i] = std::move(read);
+        }
+    }
+    ResumeThread(info.hThread);
+    CloseHandle(info.hThread);
+    return true;
+}
+
+void Win32ProcessLauncher::Kill(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = children.find(id);
+    if (it != children.end() && !it->second.exited) TerminateJobObject(it->second.job, 1);
+}
+
+void Win32ProcessLauncher::Resume(uint64_t id) {
+    // Reads are issued from the I/O thread, which owns the buffers
+    PostQueuedCompletionStatus(port, 0, ResumeKey, reinterpret_cast<LPOVERLAPPED>(static_cast<ULONG_PTR>(id)));
+}
+
+void Win32ProcessLauncher::Issue(Read& read) {
+    read.overlapped = {};
+    if (!ReadFile(read.pipe, read.buffer.data(), (DWORD)read.buffer.size(), nullptr, &read.overlapped) &&
+        GetLastError() != ERROR_IO_PENDING) {
+        // ERROR_BROKEN_PIPE: the child side is closed, which is end of file
+        CloseHandle(read.pipe);
+        read.pipe = INVALID_HANDLE_VALUE;
+        return;
+    }
+    // Completes through the port even when ReadFile finished at once
+    read.pending = true;
+}
+
+bool Win32ProcessLauncher::Finish(uint64_t id) {
+    auto it = children.find(id);
+    if (it == children.end()) return false;
+    Child& child = it->second;
+    if (!child.exited) return false;
+    for (const auto& read : child.reads) {
+        if (read->pipe != INVALID_HANDLE_VALUE) return false;
+    }
+    CloseHandle(child.process);
+    CloseHandle(child.job);
+    children.erase(it);
+    return true;
+}
+
+void Win32ProcessLauncher::Run(Handler handler) {
+    while (true) {
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED* overlapped = nullptr;
+        BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, INFINITE);
+        if (!ok && !overlapped) {
+            Log::Err() << "[Error] Process I/O loop stopped (error " << GetLastError() << ")";
+            return;
+        }
+        int code = 0;
+        bool finished = false;
+        uint64_t id = 0;
+
+        if (key == ResumeKey) {
+            id = static_cast<uint64_t>(reinterpret_cast<ULONG_PTR>(overlapped));
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = children.find(id);
+            if (it == children.end() || !it->second.paused) continue;
+            it->second.paused = false;
+            for (auto& read : it->second.reads) {
+                if (read->pipe != INVALID_HANDLE_VALUE && !read->pending) Issue(*read);
+            }
+            code = it->second.code;
+            finished = Finish(id);
+        } else if (key == ReadKey) {
+            // The Read outlives its pending read: a child is only removed once its pipes are closed
+            auto* read = reinterpret_cast<Read*>(overlapped);
+            id = read->id;
+            bool more = true;
+            if (ok && bytes > 0) more = handler.output(id, read->stream, read->buffer.data(), bytes);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            read->pending = false;
+            auto it = children.find(id);
+            if (it == children.end()) continue;
+            if (!ok) {
+                // ERROR_BROKEN_PIPE or a cancelled read: the stream is over
+                CloseHandle(read->pipe);
+                read->pipe = INVALID_HANDLE_VALUE;
+            } else if (!more) {
+                it->second.paused = true;
+            } else if (!it->second.paused) {
+                Issue(*read);
+            }
+            code = it->second.code;
+            finished = Finish(id);
+        } else {
+            // Job notification; fires once every process of the tree is gone
+            if (bytes != JOB_OBJECT_MSG_ACTIVE_PROCESS_ZERO) continue;
+            id = static_cast<uint64_t>(key);
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = children.find(id);
+            if (it == children.end()) continue;
+            DWORD exitCode = 0;
+            GetExitCodeProcess(it->second.process, &exitCode);
+            it->second.exited = true;
+            it->second.code = (int)exitCode;
+            code = it->second.code;
+            finished = Finish(id);
+        }
+        if (finished) handler.exit(id, code);
+    }
+}
+#endif
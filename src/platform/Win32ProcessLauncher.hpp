@@ -0,0 +1,60 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "ProcessLauncher.hpp"
+
+// Windows process launcher using an I/O completion port
+// Each child runs in a job object that reports to the port, so Kill ends
+// the whole tree and the exit arrives once every process in it is gone.
+// Output is read through overlapped named pipes whose completions arrive
+// at the same port. The child only inherits its own pipe ends
+// (PROC_THREAD_ATTRIBUTE_HANDLE_LIST), so concurrent launches do not leak
+// handles into each other. Pausing a child just stops issuing reads
+class Win32ProcessLauncher : public ProcessLauncher {
+public:
+    static inline DWORD readSize = 64 * 1024;     // Bytes per read and pipe buffer size
+
+    Win32ProcessLauncher();
+    ~Win32ProcessLauncher() override;
+
+    void Run(Handler handler) override;
+    bool Launch(uint64_t id, const Options& options, std::string& error) override;
+    void Kill(uint64_t id) override;
+    void Resume(uint64_t id) override;
+
+private:
+    // One pipe and its read; overlapped comes first so a completion maps back to it
+    struct Read {
+        OVERLAPPED overlapped = {};
+        uint64_t id = 0;
+        Stream stream = Stream::Stdout;
+        HANDLE pipe = INVALID_HANDLE_VALUE;   // INVALID_HANDLE_VALUE after end of file
+        bool pending = false;                  // A ReadFile is in flight
+        std::vector<char> buffer;
+    };
+
+    struct Child {
+        HANDLE process = nullptr;
+        HANDLE job = nullptr;
+        std::unique_ptr<Read> reads[2];        // stdout, stderr
+        bool exited = false;
+        bool paused = false;
+        int code = 0;
+    };
+
+    // Issues the next read of a pipe, closing it at end of file; mutex held
+    void Issue(Read& read);
+
+    // Removes a child whose pipes are closed and that has exited; mutex held
+    // Returns true if it was removed and its exit should be reported
+    bool Finish(uint64_t id);
+
+    HANDLE port = nullptr;
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Child> children;  // By caller ID; guarded by mutex
+};
+#endif
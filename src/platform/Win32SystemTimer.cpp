@@ -0,0 +1,37 @@
+#ifdef _WIN32
+#include "SystemTimer.hpp"
+#include <windows.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace {
+    // One timer per thread, created on first use and kept for the thread's lifetime
+    struct ThreadTimer {
+        HANDLE handle;
+        ThreadTimer() {
+            handle = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            if (!handle) handle = CreateWaitableTimerW(NULL, TRUE, NULL);
+        }
+        ~ThreadTimer() {
+            if (handle) CloseHandle(handle);
+        }
+    };
+}
+
+void SystemTimer::SleepUntil(std::chrono::steady_clock::time_point deadline) {
+    auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::steady_clock::duration::zero()) return;
+
+    static thread_local ThreadTimer timer;
+    // Relative due time in 100 ns units (negative = relative)
+    LARGE_INTEGER due;
+    due.QuadPart = -(LONGLONG)(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+    if (timer.handle && SetWaitableTimer(timer.handle, &due, 0, NULL, NULL, FALSE)) {
+        WaitForSingleObject(timer.handle, INFINITE);
+    } else {
+        Sleep((DWORD)std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+    }
+}
+#endif
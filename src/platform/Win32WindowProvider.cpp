@@ -0,0 +1,103 @@
+#ifdef _WIN32
+#include "Win32WindowProvider.hpp"
+
+std::unique_ptr<WindowProvider> CreateDefaultWindowProvider() {
+    return std::make_unique<Win32WindowProvider>();
+}
+
+Win32WindowProvider::~Win32WindowProvider() {
+    if (foregroundHook) UnhookWinEvent(foregroundHook);
+    if (lifetimeHook) UnhookWinEvent(lifetimeHook);
+    if (nameHook) UnhookWinEvent(nameHook);
+    if (instance == this) instance = nullptr;
+}
+
+WindowInfo Win32WindowProvider::Foreground() {
+    return Describe(GetForegroundWindow());
+}
+
+std::vector<WindowInfo> Win32WindowProvider::Enumerate() {
+    std::vector<WindowInfo> windows;
+    // EnumWindows walks top-level windows in z-order, topmost first
+    EnumWindows([](HWND hwnd, LPARAM param) -> BOOL {
+        if (IsWindowVisible(hwnd)) reinterpret_cast<std::vector<WindowInfo>*>(param)->push_back(Describe(hwnd));
+        return TRUE;
+    }, reinterpret_cast<LPARAM>(&windows));
+    return windows;
+}
+
+void Win32WindowProvider::Attach(Listener onWindowEvent) {
+    listener = std::move(onWindowEvent);
+    instance = this;
+    foregroundHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, NULL,
+                                     OnWinEvent, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    lifetimeHook = SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_HIDE, NULL,
+                                   OnWinEvent, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    nameHook = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, NULL,
+                               OnWinEvent, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+}
+
+bool Win32WindowProvider::Activate(std::uintptr_t handle) {
+    HWND hwnd = (HWND)handle;
+    if (!IsWindow(hwnd)) return false;
+    if (IsIconic(hwnd)) ShowWindow(hwnd, SW_RESTORE);
+    return SetForegroundWindow(hwnd) != FALSE;
+}
+
+WindowInfo Win32WindowProvider::Describe(HWND hwnd) {
+    WindowInfo info;
+    info.handle = (std::uintptr_t)hwnd;
+    if (hwnd == NULL) return info;
+
+    char buffer[256];
+    int length = GetWindowTextA(hwnd, buffer, sizeof(buffer));
+    info.title.assign(buffer, length > 0 ? length : 0);
+    length = GetClassNameA(hwnd, buffer, sizeof(buffer));
+    info.className.assign(buffer, length > 0 ? length : 0);
+
+    DWORD pid = 0;
+    GetWindowThreadProcessId(hwnd, &pid);
+    info.pid = pid;
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (process) {
+        char path[MAX_PATH];
+        DWORD size = MAX_PATH;
+        if (QueryFullProcessImageNameA(process, 0, path, &size)) {
+            std::string full(path, size);
+            size_t slash = full.find_last_of("\\/");
+            info.processName = slash == std::string::npos ? full : full.substr(slash + 1);
+        }
+        CloseHandle(process);
+    }
+    return info;
+}
+
+void CALLBACK Win32WindowProvider::OnWinEvent(HWINEVENTHOOK, DWORD event, HWND hwnd,
+                                              LONG idObject, LONG idChild, DWORD, DWORD) {
+    if (!instance || !instance->listener || idObject != OBJID_WINDOW || idChild != CHILDID_SELF) return;
+    // A destroyed window can no longer be inspected; the index ignores handles it does not know
+    if (event != EVENT_OBJECT_DESTROY && GetAncestor(hwnd, GA_ROOT) != hwnd) return;
+
+    WindowInfo window;
+    window.handle = (std::uintptr_t)hwnd;
+    switch (event) {
+        case EVENT_SYSTEM_FOREGROUND:
+            instance->listener({ WindowEvent::Type::Foreground, Describe(hwnd) });
+            break;
+        case EVENT_OBJECT_SHOW:
+            instance->listener({ WindowEvent::Type::Created, Describe(hwnd) });
+            break;
+        case EVENT_OBJECT_HIDE:
+        case EVENT_OBJECT_DESTROY:
+            instance->listener({ WindowEvent::Type::Destroyed, window });
+            break;
+        case EVENT_OBJECT_NAMECHANGE: {
+            char buffer[256];
+            int length = GetWindowTextA(hwnd, buffer, sizeof(buffer));
+            window.title.assign(buffer, length > 0 ? length : 0);
+            instance->listener({ WindowEvent::Type::Renamed, window });
+            break;
+        }
+    }
+}
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include "WindowProvider.hpp"
+
+// Windows window provider
+// Tracks windows with SetWinEventHook instead of polling:
+// EVENT_SYSTEM_FOREGROUND for focus changes, EVENT_OBJECT_SHOW/HIDE/DESTROY
+// for top-level windows appearing and going away, and EVENT_OBJECT_NAMECHANGE
+// for title changes
+class Win32WindowProvider : public WindowProvider {
+public:
+    ~Win32WindowProvider() override;
+
+    WindowInfo Foreground() override;
+    std::vector<WindowInfo> Enumerate() override;
+    void Attach(Listener onWindowEvent) override;
+    bool Activate(std::uintptr_t handle) override;
+
+    // Reads title, class, process ID and process name of a window
+    static WindowInfo Describe(HWND hwnd);
+
+private:
+    static void CALLBACK OnWinEvent(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+                                    LONG idObject, LONG idChild, DWORD thread, DWORD time);
+
+    static inline Win32WindowProvider* instance = nullptr; // Target of the WinEvent callback
+    Listener listener;
+    HWINEVENTHOOK foregroundHook = NULL;
+    HWINEVENTHOOK lifetimeHook = NULL;
+    HWINEVENTHOOK nameHook = NULL;
+};
+#endif
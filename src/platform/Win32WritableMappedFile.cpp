@@ -0,0 +1,83 @@
+#ifdef _WIN32
+#include "WritableMappedFile.hpp"
+#include <windows.h>
+
+bool WritableMappedFile::Open(const std::string& path) {
+    Close();
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    file = handle;
+
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(handle, &length)) {
+        Close();
+        return false;
+    }
+    size = (size_t)length.QuadPart;
+    if (!Map()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void WritableMappedFile::Close() {
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    data = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    size = 0;
+}
+
+bool WritableMappedFile::Map() {
+    data = nullptr;
+    mapping = nullptr;
+    // A mapping of an empty file cannot be created
+    if (size == 0) return true;
+    HANDLE map = CreateFileMappingW(file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+    if (!map) return false;
+    void* view = MapViewOfFile(map, FILE_MAP_WRITE, 0, 0, size);
+    if (!view) {
+        CloseHandle(map);
+        return false;
+    }
+    mapping = map;
+    data = static_cast<uint8_t*>(view);
+    return true;
+}
+
+bool WritableMappedFile::Resize(size_t length) {
+    if (!file) return false;
+    // The file cannot change length while a view of it exists
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    data = nullptr;
+    mapping = nullptr;
+
+    FILE_END_OF_FILE_INFO end;
+    end.EndOfFile.QuadPart = (LONGLONG)length;
+    if (SetFileInformationByHandle(file, FileEndOfFileInfo, &end, sizeof(end))) {
+        size_t previous = size;
+        size = length;
+        if (Map()) return true;
+        size = previous;
+        end.EndOfFile.QuadPart = (LONGLONG)previous;
+        SetFileInformationByHandle(file, FileEndOfFileInfo, &end, sizeof(end));
+    }
+    Map();
+    return false;
+}
+
+void WritableMappedFile::Flush(bool wait) {
+    if (!data) return;
+    FlushViewOfFile(data, 0);
+    if (wait) FlushFileBuffers(file);
+}
+
+bool WritableMappedFile::IsOpen() const {
+    return file != nullptr;
+}
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Snapshot of a top-level window as seen by filters
+struct WindowInfo {
+    std::uintptr_t handle = 0;    // Native window handle (HWND on Windows)
+    std::string title;            // Window caption
+    std::string className;        // Window class name
+    std::string processName;      // Executable file name, e.g. "notepad.exe"
+    uint32_t pid = 0;             // Owning process ID
+};
+
+// Change to a top-level window reported by a WindowProvider
+struct WindowEvent {
+    enum class Type {
+        Created,                  // Window became visible; fully described
+        Destroyed,                // Window was destroyed or hidden; only handle is set
+        Renamed,                  // Title changed; only handle and title are set
+        Foreground                // Window became the foreground window; fully described
+    };
+
+    Type type;
+    WindowInfo window;
+};
+
+// Source of window information
+// Abstracts window enumeration, activation and the window-change
+// notifications so window filtering and the window index can be driven by a
+// mock provider off Windows
+class WindowProvider {
+public:
+    using Listener = std::function<void(const WindowEvent&)>;
+
+    virtual ~WindowProvider() = default;
+
+    // Queries the current foreground window directly from the OS
+    virtual WindowInfo Foreground() = 0;
+
+    // Lists the visible top-level windows, topmost first
+    virtual std::vector<WindowInfo> Enumerate() = 0;
+
+    // Starts delivering window creation, destruction, title and foreground
+    // changes to the listener
+    // Called on the MessageLoop thread; native notifications are delivered
+    // while that thread pumps its event source
+    virtual void Attach(Listener onWindowEvent) = 0;
+
+    // Brings a window to the foreground, restoring it if minimized
+    // Returns false if the window does not exist or the OS refused
+    virtual bool Activate(std::uintptr_t handle) = 0;
+};
+
+// Creates the window provider for the current platform
+// Win32WindowProvider on Windows, MemoryWindowProvider elsewhere
+std::unique_ptr<WindowProvider> CreateDefaultWindowProvider();
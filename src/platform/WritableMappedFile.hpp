@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Shared read-write memory mapping of a whole file that can be resized
+// Windows: CreateFileMapping/MapViewOfFile. Elsewhere: mmap(MAP_SHARED).
+// Stores into the mapping land in the OS page cache, so they survive a
+// crash of the process without any system call; only a crash of the OS
+// can lose what has not been written back yet
+class WritableMappedFile {
+public:
+    WritableMappedFile() = default;
+    ~WritableMappedFile() { Close(); }
+    WritableMappedFile(const WritableMappedFile&) = delete;
+    WritableMappedFile& operator=(const WritableMappedFile&) = delete;
+
+    // Opens path for reading and writing, creating it if needed, and maps its current length
+    // Returns false if it cannot be opened or mapped
+    bool Open(const std::string& path);
+
+    // Unmaps and closes the file
+    void Close();
+
+    // Sets the file length and remaps it; bytes added are zero
+    // Data() may move. Returns false if the file could not be resized, in
+    // which case the previous mapping is kept
+    bool Resize(size_t length);
+
+    // Writes modified pages back to the file
+    // wait: Return only once they are on disk; otherwise just start the write-back
+    void Flush(bool wait);
+
+    bool IsOpen() const;
+    uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    // Maps size bytes of the open file
+    bool Map();
+
+    uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;         // File handle
+    void* mapping = nullptr;      // File mapping object handle
+#else
+    int fd = -1;
+#endif
+};
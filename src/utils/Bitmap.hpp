@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// 32-bit image in row-major order, top row first
+// Pixels are 0xAARRGGBB, which is BGRA in memory as produced by GDI.
+// Screen frames leave alpha undefined; templates use it for transparency
+struct Bitmap {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels; // width * height
+
+    void Resize(int w, int h) {
+        width = w;
+        height = h;
+        pixels.assign((size_t)w * h, 0);
+    }
+
+    uint32_t* Row(int y) { return pixels.data() + (size_t)y * width; }
+    const uint32_t* Row(int y) const { return pixels.data() + (size_t)y * width; }
+    uint32_t At(int x, int y) const { return Row(y)[x]; }
+};
@@ -1,39 +1,178 @@
 #pragma once
-#include <vector>
+#include <atomic>
 #include <functional>
-#include <map>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
 #include <unordered_map>
+#include <vector>
+#include "MpscQueue.hpp"
+#include "Log.hpp"
+
+// Interned event ID; small dense integers so listeners can be found by index
+using EventId = uint32_t;
+
+// Registry of event names
+// Each distinct name is given an ID once; the payload type used with it is
+// recorded so two parts of the program cannot disagree about it
+struct EventRegistry {
+    // Returns the ID for name, creating it on first use
+    // payload: Payload type used with the event, or nullptr if unknown (Lua)
+    static EventId Intern(std::string_view name, const std::type_info* payload = nullptr) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.ids.find(std::string(name));
+        if (it == s.ids.end()) {
+            it = s.ids.emplace(std::string(name), (EventId)s.names.size()).first;
+            s.names.emplace_back(name);
+            s.types.push_back(payload);
+        }
+        const std::type_info*& known = s.types[it->second];
+        if (payload && known && *known != *payload) {
+            Log::Err() << "[Error] Event '" << name << "' used with different payload types";
+        } else if (payload) {
+            known = payload;
+        }
+        return it->second;
+    }
+
+    // Name an ID was interned from
+    static std::string Name(EventId id) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return id < s.names.size() ? s.names[id] : std::string();
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::unordered_map<std::string, EventId> ids;
+        std::vector<std::string> names;
+        std::vector<const std::type_info*> types;
+    };
+
+    // Function-local so events declared as globals in any translation unit
+    // can be interned during static initialization
+    static State& state() {
+        static State s;
+        return s;
+    }
+};
+
+// Typed event handle
+// Created once (typically as a namespace-scope constant) and reused; the
+// name is looked up only at construction
+template <typename Payload>
+struct Event {
+    explicit Event(std::string_view name) : id(EventRegistry::Intern(name, &typeid(Payload))) {}
+    EventId id;
+};
 
 // Event dispatcher for inter-component communication
-// Implements a simple publisher-subscriber pattern for loose coupling
-// between system components. Used primarily for hot-reload notifications
+// Subscribers are indexed by interned event ID and receive a typed payload.
+// Subscribing and dispatching happen on the thread that owns the dispatcher;
+// other threads publish into a lock-free MPSC queue that the owner drains,
+// so subscribers always run on a known thread.
 class EventDispatcher {
 public:
-    using Callback = std::function<void()>; // Type for event callbacks
+    template <typename Payload>
+    using Callback = std::function<void(const Payload&)>;   // Type for event callbacks
+
+    // waker: Called when a publish finds the queue idle, e.g. to wake the owner's loop
+    explicit EventDispatcher(std::function<void()> waker = nullptr) : waker(std::move(waker)) {}
+
+    ~EventDispatcher() { discard(); }
 
-    // Subscribe to an event
-    // eventType: Event name to subscribe to
+    // Subscribe to an event; owning thread only
+    // event: Event to subscribe to
     // cb: Callback function to execute when event is dispatched
     // Multiple callbacks can be registered for the same event type
     // Callbacks are executed in registration order
-    void subscribe(std::string eventType, Callback cb) {
-        listeners[eventType].push_back(cb);
+    template <typename Payload>
+    void subscribe(const Event<Payload>& event, std::type_identity_t<Callback<Payload>> cb) {
+        if (event.id >= listeners.size()) listeners.resize(event.id + 1);
+        listeners[event.id].push_back([cb = std::move(cb)](const void* payload) {
+            cb(*static_cast<const Payload*>(payload));
+        });
     }
 
-    // Dispatch an event to all subscribers
-    // eventType: Event name to dispatch
+    // Dispatch an event to all subscribers; owning thread only
     // Synchronously executes all callbacks registered for the event type
     // Exceptions in callbacks are not caught and will propagate
-    void dispatch(std::string eventType) {
-        auto it = listeners.find(eventType);
-        if (it != listeners.end()) {
-            for (auto& cb : it->second) {
-                cb();
-            }
+    template <typename Payload>
+    void dispatch(const Event<Payload>& event, const Payload& payload) {
+        deliver(event.id, &payload);
+    }
+
+    // Queue an event for the owning thread; any thread
+    // Delivered in publish order per producer by the next drain()
+    template <typename Payload>
+    void publish(const Event<Payload>& event, Payload payload) {
+        queue.Push(new Message<Payload>(event.id, std::move(payload)));
+        // Only the first publish after a drain needs to wake the owner
+        if (!pending.exchange(true, std::memory_order_acq_rel)) {
+            pending.notify_one();
+            if (waker) waker();
+        }
+    }
+
+    // Deliver every queued event; owning thread only
+    // Returns: Number of events delivered
+    size_t drain() {
+        // A read-modify-write, so a publish that still saw the flag set is
+        // ordered before the pops below and its message is found by them
+        pending.exchange(false, std::memory_order_acq_rel);
+        size_t count = 0;
+        while (MpscNode* node = queue.Pop()) {
+            auto* message = static_cast<MessageBase*>(node);
+            deliver(message->id, message->payload());
+            delete message;
+            ++count;
+        }
+        return count;
+    }
+
+    // Drop every queued event without delivering it; owning thread only
+    size_t discard() {
+        size_t count = 0;
+        while (MpscNode* node = queue.Pop()) {
+            delete static_cast<MessageBase*>(node);
+            ++count;
         }
+        return count;
+    }
+
+    // Block until something was published since the last drain(); owning thread only
+    void wait() {
+        pending.wait(false, std::memory_order_acquire);
     }
 
 private:
-    std::unordered_map<std::string, std::vector<Callback>> listeners; // Event subscriptions
-};
\ No newline at end of file
+    struct MessageBase : MpscNode {
+        explicit MessageBase(EventId id) : id(id) {}
+        virtual ~MessageBase() = default;
+        virtual const void* payload() const = 0;
+        EventId id;
+    };
+
+    template <typename Payload>
+    struct Message : MessageBase {
+        Message(EventId id, Payload value) : MessageBase(id), value(std::move(value)) {}
+        const void* payload() const override { return &value; }
+        Payload value;
+    };
+
+    void deliver(EventId id, const void* payload) {
+        if (id >= listeners.size()) return;
+        for (size_t i = 0; i < listeners[id].size(); ++i) {
+            listeners[id][i](payload);
+        }
+    }
+
+    std::vector<std::vector<std::function<void(const void*)>>> listeners; // Event subscriptions by ID
+    MpscQueue queue;                                                       // Cross-thread publishes
+    std::atomic<bool> pending = false;                                     // Published since last drain()
+    std::function<void()> waker;
+};
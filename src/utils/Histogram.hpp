@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free log-linear histogram of non-negative integer samples
+// Values below 8 get a bucket each; above that every power of two is split
+// into 8 buckets, so any reported percentile is within 12.5% of the true
+// value. Recording is a few relaxed atomic increments and can happen from
+// any thread; readers see a consistent-enough snapshot for reporting.
+class Histogram {
+public:
+    static constexpr size_t subBuckets = 8;
+    static constexpr size_t bucketCount = (64 - 3 + 1) * subBuckets;
+
+    void Record(uint64_t value) {
+        buckets[Index(value)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t seen = max.load(std::memory_order_relaxed);
+        while (value > seen && !max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+    }
+
+    // Upper bound of the bucket holding the p-th fraction of samples (0 <= p <= 1)
+    uint64_t Percentile(double p) const {
+        uint64_t total = Count();
+        if (total == 0) return 0;
+        uint64_t rank = (uint64_t)(p * (double)(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucketCount; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t upper = UpperBound(i);
+                uint64_t largest = Max();
+                return upper < largest ? upper : largest;
+            }
+        }
+        return Max();
+    }
+
+    uint64_t Count() const { return count.load(std::memory_order_relaxed); }
+    uint64_t Max() const { return max.load(std::memory_order_relaxed); }
+    double Mean() const {
+        uint64_t n = Count();
+        return n ? (double)sum.load(std::memory_order_relaxed) / (double)n : 0.0;
+    }
+
+    void Reset() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    static size_t Index(uint64_t value) {
+        if (value < subBuckets) return (size_t)value;
+        int exponent = 63 - std::countl_zero(value);              // >= 3
+        size_t sub = (size_t)(value >> (exponent - 3)) & (subBuckets - 1);
+        return (size_t)(exponent - 2) * subBuckets + sub;
+    }
+
+    // Largest value that maps to bucket index
+    static uint64_t UpperBound(size_t index) {
+        if (index < subBuckets) return index;
+        int exponent = (int)(index / subBuckets) + 2;
+        uint64_t sub = index % subBuckets;
+        uint64_t base = (uint64_t)(subBuckets + sub) << (exponent - 3);
+        return base + ((uint64_t)1 << (exponent - 3)) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, bucketCount> buckets{};
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> sum = 0;
+    std::atomic<uint64_t> max = 0;
+};
@@ -0,0 +1,96 @@
+#include "HotstringAutomaton.hpp"
+#include <algorithm>
+#include <cwctype>
+
+int HotstringAutomaton::Add(const std::u16string& pattern) {
+    std::u16string folded = pattern;
+    for (auto& c : folded) c = Fold(c);
+    patterns.push_back(std::move(folded));
+    return (int)patterns.size() - 1;
+}
+
+void HotstringAutomaton::Clear() {
+    patterns.clear();
+    Build();
+}
+
+char16_t HotstringAutomaton::Fold(char16_t c) {
+    if (c < 0x80) return (c >= 'A' && c <= 'Z') ? (char16_t)(c + ('a' - 'A')) : c;
+    // Surrogates pass through unchanged; they are matched unit by unit
+    if (c >= 0xD800 && c <= 0xDFFF) return c;
+    wint_t lower = std::towlower((wint_t)c);
+    return lower <= 0xFFFF ? (char16_t)lower : c;
+}
+
+void HotstringAutomaton::Build() {
+    // Compress the alphabet to the characters patterns actually use
+    classOf.assign(0x10000, 0);
+    stride = 1;
+    maxLength = 0;
+    for (const auto& pattern : patterns) {
+        maxLength = (std::max)(maxLength, pattern.size());
+        for (char16_t c : pattern) {
+            if (classOf[c] == 0) classOf[c] = (uint16_t)stride++;
+        }
+    }
+    // Upper-case input reaches the same class as its folded form
+    for (uint32_t c = 0; c < 0x10000; ++c) {
+        char16_t folded = Fold((char16_t)c);
+        if (folded != c && classOf[folded] != 0) classOf[c] = classOf[folded];
+    }
+
+    // Trie over classes; 0 in the table means "no child" (root is never a child)
+    next.assign(stride, 0);
+    std::vector<std::vector<uint32_t>> own(1);
+    for (uint32_t id = 0; id < patterns.size(); ++id) {
+        uint32_t state = root;
+        for (char16_t c : patterns[id]) {
+            size_t slot = (size_t)state * stride + classOf[c];
+            if (next[slot] == 0) {
+                next[slot] = (uint32_t)own.size();
+                own.emplace_back();
+                next.resize(next.size() + stride, 0);
+            }
+            state = next[slot];
+        }
+        own[state].push_back(id);
+    }
+
+    // Breadth-first: fill missing transitions from the failure state, whose
+    // row is always complete by the time a deeper state is visited
+    size_t states = own.size();
+    std::vector<uint32_t> fail(states, root), order;
+    order.reserve(states);
+    for (size_t cls = 0; cls < stride; ++cls) {
+        if (uint32_t child = next[cls]) order.push_back(child);
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        uint32_t state = order[i];
+        for (size_t cls = 0; cls < stride; ++cls) {
+            uint32_t& slot = next[(size_t)state * stride + cls];
+            uint32_t fallback = next[(size_t)fail[state] * stride + cls];
+            if (slot) {
+                fail[slot] = fallback;
+                order.push_back(slot);
+            } else {
+                slot = fallback;
+            }
+        }
+    }
+
+    // Each state reports its own patterns, then those of its failure chain
+    std::vector<std::vector<uint32_t>> all(states);
+    for (uint32_t state : order) {
+        all[state] = own[state];
+        const auto& inherited = all[fail[state]];
+        all[state].insert(all[state].end(), inherited.begin(), inherited.end());
+    }
+
+    outputStart.assign(states + 1, 0);
+    outputs.clear();
+    for (size_t state = 0; state < states; ++state) {
+        outputStart[state] = (uint32_t)outputs.size();
+        outputs.insert(outputs.end(), all[state].begin(), all[state].end());
+    }
+    outputStart[states] = (uint32_t)outputs.size();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Multi-pattern matcher for hotstring abbreviations
+// Aho-Corasick automaton compiled into a dense DFA. Characters that appear
+// in any pattern are mapped to a small alphabet of classes (every other
+// character shares class 0), so each state is one row of a flat transition
+// table and a keystroke costs two array lookups regardless of how many
+// patterns are registered. Matching is case-insensitive; callers that need
+// exact case check the reported pattern against their own input history.
+class HotstringAutomaton {
+public:
+    // Adds a pattern; returns its ID (patterns are numbered from 0 in call order)
+    // Invalidates the automaton until Build() is called again
+    int Add(const std::u16string& pattern);
+
+    // Removes every pattern and state
+    void Clear();
+
+    // Compiles the patterns added so far
+    void Build();
+
+    // State after consuming c in state
+    uint32_t Step(uint32_t state, char16_t c) const {
+        return next[(size_t)state * stride + classOf[c]];
+    }
+
+    // IDs of the patterns that end in state, longest first
+    const uint32_t* OutputsBegin(uint32_t state) const { return outputs.data() + outputStart[state]; }
+    const uint32_t* OutputsEnd(uint32_t state) const { return outputs.data() + outputStart[state + 1]; }
+
+    // Length of a pattern in UTF-16 units
+    size_t Length(int id) const { return patterns[id].size(); }
+
+    // Length of the longest pattern
+    size_t MaxLength() const { return maxLength; }
+
+    size_t PatternCount() const { return patterns.size(); }
+    size_t StateCount() const { return outputStart.empty() ? 0 : outputStart.size() - 1; }
+
+    // Folds a character for case-insensitive matching
+    static char16_t Fold(char16_t c);
+
+    static constexpr uint32_t root = 0;
+
+private:
+    std::vector<std::u16string> patterns;  // Folded patterns by ID
+    std::vector<uint16_t> classOf;         // Character -> alphabet class (65536 entries)
+    std::vector<uint32_t> next;            // Transition table, stride entries per state
+    std::vector<uint32_t> outputStart;     // Offset of each state's outputs (StateCount + 1 entries)
+    std::vector<uint32_t> outputs;         // Pattern IDs, grouped by state
+    size_t stride = 1;                     // Alphabet size including class 0
+    size_t maxLength = 0;
+};
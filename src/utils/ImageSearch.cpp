@@ -0,0 +1,268 @@
+#include "ImageSearch.hpp"
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOONKEY_SIMD 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MOONKEY_AVX2
+#else
+#define MOONKEY_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+    constexpr uint32_t ColorMask = 0x00FFFFFF;
+
+    bool MatchesMasked(uint32_t a, uint32_t b, uint32_t mask, int tolerance) {
+        return !mask || ImageSearch::Matches(a, b, tolerance);
+    }
+
+    ptrdiff_t FindColorScalar(const uint32_t* pixels, size_t count, uint32_t color, int tolerance) {
+        for (size_t i = 0; i < count; ++i) {
+            if (ImageSearch::Matches(pixels[i], color, tolerance)) return (ptrdiff_t)i;
+        }
+        return -1;
+    }
+
+    bool RowMatchesScalar(const uint32_t* pixels, const uint32_t* templ, const uint32_t* mask, size_t count, int tolerance) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!MatchesMasked(pixels[i], templ[i], mask[i], tolerance)) return false;
+        }
+        return true;
+    }
+
+#ifdef MOONKEY_SIMD
+    // Per byte: how far |a - b| exceeds the tolerance, after masking
+    // One of the two saturating differences is always zero, so OR gives |a - b|
+    inline __m128i Excess(__m128i a, __m128i b, __m128i mask, __m128i tolerance) {
+        __m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+        return _mm_subs_epu8(_mm_and_si128(diff, mask), tolerance);
+    }
+
+    ptrdiff_t FindColorSse2(const uint32_t* pixels, size_t count, uint32_t color, int tolerance) {
+        const __m128i target = _mm_set1_epi32((int)color);
+        const __m128i mask = _mm_set1_epi32((int)ColorMask);
+        const __m128i tol = _mm_set1_epi8((char)tolerance);
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i excess = Excess(_mm_loadu_si128((const __m128i*)(pixels + i)), target, mask, tol);
+            int hits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(excess, zero)));
+            if (hits) return (ptrdiff_t)(i + std::countr_zero((unsigned)hits));
+        }
+        ptrdiff_t tail = FindColorScalar(pixels + i, count - i, color, tolerance);
+        return tail < 0 ? -1 : (ptrdiff_t)i + tail;
+    }
+
+    bool RowMatchesSse2(const uint32_t* pixels, const uint32_t* templ, const uint32_t* mask, size_t count, int tolerance) {
+        const __m128i tol = _mm_set1_epi8((char)tolerance);
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i excess = Excess(_mm_loadu_si128((const __m128i*)(pixels + i)), _mm_loadu_si128((const __m128i*)(templ + i)),
+                                    _mm_loadu_si128((const __m128i*)(mask + i)), tol);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(excess, zero)) != 0xFFFF) return false;
+        }
+        return RowMatchesScalar(pixels + i, templ + i, mask + i, count - i, tolerance);
+    }
+
+    MOONKEY_AVX2 inline __m256i Excess(__m256i a, __m256i b, __m256i mask, __m256i tolerance) {
+        __m256i diff = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+        return _mm256_subs_epu8(_mm256_and_si256(diff, mask), tolerance);
+    }
+
+    MOONKEY_AVX2 ptrdiff_t FindColorAvx2(const uint32_t* pixels, size_t count, uint32_t color, int tolerance) {
+        const __m256i target = _mm256_set1_epi32((int)color);
+        const __m256i mask = _mm256_set1_epi32((int)ColorMask);
+        const __m256i tol = _mm256_set1_epi8((char)tolerance);
+        const __m256i zero = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i excess = Excess(_mm256_loadu_si256((const __m256i*)(pixels + i)), target, mask, tol);
+            int hits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(excess, zero)));
+            if (hits) return (ptrdiff_t)(i + std::countr_zero((unsigned)hits));
+        }
+        ptrdiff_t tail = FindColorSse2(pixels + i, count - i, color, tolerance);
+        return tail < 0 ? -1 : (ptrdiff_t)i + tail;
+    }
+
+    MOONKEY_AVX2 bool RowMatchesAvx2(const uint32_t* pixels, const uint32_t* templ, const uint32_t* mask, size_t count, int tolerance) {
+        const __m256i tol = _mm256_set1_epi8((char)tolerance);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i excess = Excess(_mm256_loadu_si256((const __m256i*)(pixels + i)), _mm256_loadu_si256((const __m256i*)(templ + i)),
+                                    _mm256_loadu_si256((const __m256i*)(mask + i)), tol);
+            if (!_mm256_testz_si256(excess, excess)) return false;
+        }
+        return RowMatchesSse2(pixels + i, templ + i, mask + i, count - i, tolerance);
+    }
+#endif
+
+    uint32_t ReadU32(const uint8_t* p) {
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+
+    uint16_t ReadU16(const uint8_t* p) {
+        return (uint16_t)(p[0] | p[1] << 8);
+    }
+}
+
+ImageSearch::Isa ImageSearch::Detect() {
+#ifdef MOONKEY_SIMD
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    int leaves = info[0];
+    __cpuid(info, 1);
+    bool osxsave = info[2] & (1 << 27);
+    bool avx = info[2] & (1 << 28);
+    // The OS must save the YMM registers on context switches
+    if (leaves >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) return Isa::Avx2;
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+#endif
+    return Isa::Sse2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+ptrdiff_t ImageSearch::FindColor(const uint32_t* pixels, size_t count, uint32_t color, int tolerance) {
+#ifdef MOONKEY_SIMD
+    if (isa == Isa::Avx2) return FindColorAvx2(pixels, count, color, tolerance);
+    if (isa == Isa::Sse2) return FindColorSse2(pixels, count, color, tolerance);
+#endif
+    return FindColorScalar(pixels, count, color, tolerance);
+}
+
+bool ImageSearch::RowMatches(const uint32_t* pixels, const uint32_t* templ, const uint32_t* mask, size_t count, int tolerance) {
+#ifdef MOONKEY_SIMD
+    if (isa == Isa::Avx2) return RowMatchesAvx2(pixels, templ, mask, count, tolerance);
+    if (isa == Isa::Sse2) return RowMatchesSse2(pixels, templ, mask, count, tolerance);
+#endif
+    return RowMatchesScalar(pixels, templ, mask, count, tolerance);
+}
+
+ImageTemplate ImageSearch::Prepare(Bitmap image) {
+    ImageTemplate prepared;
+    prepared.mask.resize(image.pixels.size());
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        bool opaque = (image.pixels[i] >> 24) >= 0x80;
+        prepared.mask[i] = opaque ? ColorMask : 0;
+        if (opaque && prepared.blank) {
+            prepared.blank = false;
+            prepared.anchorX = (int)(i % image.width);
+            prepared.anchorY = (int)(i / image.width);
+        }
+    }
+    prepared.image = std::move(image);
+    return prepared;
+}
+
+bool ImageSearch::Find(const Bitmap& haystack, int left, int top, int width, int height,
+                       const ImageTemplate& needle, int tolerance, int& x, int& y) {
+    const Bitmap& templ = needle.image;
+    if (left < 0 || top < 0 || left + width > haystack.width || top + height > haystack.height) return false;
+    if (templ.width <= 0 || templ.height <= 0 || templ.width > width || templ.height > height) return false;
+    if (needle.blank) {
+        x = left;
+        y = top;
+        return true;
+    }
+
+    // Placements per row; the anchor of placement px sits at column px + anchorX
+    size_t span = (size_t)(width - templ.width + 1);
+    uint32_t anchor = templ.At(needle.anchorX, needle.anchorY);
+    for (int row0 = top; row0 + templ.height <= top + height; ++row0) {
+        const uint32_t* anchorRow = haystack.Row(row0 + needle.anchorY) + left + needle.anchorX;
+        size_t from = 0;
+        while (from < span) {
+            ptrdiff_t hit = FindColor(anchorRow + from, span - from, anchor, tolerance);
+            if (hit < 0) break;
+            int column = left + (int)(from + (size_t)hit);
+
+            bool matched = true;
+            for (int row = 0; row < templ.height && matched; ++row) {
+                matched = RowMatches(haystack.Row(row0 + row) + column, templ.Row(row),
+                                     needle.mask.data() + (size_t)row * templ.width, (size_t)templ.width, tolerance);
+            }
+            if (matched) {
+                x = column;
+                y = row0;
+                return true;
+            }
+            from += (size_t)hit + 1;
+        }
+    }
+    return false;
+}
+
+bool ImageSearch::LoadBmp(const std::string& path, Bitmap& out, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < 54 || data[0] != 'B' || data[1] != 'M') {
+        error = path + " is not a BMP file";
+        return false;
+    }
+
+    uint32_t offset = ReadU32(&data[10]);
+    uint32_t headerSize = ReadU32(&data[14]);
+    int32_t width = (int32_t)ReadU32(&data[18]);
+    int32_t height = (int32_t)ReadU32(&data[22]);
+    uint16_t bits = ReadU16(&data[28]);
+    uint32_t compression = ReadU32(&data[30]);
+
+    // BI_BITFIELDS is only accepted with the standard BGRA channel layout
+    bool fields = compression == 3 && bits == 32;
+    if (fields) {
+        size_t masks = headerSize >= 52 ? 54 : 14 + (size_t)headerSize;
+        if (data.size() < masks + 12 || ReadU32(&data[masks]) != 0x00FF0000 ||
+            ReadU32(&data[masks + 4]) != 0x0000FF00 || ReadU32(&data[masks + 8]) != 0x000000FF) {
+            fields = false;
+            compression = ~0u;
+        }
+    }
+    if (headerSize < 40 || (compression != 0 && !fields) || (bits != 24 && bits != 32)) {
+        error = path + ": only uncompressed 24- and 32-bit BMP files are supported";
+        return false;
+    }
+
+    bool topDown = height < 0;
+    int64_t rows = topDown ? -(int64_t)height : height;
+    size_t stride = (((size_t)width * bits + 31) / 32) * 4;
+    if (width <= 0 || rows <= 0 || width > 32768 || rows > 32768 || offset + stride * (size_t)rows > data.size()) {
+        error = path + ": invalid BMP dimensions";
+        return false;
+    }
+
+    out.Resize(width, (int)rows);
+    size_t step = bits / 8;
+    bool alpha = false;
+    for (int y = 0; y < out.height; ++y) {
+        const uint8_t* source = data.data() + offset + stride * (size_t)(topDown ? y : out.height - 1 - y);
+        uint32_t* target = out.Row(y);
+        for (int x = 0; x < width; ++x, source += step) {
+            uint32_t a = step == 4 ? source[3] : 0;
+            alpha |= a != 0;
+            target[x] = a << 24 | (uint32_t)source[2] << 16 | (uint32_t)source[1] << 8 | source[0];
+        }
+    }
+    // Files without a meaningful alpha channel are fully opaque
+    if (!alpha) {
+        for (auto& pixel : out.pixels) pixel |= 0xFF000000;
+    }
+    return true;
+}
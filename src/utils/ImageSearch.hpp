@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Bitmap.hpp"
+
+// Template prepared for ImageSearch::Find
+struct ImageTemplate {
+    Bitmap image;
+    std::vector<uint32_t> mask;   // Per pixel: 0x00FFFFFF when opaque, 0 when transparent
+    int anchorX = 0;              // First opaque pixel; candidate positions are
+    int anchorY = 0;              // found by scanning for its color
+    bool blank = true;            // No opaque pixel at all
+};
+
+// Color and template matching on 32-bit bitmaps
+// Colors match when every channel differs by at most the tolerance (0-255);
+// alpha is ignored. Scans run on AVX2 (8 pixels per step) or SSE2 (4 pixels)
+// kernels, chosen by CPU detection at startup, with a scalar fallback for
+// other CPUs and for the tails of rows.
+// Find() scans each row for the template's anchor pixel and only compares
+// the whole template where the anchor matches, so the cost is close to one
+// color scan of the search area unless the anchor color is very common.
+struct ImageSearch {
+    enum class Isa {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    // Best kernel set this CPU and OS support
+    static Isa Detect();
+
+    // Kernel set used by the scans; lowering it lets benchmarks compare them
+    static inline Isa isa = Detect();
+
+    // Whether two colors match within tolerance
+    static bool Matches(uint32_t a, uint32_t b, int tolerance) {
+        for (int shift = 0; shift < 24; shift += 8) {
+            int d = (int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF);
+            if (d > tolerance || -d > tolerance) return false;
+        }
+        return true;
+    }
+
+    // Index of the first pixel matching color, or -1
+    static ptrdiff_t FindColor(const uint32_t* pixels, size_t count, uint32_t color, int tolerance);
+
+    // Whether every opaque template pixel matches the pixel under it
+    // mask: Per-pixel masks from ImageTemplate
+    static bool RowMatches(const uint32_t* pixels, const uint32_t* templ, const uint32_t* mask, size_t count, int tolerance);
+
+    // Builds the mask and anchor of a template
+    // Pixels with alpha below 128 are transparent and match anything
+    static ImageTemplate Prepare(Bitmap image);
+
+    // Finds the first placement of needle within a window of haystack, in row-major order
+    // left, top, width, height: Search window; the template must fit inside it
+    // x, y: Set to the haystack position of the template's top-left pixel
+    static bool Find(const Bitmap& haystack, int left, int top, int width, int height,
+                     const ImageTemplate& needle, int tolerance, int& x, int& y);
+
+    // Finds the first placement of needle anywhere in haystack
+    static bool Find(const Bitmap& haystack, const ImageTemplate& needle, int tolerance, int& x, int& y) {
+        return Find(haystack, 0, 0, haystack.width, haystack.height, needle, tolerance, x, y);
+    }
+
+    // Loads an uncompressed 24- or 32-bit BMP file
+    // A 32-bit file whose alpha channel is not all zero keeps its transparency;
+    // every other pixel is opaque
+    // Returns false with error set if the file cannot be read or is not supported
+    static bool LoadBmp(const std::string& path, Bitmap& out, std::string& error);
+};
@@ -0,0 +1,183 @@
+#include "InputLog.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+namespace {
+    uint64_t ZigZag(int64_t value) {
+        return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    }
+
+    int64_t UnZigZag(uint64_t value) {
+        return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    }
+}
+
+void InputLogWriter::Append(const InputLogRecord& record) {
+    bytes.push_back(record.kind);
+    if (record.kind != InputLogRecord::Move) bytes.push_back(record.vk);
+    PutVarint(record.time > lastTime ? record.time - lastTime : 0);
+    if (record.time > lastTime) lastTime = record.time;
+    if (record.kind == InputLogRecord::Move) {
+        PutVarint(ZigZag((int64_t)record.x - lastX));
+        PutVarint(ZigZag((int64_t)record.y - lastY));
+        lastX = record.x;
+        lastY = record.y;
+    }
+    ++count;
+}
+
+void InputLogWriter::PutVarint(uint64_t value) {
+    while (value >= 0x80) {
+        bytes.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((uint8_t)value);
+}
+
+bool InputLogWriter::Save(const std::string& path, uint8_t flags) const {
+    InputLog::Header header;
+    std::memcpy(header.magic, "MKIR", 4);
+    header.version = InputLog::version;
+    header.flags = flags;
+    header.reserved = 0;
+    header.count = count;
+
+    // Write to a temporary file and rename, so an existing recording is only
+    // replaced by a complete one
+    std::error_code ec;
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+            !file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size())) {
+            file.close();
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+void InputLogWriter::Clear() {
+    bytes.clear();
+    count = 0;
+    lastTime = 0;
+    lastX = 0;
+    lastY = 0;
+}
+
+void InputLogWriter::Truncate(const Mark& mark) {
+    bytes.resize(mark.size);
+    count = mark.count;
+    lastTime = mark.lastTime;
+    lastX = mark.lastX;
+    lastY = mark.lastY;
+}
+
+bool InputLogReader::Open(const uint8_t* data, size_t size, std::string& error) {
+    if (!data || size < sizeof(InputLog::Header)) {
+        error = "not a recording (file too short)";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "MKIR", 4) != 0) {
+        error = "not a recording";
+        return false;
+    }
+    if (header.version > InputLog::version) {
+        error = "recording format version " + std::to_string(header.version) + " is newer than this build supports";
+        return false;
+    }
+    begin = data;
+    cursor = data + sizeof(InputLog::Header);
+    end = data + size;
+    lastTime = 0;
+    lastX = 0;
+    lastY = 0;
+    return true;
+}
+
+bool InputLogReader::GetVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        uint8_t byte = *cursor++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool InputLogReader::Next(InputLogRecord& out) {
+    if (cursor >= end) return false;
+    uint8_t kind = *cursor++;
+    if (kind > InputLogRecord::Move) {
+        cursor = end;             // Unknown record; nothing after it can be decoded
+        return false;
+    }
+    out.kind = (InputLogRecord::Kind)kind;
+    if (kind != InputLogRecord::Move) {
+        if (cursor >= end) return false;
+        out.vk = *cursor++;
+    }
+
+    uint64_t delta;
+    if (!GetVarint(delta)) return false;
+    lastTime += delta;
+    out.time = lastTime;
+
+    if (kind == InputLogRecord::Move) {
+        uint64_t dx, dy;
+        if (!GetVarint(dx) || !GetVarint(dy)) return false;
+        lastX = (int32_t)(lastX + UnZigZag(dx));
+        lastY = (int32_t)(lastY + UnZigZag(dy));
+        out.vk = 0;
+    }
+    out.x = lastX;
+    out.y = lastY;
+    return true;
+}
+
+uint64_t InputLog::Compact(InputLogReader& in, InputLogWriter& out, uint64_t interval) {
+    std::optional<InputLogRecord> pending;   // Latest move not written yet
+    uint64_t lastWritten = 0;                // Time of the last move written
+    bool moved = false;                      // A move was written before
+    int32_t x = 0, y = 0;                    // Cursor position after pending / the last written move
+    int32_t writtenX = 0, writtenY = 0;      // Cursor position after the last written move
+
+    auto flush = [&]() {
+        if (!pending) return;
+        out.Append(*pending);
+        lastWritten = pending->time;
+        writtenX = pending->x;
+        writtenY = pending->y;
+        moved = true;
+        pending.reset();
+    };
+
+    InputLogRecord record;
+    while (in.Next(record)) {
+        if (record.kind != InputLogRecord::Move) {
+            flush();
+            out.Append(record);
+            continue;
+        }
+        if ((moved || pending) && record.x == x && record.y == y) continue;
+        if (pending && record.time - lastWritten >= interval) flush();
+        x = record.x;
+        y = record.y;
+        if (moved && x == writtenX && y == writtenY) {
+            pending.reset();                 // Back where the last written move left it
+            continue;
+        }
+        pending = record;
+    }
+    flush();
+    return out.Count();
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One recorded input event
+struct InputLogRecord {
+    enum Kind : uint8_t {
+        KeyDown,
+        KeyUp,
+        Move
+    };
+
+    uint64_t time = 0;            // Microseconds since the recording started
+    Kind kind = KeyDown;
+    uint8_t vk = 0;               // Virtual key code (keys and mouse buttons)
+    int32_t x = 0;                // Move: cursor position in screen pixels
+    int32_t y = 0;
+};
+
+// Binary input recording format
+// A 16-byte header followed by variable-length records:
+//   header: "MKIR", version, flags, 2 reserved bytes, record count (u64 LE)
+//   record: kind byte, [vk byte for keys], varint time delta in microseconds,
+//           [zigzag varint dx, dy from the previous move for moves]
+// A key event is typically 4 bytes and a cursor move 5, so recordings stay
+// small enough to buffer in memory and replay straight from a mapping.
+namespace InputLog {
+    constexpr uint8_t version = 1;
+
+    enum Flags : uint8_t {
+        Compacted = 1             // Written by Compact()
+    };
+
+#pragma pack(push, 1)
+    struct Header {
+        char magic[4];
+        uint8_t version;
+        uint8_t flags;
+        uint16_t reserved;
+        uint64_t count;
+    };
+#pragma pack(pop)
+    static_assert(sizeof(Header) == 16);
+}
+
+// Encodes records into memory; Save writes the finished log
+class InputLogWriter {
+public:
+    // Writer state that Truncate can return to
+    struct Mark {
+        size_t size = 0;
+        uint64_t count = 0;
+        uint64_t lastTime = 0;
+        int32_t lastX = 0;
+        int32_t lastY = 0;
+    };
+
+    // Appends a record; times must not decrease
+    void Append(const InputLogRecord& record);
+
+    // Writes header and records to path through a temporary file
+    // Returns false if the file cannot be written
+    bool Save(const std::string& path, uint8_t flags = 0) const;
+
+    // Discards every record
+    void Clear();
+
+    // Current position, for a later Truncate
+    Mark GetMark() const { return { bytes.size(), count, lastTime, lastX, lastY }; }
+
+    // Discards the records appended since mark was taken
+    void Truncate(const Mark& mark);
+
+    uint64_t Count() const { return count; }
+    size_t Size() const { return bytes.size() + sizeof(InputLog::Header); }
+    const std::vector<uint8_t>& Bytes() const { return bytes; }
+
+private:
+    void PutVarint(uint64_t value);
+
+    std::vector<uint8_t> bytes;   // Encoded records, without the header
+    uint64_t count = 0;
+    uint64_t lastTime = 0;
+    int32_t lastX = 0;
+    int32_t lastY = 0;
+};
+
+// Decodes records from a complete log held in memory (usually a MappedFile)
+// Keeps a cursor and the delta state only, so reading is constant-memory
+class InputLogReader {
+public:
+    // Validates the header of data
+    // error: Set to a description of the problem
+    // Returns false if data is not a readable recording
+    bool Open(const uint8_t* data, size_t size, std::string& error);
+
+    // Decodes the next record
+    // Returns false at the end of the log or at a truncated record
+    bool Next(InputLogRecord& out);
+
+    // Record count from the header (0 if the writer did not finish)
+    uint64_t Count() const { return header.count; }
+    uint8_t Flags() const { return header.flags; }
+
+    // Bytes consumed so far, including the header
+    size_t Offset() const { return (size_t)(cursor - begin); }
+
+private:
+    bool GetVarint(uint64_t& value);
+
+    InputLog::Header header{};
+    const uint8_t* begin = nullptr;
+    const uint8_t* cursor = nullptr;
+    const uint8_t* end = nullptr;
+    uint64_t lastTime = 0;
+    int32_t lastX = 0;
+    int32_t lastY = 0;
+};
+
+namespace InputLog {
+    // Merges redundant cursor moves
+    // Moves that leave the cursor where it was are dropped, and runs of moves
+    // are thinned to roughly one per interval microseconds. The last move
+    // before every key or button event and at the end is always kept, so
+    // clicks land exactly where they were recorded.
+    // Returns the number of records written to out
+    uint64_t Compact(InputLogReader& in, InputLogWriter& out, uint64_t interval);
+}
@@ -1,10 +1,11 @@
 #pragma once
 #include <sol/sol.hpp>
-#include <windows.h>
 #include <string>
 
 // KeyCodes namespace provides key and modifier constants for Lua
 // This creates two global Lua tables: MOD and KEY
+// Values are the Windows ones (RegisterHotKey modifiers, virtual key codes)
+// on every platform, so scripts and the simulation backends agree on them
 
 namespace KeyCodes {
     // Binds key and modifier constants to Lua environment
@@ -13,59 +14,59 @@ namespace KeyCodes {
     inline void Bind(sol::state& lua) {
         auto mods = lua.create_table();
         mods["NONE"]     = 0;
-        mods["ALT"]      = MOD_ALT;
-        mods["CTRL"]     = MOD_CONTROL;
-        mods["SHIFT"]    = MOD_SHIFT;
-        mods["WIN"]      = MOD_WIN;
-        mods["NOREPEAT"] = MOD_NOREPEAT;
+        mods["ALT"]      = 0x0001;
+        mods["CTRL"]     = 0x0002;
+        mods["SHIFT"]    = 0x0004;
+        mods["WIN"]      = 0x0008;
+        mods["NOREPEAT"] = 0x4000;
         lua["MOD"] = mods;
 
         auto keys = lua.create_table();
-        keys["LBUTTON"]    = VK_LBUTTON;
-        keys["RBUTTON"]    = VK_RBUTTON;
-        keys["MBUTTON"]    = VK_MBUTTON;
-        keys["XBUTTON1"]   = VK_XBUTTON1;
-        keys["XBUTTON2"]   = VK_XBUTTON2;
+        keys["LBUTTON"]    = 0x01;
+        keys["RBUTTON"]    = 0x02;
+        keys["MBUTTON"]    = 0x04;
+        keys["XBUTTON1"]   = 0x05;
+        keys["XBUTTON2"]   = 0x06;
 
         for (char c = 'A'; c <= 'Z'; ++c) keys[std::string(1, c)] = (int)c;
         for (char n = '0'; n <= '9'; ++n) keys["N" + std::string(1, n)] = (int)n;
-        for (int i = 1; i <= 24; ++i) keys["F" + std::to_string(i)] = VK_F1 + (i - 1);
-        for (int i = 0; i <= 9; ++i) keys["NUM" + std::to_string(i)] = VK_NUMPAD0 + i;
+        for (int i = 1; i <= 24; ++i) keys["F" + std::to_string(i)] = 0x70 + (i - 1);
+        for (int i = 0; i <= 9; ++i) keys["NUM" + std::to_string(i)] = 0x60 + i;
 
-        keys["MULTIPLY"]   = VK_MULTIPLY;
-        keys["ADD"]        = VK_ADD;
-        keys["SEPARATOR"]  = VK_SEPARATOR;
-        keys["SUBTRACT"]   = VK_SUBTRACT;
-        keys["DECIMAL"]    = VK_DECIMAL;
-        keys["DIVIDE"]     = VK_DIVIDE;
-        keys["SPACE"]      = VK_SPACE;
-        keys["ENTER"]      = VK_RETURN;
-        keys["ESCAPE"]     = VK_ESCAPE;
-        keys["BACKSPACE"]  = VK_BACK;
-        keys["TAB"]        = VK_TAB;
-        keys["CAPSLOCK"]   = VK_CAPITAL;
-        keys["NUMLOCK"]    = VK_NUMLOCK;
-        keys["SCROLLLOCK"] = VK_SCROLL;
-        keys["PRINTSCREEN"] = VK_SNAPSHOT;
-        keys["PAUSE"]      = VK_PAUSE;
-        keys["LEFT"]       = VK_LEFT;
-        keys["RIGHT"]      = VK_RIGHT;
-        keys["UP"]         = VK_UP;
-        keys["DOWN"]       = VK_DOWN;
-        keys["INSERT"]     = VK_INSERT;
-        keys["DELETE"]     = VK_DELETE;
-        keys["HOME"]       = VK_HOME;
-        keys["END"]        = VK_END;
-        keys["PAGEUP"]     = VK_PRIOR;
-        keys["PAGEDOWN"]   = VK_NEXT;
-        keys["LSHIFT"]     = VK_LSHIFT;
-        keys["RSHIFT"]     = VK_RSHIFT;
-        keys["LCTRL"]      = VK_LCONTROL;
-        keys["RCTRL"]      = VK_RCONTROL;
-        keys["LALT"]       = VK_LMENU;
-        keys["RALT"]       = VK_RMENU;
-        keys["LWIN"]       = VK_LWIN;
-        keys["RWIN"]       = VK_RWIN;
+        keys["MULTIPLY"]   = 0x6A;
+        keys["ADD"]        = 0x6B;
+        keys["SEPARATOR"]  = 0x6C;
+        keys["SUBTRACT"]   = 0x6D;
+        keys["DECIMAL"]    = 0x6E;
+        keys["DIVIDE"]     = 0x6F;
+        keys["SPACE"]      = 0x20;
+        keys["ENTER"]      = 0x0D;
+        keys["ESCAPE"]     = 0x1B;
+        keys["BACKSPACE"]  = 0x08;
+        keys["TAB"]        = 0x09;
+        keys["CAPSLOCK"]   = 0x14;
+        keys["NUMLOCK"]    = 0x90;
+        keys["SCROLLLOCK"] = 0x91;
+        keys["PRINTSCREEN"] = 0x2C;
+        keys["PAUSE"]      = 0x13;
+        keys["LEFT"]       = 0x25;
+        keys["RIGHT"]      = 0x27;
+        keys["UP"]         = 0x26;
+        keys["DOWN"]       = 0x28;
+        keys["INSERT"]     = 0x2D;
+        keys["DELETE"]     = 0x2E;
+        keys["HOME"]       = 0x24;
+        keys["END"]        = 0x23;
+        keys["PAGEUP"]     = 0x21;
+        keys["PAGEDOWN"]   = 0x22;
+        keys["LSHIFT"]     = 0xA0;
+        keys["RSHIFT"]     = 0xA1;
+        keys["LCTRL"]      = 0xA2;
+        keys["RCTRL"]      = 0xA3;
+        keys["LALT"]       = 0xA4;
+        keys["RALT"]       = 0xA5;
+        keys["LWIN"]       = 0x5B;
+        keys["RWIN"]       = 0x5C;
 
         lua["KEY"] = keys;
     }
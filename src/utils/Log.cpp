@@ -0,0 +1,91 @@
+#include "Log.hpp"
+#include "MpscQueue.hpp"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+namespace {
+    struct Entry : MpscNode {
+        Log::Stream stream;
+        std::string text;
+    };
+
+    // Background writer; lives until static destruction and drains the queue before exiting
+    class Writer {
+    public:
+        Writer() : thread([this] { Run(); }) {}
+
+        ~Writer() {
+            stopping = true;
+            Signal();
+            thread.join();
+        }
+
+        void Push(Entry* entry) {
+            queue.Push(entry);
+            submitted.fetch_add(1, std::memory_order_release);
+            Signal();
+        }
+
+        void Flush() {
+            uint64_t target = submitted.load(std::memory_order_acquire);
+            for (uint64_t done = written.load(std::memory_order_acquire); done < target;
+                 done = written.load(std::memory_order_acquire)) {
+                written.wait(done, std::memory_order_acquire);
+            }
+        }
+
+    private:
+        void Signal() {
+            // Only the false -> true transition needs to wake the writer
+            if (!pending.exchange(true, std::memory_order_acq_rel)) pending.notify_one();
+        }
+
+        void Run() {
+            while (true) {
+                pending.wait(false, std::memory_order_acquire);
+                pending.store(false, std::memory_order_release);
+
+                uint64_t count = 0;
+                while (MpscNode* node = queue.Pop()) {
+                    auto* entry = static_cast<Entry*>(node);
+                    std::FILE* file = entry->stream == Log::Stream::Err ? stderr : stdout;
+                    std::fwrite(entry->text.data(), 1, entry->text.size(), file);
+                    std::fputc('\n', file);
+                    delete entry;
+                    ++count;
+                }
+                if (count) {
+                    std::fflush(stdout);
+                    std::fflush(stderr);
+                    written.fetch_add(count, std::memory_order_release);
+                    written.notify_all();
+                }
+                if (stopping && written.load() == submitted.load()) return;
+            }
+        }
+
+        MpscQueue queue;
+        std::atomic<bool> pending = false;
+        std::atomic<bool> stopping = false;
+        std::atomic<uint64_t> submitted = 0;      // Lines pushed
+        std::atomic<uint64_t> written = 0;        // Lines written
+        std::thread thread;                       // Last member: starts after the rest is initialized
+    };
+
+    Writer& Instance() {
+        static Writer writer;
+        return writer;
+    }
+}
+
+void Log::Write(Stream stream, std::string text) {
+    auto* entry = new Entry;
+    entry->stream = stream;
+    entry->text = std::move(text);
+    Instance().Push(entry);
+}
+
+void Log::Flush() {
+    Instance().Flush();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+
+// Buffered asynchronous console log
+// A line is formatted by the caller and handed to a background writer
+// through a lock-free queue, so logging from the MessageLoop, a hook or a
+// Lua callback never waits on the console. The writer outputs everything
+// queued since its last pass and flushes once per pass. Lines keep their
+// order across Out and Err.
+//   Log::Out() << "[System] Loaded " << n << " binding(s)";
+struct Log {
+    enum class Stream : uint8_t {
+        Out,                      // stdout
+        Err                       // stderr
+    };
+
+    // One line being formatted; queued when it goes out of scope
+    class Line {
+    public:
+        explicit Line(Stream stream) : stream(stream) {}
+        Line(const Line&) = delete;
+        Line& operator=(const Line&) = delete;
+        ~Line() { Write(stream, std::move(text).str()); }
+
+        template <typename T>
+        Line& operator<<(const T& value) {
+            text << value;
+            return *this;
+        }
+
+    private:
+        Stream stream;
+        std::ostringstream text;
+    };
+
+    // Starts a line for stdout
+    static Line Out() { return Line(Stream::Out); }
+
+    // Starts a line for stderr
+    static Line Err() { return Line(Stream::Err); }
+
+    // Queues a complete line (without its newline); any thread
+    static void Write(Stream stream, std::string text);
+
+    // Blocks until every line queued before the call has been written
+    static void Flush();
+};
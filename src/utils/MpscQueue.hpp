@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+
+// Intrusive lock-free queue for many producer threads and one consumer
+// (Vyukov's MPSC node queue). Node must derive from MpscNode. Push is a
+// single atomic exchange and never blocks; Pop may report empty while a
+// producer is between its two steps, so producers should signal the
+// consumer only after Push returns.
+struct MpscNode {
+    std::atomic<MpscNode*> next{ nullptr };
+};
+
+class MpscQueue {
+public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Appends a node; any thread
+    void Push(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Removes the oldest node; consumer thread only
+    // Returns nullptr when the queue is empty or a push is still in flight
+    MpscNode* Pop() {
+        MpscNode* first = tail;
+        MpscNode* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (!next) return nullptr;
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return first;
+        }
+        if (first != head.load(std::memory_order_acquire)) return nullptr;
+
+        // first is the only node; put the stub behind it so it can be detached
+        Push(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (!next) return nullptr;
+        tail = next;
+        return first;
+    }
+
+private:
+    std::atomic<MpscNode*> head;  // Last pushed node (producers)
+    MpscNode* tail;               // Next node to pop (consumer)
+    MpscNode stub;
+};
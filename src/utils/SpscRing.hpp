@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fixed-size lock-free ring buffer for one producer and one consumer thread
+// Capacity must be a power of two. Each side keeps a cached copy of the other
+// side's index, so the shared indices are only re-read when the cached view
+// says the ring is full (producer) or empty (consumer).
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Appends an item; producer thread only
+    // item: Item to copy into the ring
+    // wasEmpty: Set when the consumer had drained everything before this push,
+    // i.e. when the consumer may be idle and needs a wake-up
+    // Returns false if the ring is full (the item is dropped)
+    bool TryPush(const T& item, bool& wasEmpty) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail >= Capacity) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail >= Capacity) return false;
+        }
+        buffer[h & (Capacity - 1)] = item;
+        // seq_cst store/load pair: either the consumer sees the new head on
+        // its final empty check, or we see its final tail and report wasEmpty
+        head.store(h + 1, std::memory_order_seq_cst);
+        cachedTail = tail.load(std::memory_order_seq_cst);
+        wasEmpty = cachedTail == h;
+        return true;
+    }
+
+    // Removes up to max items in FIFO order; consumer thread only
+    // out: Destination for the items
+    // Returns the number of items copied (0 when empty)
+    size_t PopBatch(T* out, size_t max) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (cachedHead == t) {
+            cachedHead = head.load(std::memory_order_seq_cst);
+            if (cachedHead == t) return 0;
+        }
+        size_t count = cachedHead - t;
+        if (count > max) count = max;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = buffer[(t + i) & (Capacity - 1)];
+        }
+        tail.store(t + count, std::memory_order_seq_cst);
+        return count;
+    }
+
+    // Number of queued items; approximate when called concurrently
+    size_t Size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity = Capacity;
+
+private:
+    alignas(64) std::atomic<size_t> head{ 0 };  // Next slot to write (producer)
+    size_t cachedTail = 0;                      // Producer's view of tail
+    alignas(64) std::atomic<size_t> tail{ 0 };  // Next slot to read (consumer)
+    size_t cachedHead = 0;                      // Consumer's view of head
+    alignas(64) std::array<T, Capacity> buffer{};
+};
@@ -0,0 +1,55 @@
+#include "WindowIndex.hpp"
+#include <algorithm>
+
+void WindowIndex::Reset(std::vector<WindowInfo> enumerated) {
+    std::lock_guard<std::mutex> lock(mutex);
+    windows = std::move(enumerated);
+}
+
+void WindowIndex::Apply(const WindowEvent& event) {
+    const WindowInfo& window = event.window;
+    if (!window.handle) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t at = IndexOf(window.handle);
+    switch (event.type) {
+        case WindowEvent::Type::Created:
+        case WindowEvent::Type::Foreground:
+            // Moves to the front, replacing any previous description
+            if (at < windows.size()) windows.erase(windows.begin() + at);
+            windows.insert(windows.begin(), window);
+            break;
+        case WindowEvent::Type::Destroyed:
+            if (at < windows.size()) windows.erase(windows.begin() + at);
+            break;
+        case WindowEvent::Type::Renamed:
+            if (at < windows.size()) windows[at].title = window.title;
+            break;
+    }
+}
+
+std::vector<WindowInfo> WindowIndex::Query(const WindowMatcher& matcher, size_t limit) const {
+    std::vector<WindowInfo> found;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& window : windows) {
+        if (found.size() >= limit) break;
+        if (matcher.Matches(window)) found.push_back(window);
+    }
+    return found;
+}
+
+std::optional<WindowInfo> WindowIndex::Find(const WindowMatcher& matcher) const {
+    auto found = Query(matcher, 1);
+    if (found.empty()) return std::nullopt;
+    return std::move(found.front());
+}
+
+size_t WindowIndex::Size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return windows.size();
+}
+
+size_t WindowIndex::IndexOf(std::uintptr_t handle) const {
+    auto it = std::find_if(windows.begin(), windows.end(), [&](const WindowInfo& w) { return w.handle == handle; });
+    return (size_t)(it - windows.begin());
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "../platform/WindowProvider.hpp"
+#include "WindowMatcher.hpp"
+
+// Live index of the visible top-level windows
+// Seeded once from WindowProvider::Enumerate() and kept current by applying
+// the provider's window events, so queries never call the OS. Windows are
+// kept in z-order, topmost first: created and newly focused windows move to
+// the front. Events for windows the index does not hold are ignored.
+// Updated on the MessageLoop thread; queries may come from any thread.
+class WindowIndex {
+public:
+    // Replaces the contents with an enumeration, topmost first
+    void Reset(std::vector<WindowInfo> windows);
+
+    // Applies one window event
+    void Apply(const WindowEvent& event);
+
+    // Windows the matcher accepts, topmost first
+    // limit: Stop after this many matches
+    std::vector<WindowInfo> Query(const WindowMatcher& matcher, size_t limit = (std::numeric_limits<size_t>::max)()) const;
+
+    // Topmost window the matcher accepts
+    std::optional<WindowInfo> Find(const WindowMatcher& matcher) const;
+
+    // Number of indexed windows
+    size_t Size() const;
+
+private:
+    // Position of a handle in windows, or windows.size()
+    size_t IndexOf(std::uintptr_t handle) const;
+
+    mutable std::mutex mutex;
+    std::vector<WindowInfo> windows; // Topmost first; guarded by mutex
+};
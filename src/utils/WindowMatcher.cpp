@@ -0,0 +1,121 @@
+#include "WindowMatcher.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    std::string Lower(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return s;
+    }
+
+    bool SameIcase(char a, char b) {
+        return std::tolower((unsigned char)a) == std::tolower((unsigned char)b);
+    }
+
+    const std::string& Property(const WindowInfo& window, MatchField field) {
+        switch (field) {
+        case MatchField::Class:   return window.className;
+        case MatchField::Process: return window.processName;
+        default:                  return window.title;
+        }
+    }
+
+    const char* FieldName(MatchField field) {
+        switch (field) {
+        case MatchField::Class:   return "class";
+        case MatchField::Process: return "process";
+        default:                  return "title";
+        }
+    }
+}
+
+bool WindowMatcher::Add(MatchField field, const std::string& pattern, MatchMode mode) {
+    bool icase = field == MatchField::Process;
+    Condition condition{ field, mode, icase ? Lower(pattern) : pattern, nullptr };
+
+    if (mode == MatchMode::Regex) {
+        try {
+            auto flags = std::regex::ECMAScript | std::regex::optimize;
+            if (icase) flags |= std::regex::icase;
+            condition.regex = std::make_shared<const std::regex>(pattern, flags);
+        } catch (const std::regex_error& e) {
+            Log::Err() << "[Error] Invalid window pattern '" << pattern << "': " << e.what();
+            invalid = true;
+            return false;
+        }
+    }
+
+    conditions.push_back(std::move(condition));
+    return true;
+}
+
+bool WindowMatcher::Matches(const WindowInfo& window) const {
+    if (invalid) return false;
+
+    for (const auto& condition : conditions) {
+        // Compared in place, without lowercasing copies; patterns were lowered by Add()
+        const std::string& value = Property(window, condition.field);
+        const std::string& pattern = condition.pattern;
+        bool icase = condition.field == MatchField::Process;
+
+        bool ok = false;
+        switch (condition.mode) {
+        case MatchMode::Substring:
+            ok = icase ? std::search(value.begin(), value.end(), pattern.begin(), pattern.end(), SameIcase) != value.end()
+                       : value.find(pattern) != std::string::npos;
+            break;
+        case MatchMode::Exact:
+            ok = icase ? value.size() == pattern.size() && std::equal(value.begin(), value.end(), pattern.begin(), SameIcase)
+                       : value == pattern;
+            break;
+        case MatchMode::Wildcard:  ok = Wildcard(value, pattern, icase); break;
+        case MatchMode::Regex:     ok = std::regex_search(value, *condition.regex); break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+std::string WindowMatcher::Describe() const {
+    if (invalid) return "Invalid";
+    if (conditions.empty()) return "Global";
+
+    static const char* ops[] = { "~", "=", " like ", " matches " };
+    std::string out;
+    for (const auto& condition : conditions) {
+        if (!out.empty()) out += ", ";
+        out += FieldName(condition.field);
+        out += ops[(int)condition.mode];
+        out += condition.pattern;
+    }
+    return out;
+}
+
+MatchMode WindowMatcher::ParseMode(const std::string& name) {
+    if (name == "exact") return MatchMode::Exact;
+    if (name == "wildcard" || name == "glob") return MatchMode::Wildcard;
+    if (name == "regex") return MatchMode::Regex;
+    return MatchMode::Substring;
+}
+
+bool WindowMatcher::Wildcard(const std::string& text, const std::string& pattern, bool icase) {
+    // Greedy glob match with single-star backtracking, O(n*m) worst case
+    size_t t = 0, p = 0, star = std::string::npos, mark = 0;
+    while (t < text.size()) {
+        // '*' is always a star, even where the title has a literal '*'
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            mark = t;
+        } else if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t] || (icase && SameIcase(pattern[p], text[t])))) {
+            ++t; ++p;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            t = ++mark;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
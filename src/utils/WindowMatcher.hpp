@@ -0,0 +1,56 @@
+#pragma once
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+#include "../platform/WindowProvider.hpp"
+
+// Window property a filter condition looks at
+enum class MatchField { Title, Class, Process };
+
+// How a filter pattern is compared against the window property
+enum class MatchMode {
+    Substring,  // Property contains the pattern
+    Exact,      // Property equals the pattern
+    Wildcard,   // Glob with * and ?
+    Regex       // ECMAScript regular expression, searched anywhere in the property
+};
+
+// Compiled window filter for context-sensitive hotkeys and timers
+// Built once when a binding is created; Matches() only compares strings
+// against a WindowInfo snapshot. All conditions must match. A matcher with
+// no conditions is global and matches every window.
+// Process names are compared case-insensitively, titles and classes are not.
+class WindowMatcher {
+public:
+    // Adds a condition
+    // Returns false (and makes the matcher match nothing) if the pattern
+    // is not a valid regular expression
+    bool Add(MatchField field, const std::string& pattern, MatchMode mode = MatchMode::Substring);
+
+    // Tests the conditions against a window snapshot
+    bool Matches(const WindowInfo& window) const;
+
+    // True if the matcher has no conditions
+    bool IsGlobal() const { return conditions.empty() && !invalid; }
+
+    // Human-readable form for logs, e.g. "title~Notepad" or "Global"
+    std::string Describe() const;
+
+    // Parses a mode name from Lua ("substring", "exact", "wildcard", "regex")
+    // Unknown names fall back to Substring
+    static MatchMode ParseMode(const std::string& name);
+
+private:
+    struct Condition {
+        MatchField field;
+        MatchMode mode;
+        std::string pattern;
+        std::shared_ptr<const std::regex> regex;  // Compiled once; shared between copies
+    };
+
+    static bool Wildcard(const std::string& text, const std::string& pattern, bool icase);
+
+    std::vector<Condition> conditions;
+    bool invalid = false;
+};
@@ -0,0 +1,92 @@
+// 1,000 macros waiting at once on a virtual clock: every wait() resumes at
+// its exact deadline, in deadline order, whether the clock jumps from
+// deadline to deadline or moves in fixed ticks
+#include "Check.hpp"
+#include "../src/core/CoroutineScheduler.hpp"
+#include "../src/core/PrecisionClock.hpp"
+#include "../src/core/VirtualClock.hpp"
+#include <chrono>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using namespace std::chrono_literals;
+
+    constexpr int macros = 1000;
+
+    // Delay of macro i in milliseconds; many macros share a deadline
+    int Delay(int i) { return 1 + (i * 37) % 500; }
+
+    struct Resume {
+        int macro;
+        Clock::time_point at;
+    };
+
+    // Starts every macro, runs the clock until none waits and returns the resumes
+    // tick: Fixed step of the clock, or zero to jump from deadline to deadline
+    std::vector<Resume> Run(sol::state& lua, VirtualClock& clock, Clock::duration tick) {
+        std::vector<Resume> resumes;
+        lua.set_function("resumed", [&](int i) { resumes.push_back({ i, clock.Now() }); });
+        sol::function macro = lua["macro"];
+        for (int i = 0; i < macros; ++i) CoroutineScheduler::Spawn(macro, i, Delay(i));
+        CHECK(CoroutineScheduler::Pending() == macros);
+        if (tick == Clock::duration::zero()) {
+            while (clock.NextCoroutine()) {}
+        } else {
+            while (CoroutineScheduler::Pending() > 0) clock.AdvanceCoroutines(tick);
+        }
+        return resumes;
+    }
+
+    // Checks that each macro resumed twice, Delay(i) apart, in time order,
+    // exactly when due or less than tolerance after
+    void CheckResumes(const std::vector<Resume>& resumes, Clock::time_point start, Clock::duration tolerance) {
+        CHECK(resumes.size() == 2 * macros);
+        std::vector<int> count(macros, 0);
+        std::vector<Clock::time_point> first(macros);
+        Clock::time_point previous = start;
+        for (const auto& resume : resumes) {
+            CHECK(resume.at >= previous);
+            previous = resume.at;
+
+            // The second wait counts from the moment the first one resumed
+            auto delay = std::chrono::milliseconds(Delay(resume.macro));
+            auto due = count[resume.macro] == 0 ? start + delay : first[resume.macro] + delay;
+            CHECK(resume.at == due || (resume.at > due && resume.at - due < tolerance));
+            if (count[resume.macro]++ == 0) first[resume.macro] = resume.at;
+        }
+        for (int n : count) CHECK(n == 2);
+    }
+}
+
+int main() {
+    sol::state lua;
+    lua.open_libraries(sol::lib::base);
+    lua.set_function("sleep", &CoroutineScheduler::LuaSleep);
+    lua.script(R"(
+        function macro(i, ms)
+            sleep(ms)
+            resumed(i)
+            sleep(ms)
+            resumed(i)
+        end
+    )");
+
+    {
+        VirtualClock clock;
+        clock.Attach();
+        PrecisionClock::lateness.Reset();
+        auto start = clock.Now();
+        CheckResumes(Run(lua, clock, Clock::duration::zero()), start, Clock::duration::zero());
+        CHECK(PrecisionClock::lateness.Count() == 2 * macros);
+        CHECK(PrecisionClock::lateness.Max() == 0);
+    }
+    {
+        VirtualClock clock;
+        clock.Attach();
+        auto start = clock.Now();
+        CheckResumes(Run(lua, clock, 250us), start, 250us);
+    }
+    CHECK(CoroutineScheduler::Pending() == 0);
+    return 0;
+}
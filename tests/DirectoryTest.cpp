@@ -0,0 +1,119 @@
+// Hot-reload notifications from the real file watcher: a burst of saves to
+// several scripts arrives as one Changed event carrying each script once,
+// files that are not scripts are ignored, and a burst that never goes quiet
+// is still published after maxDelay. Prints the save -> event latency
+#include "Check.hpp"
+#include "../src/core/Directory.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::filesystem::path root;
+    EventDispatcher dispatcher;
+    std::vector<std::vector<std::string>> received;
+
+    void Save(const std::string& path, int revision) {
+        std::ofstream file(root / path, std::ios::trunc);
+        file << "-- revision " << revision << "\n";
+    }
+
+    double Millis(Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+    // Blocks until the watcher publishes, then returns when it arrived
+    Clock::time_point Next() {
+        dispatcher.wait();
+        auto at = Clock::now();
+        dispatcher.drain();
+        return at;
+    }
+
+    void Burst() {
+        received.clear();
+        const char* scripts[] = { "a.lua", "b.lua", "lib/c.lua" };
+        Clock::time_point saved;
+        for (int revision = 1; revision <= 10; ++revision) {
+            if (revision > 1) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            for (const char* script : scripts) Save(script, revision);
+            Save("notes.txt", revision);
+            Save("a.lua.swp", revision);
+            saved = Clock::now();
+        }
+        auto at = Next();
+
+        CHECK(received.size() == 1);
+        CHECK((received[0] == std::vector<std::string>{ "a.lua", "b.lua", "lib/c.lua" }));
+        double latency = Millis(at - saved);
+        std::printf("burst: 30 saves to 3 scripts -> 1 event, %.1f ms after the last save\n", latency);
+        CHECK(latency >= Millis(Directory::debounce) * 0.9);
+        CHECK(latency < Millis(Directory::maxDelay) + 500);
+
+        // Nothing trails the burst
+        std::this_thread::sleep_for(Directory::debounce * 4);
+        CHECK(dispatcher.drain() == 0 && received.size() == 1);
+    }
+
+    void Single() {
+        received.clear();
+        auto saved = Clock::now();
+        Save("b.lua", 100);
+        auto at = Next();
+        CHECK((received == std::vector<std::vector<std::string>>{ { "b.lua" } }));
+        std::printf("single save -> event in %.1f ms (debounce %lld ms)\n", Millis(at - saved), (long long)Directory::debounce.count());
+    }
+
+    void Continuous() {
+        // Saves every 20 ms never leave the debounce window quiet; maxDelay
+        // still bounds how long the first of them waits
+        received.clear();
+        auto start = Clock::now();
+        std::thread saver([] {
+            for (int revision = 0; revision < 50; ++revision) {
+                Save("a.lua", 200 + revision);
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        });
+        auto at = Next();
+        saver.join();
+        double held = Millis(at - start);
+        std::printf("continuous saves -> first event after %.1f ms (max delay %lld ms)\n", held, (long long)Directory::maxDelay.count());
+        CHECK(held < Millis(Directory::maxDelay) + 500);
+        CHECK(received.size() == 1 && received[0] == std::vector<std::string>{ "a.lua" });
+        std::this_thread::sleep_for(Directory::maxDelay);
+        dispatcher.drain();
+    }
+}
+
+int main() {
+    std::thread([] {
+        std::this_thread::sleep_for(std::chrono::seconds(60));
+        std::fprintf(stderr, "DirectoryTest: expected change event never arrived\n");
+        std::_Exit(1);
+    }).detach();
+
+    root = std::filesystem::temp_directory_path() / "moonkey-directory-test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "lib");
+    for (const char* script : { "a.lua", "b.lua", "lib/c.lua" }) Save(script, 0);
+
+    dispatcher.subscribe(Directory::Changed, [](const std::vector<std::string>& paths) { received.push_back(paths); });
+    std::thread([] { Directory::DirectoryChangesLoop(root.string(), dispatcher); }).detach();
+    // The watcher has no ready signal; give it time to add its watches
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    Burst();
+    Single();
+    Continuous();
+
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    std::fflush(stdout);
+    std::_Exit(0);                 // The watcher thread never returns
+}
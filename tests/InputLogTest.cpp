@@ -0,0 +1,175 @@
+// Input recordings: ten million events through the writer, a saved file and
+// the reader come back exactly as recorded; Compact keeps every key and
+// button event where it happened; a cut-off log reads up to the cut
+#include "Check.hpp"
+#include "../src/platform/MappedFile.hpp"
+#include "../src/utils/InputLog.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr uint64_t count = 10000000;
+
+    // Reproducible recording: mostly small cursor moves (some of them
+    // standing still), key and button presses, now and then a jump across
+    // the screen or a pause of several seconds
+    struct Stream {
+        std::mt19937_64 random{ 15 };
+        uint64_t time = 0;
+        int32_t x = 0;
+        int32_t y = 0;
+        bool held[256] = {};
+
+        InputLogRecord Next() {
+            InputLogRecord record;
+            uint64_t roll = random() % 100;
+            time += roll == 99 ? 10000000 : random() % 2000;
+            if (roll < 70) {
+                if (roll < 2) {
+                    x = (int32_t)(random() % 7680) - 3840;
+                    y = (int32_t)(random() % 2160);
+                } else {
+                    x += (int32_t)(random() % 7) - 3;
+                    y += (int32_t)(random() % 7) - 3;
+                }
+                record.kind = InputLogRecord::Move;
+            } else {
+                uint8_t vk = roll < 75 ? (uint8_t)(1 + random() % 2) : (uint8_t)('A' + random() % 26);
+                record.kind = held[vk] ? InputLogRecord::KeyUp : InputLogRecord::KeyDown;
+                record.vk = vk;
+                held[vk] = !held[vk];
+            }
+            record.time = time;
+            record.x = x;
+            record.y = y;
+            return record;
+        }
+    };
+
+    bool Same(const InputLogRecord& a, const InputLogRecord& b) {
+        return a.time == b.time && a.kind == b.kind && a.vk == b.vk && a.x == b.x && a.y == b.y;
+    }
+
+    std::string Path(const char* name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    void RoundTrip() {
+        InputLogWriter writer;
+        Stream recorded;
+        for (uint64_t i = 0; i < count; ++i) writer.Append(recorded.Next());
+        CHECK(writer.Count() == count);
+        std::string path = Path("moonkey-inputlog-test.mkr");
+        CHECK(writer.Save(path));
+
+        MappedFile file;
+        CHECK(file.Open(path));
+        CHECK(file.Size() == writer.Size());
+        InputLogReader reader;
+        std::string error;
+        CHECK(reader.Open(file.Data(), file.Size(), error));
+        CHECK(reader.Count() == count && reader.Flags() == 0);
+
+        Stream expected;
+        InputLogRecord record;
+        for (uint64_t i = 0; i < count; ++i) {
+            CHECK(reader.Next(record));
+            CHECK(Same(record, expected.Next()));
+        }
+        CHECK(!reader.Next(record));
+        CHECK(reader.Offset() == file.Size());
+        file.Close();
+
+        // Compacted, every key and button event survives with its time and
+        // the cursor position it happened at; moves that remain do move the
+        // cursor, and it ends where the recording ended
+        MappedFile source;
+        CHECK(source.Open(path));
+        CHECK(reader.Open(source.Data(), source.Size(), error));
+        InputLogWriter compacted;
+        uint64_t kept = InputLog::Compact(reader, compacted, 8000);
+        CHECK(kept == compacted.Count() && kept < count);
+        std::string compactPath = Path("moonkey-inputlog-test-compact.mkr");
+        CHECK(compacted.Save(compactPath, InputLog::Compacted));
+
+        MappedFile compactFile;
+        CHECK(compactFile.Open(compactPath));
+        InputLogReader compactReader;
+        CHECK(compactReader.Open(compactFile.Data(), compactFile.Size(), error));
+        CHECK(compactReader.Count() == kept && compactReader.Flags() == InputLog::Compacted);
+
+        Stream original;
+        InputLogRecord last;
+        uint64_t read = 0;
+        int32_t x = 0, y = 0;
+        bool moved = false;
+        for (uint64_t i = 0; i < count; ++i) {
+            last = original.Next();
+            if (last.kind == InputLogRecord::Move) continue;
+            while (true) {
+                CHECK(compactReader.Next(record));
+                ++read;
+                if (record.kind != InputLogRecord::Move) break;
+                CHECK(!moved || record.x != x || record.y != y);
+                x = record.x;
+                y = record.y;
+                moved = true;
+            }
+            CHECK(Same(record, last));
+        }
+        while (compactReader.Next(record)) {
+            CHECK(record.kind == InputLogRecord::Move);
+            ++read;
+        }
+        CHECK(read == kept);
+        CHECK(record.x == last.x && record.y == last.y);
+
+        source.Close();
+        compactFile.Close();
+        std::filesystem::remove(path);
+        std::filesystem::remove(compactPath);
+    }
+
+    void Truncated() {
+        InputLogWriter writer;
+        Stream recorded;
+        for (int i = 0; i < 1000; ++i) writer.Append(recorded.Next());
+        std::string path = Path("moonkey-inputlog-test-cut.mkr");
+        CHECK(writer.Save(path));
+        std::vector<uint8_t> data(writer.Size());
+        {
+            std::ifstream file(path, std::ios::binary);
+            CHECK(file.read(reinterpret_cast<char*>(data.data()), (std::streamsize)data.size()));
+        }
+        std::filesystem::remove(path);
+
+        // Cut inside the last record: everything before it decodes
+        InputLogReader reader;
+        std::string error;
+        CHECK(reader.Open(data.data(), data.size() - 1, error));
+        Stream expected;
+        InputLogRecord record;
+        int decoded = 0;
+        while (reader.Next(record)) {
+            CHECK(Same(record, expected.Next()));
+            ++decoded;
+        }
+        CHECK(decoded == 999);
+
+        // A header alone, or less, is an empty or rejected recording
+        CHECK(reader.Open(data.data(), sizeof(InputLog::Header), error));
+        CHECK(!reader.Next(record));
+        CHECK(!reader.Open(data.data(), sizeof(InputLog::Header) - 1, error));
+        data[0] = 'X';
+        CHECK(!reader.Open(data.data(), data.size(), error));
+    }
+}
+
+int main() {
+    RoundTrip();
+    Truncated();
+    return 0;
+}
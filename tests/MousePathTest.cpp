@@ -0,0 +1,119 @@
+// mouse_path through a RecordingInputSink: the trajectory of each curve and
+// easing, and when the compiled program emits every move, first on a
+// virtual timeline and then on the real clock
+#include "Check.hpp"
+#include "../src/core/Macro.hpp"
+#include "../src/core/MousePath.hpp"
+#include "../src/platform/RecordingInputSink.hpp"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    PathSpec Spec(std::vector<PathSpec::Point> points, double duration, double rate) {
+        PathSpec spec;
+        spec.points = std::move(points);
+        spec.duration = duration;
+        spec.rate = rate;
+        return spec;
+    }
+
+    void Linear() {
+        // 50 samples 4 ms apart, 20 px along x and 10 px along y each
+        auto samples = MousePath::Generate(Spec({ { 100, 100 }, { 1100, 600 } }, 200, 250));
+        CHECK(samples.size() == 50);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            CHECK(samples[i].time == 4000 * (i + 1));
+            CHECK(samples[i].x == 100 + 20 * (int)(i + 1));
+            CHECK(samples[i].y == 100 + 10 * (int)(i + 1));
+        }
+
+        // Constant speed across the corner of a polyline
+        samples = MousePath::Generate(Spec({ { 0, 0 }, { 300, 0 }, { 300, 400 } }, 700, 100));
+        CHECK(samples.size() == 70);
+        CHECK(samples[29].x == 300 && samples[29].y == 0);
+        CHECK(samples[39].x == 300 && samples[39].y == 100);
+        CHECK(samples.back().x == 300 && samples.back().y == 400 && samples.back().time == 700000);
+
+        // Steps that stay on the same pixel are dropped, the end is kept
+        samples = MousePath::Generate(Spec({ { 0, 0 }, { 3, 0 } }, 100, 1000));
+        CHECK(samples.size() == 4);
+        CHECK(samples[0].x == 1 && samples[1].x == 2 && samples[2].x == 3);
+        CHECK(samples[3].x == 3 && samples[3].time == 100000);
+
+        // jump starts with a move to the start point
+        auto spec = Spec({ { 10, 20 }, { 30, 20 } }, 10, 100);
+        spec.jump = true;
+        samples = MousePath::Generate(spec);
+        CHECK(samples.front().time == 0 && samples.front().x == 10 && samples.front().y == 20);
+    }
+
+    void Curves() {
+        // Quadratic Bezier: halfway in time is halfway between the chords
+        auto spec = Spec({ { 0, 0 }, { 50, 100 }, { 100, 0 } }, 100, 100);
+        spec.curve = PathSpec::Curve::Bezier;
+        auto samples = MousePath::Generate(spec);
+        CHECK(samples.size() == 10);
+        CHECK(samples[4].time == 50000 && samples[4].x == 50 && samples[4].y == 50);
+        CHECK(samples.back().x == 100 && samples.back().y == 0);
+
+        // Ease in-out: slow at both ends, fast in the middle, symmetric
+        spec = Spec({ { 0, 0 }, { 1000, 0 } }, 100, 100);
+        spec.ease = PathSpec::Ease::InOut;
+        samples = MousePath::Generate(spec);
+        CHECK(samples.size() == 10);
+        int first = samples[0].x;
+        int middle = samples[5].x - samples[4].x;
+        int last = samples[9].x - samples[8].x;
+        CHECK(first < middle && last < middle && first == last);
+        CHECK(samples[4].x == 500);
+    }
+
+    void Timing() {
+        auto samples = MousePath::Generate(Spec({ { 0, 0 }, { 500, 250 } }, 50, 1000));
+        CHECK(samples.size() == 50);
+        auto program = MousePath::Compile(samples);
+
+        // On a virtual timeline every move goes out alone, exactly at its sample's time
+        RecordingInputSink sink;
+        uint32_t at = 0;
+        std::vector<std::pair<uint32_t, InputEvent>> emitted;
+        sink.Observe([&](const InputEvent* events, size_t count) {
+            for (size_t i = 0; i < count; ++i) emitted.push_back({ at, events[i] });
+        });
+        MacroRun run;
+        run.program = program;
+        while (auto delay = Macro::Advance(run, sink)) at += (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(*delay).count();
+        CHECK(emitted.size() == samples.size());
+        CHECK(sink.Batches() == samples.size());
+        for (size_t i = 0; i < samples.size(); ++i) {
+            CHECK(emitted[i].first == samples[i].time);
+            CHECK(emitted[i].second.type == InputEvent::Type::MouseMove);
+            CHECK(emitted[i].second.x == samples[i].x && emitted[i].second.y == samples[i].y);
+        }
+
+        // On the real clock no move is early and the path does not overrun by much
+        RecordingInputSink live;
+        std::vector<Clock::time_point> times;
+        live.Observe([&](const InputEvent*, size_t) { times.push_back(Clock::now()); });
+        MacroRun timed;
+        timed.program = program;
+        auto start = Clock::now();
+        Macro::Execute(timed, live);
+        CHECK(times.size() == samples.size());
+        for (size_t i = 0; i < samples.size(); ++i) CHECK(times[i] >= start + std::chrono::microseconds(samples[i].time));
+        CHECK(times.back() - start < std::chrono::milliseconds(50 + 25));
+        int x, y;
+        live.GetCursorPos(x, y);
+        CHECK(x == 500 && y == 250);
+    }
+}
+
+int main() {
+    Linear();
+    Curves();
+    Timing();
+    return 0;
+}
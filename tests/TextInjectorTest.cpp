@@ -0,0 +1,145 @@
+// write() through a RecordingInputSink: the event plan for layout keys,
+// Shift runs, line breaks and characters off the layout, how the plan is
+// cut into batches for each pacing mode, pasting, and resending what a
+// blocked sink did not accept
+#include "Check.hpp"
+#include "../src/core/TextInjector.hpp"
+#include "../src/platform/RecordingInputSink.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+    bool Same(const InputEvent& a, const InputEvent& b) {
+        return a.type == b.type && a.up == b.up && a.code == b.code && a.x == b.x && a.y == b.y;
+    }
+
+    bool Same(const std::vector<InputEvent>& a, const std::vector<InputEvent>& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const auto& x, const auto& y) { return Same(x, y); });
+    }
+
+    // Sink that accepts at most limit events per Send, like SendInput while
+    // another program holds the input queue
+    class LimitedSink : public RecordingInputSink {
+    public:
+        explicit LimitedSink(size_t limit) : limit(limit) {}
+        size_t Send(const InputEvent* events, size_t count) override {
+            return RecordingInputSink::Send(events, (std::min)(count, limit));
+        }
+
+    private:
+        size_t limit;
+    };
+
+    // Sizes of the batches a write sent
+    std::vector<size_t> Batches(RecordingInputSink& sink, const std::string& text, const WriteOptions& options) {
+        std::vector<size_t> sizes;
+        sink.Observe([&](const InputEvent*, size_t count) { sizes.push_back(count); });
+        TextInjector::Write(text, options, sink);
+        sink.Observe(nullptr);
+        return sizes;
+    }
+
+    void Plan() {
+        RecordingInputSink sink;
+
+        // Shift is held once across "BC!" and released before the next plain key
+        TextPlan plan = TextInjector::Build(u"aBC!d", sink);
+        CHECK(Same(plan.events, {
+            InputEvent::Key('A', false), InputEvent::Key('A', true),
+            InputEvent::Key(Vk::Shift, false),
+            InputEvent::Key('B', false), InputEvent::Key('B', true),
+            InputEvent::Key('C', false), InputEvent::Key('C', true),
+            InputEvent::Key('1', false), InputEvent::Key('1', true),
+            InputEvent::Key(Vk::Shift, true),
+            InputEvent::Key('D', false), InputEvent::Key('D', true),
+        }));
+        CHECK((plan.charEnds == std::vector<size_t>{ 2, 5, 7, 9, 12 }));
+
+        // A trailing Shift is released at the end; CRLF is one Enter
+        plan = TextInjector::Build(u"A\r\n\n", sink);
+        CHECK(Same(plan.events, {
+            InputEvent::Key(Vk::Shift, false), InputEvent::Key('A', false), InputEvent::Key('A', true), InputEvent::Key(Vk::Shift, true),
+            InputEvent::Key(Vk::Return, false), InputEvent::Key(Vk::Return, true),
+            InputEvent::Key(Vk::Return, false), InputEvent::Key(Vk::Return, true),
+        }));
+        CHECK(plan.charEnds.size() == 3);
+
+        // Characters off the layout go out as Unicode, surrogate pairs as one character
+        plan = TextInjector::Build(TextInjector::DecodeUtf8("\xC3\xA4\xF0\x9F\x98\x80"), sink);
+        CHECK(Same(plan.events, {
+            InputEvent::Unicode(0xE4, false), InputEvent::Unicode(0xE4, true),
+            InputEvent::Unicode(0xD83D, false), InputEvent::Unicode(0xD83D, true),
+            InputEvent::Unicode(0xDE00, false), InputEvent::Unicode(0xDE00, true),
+        }));
+        CHECK((plan.charEnds == std::vector<size_t>{ 2, 6 }));
+    }
+
+    void Batching() {
+        RecordingInputSink sink;
+        std::string text(10000, 'a');
+        WriteOptions options;
+        options.batchSize = 4096;
+
+        // 20,000 events in full batches plus the remainder, in plan order
+        auto sizes = Batches(sink, text, options);
+        CHECK((sizes == std::vector<size_t>{ 4096, 4096, 4096, 4096, 3616 }));
+        CHECK(sink.Batches() == 5);
+        CHECK(Same(sink.Events(), TextInjector::Build(std::u16string(10000, u'a'), sink).events));
+
+        // Fixed pacing sends one character per batch, then the Shift release
+        sink.Reset();
+        options.pacing = PacingMode::Fixed;
+        options.delay = std::chrono::milliseconds(1);
+        sizes = Batches(sink, "aBC", options);
+        CHECK((sizes == std::vector<size_t>{ 2, 3, 2, 1 }));
+        CHECK(Same(sink.Events(), TextInjector::Build(u"aBC", sink).events));
+
+        // Adaptive pacing starts with bursts of eight characters
+        sink.Reset();
+        options.pacing = PacingMode::Adaptive;
+        sizes = Batches(sink, std::string(40, 'a'), options);
+        CHECK((sizes == std::vector<size_t>{ 16, 32, 32 }));
+    }
+
+    void Paste() {
+        RecordingInputSink sink;
+        WriteOptions options;
+        options.pasteThreshold = 5;
+
+        // Below the threshold the text is typed
+        TextInjector::Write("abcd", options, sink);
+        CHECK(sink.Events().size() == 8);
+        CHECK(!sink.GetClipboardText());
+
+        // From the threshold on it goes through the clipboard as Ctrl+V
+        sink.Reset();
+        TextInjector::Write("abcde", options, sink);
+        CHECK(Same(sink.Events(), {
+            InputEvent::Key(Vk::Control, false), InputEvent::Key(Vk::V, false), InputEvent::Key(Vk::V, true), InputEvent::Key(Vk::Control, true),
+        }));
+        CHECK(sink.GetClipboardText() == u"abcde");
+    }
+
+    void Blocked() {
+        // What the sink refused is sent again, so nothing is lost or repeated
+        std::string text = "Hello, World! 123";
+        RecordingInputSink layout;
+        auto expected = TextInjector::Build(TextInjector::DecodeUtf8(text), layout).events;
+        for (PacingMode pacing : { PacingMode::None, PacingMode::Adaptive }) {
+            LimitedSink sink(5);
+            WriteOptions options;
+            options.pacing = pacing;
+            TextInjector::Write(text, options, sink);
+            CHECK(Same(sink.Events(), expected));
+        }
+    }
+}
+
+int main() {
+    Plan();
+    Batching();
+    Paste();
+    Blocked();
+    return 0;
+}
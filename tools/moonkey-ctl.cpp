@@ -0,0 +1,193 @@
+// moonkey-ctl: command-line client for MoonKey's control channel
+// Usage:
+//   moonkey-ctl [-e endpoint] invoke <action> [args...]
+//   moonkey-ctl [-e endpoint] stats
+//   moonkey-ctl [-e endpoint] reload [script.lua]
+//   moonkey-ctl [-e endpoint] list
+//   moonkey-ctl [-e endpoint] bench <action> [count] [depth]
+// bench invokes an action count times with up to depth requests in flight
+// and prints one JSON line with the round-trip latency and throughput
+#include "../src/core/ControlProtocol.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using ControlProtocol::Op;
+    using ControlProtocol::Status;
+
+    // Blocking connection to the endpoint
+    class Connection {
+    public:
+        bool Open(const std::string& endpoint) {
+#ifdef _WIN32
+            pipe = CreateFileA(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+            return pipe != INVALID_HANDLE_VALUE;
+#else
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (endpoint.size() >= sizeof(address.sun_path)) return false;
+            std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+            fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            return fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+#endif
+        }
+
+        bool Write(const std::string& data) {
+            size_t written = 0;
+            while (written < data.size()) {
+#ifdef _WIN32
+                DWORD sent = 0;
+                if (!WriteFile(pipe, data.data() + written, (DWORD)(data.size() - written), &sent, nullptr)) return false;
+#else
+                ssize_t sent = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+                if (sent <= 0) return false;
+#endif
+                written += (size_t)sent;
+            }
+            return true;
+        }
+
+        // Reads the next reply; false once the connection is gone
+        bool Next(ControlProtocol::Message& message) {
+            buffer.erase(0, consumed);
+            consumed = 0;
+            while (true) {
+                size_t length = ControlProtocol::Parse(buffer, message);
+                if (length == SIZE_MAX) return false;
+                if (length > 0) {
+                    consumed = length;
+                    return true;
+                }
+                char chunk[64 * 1024];
+#ifdef _WIN32
+                DWORD got = 0;
+                if (!ReadFile(pipe, chunk, sizeof(chunk), &got, nullptr) || got == 0) return false;
+#else
+                ssize_t got = read(fd, chunk, sizeof(chunk));
+                if (got <= 0) return false;
+#endif
+                buffer.append(chunk, (size_t)got);
+            }
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE pipe = INVALID_HANDLE_VALUE;
+#else
+        int fd = -1;
+#endif
+        std::string buffer;       // Received bytes; the message last returned starts it
+        size_t consumed = 0;
+    };
+
+    int Usage() {
+        std::cerr << "usage: moonkey-ctl [-e endpoint] invoke <action> [args...] | stats | reload [script] | list |\n"
+                     "                   bench <action> [count] [depth]\n";
+        return 2;
+    }
+
+    // Sends one request and prints its reply
+    int Request(Connection& connection, Op op, const std::string& body) {
+        std::string frame;
+        ControlProtocol::Append(frame, 1, (uint8_t)op, body);
+        ControlProtocol::Message reply;
+        if (!connection.Write(frame) || !connection.Next(reply)) {
+            std::cerr << "moonkey-ctl: connection lost\n";
+            return 1;
+        }
+        if ((Status)reply.code != Status::Ok) {
+            std::cerr << "moonkey-ctl: " << reply.body << "\n";
+            return 1;
+        }
+        std::cout << reply.body;
+        if (!reply.body.empty() && reply.body.back() != '\n') std::cout << "\n";
+        return 0;
+    }
+
+    int Bench(Connection& connection, const std::string& action, size_t count, size_t depth) {
+        std::vector<Clock::time_point> sent(count);
+        std::vector<double> latencies;
+        latencies.reserve(count);
+        size_t next = 0, errors = 0;
+
+        // Tops the pipeline up to depth requests in one write
+        auto fill = [&] {
+            std::string frames;
+            while (next < count && next - latencies.size() < depth) {
+                sent[next] = Clock::now();
+                ControlProtocol::Append(frames, (uint32_t)next, (uint8_t)Op::Invoke, action);
+                ++next;
+            }
+            return frames.empty() || connection.Write(frames);
+        };
+
+        auto start = Clock::now();
+        while (latencies.size() < count) {
+            ControlProtocol::Message reply;
+            if (!fill() || !connection.Next(reply) || reply.id >= count) {
+                std::cerr << "moonkey-ctl: connection lost\n";
+                return 1;
+            }
+            if ((Status)reply.code != Status::Ok) ++errors;
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent[reply.id]).count());
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) { return latencies[std::min(count - 1, (size_t)(p * (double)count))]; };
+        std::printf("{\"bench\":\"control_invoke\",\"count\":%zu,\"depth\":%zu,\"errors\":%zu,\"seconds\":%.6f,"
+                    "\"per_second\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}\n",
+                    count, depth, errors, seconds, (double)count / seconds, percentile(0.5), percentile(0.99), latencies.back());
+        return errors == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string endpoint = ControlProtocol::DefaultEndpoint();
+    int arg = 1;
+    if (arg + 1 < argc && std::strcmp(argv[arg], "-e") == 0) {
+        endpoint = argv[arg + 1];
+        arg += 2;
+    }
+    if (arg >= argc) return Usage();
+    std::string command = argv[arg++];
+
+    Connection connection;
+    if (!connection.Open(endpoint)) {
+        std::cerr << "moonkey-ctl: cannot connect to " << endpoint << "\n";
+        return 1;
+    }
+
+    if (command == "invoke" && arg < argc) {
+        std::string body = argv[arg++];
+        for (; arg < argc; ++arg) {
+            body += '\0';
+            body += argv[arg];
+        }
+        return Request(connection, Op::Invoke, body);
+    }
+    if (command == "stats") return Request(connection, Op::Stats, "");
+    if (command == "reload") return Request(connection, Op::Reload, arg < argc ? argv[arg] : "");
+    if (command == "list") return Request(connection, Op::List, "");
+    if (command == "bench" && arg < argc) {
+        std::string action = argv[arg++];
+        size_t count = arg < argc ? std::stoul(argv[arg++]) : 100000;
+        size_t depth = arg < argc ? std::stoul(argv[arg++]) : 64;
+        if (count == 0 || depth == 0) return Usage();
+        return Bench(connection, action, count, depth);
+    }
+    return Usage();
+}